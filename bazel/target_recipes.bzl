@@ -4,10 +4,12 @@
 TARGET_RECIPES = {
     "ares": "cares",
     "benchmark": "benchmark",
+    "brotli": "brotli",
     "event": "libevent",
     "tcmalloc_and_profiler": "gperftools",
     "luajit": "luajit",
     "nghttp2": "nghttp2",
     "yaml_cpp": "yaml-cpp",
     "zlib": "zlib",
+    "zstd": "zstd",
 }
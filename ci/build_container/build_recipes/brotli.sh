@@ -0,0 +1,21 @@
+#!/bin/bash
+
+set -e
+
+VERSION=1.0.9
+SHA256=f9e8d81d0405ba66d181529af42a3354f838c939095ff99930da6aa9cdf6fe46
+
+curl https://github.com/google/brotli/archive/v"$VERSION".tar.gz -sLo brotli-"$VERSION".tar.gz \
+  && echo "$SHA256" brotli-"$VERSION".tar.gz | sha256sum --check
+tar xf brotli-"$VERSION".tar.gz
+cd brotli-"$VERSION"
+
+mkdir build
+cd build
+
+cmake -G "Ninja" -DCMAKE_INSTALL_PREFIX:PATH="$THIRDPARTY_BUILD" \
+  -DCMAKE_BUILD_TYPE=Release \
+  -DBROTLI_DISABLE_TESTS=ON \
+  ..
+ninja
+ninja install
@@ -0,0 +1,24 @@
+#!/bin/bash
+
+set -e
+
+VERSION=1.4.5
+SHA256=98e91c7c6bf162bf90e4e70fdbc41a8188b9fa8de5ad840c401198014406ce9e
+
+curl https://github.com/facebook/zstd/releases/download/v"$VERSION"/zstd-"$VERSION".tar.gz \
+  -sLo zstd-"$VERSION".tar.gz \
+  && echo "$SHA256" zstd-"$VERSION".tar.gz | sha256sum --check
+tar xf zstd-"$VERSION".tar.gz
+cd zstd-"$VERSION"/build/cmake
+
+mkdir build
+cd build
+
+cmake -G "Ninja" -DCMAKE_INSTALL_PREFIX:PATH="$THIRDPARTY_BUILD" \
+  -DCMAKE_BUILD_TYPE=Release \
+  -DZSTD_BUILD_PROGRAMS=OFF \
+  -DZSTD_BUILD_SHARED=OFF \
+  -DZSTD_BUILD_STATIC=ON \
+  ..
+ninja
+ninja install
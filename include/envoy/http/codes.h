@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <memory>
 
 #include "envoy/stats/scope.h"
 
@@ -86,6 +87,18 @@ class CodeStats {
 public:
   virtual ~CodeStats() = default;
 
+  /**
+   * Response code counters of one scope and prefix, each resolved the first time it is charged
+   * so that charging a response does not build stat names or look them up in the scope. Created
+   * with createResponseCounters() and owned by whoever owns the scope, such as a cluster.
+   */
+  class ResponseCounters {
+  public:
+    virtual ~ResponseCounters() = default;
+  };
+
+  typedef std::unique_ptr<ResponseCounters> ResponseCountersPtr;
+
   struct ResponseStatInfo {
     Stats::Scope& global_scope_;
     Stats::Scope& cluster_scope_;
@@ -97,6 +110,9 @@ public:
     const std::string& from_zone_;
     const std::string& to_zone_;
     bool upstream_canary_;
+    // If set, charges the stats of cluster_scope_ and prefix_ through these counters. They must
+    // have been created by the same CodeStats for cluster_scope_ and prefix_.
+    const ResponseCounters* cluster_counters_{};
   };
 
   struct ResponseTimingInfo {
@@ -125,6 +141,14 @@ public:
    */
   virtual void chargeResponseStat(const ResponseStatInfo& info) const PURE;
 
+  /**
+   * @param scope supplies the scope to charge response stats to. It must outlive the counters.
+   * @param prefix supplies the prefix of the response stats.
+   * @return ResponseCountersPtr counters to pass as ResponseStatInfo::cluster_counters_.
+   */
+  virtual ResponseCountersPtr createResponseCounters(Stats::Scope& scope,
+                                                     const std::string& prefix) const PURE;
+
   /**
    * Charge a response timing to the various dynamic stat postfixes.
    */
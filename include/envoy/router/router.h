@@ -7,9 +7,11 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/api/v2/core/base.pb.h"
+#include "envoy/common/regex.h"
 #include "envoy/config/typed_metadata.h"
 #include "envoy/http/codec.h"
 #include "envoy/http/codes.h"
@@ -101,9 +103,9 @@ public:
   virtual const std::list<std::string>& allowOrigins() const PURE;
 
   /*
-   * @return std::list<std::regex>& regexes that match allowed origins.
+   * @return std::vector<Regex::CompiledMatcherPtr>& regexes that match allowed origins.
    */
-  virtual const std::list<std::regex>& allowOriginRegexes() const PURE;
+  virtual const std::vector<Regex::CompiledMatcherPtr>& allowOriginRegexes() const PURE;
 
   /**
    * @return std::string access-control-allow-methods value.
@@ -343,9 +345,10 @@ public:
   virtual const RateLimitPolicy& rateLimitPolicy() const PURE;
 
   /**
-   * @return const Config& the RouteConfiguration that owns this virtual host.
+   * @return const CommonConfig& the shared part of the RouteConfiguration that owns this virtual
+   *         host. A virtual host may be shared by successive versions of a RouteConfiguration.
    */
-  virtual const Config& routeConfig() const PURE;
+  virtual const CommonConfig& routeConfig() const PURE;
 
   /**
    * @return const RouteSpecificFilterConfig* the per-filter config pre-processed object for
@@ -701,22 +704,11 @@ public:
 typedef std::shared_ptr<const Route> RouteConstSharedPtr;
 
 /**
- * The router configuration.
+ * The part of the router configuration that is shared by all of its virtual hosts.
  */
-class Config {
+class CommonConfig {
 public:
-  virtual ~Config() {}
-
-  /**
-   * Based on the incoming HTTP request headers, determine the target route (containing either a
-   * route entry or a direct response entry) for the request.
-   * @param headers supplies the request headers.
-   * @param random_value supplies the random seed to use if a runtime choice is required. This
-   *        allows stable choices between calls if desired.
-   * @return the route or nullptr if there is no matching route for the request.
-   */
-  virtual RouteConstSharedPtr route(const Http::HeaderMap& headers,
-                                    uint64_t random_value) const PURE;
+  virtual ~CommonConfig() {}
 
   /**
    * Return a list of headers that will be cleaned from any requests that are not from an internal
@@ -730,6 +722,23 @@ public:
   virtual const std::string& name() const PURE;
 };
 
+/**
+ * The router configuration.
+ */
+class Config : public CommonConfig {
+public:
+  /**
+   * Based on the incoming HTTP request headers, determine the target route (containing either a
+   * route entry or a direct response entry) for the request.
+   * @param headers supplies the request headers.
+   * @param random_value supplies the random seed to use if a runtime choice is required. This
+   *        allows stable choices between calls if desired.
+   * @return the route or nullptr if there is no matching route for the request.
+   */
+  virtual RouteConstSharedPtr route(const Http::HeaderMap& headers,
+                                    uint64_t random_value) const PURE;
+};
+
 typedef std::shared_ptr<const Config> ConfigConstSharedPtr;
 
 } // namespace Router
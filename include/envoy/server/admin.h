@@ -39,6 +39,13 @@ public:
    */
   virtual Http::StreamDecoderFilterCallbacks& getDecoderFilterCallbacks() const PURE;
 
+  /**
+   * @return bool whether the handler can stream the response through getDecoderFilterCallbacks().
+   * This is not the case for requests made through Admin::request(), which are not received on a
+   * connection.
+   */
+  virtual bool canStream() const PURE;
+
   /**
    * @return Http::HeaderMap& to be used by handler to parse header information sent with the
    * request.
@@ -70,6 +70,13 @@ public:
    */
   virtual std::chrono::milliseconds statsFlushInterval() const PURE;
 
+  /**
+   * @return std::chrono::milliseconds the minimum time interval between flushes of all used stats
+   *         to configured stat sinks. Other flushes only include the stats that changed. Zero if
+   *         every flush includes all used stats.
+   */
+  virtual std::chrono::milliseconds statsFullFlushInterval() const PURE;
+
   /**
    * @return std::chrono::milliseconds the time interval after which we count a nonresponsive thread
    *         event as a "miss" statistic.
@@ -3,6 +3,7 @@
 #include <functional>
 
 #include "envoy/access_log/access_log.h"
+#include "envoy/api/api.h"
 #include "envoy/api/v2/core/base.pb.h"
 #include "envoy/http/codes.h"
 #include "envoy/http/context.h"
@@ -42,6 +43,11 @@ public:
    */
   virtual AccessLog::AccessLogManager& accessLogManager() PURE;
 
+  /**
+   * @return Api::Api& a reference to the api object.
+   */
+  virtual Api::Api& api() PURE;
+
   /**
    * @return Upstream::ClusterManager& singleton for use by the entire server.
    */
@@ -31,6 +31,27 @@ public:
    * Returns computed quantile values during the period.
    */
   virtual const std::vector<double>& computedQuantiles() const PURE;
+
+  /**
+   * Returns the upper bounds of the supported buckets, in ascending order.
+   */
+  virtual const std::vector<double>& supportedBuckets() const PURE;
+
+  /**
+   * Returns the computed number of values less than or equal to the upper bound of each of the
+   * supported buckets during the period.
+   */
+  virtual const std::vector<uint64_t>& computedBuckets() const PURE;
+
+  /**
+   * Returns the number of values recorded during the period.
+   */
+  virtual uint64_t sampleCount() const PURE;
+
+  /**
+   * Returns the approximate sum of the values recorded during the period.
+   */
+  virtual double sampleSum() const PURE;
 };
 
 /**
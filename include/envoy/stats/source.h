@@ -45,6 +45,32 @@ public:
    */
   virtual const std::vector<ParentHistogramSharedPtr>& cachedHistograms() PURE;
 
+  /**
+   * Returns the counters that were added to since the changed counters were last computed, or all
+   * used counters if the flush is a full one. The changed state of every counter is cleared, so
+   * all the sinks of a flush see the same counters. Will use cached values if already accessed and
+   * clearCache() hasn't been called since.
+   * @return std::vector<CounterSharedPtr>& the changed counters. Note: reference may not be valid
+   * after clearCache() is called.
+   */
+  virtual const std::vector<CounterSharedPtr>& cachedChangedCounters() PURE;
+
+  /**
+   * Returns the gauges whose value changed since the changed gauges were last computed, or all used
+   * gauges if the flush is a full one. Will use cached values if already accessed and clearCache()
+   * hasn't been called since.
+   * @return std::vector<GaugeSharedPtr>& the changed gauges. Note: reference may not be valid after
+   * clearCache() is called.
+   */
+  virtual const std::vector<GaugeSharedPtr>& cachedChangedGauges() PURE;
+
+  /**
+   * Sets whether the changed metrics computed until the next clearCache() include all used
+   * metrics, so that sinks which only flush changed metrics periodically resend every metric.
+   * @param full_flush supplies whether the flush is a full one.
+   */
+  virtual void setFullFlush(bool full_flush) PURE;
+
   /**
    * Resets the cache so that any future calls to get cached metrics will refresh the set.
    */
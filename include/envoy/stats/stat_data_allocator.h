@@ -10,6 +10,7 @@
 
 #include "envoy/common/pure.h"
 #include "envoy/stats/stats.h"
+#include "envoy/stats/symbol_table.h"
 #include "envoy/stats/tag.h"
 
 #include "absl/strings/string_view.h"
@@ -18,9 +19,8 @@ namespace Envoy {
 namespace Stats {
 
 /**
- * Abstract interface for allocating statistics. Implementations can
- * be created utilizing a single fixed-size block suitable for
- * shared-memory, or in the heap, allowing for pointers and sharing of
+ * Abstract interface for allocating statistics. Implementations allocate
+ * the statistics in the heap, allowing for pointers and sharing of
  * substrings, with an opportunity for reduced memory consumption.
  */
 class StatDataAllocator {
@@ -52,6 +52,13 @@ public:
    */
   virtual bool requiresBoundedStatNameSize() const PURE;
 
+  /**
+   * @return SymbolTable& the symbol table in which the tag-extracted names and tags of the stats
+   *     created by this allocator are stored. Stats created elsewhere in the same store, such as
+   *     histograms, may share it.
+   */
+  virtual SymbolTable& symbolTable() PURE;
+
   // TODO(jmarantz): create a parallel mechanism to instantiate histograms. At
   // the moment, histograms don't fit the same pattern of counters and gaugaes
   // as they are not actually created in the context of a stats allocator.
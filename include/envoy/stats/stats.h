@@ -45,14 +45,17 @@ public:
   virtual const char* nameCStr() const PURE;
 
   /**
-   * Returns a vector of configurable tags to identify this Metric.
+   * Returns a vector of configurable tags to identify this Metric. The tags are
+   * returned by value, as implementations may store them in a symbolized form
+   * and only elaborate them when exporting.
    */
-  virtual const std::vector<Tag>& tags() const PURE;
+  virtual std::vector<Tag> tags() const PURE;
 
   /**
    * Returns the name of the Metric with the portions designated as tags removed.
+   * As with tags(), this is returned by value.
    */
-  virtual const std::string& tagExtractedName() const PURE;
+  virtual std::string tagExtractedName() const PURE;
 
   /**
    * Indicates whether this metric has been updated since the server was started.
@@ -73,6 +76,12 @@ public:
   virtual uint64_t latch() PURE;
   virtual void reset() PURE;
   virtual uint64_t value() const PURE;
+
+  /**
+   * Clears the changed state of the counter, independently of latch().
+   * @return bool whether the counter was added to since the previous call.
+   */
+  virtual bool latchChanged() PURE;
 };
 
 typedef std::shared_ptr<Counter> CounterSharedPtr;
@@ -90,6 +99,18 @@ public:
   virtual void set(uint64_t value) PURE;
   virtual void sub(uint64_t amount) PURE;
   virtual uint64_t value() const PURE;
+
+  /**
+   * @return bool whether the gauge was ever set() to a value. Such a gauge holds a value of its
+   *         own process, e.g. the uptime, rather than the sum of what its users added to it.
+   */
+  virtual bool wasSet() const PURE;
+
+  /**
+   * Clears the changed state of the gauge.
+   * @return bool whether the value of the gauge changed since the previous call.
+   */
+  virtual bool latchChanged() PURE;
 };
 
 typedef std::shared_ptr<Gauge> GaugeSharedPtr;
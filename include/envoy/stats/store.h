@@ -74,6 +74,14 @@ public:
    */
   virtual void setStatsMatcher(StatsMatcherPtr&& stats_matcher) PURE;
 
+  /**
+   * Sets the upper bounds of the buckets that the bucket counts of histograms are computed for.
+   * Histograms keep the buckets they were created with, so this only applies to the histograms
+   * created after it is called.
+   * @param buckets supplies the upper bounds, in any order. If empty, default buckets are used.
+   */
+  virtual void setHistogramBuckets(const std::vector<double>& buckets) PURE;
+
   /**
    * Initialize the store for threading. This will be called once after all worker threads have
    * been initialized. At this point the store can initialize itself for multi-threaded operation.
@@ -55,6 +55,16 @@ public:
    */
   virtual void runOnAllThreads(Event::PostCb cb, Event::PostCb all_threads_complete_cb) PURE;
 
+  /**
+   * Run a callback on all registered threads with the object stored in the slot on each of them.
+   * The callback is handed the object rather than looking it up through the slot, so that it does
+   * not need to capture the slot or its owner, which may be destroyed before the callback runs on
+   * every thread. The callback is not run on threads where the slot holds no object.
+   * @param cb supplies the callback to run on each thread.
+   */
+  typedef std::function<void(ThreadLocalObject& object)> ObjectCb;
+  virtual void runOnAllThreads(ObjectCb cb) PURE;
+
   /**
    * Set thread local data on all threads previously registered via registerThread().
    * @param initializeCb supplies the functor that will be called *on each thread*. The functor
@@ -12,6 +12,7 @@
 #include "envoy/common/callback.h"
 #include "envoy/config/typed_metadata.h"
 #include "envoy/http/codec.h"
+#include "envoy/http/codes.h"
 #include "envoy/network/connection.h"
 #include "envoy/network/transport_socket.h"
 #include "envoy/ssl/context.h"
@@ -647,6 +648,15 @@ public:
    */
   virtual Stats::Scope& statsScope() const PURE;
 
+  /**
+   * @param code_stats supplies the CodeStats that charges the counters. It is only used to create
+   *        them on the first call, so every call must pass the same one.
+   * @return const Http::CodeStats::ResponseCounters& the response code counters of statsScope()
+   *         with no prefix.
+   */
+  virtual const Http::CodeStats::ResponseCounters&
+  responseCounters(const Http::CodeStats& code_stats) const PURE;
+
   /**
    * @return ClusterLoadReportStats& strongly named load report stats for this cluster.
    */
@@ -0,0 +1,68 @@
+#include "common/common/regex.h"
+
+#include <algorithm>
+
+#include "envoy/common/exception.h"
+
+#include "fmt/format.h"
+
+namespace Envoy {
+namespace Regex {
+namespace {
+
+re2::RE2::Options regexOptions() {
+  re2::RE2::Options options;
+  // Errors are reported through exceptions rather than logged by RE2.
+  options.set_log_errors(false);
+  return options;
+}
+
+} // namespace
+
+CompiledGoogleReMatcher::CompiledGoogleReMatcher(const std::string& regex,
+                                                 uint32_t max_program_size)
+    : regex_(regex, regexOptions()) {
+  if (!regex_.ok()) {
+    throw EnvoyException(fmt::format("Invalid regex '{}': {}", regex, regex_.error()));
+  }
+
+  const uint32_t program_size = static_cast<uint32_t>(regex_.ProgramSize());
+  if (program_size > max_program_size) {
+    throw EnvoyException(fmt::format("Regex '{}' program size of {} > max program size of {}",
+                                     regex, program_size, max_program_size));
+  }
+}
+
+CompiledGoogleReSet::CompiledGoogleReSet(const std::vector<std::string>& regexes,
+                                         re2::RE2::Anchor anchor)
+    : set_(regexOptions(), anchor) {
+  for (const std::string& regex : regexes) {
+    std::string error;
+    if (set_.Add(regex, &error) < 0) {
+      throw EnvoyException(fmt::format("Invalid regex '{}': {}", regex, error));
+    }
+  }
+  if (!set_.Compile()) {
+    throw EnvoyException(fmt::format("Unable to compile a set of {} regexes", regexes.size()));
+  }
+}
+
+bool CompiledGoogleReSet::match(absl::string_view value, std::vector<int>& matches) const {
+  re2::RE2::Set::ErrorInfo error_info;
+  if (!set_.Match(re2::StringPiece(value.data(), value.size()), &matches, &error_info) &&
+      error_info.kind != re2::RE2::Set::kNoError) {
+    return false;
+  }
+  // RE2 does not report the matches in any particular order.
+  std::sort(matches.begin(), matches.end());
+  return true;
+}
+
+constexpr uint32_t Utility::DefaultMaxProgramSize;
+
+CompiledMatcherPtr Utility::parseRegex(const std::string& regex) {
+  return std::make_unique<const CompiledGoogleReMatcher>(regex, DefaultMaxProgramSize);
+}
+
+} // namespace Regex
+} // namespace Envoy
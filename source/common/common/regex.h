@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "envoy/common/regex.h"
+
+#include "re2/re2.h"
+#include "re2/set.h"
+
+namespace Envoy {
+namespace Regex {
+
+/**
+ * A regular expression matcher backed by RE2. RE2 runs in time linear in the size of the input
+ * and uses bounded memory, so unlike std::regex it cannot be made to backtrack or recurse on
+ * adversarial input. In exchange it does not support backreferences or lookaround assertions.
+ */
+class CompiledGoogleReMatcher : public CompiledMatcher {
+public:
+  /**
+   * @param regex supplies the regular expression in RE2 syntax.
+   * @param max_program_size supplies the largest program size the compiled regex may have.
+   * @throw EnvoyException if the regex is invalid or its program is too large.
+   */
+  CompiledGoogleReMatcher(const std::string& regex, uint32_t max_program_size);
+
+  // Regex::CompiledMatcher
+  bool match(absl::string_view value) const override {
+    return re2::RE2::FullMatch(re2::StringPiece(value.data(), value.size()), regex_);
+  }
+
+  /**
+   * @return const re2::RE2& the compiled regex, for callers that need submatches.
+   */
+  const re2::RE2& regex() const { return regex_; }
+
+private:
+  const re2::RE2 regex_;
+};
+
+/**
+ * A set of regular expressions backed by RE2::Set. The set is compiled into a single automaton
+ * that finds every regex fully matching a value in one pass over the value, instead of one pass
+ * per regex.
+ */
+class CompiledGoogleReSet {
+public:
+  /**
+   * @param regexes supplies the regular expressions in RE2 syntax. A regex is identified by its
+   *        position in this list.
+   * @param anchor supplies where the regexes must match a value. By default they must match all
+   *        of it; UNANCHORED finds the regexes that match anywhere in the value.
+   * @throw EnvoyException if a regex is invalid or the set cannot be compiled.
+   */
+  CompiledGoogleReSet(const std::vector<std::string>& regexes,
+                      re2::RE2::Anchor anchor = re2::RE2::ANCHOR_BOTH);
+
+  /**
+   * @param value supplies the value to match.
+   * @param matches receives the positions of the regexes that match the value, in ascending
+   *        order.
+   * @return bool false if the automaton ran out of memory, in which case the matches are unknown
+   *         and the caller must match each regex on its own.
+   */
+  bool match(absl::string_view value, std::vector<int>& matches) const;
+
+private:
+  re2::RE2::Set set_;
+};
+
+typedef std::unique_ptr<const CompiledGoogleReSet> CompiledGoogleReSetPtr;
+
+/**
+ * Utilities for constructing regular expression matchers.
+ */
+class Utility {
+public:
+  /**
+   * The default upper bound on the program size of a compiled regex. The program size is a
+   * rough measure of the cost of running the regex; this bound rejects pathological patterns
+   * such as large bounded repetitions at config load.
+   */
+  static constexpr uint32_t DefaultMaxProgramSize = 1000;
+
+  /**
+   * Constructs a matcher for a regex in RE2 syntax.
+   * @param regex supplies the regular expression.
+   * @return CompiledMatcherPtr the compiled matcher.
+   * @throw EnvoyException if the regex is invalid or its program is too large.
+   */
+  static CompiledMatcherPtr parseRegex(const std::string& regex);
+};
+
+} // namespace Regex
+} // namespace Envoy
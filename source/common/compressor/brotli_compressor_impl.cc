@@ -0,0 +1,72 @@
+#include "common/compressor/brotli_compressor_impl.h"
+
+#include <memory>
+
+#include "common/common/assert.h"
+#include "common/common/stack_array.h"
+
+namespace Envoy {
+namespace Compressor {
+
+BrotliCompressorImpl::BrotliCompressorImpl(uint32_t quality, uint32_t window_bits,
+                                           uint64_t chunk_size)
+    : chunk_size_{chunk_size}, chunk_ptr_(new uint8_t[chunk_size]),
+      state_(BrotliEncoderCreateInstance(nullptr, nullptr, nullptr), &BrotliEncoderDestroyInstance),
+      avail_out_(chunk_size), next_out_(chunk_ptr_.get()) {
+  RELEASE_ASSERT(state_ != nullptr, "");
+  RELEASE_ASSERT(BrotliEncoderSetParameter(state_.get(), BROTLI_PARAM_QUALITY, quality), "");
+  RELEASE_ASSERT(BrotliEncoderSetParameter(state_.get(), BROTLI_PARAM_LGWIN, window_bits), "");
+}
+
+void BrotliCompressorImpl::compress(Buffer::Instance& buffer, State state) {
+  const uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
+  STACK_ARRAY(slices, Buffer::RawSlice, num_slices);
+  buffer.getRawSlices(slices.begin(), num_slices);
+
+  for (const Buffer::RawSlice& input_slice : slices) {
+    avail_in_ = input_slice.len_;
+    next_in_ = static_cast<const uint8_t*>(input_slice.mem_);
+    // As with zlib, output is appended to the end of the buffer whenever the chunk fills up, and
+    // the input is drained from the front once it has been consumed.
+    process(buffer, BROTLI_OPERATION_PROCESS);
+    buffer.drain(input_slice.len_);
+  }
+
+  process(buffer, state == State::Finish ? BROTLI_OPERATION_FINISH : BROTLI_OPERATION_FLUSH);
+}
+
+void BrotliCompressorImpl::process(Buffer::Instance& output_buffer,
+                                   BrotliEncoderOperation operation) {
+  while (true) {
+    RELEASE_ASSERT(BrotliEncoderCompressStream(state_.get(), operation, &avail_in_, &next_in_,
+                                               &avail_out_, &next_out_, nullptr),
+                   "");
+    if (avail_out_ == 0) {
+      updateOutput(output_buffer);
+    }
+    if (operation == BROTLI_OPERATION_PROCESS) {
+      // Without a flush, only the input needs to be consumed; the encoder may hold on to output.
+      if (avail_in_ == 0) {
+        break;
+      }
+    } else if (avail_in_ == 0 && !BrotliEncoderHasMoreOutput(state_.get())) {
+      break;
+    }
+  }
+
+  if (operation != BROTLI_OPERATION_PROCESS) {
+    updateOutput(output_buffer);
+  }
+}
+
+void BrotliCompressorImpl::updateOutput(Buffer::Instance& output_buffer) {
+  const uint64_t n_output = chunk_size_ - avail_out_;
+  if (n_output > 0) {
+    output_buffer.add(static_cast<void*>(chunk_ptr_.get()), n_output);
+  }
+  avail_out_ = chunk_size_;
+  next_out_ = chunk_ptr_.get();
+}
+
+} // namespace Compressor
+} // namespace Envoy
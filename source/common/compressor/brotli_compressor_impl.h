@@ -0,0 +1,42 @@
+#pragma once
+
+#include "envoy/compressor/compressor.h"
+
+#include "brotli/encode.h"
+
+namespace Envoy {
+namespace Compressor {
+
+/**
+ * Implementation of compressor's interface producing a Brotli stream. @see RFC 7932
+ */
+class BrotliCompressorImpl : public Compressor {
+public:
+  /**
+   * @param quality sets the compression quality, from 0 (fastest) to 11 (best compression).
+   * @param window_bits sets the base 2 logarithm of the sliding window size, from 10 to 24. Larger
+   * values result in better compression, but use more memory in both the compressor and the
+   * decompressor.
+   * @param chunk_size amount of memory reserved for the compressor output.
+   */
+  BrotliCompressorImpl(uint32_t quality, uint32_t window_bits, uint64_t chunk_size = 4096);
+
+  // Compressor
+  void compress(Buffer::Instance& buffer, State state) override;
+
+private:
+  void process(Buffer::Instance& output_buffer, BrotliEncoderOperation operation);
+  void updateOutput(Buffer::Instance& output_buffer);
+
+  const uint64_t chunk_size_;
+  std::unique_ptr<uint8_t[]> chunk_ptr_;
+  std::unique_ptr<BrotliEncoderState, decltype(&BrotliEncoderDestroyInstance)> state_;
+
+  size_t avail_in_{};
+  const uint8_t* next_in_{};
+  size_t avail_out_;
+  uint8_t* next_out_;
+};
+
+} // namespace Compressor
+} // namespace Envoy
@@ -0,0 +1,67 @@
+#include "common/compressor/zstd_compressor_impl.h"
+
+#include <memory>
+
+#include "common/common/assert.h"
+#include "common/common/stack_array.h"
+
+namespace Envoy {
+namespace Compressor {
+
+ZstdCompressorImpl::ZstdCompressorImpl(uint32_t compression_level, bool enable_checksum,
+                                       uint64_t chunk_size)
+    : chunk_ptr_(new uint8_t[chunk_size]), cctx_(ZSTD_createCCtx(), &ZSTD_freeCCtx),
+      output_{chunk_ptr_.get(), chunk_size, 0} {
+  RELEASE_ASSERT(cctx_ != nullptr, "");
+  size_t result =
+      ZSTD_CCtx_setParameter(cctx_.get(), ZSTD_c_compressionLevel, compression_level);
+  RELEASE_ASSERT(!ZSTD_isError(result), ZSTD_getErrorName(result));
+  result = ZSTD_CCtx_setParameter(cctx_.get(), ZSTD_c_checksumFlag, enable_checksum ? 1 : 0);
+  RELEASE_ASSERT(!ZSTD_isError(result), ZSTD_getErrorName(result));
+}
+
+void ZstdCompressorImpl::compress(Buffer::Instance& buffer, State state) {
+  const uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
+  STACK_ARRAY(slices, Buffer::RawSlice, num_slices);
+  buffer.getRawSlices(slices.begin(), num_slices);
+
+  for (const Buffer::RawSlice& input_slice : slices) {
+    input_ = {input_slice.mem_, input_slice.len_, 0};
+    // As with zlib, output is appended to the end of the buffer whenever the chunk fills up, and
+    // the input is drained from the front once it has been consumed.
+    process(buffer, ZSTD_e_continue);
+    buffer.drain(input_slice.len_);
+  }
+
+  input_ = {nullptr, 0, 0};
+  process(buffer, state == State::Finish ? ZSTD_e_end : ZSTD_e_flush);
+}
+
+void ZstdCompressorImpl::process(Buffer::Instance& output_buffer, ZSTD_EndDirective mode) {
+  while (true) {
+    const size_t remaining = ZSTD_compressStream2(cctx_.get(), &output_, &input_, mode);
+    RELEASE_ASSERT(!ZSTD_isError(remaining), ZSTD_getErrorName(remaining));
+    if (output_.pos == output_.size) {
+      updateOutput(output_buffer);
+    }
+    // Without a flush, only the input needs to be consumed. Otherwise the return value is the
+    // amount of data still to be flushed.
+    if (mode == ZSTD_e_continue ? input_.pos == input_.size : remaining == 0) {
+      break;
+    }
+  }
+
+  if (mode != ZSTD_e_continue) {
+    updateOutput(output_buffer);
+  }
+}
+
+void ZstdCompressorImpl::updateOutput(Buffer::Instance& output_buffer) {
+  if (output_.pos > 0) {
+    output_buffer.add(output_.dst, output_.pos);
+  }
+  output_.pos = 0;
+}
+
+} // namespace Compressor
+} // namespace Envoy
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "envoy/compressor/compressor.h"
+
+#include "zstd.h"
+
+namespace Envoy {
+namespace Compressor {
+
+/**
+ * Implementation of compressor's interface producing a Zstandard stream. @see RFC 8478
+ */
+class ZstdCompressorImpl : public Compressor {
+public:
+  /**
+   * @param compression_level sets the compression level, from 1 (fastest) to 19 (best
+   * compression); 3 is the library default.
+   * @param enable_checksum adds a checksum of the uncompressed data to the end of the stream.
+   * @param chunk_size amount of memory reserved for the compressor output.
+   */
+  ZstdCompressorImpl(uint32_t compression_level, bool enable_checksum,
+                     uint64_t chunk_size = 4096);
+
+  // Compressor
+  void compress(Buffer::Instance& buffer, State state) override;
+
+private:
+  void process(Buffer::Instance& output_buffer, ZSTD_EndDirective mode);
+  void updateOutput(Buffer::Instance& output_buffer);
+
+  std::unique_ptr<uint8_t[]> chunk_ptr_;
+  std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> cctx_;
+  ZSTD_inBuffer input_{nullptr, 0, 0};
+  ZSTD_outBuffer output_;
+};
+
+} // namespace Compressor
+} // namespace Envoy
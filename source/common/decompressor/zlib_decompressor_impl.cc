@@ -41,6 +41,9 @@ void ZlibDecompressorImpl::decompress(const Buffer::Instance& input_buffer,
   input_buffer.getRawSlices(slices.begin(), num_slices);
 
   for (const Buffer::RawSlice& input_slice : slices) {
+    if (decompression_error_) {
+      break;
+    }
     zstream_ptr_->avail_in = input_slice.len_;
     zstream_ptr_->next_in = static_cast<Bytef*>(input_slice.mem_);
     while (inflateNext()) {
@@ -57,6 +60,10 @@ void ZlibDecompressorImpl::decompress(const Buffer::Instance& input_buffer,
   const uint64_t n_output{chunk_size_ - zstream_ptr_->avail_out};
   if (n_output > 0) {
     output_buffer.add(static_cast<void*>(chunk_char_ptr_.get()), n_output);
+    // The next call starts a new chunk, so that the bytes flushed here are not output again.
+    chunk_char_ptr_ = std::make_unique<unsigned char[]>(chunk_size_);
+    zstream_ptr_->avail_out = chunk_size_;
+    zstream_ptr_->next_out = chunk_char_ptr_.get();
   }
 }
 
@@ -73,6 +80,12 @@ bool ZlibDecompressorImpl::inflateNext() {
     return false; // This means that zlib needs more input, so stop here.
   }
 
+  // Malformed input is not fatal, as the compressed data may come from an untrusted peer.
+  if (result == Z_DATA_ERROR || result == Z_NEED_DICT) {
+    decompression_error_ = true;
+    return false;
+  }
+
   RELEASE_ASSERT(result == Z_OK, "");
   return true;
 }
@@ -40,6 +40,12 @@ public:
    */
   uint64_t checksum();
 
+  /**
+   * @return true if the input was found to be malformed. Once set, further input is ignored, as
+   * the stream cannot be resynchronized.
+   */
+  bool decompressionError() const { return decompression_error_; }
+
   // Decompressor
   void decompress(const Buffer::Instance& input_buffer, Buffer::Instance& output_buffer) override;
 
@@ -48,6 +54,7 @@ private:
 
   const uint64_t chunk_size_;
   bool initialized_;
+  bool decompression_error_{};
 
   std::unique_ptr<unsigned char[]> chunk_char_ptr_;
   std::unique_ptr<z_stream, std::function<void(z_stream*)>> zstream_ptr_;
@@ -1,5 +1,6 @@
 #include "common/http/codes.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 
@@ -29,8 +30,78 @@ void CodeStatsImpl::chargeBasicResponseStat(Stats::Scope& scope, const std::stri
   scope.counter(absl::StrCat(prefix, upstream_rq_, enumToInt(response_code))).inc();
 }
 
+namespace {
+
+// The prefixes of the response code counters, indexed by ResponseCountersImpl::Kind.
+const char* const RESPONSE_COUNTER_PREFIXES[] = {"upstream_rq_", "canary.upstream_rq_",
+                                                 "internal.upstream_rq_", "external.upstream_rq_"};
+
+} // namespace
+
+constexpr std::array<uint16_t, 23> CodeStatsImpl::ResponseCountersImpl::COMMON_CODES;
+
+CodeStatsImpl::ResponseCountersImpl::ResponseCountersImpl(Stats::Scope& scope,
+                                                          const std::string& prefix)
+    : scope_(scope), prefix_(prefix) {}
+
+void CodeStatsImpl::ResponseCountersImpl::charge(Kind kind, Code response_code) const {
+  const uint64_t code = enumToInt(response_code);
+  counter(kind, 0, "completed").inc();
+
+  const std::string group_string = CodeUtility::groupStringForResponseCode(response_code);
+  if (!group_string.empty()) {
+    counter(kind, code / 100, group_string).inc();
+  } else {
+    scope_.counter(absl::StrCat(prefix_, RESPONSE_COUNTER_PREFIXES[static_cast<size_t>(kind)]))
+        .inc();
+  }
+
+  const auto it = std::lower_bound(COMMON_CODES.begin(), COMMON_CODES.end(), code);
+  if (it != COMMON_CODES.end() && *it == code) {
+    counter(kind, 6 + (it - COMMON_CODES.begin()), std::to_string(code)).inc();
+  } else {
+    scope_
+        .counter(
+            absl::StrCat(prefix_, RESPONSE_COUNTER_PREFIXES[static_cast<size_t>(kind)], code))
+        .inc();
+  }
+}
+
+Stats::Counter& CodeStatsImpl::ResponseCountersImpl::counter(Kind kind, size_t index,
+                                                             absl::string_view suffix) const {
+  std::atomic<Stats::Counter*>& slot =
+      counters_[static_cast<size_t>(kind) * COUNTERS_PER_KIND + index];
+  Stats::Counter* counter = slot.load(std::memory_order_acquire);
+  if (counter == nullptr) {
+    // Racing threads resolve the same counter, so either may store it.
+    counter = &scope_.counter(
+        absl::StrCat(prefix_, RESPONSE_COUNTER_PREFIXES[static_cast<size_t>(kind)], suffix));
+    slot.store(counter, std::memory_order_release);
+  }
+  return *counter;
+}
+
+CodeStats::ResponseCountersPtr CodeStatsImpl::createResponseCounters(Stats::Scope& scope,
+                                                                     const std::string& prefix) const {
+  return std::make_unique<ResponseCountersImpl>(scope, prefix);
+}
+
 void CodeStatsImpl::chargeResponseStat(const ResponseStatInfo& info) const {
   const uint64_t response_code = info.response_status_code_;
+
+  if (info.cluster_counters_ != nullptr) {
+    const auto& counters = static_cast<const ResponseCountersImpl&>(*info.cluster_counters_);
+    counters.charge(ResponseCountersImpl::Kind::All, static_cast<Code>(response_code));
+    if (info.upstream_canary_) {
+      counters.charge(ResponseCountersImpl::Kind::Canary, static_cast<Code>(response_code));
+    }
+    counters.charge(info.internal_request_ ? ResponseCountersImpl::Kind::Internal
+                                           : ResponseCountersImpl::Kind::External,
+                    static_cast<Code>(response_code));
+    chargeVirtualClusterAndZoneStats(info);
+    return;
+  }
+
   chargeBasicResponseStat(info.cluster_scope_, info.prefix_, static_cast<Code>(response_code));
 
   std::string group_string =
@@ -60,6 +131,14 @@ void CodeStatsImpl::chargeResponseStat(const ResponseStatInfo& info) const {
         .inc();
   }
 
+  chargeVirtualClusterAndZoneStats(info);
+}
+
+void CodeStatsImpl::chargeVirtualClusterAndZoneStats(const ResponseStatInfo& info) const {
+  const uint64_t response_code = info.response_status_code_;
+  const std::string group_string =
+      CodeUtility::groupStringForResponseCode(static_cast<Code>(response_code));
+
   // Handle request virtual cluster.
   if (!info.request_vcluster_name_.empty()) {
     info.global_scope_
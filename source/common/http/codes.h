@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <string>
@@ -20,10 +22,49 @@ public:
                                Code response_code) const override;
   void chargeResponseStat(const ResponseStatInfo& info) const override;
   void chargeResponseTiming(const ResponseTimingInfo& info) const override;
+  ResponseCountersPtr createResponseCounters(Stats::Scope& scope,
+                                             const std::string& prefix) const override;
 
 private:
   friend class CodeStatsTest;
 
+  /**
+   * Resolves the counters of the response code classes and of the most common codes on first
+   * use. Other codes are charged by name.
+   */
+  class ResponseCountersImpl : public ResponseCounters {
+  public:
+    // The sets of counters charged for a response, with the prefix of their names.
+    enum class Kind { All, Canary, Internal, External, Count };
+
+    ResponseCountersImpl(Stats::Scope& scope, const std::string& prefix);
+
+    void charge(Kind kind, Code response_code) const;
+
+  private:
+    // The common codes, for which counters are kept.
+    static constexpr std::array<uint16_t, 23> COMMON_CODES{{200, 201, 202, 204, 206, 301,
+                                                            302, 304, 307, 400, 401, 403,
+                                                            404, 405, 408, 409, 413, 429,
+                                                            500, 501, 502, 503, 504}};
+    // upstream_rq_completed, one per class (1xx to 5xx) and one per common code.
+    static constexpr size_t COUNTERS_PER_KIND = 1 + 5 + COMMON_CODES.size();
+
+    Stats::Counter& counter(Kind kind, size_t index, absl::string_view suffix) const;
+
+    Stats::Scope& scope_;
+    const std::string prefix_;
+    mutable std::array<std::atomic<Stats::Counter*>,
+                       static_cast<size_t>(Kind::Count) * COUNTERS_PER_KIND>
+        counters_{};
+  };
+
+  /**
+   * Charges the virtual cluster and zone stats of a response, which are not kept in
+   * ResponseCounters.
+   */
+  void chargeVirtualClusterAndZoneStats(const ResponseStatInfo& info) const;
+
   /**
    * Strips any trailing "." from a prefix. This is handy as most prefixes
    * are specified as a literal like "http.", or an empty-string "". We
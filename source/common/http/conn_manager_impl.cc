@@ -1706,9 +1706,10 @@ void ConnectionManagerImpl::ActiveStreamDecoderFilter::
 
 void ConnectionManagerImpl::ActiveStreamDecoderFilter::addDownstreamWatermarkCallbacks(
     DownstreamWatermarkCallbacks& watermark_callbacks) {
-  // This is called exactly once per stream, by the router filter.
-  // If there's ever a need for another filter to subscribe to watermark callbacks this can be
-  // turned into a vector.
+  // This is called at most once per stream at any time, by the router filter or by a filter that
+  // answers the stream without forwarding it, such as the request coalescing filter. If there's
+  // ever a need for several filters to subscribe to watermark callbacks this can be turned into a
+  // vector.
   ASSERT(parent_.watermark_callbacks_ == nullptr);
   parent_.watermark_callbacks_ = &watermark_callbacks;
   for (uint32_t i = 0; i < parent_.high_watermark_count_; ++i) {
@@ -1,15 +1,39 @@
 #include "common/http/header_utility.h"
 
+#include "common/common/regex.h"
 #include "common/common/utility.h"
 #include "common/config/rds_json.h"
 #include "common/http/header_map_impl.h"
+#include "common/http/headers.h"
 #include "common/protobuf/utility.h"
 
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/match.h"
 
 namespace Envoy {
 namespace Http {
 
+namespace {
+
+typedef absl::flat_hash_map<std::string, HeaderUtility::InlineHeaderAccessor>
+    InlineHeaderAccessorMap;
+
+const InlineHeaderAccessorMap& inlineHeaderAccessors() {
+  CONSTRUCT_ON_FIRST_USE(InlineHeaderAccessorMap, [] {
+    InlineHeaderAccessorMap accessors;
+#define INLINE_HEADER_ACCESSOR(name)                                                               \
+  accessors.emplace(Headers::get().name.get(),                                                     \
+                    static_cast<HeaderUtility::InlineHeaderAccessor>(&HeaderMap::name));
+    ALL_INLINE_HEADERS(INLINE_HEADER_ACCESSOR)
+#undef INLINE_HEADER_ACCESSOR
+    accessors.emplace(Headers::get().HostLegacy.get(),
+                      static_cast<HeaderUtility::InlineHeaderAccessor>(&HeaderMap::Host));
+    return accessors;
+  }());
+}
+
+} // namespace
+
 // HeaderMatcher will consist of:
 //   header_match_specifier which can be any one of exact_match, regex_match, range_match,
 //   present_match, prefix_match or suffix_match.
@@ -31,7 +55,7 @@ HeaderUtility::HeaderData::HeaderData(const envoy::api::v2::route::HeaderMatcher
     break;
   case envoy::api::v2::route::HeaderMatcher::kRegexMatch:
     header_match_type_ = HeaderMatchType::Regex;
-    regex_pattern_ = RegexUtil::parseRegex(config.regex_match());
+    regex_ = Regex::Utility::parseRegex(config.regex_match());
     break;
   case envoy::api::v2::route::HeaderMatcher::kRangeMatch:
     header_match_type_ = HeaderMatchType::Range;
@@ -55,6 +79,11 @@ HeaderUtility::HeaderData::HeaderData(const envoy::api::v2::route::HeaderMatcher
     header_match_type_ = HeaderMatchType::Present;
     break;
   }
+
+  const auto it = inlineHeaderAccessors().find(name_.get());
+  if (it != inlineHeaderAccessors().end()) {
+    inline_header_ = it->second;
+  }
 }
 
 HeaderUtility::HeaderData::HeaderData(const Json::Object& config)
@@ -78,10 +107,79 @@ bool HeaderUtility::matchHeaders(const Http::HeaderMap& request_headers,
   return true;
 }
 
+HeaderUtility::HeaderDataList::HeaderDataList(
+    const Protobuf::RepeatedPtrField<envoy::api::v2::route::HeaderMatcher>& config_headers) {
+  for (const auto& config_header : config_headers) {
+    HeaderData header_data(config_header);
+    if (header_data.inline_header_ != nullptr) {
+      inline_headers_.push_back(std::move(header_data));
+      continue;
+    }
+    // Conditions on the same header share its position.
+    const uint32_t position =
+        other_header_names_.emplace(header_data.name_.get(), other_header_names_.size())
+            .first->second;
+    other_headers_.emplace_back(position, std::move(header_data));
+  }
+}
+
+bool HeaderUtility::HeaderDataList::matches(const Http::HeaderMap& request_headers) const {
+  for (const HeaderData& header_data : inline_headers_) {
+    if (!matchHeaders(request_headers, header_data)) {
+      return false;
+    }
+  }
+
+  if (other_header_names_.size() <= 1) {
+    // A single scan of the header map is as cheap as the lookup pass.
+    for (const auto& other_header : other_headers_) {
+      if (!matchHeaders(request_headers, other_header.second)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  struct LookupPass {
+    const absl::flat_hash_map<std::string, uint32_t>& names_;
+    absl::InlinedVector<const HeaderEntry*, 8> headers_;
+    size_t remaining_;
+  };
+  LookupPass pass{other_header_names_,
+                  absl::InlinedVector<const HeaderEntry*, 8>(other_header_names_.size()),
+                  other_header_names_.size()};
+  request_headers.iterate(
+      [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+        LookupPass& pass = *static_cast<LookupPass*>(context);
+        const auto it = pass.names_.find(header.key().getStringView());
+        // Like HeaderMap::get(), use the first header with the name.
+        if (it != pass.names_.end() && pass.headers_[it->second] == nullptr) {
+          pass.headers_[it->second] = &header;
+          if (--pass.remaining_ == 0) {
+            return HeaderMap::Iterate::Break;
+          }
+        }
+        return HeaderMap::Iterate::Continue;
+      },
+      &pass);
+
+  for (const auto& other_header : other_headers_) {
+    if (!matchHeader(pass.headers_[other_header.first], other_header.second)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool HeaderUtility::matchHeaders(const Http::HeaderMap& request_headers,
                                  const HeaderData& header_data) {
-  const Http::HeaderEntry* header = request_headers.get(header_data.name_);
+  const Http::HeaderEntry* header = header_data.inline_header_ != nullptr
+                                        ? (request_headers.*header_data.inline_header_)()
+                                        : request_headers.get(header_data.name_);
+  return matchHeader(header, header_data);
+}
 
+bool HeaderUtility::matchHeader(const Http::HeaderEntry* header, const HeaderData& header_data) {
   if (header == nullptr) {
     return header_data.invert_match_ && header_data.header_match_type_ == HeaderMatchType::Present;
   }
@@ -89,10 +187,10 @@ bool HeaderUtility::matchHeaders(const Http::HeaderMap& request_headers,
   bool match;
   switch (header_data.header_match_type_) {
   case HeaderMatchType::Value:
-    match = header_data.value_.empty() || header->value() == header_data.value_.c_str();
+    match = header_data.value_.empty() || header->value().getStringView() == header_data.value_;
     break;
   case HeaderMatchType::Regex:
-    match = std::regex_match(header->value().c_str(), header_data.regex_pattern_);
+    match = header_data.regex_->match(header->value().getStringView());
     break;
   case HeaderMatchType::Range: {
     int64_t header_value = 0;
@@ -1,13 +1,17 @@
 #pragma once
 
-#include <regex>
 #include <vector>
 
 #include "envoy/api/v2/route/route.pb.h"
+#include "envoy/common/regex.h"
 #include "envoy/http/header_map.h"
 #include "envoy/json/json_object.h"
 #include "envoy/type/range.pb.h"
 
+#include "common/protobuf/protobuf.h"
+
+#include "absl/container/flat_hash_map.h"
+
 namespace Envoy {
 namespace Http {
 
@@ -18,6 +22,9 @@ class HeaderUtility {
 public:
   enum class HeaderMatchType { Value, Regex, Range, Present, Prefix, Suffix };
 
+  // Accessor of one of the predefined inline headers (see ALL_INLINE_HEADERS).
+  typedef const HeaderEntry* (HeaderMap::*InlineHeaderAccessor)() const;
+
   // A HeaderData specifies one of exact value or regex or range element
   // to match in a request's header, specified in the header_match_type_ member.
   // It is the runtime equivalent of the HeaderMatchSpecifier proto in RDS API.
@@ -28,9 +35,35 @@ public:
     const Http::LowerCaseString name_;
     HeaderMatchType header_match_type_;
     std::string value_;
-    std::regex regex_pattern_;
+    Regex::CompiledMatcherPtr regex_;
     envoy::type::Int64Range range_;
     const bool invert_match_;
+    // Set if name_ is an inline header, so that it is found without scanning the header map.
+    InlineHeaderAccessor inline_header_{};
+  };
+
+  /**
+   * A list of header conditions compiled to be matched together. Conditions on inline headers are
+   * checked first. The headers of all the other conditions are then found in a single pass over
+   * the header map, instead of one pass per condition.
+   */
+  class HeaderDataList {
+  public:
+    HeaderDataList(
+        const Protobuf::RepeatedPtrField<envoy::api::v2::route::HeaderMatcher>& config_headers);
+
+    /**
+     * @param request_headers supplies the headers from the request.
+     * @return bool true if all the conditions match, or if there are none.
+     */
+    bool matches(const Http::HeaderMap& request_headers) const;
+
+  private:
+    std::vector<HeaderData> inline_headers_;
+    // Conditions on other headers, with the position of their header in a lookup pass.
+    std::vector<std::pair<uint32_t, HeaderData>> other_headers_;
+    // Maps the names of the other headers to their position in a lookup pass.
+    absl::flat_hash_map<std::string, uint32_t> other_header_names_;
   };
 
   /**
@@ -45,6 +78,13 @@ public:
 
   static bool matchHeaders(const Http::HeaderMap& request_headers, const HeaderData& config_header);
 
+  /**
+   * @param header supplies the request header named by config_header, or nullptr if it is absent.
+   * @param config_header supplies the configured header condition.
+   * @return bool true if the header satisfies the condition.
+   */
+  static bool matchHeader(const Http::HeaderEntry* header, const HeaderData& config_header);
+
   /**
    * Add headers from one HeaderMap to another
    * @param headers target where headers will be added
@@ -24,6 +24,7 @@ public:
   const LowerCaseString AccessControlExposeHeaders{"access-control-expose-headers"};
   const LowerCaseString AccessControlMaxAge{"access-control-max-age"};
   const LowerCaseString AccessControlAllowCredentials{"access-control-allow-credentials"};
+  const LowerCaseString Age{"age"};
   const LowerCaseString Authorization{"authorization"};
   const LowerCaseString CacheControl{"cache-control"};
   const LowerCaseString ClientTraceId{"x-client-trace-id"};
@@ -63,6 +64,7 @@ public:
   const LowerCaseString EnvoyDecoratorOperation{"x-envoy-decorator-operation"};
   const LowerCaseString Etag{"etag"};
   const LowerCaseString Expect{"expect"};
+  const LowerCaseString Expires{"expires"};
   const LowerCaseString ForwardedClientCert{"x-forwarded-client-cert"};
   const LowerCaseString ForwardedFor{"x-forwarded-for"};
   const LowerCaseString ForwardedProto{"x-forwarded-proto"};
@@ -72,6 +74,7 @@ public:
   const LowerCaseString GrpcAcceptEncoding{"grpc-accept-encoding"};
   const LowerCaseString Host{":authority"};
   const LowerCaseString HostLegacy{"host"};
+  const LowerCaseString IfNoneMatch{"if-none-match"};
   const LowerCaseString KeepAlive{"keep-alive"};
   const LowerCaseString LastModified{"last-modified"};
   const LowerCaseString Location{"location"};
@@ -108,9 +111,13 @@ public:
   } UpgradeValues;
 
   struct {
+    const std::string MaxAge{"max-age"};
     const std::string NoCache{"no-cache"};
     const std::string NoCacheMaxAge0{"no-cache, max-age=0"};
+    const std::string NoStore{"no-store"};
     const std::string NoTransform{"no-transform"};
+    const std::string Private{"private"};
+    const std::string SMaxAge{"s-maxage"};
   } CacheControlValues;
 
   struct {
@@ -209,13 +216,18 @@ public:
   } ProtocolStrings;
 
   struct {
+    const std::string Brotli{"br"};
     const std::string Gzip{"gzip"};
     const std::string Identity{"identity"};
     const std::string Wildcard{"*"};
+    const std::string Zstd{"zstd"};
   } AcceptEncodingValues;
 
   struct {
+    const std::string Brotli{"br"};
+    const std::string Deflate{"deflate"};
     const std::string Gzip{"gzip"};
+    const std::string Zstd{"zstd"};
   } ContentEncodingValues;
 
   struct {
@@ -5,7 +5,7 @@
 #include <cstdint>
 #include <map>
 #include <memory>
-#include <regex>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -20,6 +20,7 @@
 #include "common/common/fmt.h"
 #include "common/common/hash.h"
 #include "common/common/logger.h"
+#include "common/common/regex.h"
 #include "common/common/utility.h"
 #include "common/config/metadata.h"
 #include "common/config/rds_json.h"
@@ -108,7 +109,7 @@ CorsPolicyImpl::CorsPolicyImpl(const envoy::api::v2::route::CorsPolicy& config)
     allow_origin_.push_back(origin);
   }
   for (const auto& regex : config.allow_origin_regex()) {
-    allow_origin_regex_.push_back(RegexUtil::parseRegex(regex));
+    allow_origin_regex_.push_back(Regex::Utility::parseRegex(regex));
   }
   allow_methods_ = config.allow_methods();
   allow_headers_ = config.allow_headers();
@@ -308,6 +309,7 @@ RouteEntryImplBase::RouteEntryImplBase(const VirtualHostImpl& vhost,
       strip_query_(route.redirect().strip_query()), retry_policy_(route.route()),
       rate_limit_policy_(route.route().rate_limits()), shadow_policy_(route.route()),
       priority_(ConfigUtility::parsePriority(route.route().priority())),
+      config_headers_(route.match().headers()),
       total_cluster_weight_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(route.route().weighted_clusters(), total_weight, 100UL)),
       route_action_request_headers_parser_(
@@ -358,10 +360,6 @@ RouteEntryImplBase::RouteEntryImplBase(const VirtualHostImpl& vhost,
     }
   }
 
-  for (const auto& header_map : route.match().headers()) {
-    config_headers_.push_back(header_map);
-  }
-
   for (const auto& query_parameter : route.match().query_parameters()) {
     config_query_parameters_.push_back(query_parameter);
   }
@@ -412,7 +410,7 @@ bool RouteEntryImplBase::matchRoute(const Http::HeaderMap& headers, uint64_t ran
     matches &= Grpc::Common::hasGrpcContentType(headers);
   }
 
-  matches &= Http::HeaderUtility::matchHeaders(headers, config_headers_);
+  matches &= config_headers_.matches(headers);
   if (!config_query_parameters_.empty()) {
     Http::Utility::QueryParams query_parameters =
         Http::Utility::parseQueryString(headers.Path()->value().c_str());
@@ -767,7 +765,8 @@ RegexRouteEntryImpl::RegexRouteEntryImpl(const VirtualHostImpl& vhost,
                                          const envoy::api::v2::route::Route& route,
                                          Server::Configuration::FactoryContext& factory_context)
     : RouteEntryImplBase(vhost, route, factory_context),
-      regex_(RegexUtil::parseRegex(route.match().regex())), regex_str_(route.match().regex()) {}
+      regex_(Regex::Utility::parseRegex(route.match().regex())),
+      regex_str_(route.match().regex()) {}
 
 void RegexRouteEntryImpl::rewritePathHeader(Http::HeaderMap& headers,
                                             bool insert_envoy_original_path) const {
@@ -775,7 +774,7 @@ void RegexRouteEntryImpl::rewritePathHeader(Http::HeaderMap& headers,
   const char* query_string_start = Http::Utility::findQueryStringStart(path);
   // TODO(yuval-k): This ASSERT can happen if the path was changed by a filter without clearing the
   // route cache. We should consider if ASSERT-ing is the desired behavior in this case.
-  ASSERT(std::regex_match(path.c_str(), query_string_start, regex_));
+  ASSERT(regex_->match(absl::string_view(path.c_str(), query_string_start - path.c_str())));
   std::string matched_path(path.c_str(), query_string_start);
 
   finalizePathHeader(headers, matched_path, insert_envoy_original_path);
@@ -786,7 +785,7 @@ RouteConstSharedPtr RegexRouteEntryImpl::matches(const Http::HeaderMap& headers,
   if (RouteEntryImplBase::matchRoute(headers, random_value)) {
     const Http::HeaderString& path = headers.Path()->value();
     const char* query_string_start = Http::Utility::findQueryStringStart(path);
-    if (std::regex_match(path.c_str(), query_string_start, regex_)) {
+    if (regex_->match(absl::string_view(path.c_str(), query_string_start - path.c_str()))) {
       return clusterEntry(headers, random_value);
     }
   }
@@ -794,7 +793,7 @@ RouteConstSharedPtr RegexRouteEntryImpl::matches(const Http::HeaderMap& headers,
 }
 
 VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::route::VirtualHost& virtual_host,
-                                 const ConfigImpl& global_route_config,
+                                 const CommonConfigImplConstSharedPtr& global_route_config,
                                  Server::Configuration::FactoryContext& factory_context,
                                  bool validate_clusters)
     : name_(virtual_host.name()), rate_limit_policy_(virtual_host.rate_limits()),
@@ -826,28 +825,41 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::route::VirtualHost& virtu
         route.match().path_specifier_case() == envoy::api::v2::route::RouteMatch::kPath;
     const bool has_regex =
         route.match().path_specifier_case() == envoy::api::v2::route::RouteMatch::kRegex;
+    const bool case_sensitive =
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(route.match(), case_sensitive, true);
+    const uint32_t route_index = routes_.size();
     if (has_prefix) {
       routes_.emplace_back(new PrefixRouteEntryImpl(*this, route, factory_context));
+      route_index_.addPrefix(route_index, route.match().prefix(), case_sensitive);
     } else if (has_path) {
       routes_.emplace_back(new PathRouteEntryImpl(*this, route, factory_context));
+      route_index_.addPath(route_index, route.match().path(), case_sensitive);
     } else {
       ASSERT(has_regex);
       routes_.emplace_back(new RegexRouteEntryImpl(*this, route, factory_context));
+      route_index_.addRegex(route_index, route.match().regex());
     }
 
-    if (validate_clusters) {
-      routes_.back()->validateClusters(factory_context.clusterManager());
-      if (!routes_.back()->shadowPolicy().cluster().empty()) {
-        if (!factory_context.clusterManager().get(routes_.back()->shadowPolicy().cluster())) {
-          throw EnvoyException(fmt::format("route: unknown shadow cluster '{}'",
-                                           routes_.back()->shadowPolicy().cluster()));
-        }
-      }
+    if (route.match().has_runtime_fraction() || route.route().has_weighted_clusters() ||
+        !route.route().cluster_header().empty()) {
+      cacheable_ = false;
     }
   }
 
+  if (validate_clusters) {
+    validateClusters(factory_context.clusterManager());
+  }
+
+  route_index_.compile();
+
+  std::vector<std::string> virtual_cluster_patterns;
   for (const auto& virtual_cluster : virtual_host.virtual_clusters()) {
     virtual_clusters_.push_back(VirtualClusterEntry(virtual_cluster));
+    virtual_cluster_patterns.push_back(virtual_cluster.pattern());
+  }
+  if (!virtual_cluster_patterns.empty()) {
+    virtual_cluster_set_ =
+        std::make_unique<const Regex::CompiledGoogleReSet>(virtual_cluster_patterns);
   }
 
   if (virtual_host.has_cors()) {
@@ -862,59 +874,222 @@ VirtualHostImpl::VirtualClusterEntry::VirtualClusterEntry(
   }
 
   const std::string pattern = virtual_cluster.pattern();
-  pattern_ = RegexUtil::parseRegex(pattern);
+  pattern_ = Regex::Utility::parseRegex(pattern);
   name_ = virtual_cluster.name();
 }
 
-const Config& VirtualHostImpl::routeConfig() const { return global_route_config_; }
+void VirtualHostImpl::validateClusters(Upstream::ClusterManager& cm) const {
+  for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
+    route->validateClusters(cm);
+    if (!route->shadowPolicy().cluster().empty()) {
+      if (!cm.get(route->shadowPolicy().cluster())) {
+        throw EnvoyException(
+            fmt::format("route: unknown shadow cluster '{}'", route->shadowPolicy().cluster()));
+      }
+    }
+  }
+}
+
+const CommonConfig& VirtualHostImpl::routeConfig() const { return *global_route_config_; }
 
 const RouteSpecificFilterConfig* VirtualHostImpl::perFilterConfig(const std::string& name) const {
   return per_filter_configs_.get(name);
 }
 
-const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(const std::string& host) const {
-  // We do a longest wildcard suffix match against the host that's passed in.
-  // (e.g. foo-bar.baz.com should match *-bar.baz.com before matching *.baz.com)
-  // This is done by scanning the length => wildcards map looking for every
-  // wildcard whose size is < length.
-  for (const auto& iter : wildcard_virtual_host_suffixes_) {
-    const uint32_t wildcard_length = iter.first;
-    const auto& wildcard_map = iter.second;
-    // >= because *.foo.com shouldn't match .foo.com.
-    if (wildcard_length >= host.size()) {
-      continue;
+namespace {
+
+std::string lazyVirtualHostStatPrefix(const envoy::api::v2::RouteConfiguration& config) {
+  return config.name().empty() ? "lazy_virtual_hosts."
+                               : fmt::format("lazy_virtual_hosts.{}.", config.name());
+}
+
+bool hasPerFilterConfig(const envoy::api::v2::route::VirtualHost& virtual_host) {
+  if (virtual_host.per_filter_config_size() > 0 ||
+      virtual_host.typed_per_filter_config_size() > 0) {
+    return true;
+  }
+  for (const auto& route : virtual_host.routes()) {
+    if (route.per_filter_config_size() > 0 || route.typed_per_filter_config_size() > 0) {
+      return true;
     }
-    const auto& match = wildcard_map.find(host.substr(host.size() - wildcard_length));
-    if (match != wildcard_map.end()) {
-      return match->second.get();
+    for (const auto& cluster : route.route().weighted_clusters().clusters()) {
+      if (cluster.per_filter_config_size() > 0 || cluster.typed_per_filter_config_size() > 0) {
+        return true;
+      }
     }
   }
-  return nullptr;
+  return false;
+}
+
+} // namespace
+
+LazyVirtualHosts::LazyVirtualHosts(const envoy::api::v2::RouteConfiguration& config,
+                                   const CommonConfigImplConstSharedPtr& global_route_config,
+                                   Server::Configuration::FactoryContext& factory_context)
+    : global_route_config_(global_route_config), factory_context_(factory_context),
+      time_source_(factory_context.timeSource()),
+      idle_timeout_(PROTOBUF_GET_MS_OR_DEFAULT(config.lazy_virtual_hosts(), idle_timeout, 600000)),
+      max_cached_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.lazy_virtual_hosts(),
+                                                  max_cached_virtual_hosts, 1024)),
+      stats_({ALL_LAZY_VIRTUAL_HOST_STATS(
+          POOL_COUNTER_PREFIX(factory_context.scope(), lazyVirtualHostStatPrefix(config)))}) {}
+
+uint32_t LazyVirtualHosts::add(const envoy::api::v2::route::VirtualHost& virtual_host,
+                               bool validate_clusters) {
+  // Throws if the virtual host is invalid, which rejects the whole configuration.
+  VirtualHostSharedPtr built = std::make_shared<VirtualHostImpl>(
+      virtual_host, global_route_config_, factory_context_, validate_clusters);
+  if (hasPerFilterConfig(virtual_host)) {
+    slots_.emplace_back(std::string(), std::move(built));
+  } else {
+    slots_.emplace_back(virtual_host.SerializeAsString(), nullptr);
+  }
+  return slots_.size() - 1;
+}
+
+VirtualHostSharedPtr LazyVirtualHosts::get(uint32_t index) const {
+  Slot& slot = slots_[index];
+  if (slot.pinned_ != nullptr) {
+    return slot.pinned_;
+  }
+
+  const MonotonicTime now = time_source_.monotonicTime();
+  // Evicted virtual hosts are destroyed once the lock is released.
+  VirtualHostSharedPtr evicted;
+  {
+    Thread::LockGuard lock(mutex_);
+    // Evict at most one idle virtual host per lookup, so that no request pays for many of them.
+    if (!lru_.empty() && lru_.back() != index &&
+        now - slots_[lru_.back()].last_used_ >= idle_timeout_) {
+      evicted = evict(lru_.back());
+    }
+    if (slot.virtual_host_ != nullptr) {
+      use(index, now);
+      return slot.virtual_host_;
+    }
+    if (slot.invalid_) {
+      return nullptr;
+    }
+  }
+  evicted.reset();
+
+  // Build without holding the lock, so that requests for other virtual hosts in flight are not
+  // held up. Concurrent requests for this one may build it more than once; the first one wins.
+  VirtualHostSharedPtr virtual_host = build(slot);
+  Thread::LockGuard lock(mutex_);
+  if (virtual_host == nullptr) {
+    slot.invalid_ = true;
+    return nullptr;
+  }
+  if (slot.virtual_host_ == nullptr) {
+    if (lru_.size() >= max_cached_) {
+      evicted = evict(lru_.back());
+    }
+    slot.virtual_host_ = std::move(virtual_host);
+    slot.lru_position_ = lru_.insert(lru_.begin(), index);
+  }
+  use(index, now);
+  return slot.virtual_host_;
+}
+
+uint32_t LazyVirtualHosts::cached() const {
+  Thread::LockGuard lock(mutex_);
+  return lru_.size();
+}
+
+VirtualHostSharedPtr LazyVirtualHosts::build(const Slot& slot) const {
+  envoy::api::v2::route::VirtualHost config;
+  if (!config.ParseFromString(slot.config_)) {
+    ENVOY_LOG(warn, "lazy virtual host: unable to parse config");
+    stats_.build_failed_.inc();
+    return nullptr;
+  }
+  try {
+    ENVOY_LOG(debug, "lazy virtual host: building {}", config.name());
+    VirtualHostSharedPtr virtual_host =
+        std::make_shared<VirtualHostImpl>(config, global_route_config_, factory_context_, false);
+    stats_.built_.inc();
+    return virtual_host;
+  } catch (const EnvoyException& e) {
+    // Not expected, as the virtual host was built when it was added.
+    ENVOY_LOG(warn, "lazy virtual host: unable to build {}: {}", config.name(), e.what());
+    stats_.build_failed_.inc();
+    return nullptr;
+  }
+}
+
+void LazyVirtualHosts::use(uint32_t index, MonotonicTime now) const {
+  Slot& slot = slots_[index];
+  slot.last_used_ = now;
+  lru_.splice(lru_.begin(), lru_, slot.lru_position_);
+}
+
+VirtualHostSharedPtr LazyVirtualHosts::evict(uint32_t index) const {
+  Slot& slot = slots_[index];
+  ENVOY_LOG(debug, "lazy virtual host: evicting {}", slot.virtual_host_->name());
+  lru_.erase(slot.lru_position_);
+  stats_.evicted_.inc();
+  evictions_++;
+  VirtualHostSharedPtr evicted = std::move(slot.virtual_host_);
+  slot.virtual_host_ = nullptr;
+  return evicted;
 }
 
 RouteMatcher::RouteMatcher(const envoy::api::v2::RouteConfiguration& route_config,
-                           const ConfigImpl& global_route_config,
+                           const CommonConfigImplConstSharedPtr& global_route_config,
                            Server::Configuration::FactoryContext& factory_context,
-                           bool validate_clusters) {
+                           bool validate_clusters, bool reusable,
+                           const RouteMatcher* previous_matcher) {
+  if (route_config.has_lazy_virtual_hosts()) {
+    lazy_virtual_hosts_ =
+        std::make_unique<LazyVirtualHosts>(route_config, global_route_config, factory_context);
+  }
+
   for (const auto& virtual_host_config : route_config.virtual_hosts()) {
-    VirtualHostSharedPtr virtual_host(new VirtualHostImpl(virtual_host_config, global_route_config,
-                                                          factory_context, validate_clusters));
+    uint32_t virtual_host_index;
+    if (lazy_virtual_hosts_ != nullptr) {
+      virtual_host_index = lazy_virtual_hosts_->add(virtual_host_config, validate_clusters);
+    } else {
+      VirtualHostSharedPtr virtual_host;
+      uint64_t virtual_host_hash = 0;
+      if (reusable) {
+        virtual_host_hash = MessageUtil::hash(virtual_host_config);
+        if (previous_matcher != nullptr) {
+          const auto it = previous_matcher->virtual_hosts_by_hash_.find(virtual_host_hash);
+          if (it != previous_matcher->virtual_hosts_by_hash_.end() &&
+              Protobuf::util::MessageDifferencer::Equals(it->second.config_,
+                                                         virtual_host_config)) {
+            virtual_host = it->second.virtual_host_;
+            if (validate_clusters) {
+              virtual_host->validateClusters(factory_context.clusterManager());
+            }
+            virtual_hosts_reused_++;
+          }
+        }
+      }
+      if (virtual_host == nullptr) {
+        virtual_host = std::make_shared<VirtualHostImpl>(virtual_host_config, global_route_config,
+                                                         factory_context, validate_clusters);
+        virtual_hosts_built_++;
+      }
+      if (reusable) {
+        virtual_hosts_by_hash_.emplace(virtual_host_hash,
+                                       ReusableVirtualHost{virtual_host_config, virtual_host});
+      }
+      virtual_host_index = virtual_hosts_.size();
+      virtual_hosts_.push_back(virtual_host);
+    }
+
     for (const std::string& domain_name : virtual_host_config.domains()) {
-      const std::string domain = Http::LowerCaseString(domain_name).get();
-      if ("*" == domain) {
-        if (default_virtual_host_) {
+      if ("*" == domain_name) {
+        if (default_virtual_host_ >= 0) {
           throw EnvoyException(fmt::format("Only a single wildcard domain is permitted"));
         }
-        default_virtual_host_ = virtual_host;
-      } else if (domain.size() > 0 && '*' == domain[0]) {
-        wildcard_virtual_host_suffixes_[domain.size() - 1].emplace(domain.substr(1), virtual_host);
-      } else {
-        if (virtual_hosts_.find(domain) != virtual_hosts_.end()) {
-          throw EnvoyException(fmt::format(
-              "Only unique values for domains are permitted. Duplicate entry of domain {}",
-              domain));
-        }
-        virtual_hosts_.emplace(domain, virtual_host);
+        default_virtual_host_ = virtual_host_index;
+      } else if (!domains_.add(domain_name, virtual_host_index)) {
+        throw EnvoyException(
+            fmt::format("Only unique values for domains are permitted. Duplicate entry of domain {}",
+                        Http::LowerCaseString(domain_name).get()));
       }
     }
   }
@@ -930,9 +1105,22 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const Http::HeaderMap&
     return SSL_REDIRECT_ROUTE;
   }
 
-  // Check for a route that matches the request.
-  for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
-    RouteConstSharedPtr route_entry = route->matches(headers, random_value);
+  if (headers.Path() == nullptr) {
+    // The index is keyed on the path, so try every route for the rare request without one.
+    for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
+      RouteConstSharedPtr route_entry = route->matches(headers, random_value);
+      if (nullptr != route_entry) {
+        return route_entry;
+      }
+    }
+    return nullptr;
+  }
+
+  // Check the routes whose path matches the request, in config order.
+  RouteIndex::Candidates candidates;
+  route_index_.findCandidates(headers.Path()->value().getStringView(), candidates);
+  for (const uint32_t candidate : candidates) {
+    RouteConstSharedPtr route_entry = routes_[candidate]->matches(headers, random_value);
     if (nullptr != route_entry) {
       return route_entry;
     }
@@ -941,36 +1129,56 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const Http::HeaderMap&
   return nullptr;
 }
 
-const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::HeaderMap& headers) const {
+int64_t RouteMatcher::findVirtualHost(const Http::HeaderMap& headers) const {
   // Fast path the case where we only have a default virtual host.
-  if (virtual_hosts_.empty() && wildcard_virtual_host_suffixes_.empty() && default_virtual_host_) {
-    return default_virtual_host_.get();
+  if (domains_.empty()) {
+    return default_virtual_host_;
   }
 
   // TODO (@rshriram) Match Origin header in WebSocket
   // request with VHost, using wildcard match
-  const std::string host = Http::LowerCaseString(headers.Host()->value().c_str()).get();
-  const auto& iter = virtual_hosts_.find(host);
-  if (iter != virtual_hosts_.end()) {
-    return iter->second.get();
-  }
-  if (!wildcard_virtual_host_suffixes_.empty()) {
-    const VirtualHostImpl* vhost = findWildcardVirtualHost(host);
-    if (vhost != nullptr) {
-      return vhost;
-    }
+  const int64_t virtual_host = domains_.find(headers.Host()->value().getStringView());
+  if (virtual_host >= 0) {
+    return virtual_host;
   }
-  return default_virtual_host_.get();
+  return default_virtual_host_;
 }
 
 RouteConstSharedPtr RouteMatcher::route(const Http::HeaderMap& headers,
                                         uint64_t random_value) const {
-  const VirtualHostImpl* virtual_host = findVirtualHost(headers);
-  if (virtual_host) {
-    return virtual_host->getRouteFromEntries(headers, random_value);
-  } else {
+  bool cacheable;
+  return route(headers, random_value, cacheable);
+}
+
+RouteConstSharedPtr RouteMatcher::route(const Http::HeaderMap& headers, uint64_t random_value,
+                                        bool& cacheable) const {
+  cacheable = true;
+  const int64_t index = findVirtualHost(headers);
+  if (index < 0) {
     return nullptr;
   }
+  if (lazy_virtual_hosts_ == nullptr) {
+    cacheable = virtual_hosts_[index]->cacheable();
+    return virtual_hosts_[index]->getRouteFromEntries(headers, random_value);
+  }
+
+  const VirtualHostSharedPtr virtual_host = lazy_virtual_hosts_->get(index);
+  if (virtual_host == nullptr) {
+    return nullptr;
+  }
+  cacheable = virtual_host->cacheable();
+  RouteConstSharedPtr route = virtual_host->getRouteFromEntries(headers, random_value);
+  if (route == nullptr) {
+    return nullptr;
+  }
+  // Routes refer to their virtual host, which may be evicted while the request still uses the
+  // route, so make the returned route keep the virtual host alive.
+  struct LazyRoute {
+    VirtualHostSharedPtr virtual_host_;
+    RouteConstSharedPtr route_;
+  };
+  auto lazy_route = std::make_shared<LazyRoute>(LazyRoute{virtual_host, std::move(route)});
+  return RouteConstSharedPtr(lazy_route, lazy_route->route_.get());
 }
 
 const VirtualHostImpl::CatchAllVirtualCluster VirtualHostImpl::VIRTUAL_CLUSTER_CATCH_ALL;
@@ -980,30 +1188,50 @@ const std::shared_ptr<const SslRedirectRoute> VirtualHostImpl::SSL_REDIRECT_ROUT
 
 const VirtualCluster*
 VirtualHostImpl::virtualClusterFromEntries(const Http::HeaderMap& headers) const {
-  for (const VirtualClusterEntry& entry : virtual_clusters_) {
-    bool method_matches =
-        !entry.method_ || headers.Method()->value().c_str() == entry.method_.value();
+  if (virtual_clusters_.empty()) {
+    return nullptr;
+  }
 
-    if (method_matches && std::regex_match(headers.Path()->value().c_str(), entry.pattern_)) {
-      return &entry;
+  // Find every virtual cluster whose pattern matches the path in one pass, then take the first
+  // one in config order whose method also matches.
+  const absl::string_view path = headers.Path()->value().getStringView();
+  std::vector<int> matches;
+  if (virtual_cluster_set_->match(path, matches)) {
+    for (const int match : matches) {
+      const VirtualClusterEntry& entry = virtual_clusters_[match];
+      if (entry.matchesMethod(headers)) {
+        return &entry;
+      }
+    }
+  } else {
+    for (const VirtualClusterEntry& entry : virtual_clusters_) {
+      if (entry.matchesMethod(headers) && entry.pattern_->match(path)) {
+        return &entry;
+      }
     }
   }
 
-  if (virtual_clusters_.size() > 0) {
-    return &VIRTUAL_CLUSTER_CATCH_ALL;
-  }
+  return &VIRTUAL_CLUSTER_CATCH_ALL;
+}
 
-  return nullptr;
+namespace {
+
+envoy::api::v2::RouteConfiguration commonConfig(const envoy::api::v2::RouteConfiguration& config) {
+  // Only copy the fields read by CommonConfigImpl, so that the virtual hosts are not compared.
+  envoy::api::v2::RouteConfiguration common_config;
+  common_config.set_name(config.name());
+  *common_config.mutable_internal_only_headers() = config.internal_only_headers();
+  *common_config.mutable_request_headers_to_add() = config.request_headers_to_add();
+  *common_config.mutable_request_headers_to_remove() = config.request_headers_to_remove();
+  *common_config.mutable_response_headers_to_add() = config.response_headers_to_add();
+  *common_config.mutable_response_headers_to_remove() = config.response_headers_to_remove();
+  return common_config;
 }
 
-ConfigImpl::ConfigImpl(const envoy::api::v2::RouteConfiguration& config,
-                       Server::Configuration::FactoryContext& factory_context,
-                       bool validate_clusters_default)
-    : name_(config.name()) {
-  route_matcher_ = std::make_unique<RouteMatcher>(
-      config, *this, factory_context,
-      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, validate_clusters, validate_clusters_default));
+} // namespace
 
+CommonConfigImpl::CommonConfigImpl(const envoy::api::v2::RouteConfiguration& config)
+    : name_(config.name()), common_config_(commonConfig(config)) {
   for (const std::string& header : config.internal_only_headers()) {
     internal_only_headers_.push_back(Http::LowerCaseString(header));
   }
@@ -1014,6 +1242,144 @@ ConfigImpl::ConfigImpl(const envoy::api::v2::RouteConfiguration& config,
                                                      config.response_headers_to_remove());
 }
 
+bool CommonConfigImpl::builtFrom(const envoy::api::v2::RouteConfiguration& config) const {
+  return Protobuf::util::MessageDifferencer::Equals(common_config_, commonConfig(config));
+}
+
+namespace {
+
+std::string routeCacheStatPrefix(const envoy::api::v2::RouteConfiguration& config) {
+  return config.name().empty() ? "route_cache." : fmt::format("route_cache.{}.", config.name());
+}
+
+} // namespace
+
+RouteCache::RouteCache(const envoy::api::v2::RouteConfiguration& config,
+                       Server::Configuration::FactoryContext& factory_context)
+    : max_entries_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.route_cache(), max_entries, 1024)),
+      stats_({ALL_ROUTE_CACHE_STATS(
+          POOL_COUNTER_PREFIX(factory_context.scope(), routeCacheStatPrefix(config)))}),
+      main_dispatcher_(factory_context.dispatcher()),
+      tls_(factory_context.threadLocal().allocateSlot()) {
+  std::set<std::string> key_headers;
+  for (const auto& virtual_host : config.virtual_hosts()) {
+    if (virtual_host.require_tls() != envoy::api::v2::route::VirtualHost::NONE) {
+      key_headers.insert(Http::Headers::get().ForwardedProto.get());
+      key_headers.insert(Http::Headers::get().EnvoyInternalRequest.get());
+    }
+    for (const auto& route : virtual_host.routes()) {
+      if (route.match().has_grpc()) {
+        key_headers.insert(Http::Headers::get().ContentType.get());
+      }
+      for (const auto& header : route.match().headers()) {
+        key_headers.insert(Http::LowerCaseString(header.name()).get());
+      }
+    }
+  }
+  for (const std::string& key_header : key_headers) {
+    key_headers_.emplace_back(key_header);
+  }
+
+  tls_->set([](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<ThreadLocalCache>();
+  });
+}
+
+RouteCache::~RouteCache() {
+  // The last reference to a configuration may be dropped on a worker, by its RDS thread local
+  // config or by a stream, but slots can only be freed on the main thread. The callback frees the
+  // slot itself, so that it is freed on the main thread whichever copy of the callback is the last
+  // one destroyed.
+  auto tls = std::make_shared<ThreadLocal::SlotPtr>(std::move(tls_));
+  main_dispatcher_.post([tls]() -> void { tls->reset(); });
+}
+
+void RouteCache::buildKey(const Http::HeaderMap& headers, std::string& key) const {
+  // Each part of the key starts with a tag telling whether the header is present. A present
+  // header is followed by its value and a NUL, which header values may not contain, so that the
+  // parts of the key are separated unambiguously.
+  const auto append = [&key](const Http::HeaderEntry* header) {
+    if (header != nullptr) {
+      key.push_back('\x01');
+      key.append(header->value().c_str(), header->value().size());
+      key.push_back('\0');
+    } else {
+      key.push_back('\0');
+    }
+  };
+
+  key.clear();
+  append(headers.Host());
+  append(headers.Path());
+  for (const Http::LowerCaseString& key_header : key_headers_) {
+    append(headers.get(key_header));
+  }
+}
+
+RouteConstSharedPtr RouteCache::route(const RouteMatcher& matcher, const Http::HeaderMap& headers,
+                                      uint64_t random_value) const {
+  ThreadLocalCache& cache = tls_->getTyped<ThreadLocalCache>();
+  // Routes of evicted lazy virtual hosts would keep them alive, so they are dropped.
+  const uint64_t virtual_host_evictions = matcher.virtualHostEvictions();
+  if (virtual_host_evictions != cache.virtual_host_evictions_) {
+    cache.routes_.clear();
+    cache.virtual_host_evictions_ = virtual_host_evictions;
+  }
+  buildKey(headers, cache.key_);
+  const auto it = cache.routes_.find(cache.key_);
+  if (it != cache.routes_.end()) {
+    stats_.hit_.inc();
+    return it->second;
+  }
+
+  bool cacheable;
+  RouteConstSharedPtr route = matcher.route(headers, random_value, cacheable);
+  if (!cacheable) {
+    stats_.bypass_.inc();
+    return route;
+  }
+  stats_.miss_.inc();
+  if (cache.routes_.size() >= max_entries_) {
+    stats_.overflow_.inc();
+    cache.routes_.clear();
+  }
+  cache.routes_.emplace(cache.key_, route);
+  return route;
+}
+
+ConfigImpl::ConfigImpl(const envoy::api::v2::RouteConfiguration& config,
+                       Server::Configuration::FactoryContext& factory_context,
+                       bool validate_clusters_default)
+    : shared_config_(std::make_shared<const CommonConfigImpl>(config)) {
+  route_matcher_ = std::make_unique<RouteMatcher>(
+      config, shared_config_, factory_context,
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, validate_clusters, validate_clusters_default), false,
+      nullptr);
+  if (config.has_route_cache()) {
+    route_cache_ = std::make_unique<const RouteCache>(config, factory_context);
+  }
+}
+
+ConfigImpl::ConfigImpl(const envoy::api::v2::RouteConfiguration& config,
+                       Server::Configuration::FactoryContext& factory_context,
+                       bool validate_clusters_default, const ConfigImpl* previous_config) {
+  // Virtual hosts refer to the shared config, so they can only be reused along with it.
+  const RouteMatcher* previous_matcher = nullptr;
+  if (previous_config != nullptr && previous_config->shared_config_->builtFrom(config)) {
+    shared_config_ = previous_config->shared_config_;
+    previous_matcher = previous_config->route_matcher_.get();
+  } else {
+    shared_config_ = std::make_shared<const CommonConfigImpl>(config);
+  }
+  route_matcher_ = std::make_unique<RouteMatcher>(
+      config, shared_config_, factory_context,
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, validate_clusters, validate_clusters_default), true,
+      previous_matcher);
+  if (config.has_route_cache()) {
+    route_cache_ = std::make_unique<const RouteCache>(config, factory_context);
+  }
+}
+
 PerFilterConfigs::PerFilterConfigs(
     const Protobuf::Map<ProtobufTypes::String, ProtobufWkt::Struct>& configs,
     Server::Configuration::FactoryContext& factory_context) {
@@ -1,30 +1,43 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <deque>
 #include <list>
 #include <map>
 #include <memory>
-#include <regex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "envoy/api/v2/rds.pb.h"
 #include "envoy/api/v2/route/route.pb.h"
+#include "envoy/common/time.h"
 #include "envoy/router/router.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/server/filter_config.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
+#include "common/common/lock_guard.h"
+#include "common/common/logger.h"
+#include "common/common/regex.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
 #include "common/config/metadata.h"
 #include "common/http/header_utility.h"
 #include "common/router/config_utility.h"
+#include "common/router/domain_index.h"
 #include "common/router/header_formatter.h"
 #include "common/router/header_parser.h"
 #include "common/router/metadatamatchcriteria_impl.h"
+#include "common/router/route_index.h"
 #include "common/router/router_ratelimit.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/types/optional.h"
 
 namespace Envoy {
@@ -98,7 +111,9 @@ public:
 
   // Router::CorsPolicy
   const std::list<std::string>& allowOrigins() const override { return allow_origin_; };
-  const std::list<std::regex>& allowOriginRegexes() const override { return allow_origin_regex_; }
+  const std::vector<Regex::CompiledMatcherPtr>& allowOriginRegexes() const override {
+    return allow_origin_regex_;
+  }
   const std::string& allowMethods() const override { return allow_methods_; };
   const std::string& allowHeaders() const override { return allow_headers_; };
   const std::string& exposeHeaders() const override { return expose_headers_; };
@@ -108,7 +123,7 @@ public:
 
 private:
   std::list<std::string> allow_origin_;
-  std::list<std::regex> allow_origin_regex_;
+  std::vector<Regex::CompiledMatcherPtr> allow_origin_regex_;
   std::string allow_methods_;
   std::string allow_headers_;
   std::string expose_headers_;
@@ -117,20 +132,54 @@ private:
   bool enabled_;
 };
 
-class ConfigImpl;
+/**
+ * The part of a route configuration that its virtual hosts refer to. It is shared between
+ * successive versions of a route configuration, along with their unchanged virtual hosts.
+ */
+class CommonConfigImpl : public CommonConfig {
+public:
+  CommonConfigImpl(const envoy::api::v2::RouteConfiguration& config);
+
+  const HeaderParser& requestHeaderParser() const { return *request_headers_parser_; };
+  const HeaderParser& responseHeaderParser() const { return *response_headers_parser_; };
+
+  /**
+   * @param config supplies a route configuration.
+   * @return bool whether the fields of config that a CommonConfigImpl is built from are equal to
+   *         the ones this was built from.
+   */
+  bool builtFrom(const envoy::api::v2::RouteConfiguration& config) const;
+
+  // Router::CommonConfig
+  const std::list<Http::LowerCaseString>& internalOnlyHeaders() const override {
+    return internal_only_headers_;
+  }
+  const std::string& name() const override { return name_; }
+
+private:
+  std::list<Http::LowerCaseString> internal_only_headers_;
+  HeaderParserPtr request_headers_parser_;
+  HeaderParserPtr response_headers_parser_;
+  const std::string name_;
+  // The fields of the route configuration this was built from, without the virtual hosts.
+  const envoy::api::v2::RouteConfiguration common_config_;
+};
+
+typedef std::shared_ptr<const CommonConfigImpl> CommonConfigImplConstSharedPtr;
+
 /**
  * Holds all routing configuration for an entire virtual host.
  */
 class VirtualHostImpl : public VirtualHost {
 public:
   VirtualHostImpl(const envoy::api::v2::route::VirtualHost& virtual_host,
-                  const ConfigImpl& global_route_config,
+                  const CommonConfigImplConstSharedPtr& global_route_config,
                   Server::Configuration::FactoryContext& factory_context, bool validate_clusters);
 
   RouteConstSharedPtr getRouteFromEntries(const Http::HeaderMap& headers,
                                           uint64_t random_value) const;
   const VirtualCluster* virtualClusterFromEntries(const Http::HeaderMap& headers) const;
-  const ConfigImpl& globalRouteConfig() const { return global_route_config_; }
+  const CommonConfigImpl& globalRouteConfig() const { return *global_route_config_; }
   const HeaderParser& requestHeaderParser() const { return *request_headers_parser_; };
   const HeaderParser& responseHeaderParser() const { return *response_headers_parser_; };
 
@@ -138,10 +187,17 @@ public:
   const CorsPolicy* corsPolicy() const override { return cors_policy_.get(); }
   const std::string& name() const override { return name_; }
   const RateLimitPolicy& rateLimitPolicy() const override { return rate_limit_policy_; }
-  const Config& routeConfig() const override;
+  const CommonConfig& routeConfig() const override;
   const RouteSpecificFilterConfig* perFilterConfig(const std::string&) const override;
   bool includeAttemptCount() const override { return include_attempt_count_; }
 
+  /**
+   * Checks that the clusters of every route exist.
+   * @param cm supplies the cluster manager.
+   * @throw EnvoyException if a cluster does not exist.
+   */
+  void validateClusters(Upstream::ClusterManager& cm) const;
+
 private:
   enum class SslRequirements { NONE, EXTERNAL_ONLY, ALL };
 
@@ -151,7 +207,11 @@ private:
     // Router::VirtualCluster
     const std::string& name() const override { return name_; }
 
-    std::regex pattern_;
+    bool matchesMethod(const Http::HeaderMap& headers) const {
+      return !method_ || headers.Method()->value().c_str() == method_.value();
+    }
+
+    Regex::CompiledMatcherPtr pattern_;
     absl::optional<std::string> method_;
     std::string name_;
   };
@@ -168,16 +228,20 @@ private:
 
   const std::string name_;
   std::vector<RouteEntryImplBaseConstSharedPtr> routes_;
+  RouteIndex route_index_;
   std::vector<VirtualClusterEntry> virtual_clusters_;
+  // Matches the patterns of all virtual_clusters_ at once, or null if there are none.
+  Regex::CompiledGoogleReSetPtr virtual_cluster_set_;
   SslRequirements ssl_requirements_;
   const RateLimitPolicyImpl rate_limit_policy_;
   std::unique_ptr<const CorsPolicyImpl> cors_policy_;
-  const ConfigImpl& global_route_config_; // See note in RouteEntryImplBase::clusterEntry() on why
-                                          // raw ref to the top level config is currently safe.
+  // Shared rather than a reference, as this virtual host may outlive the ConfigImpl that built it.
+  const CommonConfigImplConstSharedPtr global_route_config_;
   HeaderParserPtr request_headers_parser_;
   HeaderParserPtr response_headers_parser_;
   PerFilterConfigs per_filter_configs_;
   const bool include_attempt_count_;
+  bool cacheable_{true};
 };
 
 typedef std::shared_ptr<VirtualHostImpl> VirtualHostSharedPtr;
@@ -547,7 +611,7 @@ private:
   const RateLimitPolicyImpl rate_limit_policy_;
   const ShadowPolicyImpl shadow_policy_;
   const Upstream::ResourcePriority priority_;
-  std::vector<Http::HeaderUtility::HeaderData> config_headers_;
+  const Http::HeaderUtility::HeaderDataList config_headers_;
   std::vector<ConfigUtility::QueryParameterMatcher> config_query_parameters_;
   std::vector<WeightedClusterEntrySharedPtr> weighted_clusters_;
 
@@ -636,39 +700,226 @@ public:
   void rewritePathHeader(Http::HeaderMap& headers, bool insert_envoy_original_path) const override;
 
 private:
-  const std::regex regex_;
+  const Regex::CompiledMatcherPtr regex_;
   const std::string regex_str_;
 };
 
+/**
+ * All lazy virtual host stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_LAZY_VIRTUAL_HOST_STATS(COUNTER)                                                       \
+  COUNTER(built)                                                                                   \
+  COUNTER(build_failed)                                                                            \
+  COUNTER(evicted)
+// clang-format on
+
+/**
+ * Struct definition for all lazy virtual host stats. @see stats_macros.h
+ */
+struct LazyVirtualHostStats {
+  ALL_LAZY_VIRTUAL_HOST_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Builds the virtual hosts of a route configuration on demand, when a request first matches one
+ * of their domains, rather than keeping all of them built. Built virtual hosts are shared by all
+ * workers. At most a bounded number of them is kept, evicting the least recently used one to make
+ * room for another, and they are evicted once they go without requests for the idle timeout.
+ *
+ * Each virtual host is built once on the main thread when it is added, so that an invalid one
+ * rejects the configuration. It is then kept serialized until it is requested, and built again on
+ * the worker serving the request. This is safe as, apart from per filter configs, building a
+ * virtual host only reads the runtime loader and the time system of the factory context. Virtual
+ * hosts with per filter configs, which are built by the filter factories, are therefore kept built
+ * from the main thread and never evicted.
+ */
+class LazyVirtualHosts : Logger::Loggable<Logger::Id::router> {
+public:
+  LazyVirtualHosts(const envoy::api::v2::RouteConfiguration& config,
+                   const CommonConfigImplConstSharedPtr& global_route_config,
+                   Server::Configuration::FactoryContext& factory_context);
+
+  /**
+   * Validates a virtual host by building it. Must be called on the main thread.
+   * @param virtual_host supplies the config of a virtual host.
+   * @param validate_clusters supplies whether the clusters of the virtual host are validated.
+   * @return uint32_t the position of the virtual host.
+   * @throw EnvoyException if the virtual host is invalid.
+   */
+  uint32_t add(const envoy::api::v2::route::VirtualHost& virtual_host, bool validate_clusters);
+
+  /**
+   * @param index supplies the position of a virtual host.
+   * @return VirtualHostSharedPtr the virtual host, built if needed, or nullptr if building it
+   *         failed.
+   */
+  VirtualHostSharedPtr get(uint32_t index) const;
+
+  /**
+   * @return uint32_t the number of virtual hosts currently kept built, not counting the ones with
+   *         per filter configs.
+   */
+  uint32_t cached() const;
+
+  /**
+   * @return uint64_t the number of virtual hosts evicted so far, so that callers holding on to
+   *         their routes can release them in turn.
+   */
+  uint64_t evictions() const { return evictions_; }
+
+private:
+  struct Slot {
+    Slot(std::string&& config, VirtualHostSharedPtr&& pinned)
+        : config_(std::move(config)), pinned_(std::move(pinned)) {}
+
+    // Empty if the virtual host is pinned.
+    const std::string config_;
+    // Set if the virtual host is always kept built.
+    const VirtualHostSharedPtr pinned_;
+    // The following are guarded by the mutex_ of LazyVirtualHosts.
+    VirtualHostSharedPtr virtual_host_;
+    MonotonicTime last_used_;
+    // The position of the slot in lru_, if virtual_host_ is set.
+    std::list<uint32_t>::iterator lru_position_;
+    // Set once building the virtual host failed, so that it is not retried for every request.
+    bool invalid_{};
+  };
+
+  VirtualHostSharedPtr build(const Slot& slot) const;
+  void use(uint32_t index, MonotonicTime now) const EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  VirtualHostSharedPtr evict(uint32_t index) const EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const CommonConfigImplConstSharedPtr global_route_config_;
+  Server::Configuration::FactoryContext& factory_context_;
+  TimeSource& time_source_;
+  const std::chrono::milliseconds idle_timeout_;
+  const uint32_t max_cached_;
+  LazyVirtualHostStats stats_;
+  // A deque, as slots are neither copyable nor movable.
+  mutable std::deque<Slot> slots_;
+  mutable Thread::MutexBasicLockable mutex_;
+  // The positions of the built virtual hosts, the most recently used first.
+  mutable std::list<uint32_t> lru_ GUARDED_BY(mutex_);
+  mutable std::atomic<uint64_t> evictions_{};
+};
+
 /**
  * Wraps the route configuration which matches an incoming request headers to a backend cluster.
  * This is split out mainly to help with unit testing.
  */
 class RouteMatcher {
 public:
+  /**
+   * @param reusable supplies whether to remember the virtual hosts by the hash of their config,
+   *        so that a later RouteMatcher can reuse them.
+   * @param previous_matcher supplies a RouteMatcher built with reusable set whose virtual hosts
+   *        are reused where their config is unchanged, or nullptr. It must share the same
+   *        global_http_config and factory_context.
+   * Neither applies if config has lazy_virtual_hosts set.
+   */
   RouteMatcher(const envoy::api::v2::RouteConfiguration& config,
-               const ConfigImpl& global_http_config,
-               Server::Configuration::FactoryContext& factory_context, bool validate_clusters);
+               const CommonConfigImplConstSharedPtr& global_http_config,
+               Server::Configuration::FactoryContext& factory_context, bool validate_clusters,
+               bool reusable, const RouteMatcher* previous_matcher);
 
   RouteConstSharedPtr route(const Http::HeaderMap& headers, uint64_t random_value) const;
 
+  /**
+   * @param cacheable supplies set to whether the route found may be cached, see
+   *        VirtualHostImpl::cacheable().
+   */
+  RouteConstSharedPtr route(const Http::HeaderMap& headers, uint64_t random_value,
+                            bool& cacheable) const;
+
+  uint32_t virtualHostsReused() const { return virtual_hosts_reused_; }
+  uint32_t virtualHostsBuilt() const { return virtual_hosts_built_; }
+
+  /**
+   * @return uint64_t the number of lazy virtual hosts evicted so far, or 0 if the virtual hosts
+   *         are not built lazily.
+   */
+  uint64_t virtualHostEvictions() const {
+    return lazy_virtual_hosts_ != nullptr ? lazy_virtual_hosts_->evictions() : 0;
+  }
+
+private:
+  /**
+   * @return int64_t the position of the virtual host matching the request, or -1.
+   */
+  int64_t findVirtualHost(const Http::HeaderMap& headers) const;
+
+  // Empty if the virtual hosts are built lazily.
+  std::vector<VirtualHostSharedPtr> virtual_hosts_;
+  std::unique_ptr<LazyVirtualHosts> lazy_virtual_hosts_;
+  // Maps domains to positions in virtual_hosts_ or lazy_virtual_hosts_.
+  DomainIndex domains_;
+  // The position of the virtual host matching the ``*`` domain, or -1.
+  int64_t default_virtual_host_{-1};
+  struct ReusableVirtualHost {
+    // Compared before reusing the virtual host, as hashes may collide.
+    const envoy::api::v2::route::VirtualHost config_;
+    const VirtualHostSharedPtr virtual_host_;
+  };
+
+  // Only filled in when reusable.
+  std::unordered_map<uint64_t, ReusableVirtualHost> virtual_hosts_by_hash_;
+  uint32_t virtual_hosts_reused_{};
+  uint32_t virtual_hosts_built_{};
+};
+
+/**
+ * All route cache stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_ROUTE_CACHE_STATS(COUNTER)                                                             \
+  COUNTER(hit)                                                                                     \
+  COUNTER(miss)                                                                                    \
+  COUNTER(bypass)                                                                                  \
+  COUNTER(overflow)
+// clang-format on
+
+/**
+ * Struct definition for all route cache stats. @see stats_macros.h
+ */
+struct RouteCacheStats {
+  ALL_ROUTE_CACHE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Per worker cache of the routes found by a RouteMatcher, so that a repeated request is routed
+ * with a single hash probe. Lookups are keyed on the host, the path and the values of the other
+ * headers the route table matches on. Requests for a virtual host that is not
+ * VirtualHostImpl::cacheable() bypass the cache. The cache is cleared once it is full, and when
+ * lazy virtual hosts were evicted since the last lookup, so that the cached routes do not keep
+ * them alive.
+ */
+class RouteCache {
+public:
+  RouteCache(const envoy::api::v2::RouteConfiguration& config,
+             Server::Configuration::FactoryContext& factory_context);
+  ~RouteCache();
+
+  RouteConstSharedPtr route(const RouteMatcher& matcher, const Http::HeaderMap& headers,
+                            uint64_t random_value) const;
+
 private:
-  const VirtualHostImpl* findVirtualHost(const Http::HeaderMap& headers) const;
-  const VirtualHostImpl* findWildcardVirtualHost(const std::string& host) const;
-
-  std::unordered_map<std::string, VirtualHostSharedPtr> virtual_hosts_;
-  // std::greater as a minor optimization to iterate from more to less specific
-  //
-  // A note on using an unordered_map versus a vector of (string, VirtualHostSharedPtr) pairs:
-  //
-  // Based on local benchmarks, each vector entry costs around 20ns for recall and (string)
-  // comparison with a fixed cost of about 25ns. For unordered_map, the empty map costs about 65ns
-  // and climbs to about 110ns once there are any entries.
-  //
-  // The break-even is 4 entries.
-  std::map<int64_t, std::unordered_map<std::string, VirtualHostSharedPtr>, std::greater<int64_t>>
-      wildcard_virtual_host_suffixes_;
-  VirtualHostSharedPtr default_virtual_host_;
+  struct ThreadLocalCache : public ThreadLocal::ThreadLocalObject {
+    absl::flat_hash_map<std::string, RouteConstSharedPtr> routes_;
+    // RouteMatcher::virtualHostEvictions() when routes_ was last cleared.
+    uint64_t virtual_host_evictions_{};
+    // Reused to build keys without allocating.
+    std::string key_;
+  };
+
+  void buildKey(const Http::HeaderMap& headers, std::string& key) const;
+
+  // Headers other than the host and the path that the route table matches on.
+  std::vector<Http::LowerCaseString> key_headers_;
+  const uint32_t max_entries_;
+  RouteCacheStats stats_;
+  Event::Dispatcher& main_dispatcher_;
+  ThreadLocal::SlotPtr tls_;
 };
 
 /**
@@ -680,26 +931,51 @@ public:
              Server::Configuration::FactoryContext& factory_context,
              bool validate_clusters_default);
 
-  const HeaderParser& requestHeaderParser() const { return *request_headers_parser_; };
-  const HeaderParser& responseHeaderParser() const { return *response_headers_parser_; };
+  /**
+   * Builds a configuration that can be updated incrementally. The virtual hosts of
+   * previous_config whose config is unchanged are reused instead of being built again.
+   * @param previous_config supplies the configuration being replaced, or nullptr. Only
+   *        virtual hosts of a configuration built with this constructor and the same
+   *        factory_context are reused.
+   */
+  ConfigImpl(const envoy::api::v2::RouteConfiguration& config,
+             Server::Configuration::FactoryContext& factory_context,
+             bool validate_clusters_default, const ConfigImpl* previous_config);
+
+  const HeaderParser& requestHeaderParser() const { return shared_config_->requestHeaderParser(); };
+  const HeaderParser& responseHeaderParser() const {
+    return shared_config_->responseHeaderParser();
+  };
+
+  /**
+   * @return uint32_t the number of virtual hosts reused from the previous configuration.
+   */
+  uint32_t virtualHostsReused() const { return route_matcher_->virtualHostsReused(); }
+
+  /**
+   * @return uint32_t the number of virtual hosts built for this configuration.
+   */
+  uint32_t virtualHostsBuilt() const { return route_matcher_->virtualHostsBuilt(); }
 
   // Router::Config
   RouteConstSharedPtr route(const Http::HeaderMap& headers, uint64_t random_value) const override {
+    if (route_cache_ != nullptr) {
+      return route_cache_->route(*route_matcher_, headers, random_value);
+    }
     return route_matcher_->route(headers, random_value);
   }
 
   const std::list<Http::LowerCaseString>& internalOnlyHeaders() const override {
-    return internal_only_headers_;
+    return shared_config_->internalOnlyHeaders();
   }
 
-  const std::string& name() const override { return name_; }
+  const std::string& name() const override { return shared_config_->name(); }
 
 private:
+  CommonConfigImplConstSharedPtr shared_config_;
   std::unique_ptr<RouteMatcher> route_matcher_;
-  std::list<Http::LowerCaseString> internal_only_headers_;
-  HeaderParserPtr request_headers_parser_;
-  HeaderParserPtr response_headers_parser_;
-  const std::string name_;
+  // Set if the config enables route_cache. A new configuration starts with an empty cache.
+  std::unique_ptr<const RouteCache> route_cache_;
 };
 
 /**
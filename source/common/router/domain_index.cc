@@ -0,0 +1,96 @@
+#include "common/router/domain_index.h"
+
+#include <algorithm>
+
+#include "absl/strings/ascii.h"
+
+namespace Envoy {
+namespace Router {
+
+DomainIndex::Trie::Node& DomainIndex::Trie::insert(absl::string_view key) {
+  uint32_t node = 0;
+  for (const char c : key) {
+    const Node* next = child(nodes_[node], c);
+    if (next != nullptr) {
+      node = next - nodes_.data();
+      continue;
+    }
+    const uint32_t added = nodes_.size();
+    nodes_.emplace_back();
+    auto& children = nodes_[node].children_;
+    children.emplace(std::lower_bound(children.begin(), children.end(), std::make_pair(c, 0U)),
+                     c, added);
+    node = added;
+  }
+  return nodes_[node];
+}
+
+const DomainIndex::Trie::Node* DomainIndex::Trie::child(const Node& node, char c) const {
+  const auto it =
+      std::lower_bound(node.children_.begin(), node.children_.end(), std::make_pair(c, 0U));
+  if (it == node.children_.end() || it->first != c) {
+    return nullptr;
+  }
+  return &nodes_[it->second];
+}
+
+bool DomainIndex::add(absl::string_view domain, uint32_t virtual_host) {
+  std::string key = absl::AsciiStrToLower(domain);
+  if (!key.empty() && key.front() == '*') {
+    key.erase(0, 1);
+    std::reverse(key.begin(), key.end());
+    Trie::Node& node = suffixes_.insert(key);
+    if (node.wildcard_ < 0) {
+      node.wildcard_ = virtual_host;
+    }
+  } else if (!key.empty() && key.back() == '*') {
+    key.pop_back();
+    Trie::Node& node = prefixes_.insert(key);
+    if (node.wildcard_ < 0) {
+      node.wildcard_ = virtual_host;
+    }
+  } else {
+    std::reverse(key.begin(), key.end());
+    Trie::Node& node = suffixes_.insert(key);
+    if (node.exact_ >= 0) {
+      return false;
+    }
+    node.exact_ = virtual_host;
+  }
+  return true;
+}
+
+int64_t DomainIndex::find(absl::string_view host) const {
+  // Walk the host from its end. Any wildcard passed on the way is shorter than the host, and the
+  // last one passed is the longest.
+  int64_t suffix_wildcard = -1;
+  const Trie::Node* node = &suffixes_.root();
+  for (size_t depth = 0; node != nullptr; depth++) {
+    if (depth == host.size()) {
+      if (node->exact_ >= 0) {
+        return node->exact_;
+      }
+      break;
+    }
+    if (node->wildcard_ >= 0) {
+      suffix_wildcard = node->wildcard_;
+    }
+    node = suffixes_.child(*node, absl::ascii_tolower(host[host.size() - 1 - depth]));
+  }
+  if (suffix_wildcard >= 0) {
+    return suffix_wildcard;
+  }
+
+  int64_t prefix_wildcard = -1;
+  node = &prefixes_.root();
+  for (size_t depth = 0; node != nullptr && depth < host.size(); depth++) {
+    if (node->wildcard_ >= 0) {
+      prefix_wildcard = node->wildcard_;
+    }
+    node = prefixes_.child(*node, absl::ascii_tolower(host[depth]));
+  }
+  return prefix_wildcard;
+}
+
+} // namespace Router
+} // namespace Envoy
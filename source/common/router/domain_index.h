@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Finds the virtual host whose domains match a host header. Virtual hosts are identified by their
+ * position in the route configuration. Exact domains and suffix wildcards (``*.foo.com``,
+ * ``*-bar.foo.com``) are kept in a character trie of the reversed domains, and prefix wildcards
+ * (``foo.*``) in a character trie of the domains. The host is lower cased character by character
+ * as the tries are walked, so a lookup takes time linear in the length of the host, however many
+ * domains there are, and does not allocate.
+ *
+ * An exact domain is preferred over a suffix wildcard, and a suffix wildcard over a prefix
+ * wildcard. Among wildcards of the same kind the longest one wins. A wildcard does not match the
+ * empty string.
+ */
+class DomainIndex {
+public:
+  /**
+   * @param domain supplies an exact domain, or a wildcard domain starting or ending with ``*``.
+   *        The catch-all domain ``*`` is not supported. Domains are matched case insensitively.
+   * @param virtual_host supplies the position of the virtual host.
+   * @return bool false if the domain is exact and was already added. A duplicate wildcard is
+   *         ignored, so that the first virtual host to add it wins.
+   */
+  bool add(absl::string_view domain, uint32_t virtual_host);
+
+  /**
+   * @return bool whether no domains were added.
+   */
+  bool empty() const { return suffixes_.empty() && prefixes_.empty(); }
+
+  /**
+   * @param host supplies the host header value.
+   * @return int64_t the position of the matching virtual host, or -1 if no domain matches.
+   */
+  int64_t find(absl::string_view host) const;
+
+private:
+  class Trie {
+  public:
+    struct Node {
+      // Children as (character, node index) pairs sorted by character.
+      std::vector<std::pair<char, uint32_t>> children_;
+      // The virtual host of the domain ending at this node, or -1.
+      int64_t exact_{-1};
+      // The virtual host of the wildcard whose fixed part ends at this node, or -1.
+      int64_t wildcard_{-1};
+    };
+
+    /**
+     * @param key supplies the lower cased key, in the order the trie is walked.
+     * @return Node& the node for the key, added if needed.
+     */
+    Node& insert(absl::string_view key);
+    const Node& root() const { return nodes_[0]; }
+    const Node* child(const Node& node, char c) const;
+    bool empty() const {
+      return nodes_.size() == 1 && nodes_[0].exact_ < 0 && nodes_[0].wildcard_ < 0;
+    }
+
+  private:
+    std::vector<Node> nodes_{1};
+  };
+
+  // Reversed exact domains and suffix wildcards.
+  Trie suffixes_;
+  // Prefix wildcards.
+  Trie prefixes_;
+};
+
+} // namespace Router
+} // namespace Envoy
@@ -20,6 +20,21 @@ public:
 
   virtual const std::string format(const Envoy::StreamInfo::StreamInfo& stream_info) const PURE;
 
+  /**
+   * Appends the formatted value to a buffer, so that the parts of a compound value are formatted
+   * without a temporary string for each constant part.
+   * @param stream_info supplies the stream info to format the value from.
+   * @param buf supplies the buffer to append to.
+   */
+  virtual void formatInto(const Envoy::StreamInfo::StreamInfo& stream_info,
+                          std::string& buf) const PURE;
+
+  /**
+   * @return const std::string* the value if it does not depend on the stream, or nullptr. The
+   *         value lives as long as the formatter, so that it can be added to headers by reference.
+   */
+  virtual const std::string* constantValue() const PURE;
+
   /**
    * @return bool indicating whether the formatted header should be appended to the existing
    *              headers
@@ -38,6 +53,11 @@ public:
 
   // HeaderFormatter::format
   const std::string format(const Envoy::StreamInfo::StreamInfo& stream_info) const override;
+  void formatInto(const Envoy::StreamInfo::StreamInfo& stream_info,
+                  std::string& buf) const override {
+    buf += format(stream_info);
+  }
+  const std::string* constantValue() const override { return nullptr; }
   bool append() const override { return append_; }
 
 private:
@@ -59,6 +79,10 @@ public:
   const std::string format(const Envoy::StreamInfo::StreamInfo&) const override {
     return static_value_;
   };
+  void formatInto(const Envoy::StreamInfo::StreamInfo&, std::string& buf) const override {
+    buf += static_value_;
+  }
+  const std::string* constantValue() const override { return &static_value_; }
   bool append() const override { return append_; }
 
 private:
@@ -72,21 +96,37 @@ private:
 class CompoundHeaderFormatter : public HeaderFormatter {
 public:
   CompoundHeaderFormatter(std::vector<HeaderFormatterPtr>&& formatters, bool append)
-      : formatters_(std::move(formatters)), append_(append) {}
+      : formatters_(std::move(formatters)), append_(append) {
+    for (const auto& formatter : formatters_) {
+      const std::string* constant_value = formatter->constantValue();
+      reserve_size_ +=
+          constant_value != nullptr ? constant_value->size() : DYNAMIC_VALUE_SIZE_ESTIMATE;
+    }
+  }
 
   // HeaderFormatter::format
   const std::string format(const Envoy::StreamInfo::StreamInfo& stream_info) const override {
     std::string buf;
-    for (const auto& formatter : formatters_) {
-      buf += formatter->format(stream_info);
-    }
+    buf.reserve(reserve_size_);
+    formatInto(stream_info, buf);
     return buf;
   };
+  void formatInto(const Envoy::StreamInfo::StreamInfo& stream_info,
+                  std::string& buf) const override {
+    for (const auto& formatter : formatters_) {
+      formatter->formatInto(stream_info, buf);
+    }
+  }
+  const std::string* constantValue() const override { return nullptr; }
   bool append() const override { return append_; }
 
 private:
+  // Bytes reserved for each part that depends on the stream, e.g. an address or a metadata value.
+  static constexpr size_t DYNAMIC_VALUE_SIZE_ESTIMATE = 32;
+
   const std::vector<HeaderFormatterPtr> formatters_;
   const bool append_;
+  size_t reserve_size_{};
 };
 
 } // namespace Router
@@ -227,8 +227,8 @@ HeaderParserPtr HeaderParser::configure(
   for (const auto& header_value_option : headers_to_add) {
     HeaderFormatterPtr header_formatter = parseInternal(header_value_option);
 
-    header_parser->headers_to_add_.emplace_back(
-        Http::LowerCaseString(header_value_option.header().key()), std::move(header_formatter));
+    header_parser->headers_to_add_.emplace_back(header_value_option.header().key(),
+                                                std::move(header_formatter));
   }
 
   return header_parser;
@@ -260,13 +260,24 @@ void HeaderParser::evaluateHeaders(Http::HeaderMap& headers,
     headers.remove(header);
   }
 
-  for (const auto& formatter : headers_to_add_) {
-    const std::string value = formatter.second->format(stream_info);
+  for (const auto& header : headers_to_add_) {
+    if (header.constant_value_ != nullptr) {
+      if (!header.constant_value_->empty()) {
+        if (header.formatter_->append()) {
+          headers.addReference(header.key_, *header.constant_value_);
+        } else {
+          headers.setReference(header.key_, *header.constant_value_);
+        }
+      }
+      continue;
+    }
+
+    const std::string value = header.formatter_->format(stream_info);
     if (!value.empty()) {
-      if (formatter.second->append()) {
-        headers.addReferenceKey(formatter.first, value);
+      if (header.formatter_->append()) {
+        headers.addReferenceKey(header.key_, value);
       } else {
-        headers.setReferenceKey(formatter.first, value);
+        headers.setReferenceKey(header.key_, value);
       }
     }
   }
@@ -19,7 +19,8 @@ typedef std::unique_ptr<HeaderParser> HeaderParserPtr;
 /**
  * HeaderParser manipulates Http::HeaderMap instances. Headers to be added are pre-parsed to select
  * between a constant value implementation and a dynamic value implementation based on
- * StreamInfo::StreamInfo fields.
+ * StreamInfo::StreamInfo fields. Constant values are added by reference, without copying them
+ * into each request.
  */
 class HeaderParser {
 public:
@@ -45,7 +46,19 @@ protected:
   HeaderParser() {}
 
 private:
-  std::vector<std::pair<Http::LowerCaseString, HeaderFormatterPtr>> headers_to_add_;
+  struct HeaderToAdd {
+    HeaderToAdd(const std::string& key, HeaderFormatterPtr&& formatter)
+        : key_(key), formatter_(std::move(formatter)),
+          constant_value_(formatter_->constantValue()) {}
+
+    Http::LowerCaseString key_;
+    HeaderFormatterPtr formatter_;
+    // Owned by formatter_, or nullptr if the value depends on the stream. Moving the HeaderToAdd
+    // does not move the formatter, so the pointer stays valid.
+    const std::string* constant_value_;
+  };
+
+  std::vector<HeaderToAdd> headers_to_add_;
   std::vector<Http::LowerCaseString> headers_to_remove_;
 };
 
@@ -62,7 +62,7 @@ RdsRouteConfigSubscription::RdsRouteConfigSubscription(
     Envoy::Router::RouteConfigProviderManagerImpl& route_config_provider_manager)
     : route_config_name_(rds.route_config_name()),
       scope_(factory_context.scope().createScope(stat_prefix + "rds." + route_config_name_ + ".")),
-      stats_({ALL_RDS_STATS(POOL_COUNTER(*scope_))}),
+      stats_({ALL_RDS_STATS(POOL_COUNTER(*scope_), POOL_HISTOGRAM(*scope_))}),
       route_config_provider_manager_(route_config_provider_manager),
       manager_identifier_(manager_identifier), time_source_(factory_context.timeSource()),
       last_updated_(factory_context.timeSource().systemTime()) {
@@ -154,8 +154,9 @@ RdsRouteConfigProviderImpl::RdsRouteConfigProviderImpl(
       tls_(factory_context.threadLocal().allocateSlot()) {
   ConfigConstSharedPtr initial_config;
   if (subscription_->config_info_.has_value()) {
-    initial_config =
-        std::make_shared<ConfigImpl>(subscription_->route_config_proto_, factory_context_, false);
+    config_ = std::make_shared<ConfigImpl>(subscription_->route_config_proto_, factory_context_,
+                                           false, nullptr);
+    initial_config = config_;
   } else {
     initial_config = std::make_shared<NullConfigImpl>();
   }
@@ -183,8 +184,19 @@ absl::optional<RouteConfigProvider::ConfigInfo> RdsRouteConfigProviderImpl::conf
 }
 
 void RdsRouteConfigProviderImpl::onConfigUpdate() {
-  ConfigConstSharedPtr new_config(
-      new ConfigImpl(subscription_->route_config_proto_, factory_context_, false));
+  const MonotonicTime start = subscription_->time_source_.monotonicTime();
+  std::shared_ptr<const ConfigImpl> new_config = std::make_shared<ConfigImpl>(
+      subscription_->route_config_proto_, factory_context_, false, config_.get());
+  subscription_->stats_.config_build_time_ms_.recordValue(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          subscription_->time_source_.monotonicTime() - start)
+          .count());
+  subscription_->stats_.virtual_host_reused_.add(new_config->virtualHostsReused());
+  subscription_->stats_.virtual_host_rebuilt_.add(new_config->virtualHostsBuilt());
+  ENVOY_LOG(debug, "rds: built config {}: {} virtual hosts reused, {} rebuilt", new_config->name(),
+            new_config->virtualHostsReused(), new_config->virtualHostsBuilt());
+
+  config_ = new_config;
   tls_->runOnAllThreads(
       [this, new_config]() -> void { tls_->getTyped<ThreadLocalConfig>().config_ = new_config; });
 }
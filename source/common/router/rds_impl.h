@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -74,9 +75,12 @@ private:
  * All RDS stats. @see stats_macros.h
  */
 // clang-format off
-#define ALL_RDS_STATS(COUNTER)                                                                     \
+#define ALL_RDS_STATS(COUNTER, HISTOGRAM)                                                          \
   COUNTER(config_reload)                                                                           \
-  COUNTER(update_empty)
+  COUNTER(update_empty)                                                                            \
+  COUNTER(virtual_host_rebuilt)                                                                    \
+  COUNTER(virtual_host_reused)                                                                     \
+  HISTOGRAM(config_build_time_ms)
 
 // clang-format on
 
@@ -84,9 +88,10 @@ private:
  * Struct definition for all RDS stats. @see stats_macros.h
  */
 struct RdsStats {
-  ALL_RDS_STATS(GENERATE_COUNTER_STRUCT)
+  ALL_RDS_STATS(GENERATE_COUNTER_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
+class ConfigImpl;
 class RdsRouteConfigProviderImpl;
 
 /**
@@ -177,6 +182,9 @@ private:
   RdsRouteConfigSubscriptionSharedPtr subscription_;
   Server::Configuration::FactoryContext& factory_context_;
   ThreadLocal::SlotPtr tls_;
+  // The config last posted to the workers, if any, whose unchanged virtual hosts are reused by the
+  // next update. Only used on the main thread.
+  std::shared_ptr<const ConfigImpl> config_;
 
   friend class RouteConfigProviderManagerImpl;
 };
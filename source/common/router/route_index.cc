@@ -0,0 +1,125 @@
+#include "common/router/route_index.h"
+
+#include <algorithm>
+
+#include "absl/strings/ascii.h"
+
+namespace Envoy {
+namespace Router {
+
+void RouteIndex::Trie::insert(absl::string_view key, uint32_t route) {
+  uint32_t node = 0;
+  for (const char c : key) {
+    const int64_t next = child(nodes_[node], c);
+    if (next >= 0) {
+      node = next;
+      continue;
+    }
+    const uint32_t added = nodes_.size();
+    nodes_.emplace_back();
+    auto& children = nodes_[node].children_;
+    children.emplace(std::lower_bound(children.begin(), children.end(), std::make_pair(c, 0U)),
+                     c, added);
+    node = added;
+  }
+  nodes_[node].routes_.push_back(route);
+}
+
+void RouteIndex::Trie::find(absl::string_view path, bool lower_case,
+                            Candidates& candidates) const {
+  uint32_t node = 0;
+  size_t depth = 0;
+  while (true) {
+    const Node& current = nodes_[node];
+    candidates.insert(candidates.end(), current.routes_.begin(), current.routes_.end());
+    if (depth == path.size() || current.children_.empty()) {
+      return;
+    }
+    const char c = lower_case ? absl::ascii_tolower(path[depth]) : path[depth];
+    const int64_t next = child(current, c);
+    if (next < 0) {
+      return;
+    }
+    node = next;
+    depth++;
+  }
+}
+
+int64_t RouteIndex::Trie::child(const Node& node, char c) const {
+  const auto it =
+      std::lower_bound(node.children_.begin(), node.children_.end(), std::make_pair(c, 0U));
+  if (it == node.children_.end() || it->first != c) {
+    return -1;
+  }
+  return it->second;
+}
+
+void RouteIndex::addPrefix(uint32_t route, const std::string& prefix, bool case_sensitive) {
+  if (case_sensitive) {
+    prefixes_.insert(prefix, route);
+  } else {
+    case_insensitive_prefixes_.insert(absl::AsciiStrToLower(prefix), route);
+  }
+}
+
+void RouteIndex::addPath(uint32_t route, const std::string& path, bool case_sensitive) {
+  if (case_sensitive) {
+    paths_[path].push_back(route);
+  } else {
+    case_insensitive_paths_[absl::AsciiStrToLower(path)].push_back(route);
+  }
+}
+
+void RouteIndex::addRegex(uint32_t route, const std::string& regex) {
+  regex_routes_.push_back(route);
+  regexes_.push_back(regex);
+}
+
+void RouteIndex::compile() {
+  if (!regexes_.empty()) {
+    regex_set_ = std::make_unique<const Regex::CompiledGoogleReSet>(regexes_);
+  }
+  regexes_.clear();
+  regexes_.shrink_to_fit();
+}
+
+void RouteIndex::findCandidates(absl::string_view path, Candidates& candidates) const {
+  prefixes_.find(path, false, candidates);
+  if (!case_insensitive_prefixes_.empty()) {
+    case_insensitive_prefixes_.find(path, true, candidates);
+  }
+
+  // Exact path and regex routes do not match the query string.
+  const absl::string_view path_only = path.substr(0, path.find('?'));
+  if (!paths_.empty() || !case_insensitive_paths_.empty()) {
+    findPath(paths_, path_only, candidates);
+    if (!case_insensitive_paths_.empty()) {
+      findPath(case_insensitive_paths_, absl::AsciiStrToLower(path_only), candidates);
+    }
+  }
+
+  if (regex_set_ != nullptr) {
+    std::vector<int> matches;
+    if (regex_set_->match(path_only, matches)) {
+      for (const int match : matches) {
+        candidates.push_back(regex_routes_[match]);
+      }
+    } else {
+      // The candidates are checked in full anyway, so fall back to trying every regex route.
+      candidates.insert(candidates.end(), regex_routes_.begin(), regex_routes_.end());
+    }
+  }
+
+  // Each route is in exactly one of the structures above, so there are no duplicates.
+  std::sort(candidates.begin(), candidates.end());
+}
+
+void RouteIndex::findPath(const PathMap& paths, absl::string_view path, Candidates& candidates) {
+  const auto it = paths.find(path);
+  if (it != paths.end()) {
+    candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+  }
+}
+
+} // namespace Router
+} // namespace Envoy
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/common/regex.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Narrows down the routes of a virtual host that may match a request path, so that the router
+ * does not have to try every route in turn. Routes are identified by their position in the
+ * virtual host. Prefix routes are kept in a character trie and exact path routes in a hash map;
+ * case insensitive routes are keyed on their lower cased matcher in separate structures. Regex
+ * routes are compiled into a single regex set, so that all of them are matched in one pass over
+ * the path.
+ *
+ * A candidate only has a matching path: the caller must still check it in full, in the order
+ * returned, to keep first-match semantics.
+ */
+class RouteIndex {
+public:
+  typedef absl::InlinedVector<uint32_t, 16> Candidates;
+
+  /**
+   * Routes must be added in ascending order.
+   * @param route supplies the position of the route in the virtual host.
+   * @param prefix supplies the path prefix matched by the route.
+   * @param case_sensitive supplies whether the prefix is matched case sensitively.
+   */
+  void addPrefix(uint32_t route, const std::string& prefix, bool case_sensitive);
+
+  /**
+   * Routes must be added in ascending order.
+   * @param route supplies the position of the route in the virtual host.
+   * @param path supplies the exact path matched by the route, excluding the query string.
+   * @param case_sensitive supplies whether the path is matched case sensitively.
+   */
+  void addPath(uint32_t route, const std::string& path, bool case_sensitive);
+
+  /**
+   * Routes must be added in ascending order.
+   * @param route supplies the position of the route in the virtual host.
+   * @param regex supplies the regex matched by the path, excluding the query string.
+   */
+  void addRegex(uint32_t route, const std::string& regex);
+
+  /**
+   * Compiles the regex routes. Must be called once all routes are added and before
+   * findCandidates().
+   * @throw EnvoyException if the regex routes cannot be compiled.
+   */
+  void compile();
+
+  /**
+   * @param path supplies the request path, including the query string.
+   * @param candidates receives the positions of the routes whose path matcher may match, in
+   *        ascending order.
+   */
+  void findCandidates(absl::string_view path, Candidates& candidates) const;
+
+private:
+  class Trie {
+  public:
+    void insert(absl::string_view key, uint32_t route);
+    void find(absl::string_view path, bool lower_case, Candidates& candidates) const;
+    bool empty() const { return nodes_.size() == 1 && nodes_[0].routes_.empty(); }
+
+  private:
+    struct Node {
+      // Children as (character, node index) pairs sorted by character.
+      std::vector<std::pair<char, uint32_t>> children_;
+      std::vector<uint32_t> routes_;
+    };
+
+    int64_t child(const Node& node, char c) const;
+
+    std::vector<Node> nodes_{1};
+  };
+
+  typedef absl::flat_hash_map<std::string, std::vector<uint32_t>> PathMap;
+
+  static void findPath(const PathMap& paths, absl::string_view path, Candidates& candidates);
+
+  Trie prefixes_;
+  Trie case_insensitive_prefixes_;
+  PathMap paths_;
+  PathMap case_insensitive_paths_;
+  std::vector<uint32_t> regex_routes_;
+  std::vector<std::string> regexes_;
+  Regex::CompiledGoogleReSetPtr regex_set_;
+};
+
+} // namespace Router
+} // namespace Envoy
@@ -160,6 +160,7 @@ void Filter::chargeUpstreamCode(uint64_t response_status_code,
     const std::string zone_name = config_.local_info_.zoneName();
     const std::string upstream_zone = upstreamZone(upstream_host);
 
+    Http::CodeStats& code_stats = httpContext().codeStats();
     Http::CodeStats::ResponseStatInfo info{config_.scope_,
                                            cluster_->statsScope(),
                                            EMPTY_STRING,
@@ -170,9 +171,9 @@ void Filter::chargeUpstreamCode(uint64_t response_status_code,
                                                              : EMPTY_STRING,
                                            zone_name,
                                            upstream_zone,
-                                           is_canary};
+                                           is_canary,
+                                           &cluster_->responseCounters(code_stats)};
 
-    Http::CodeStats& code_stats = httpContext().codeStats();
     code_stats.chargeResponseStat(info);
 
     if (!alt_stat_prefix_.empty()) {
@@ -180,7 +181,8 @@ void Filter::chargeUpstreamCode(uint64_t response_status_code,
                                              alt_stat_prefix_, response_status_code,
                                              internal_request, EMPTY_STRING,
                                              EMPTY_STRING,     zone_name,
-                                             upstream_zone,    is_canary};
+                                             upstream_zone,    is_canary,
+                                             nullptr};
 
       code_stats.chargeResponseStat(info);
     }
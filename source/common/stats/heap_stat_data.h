@@ -73,9 +73,12 @@ private:
     }
   };
 
+  // The tag-extracted names and tags of the stats are held in the symbol table of the
+  // allocator (see MetricImpl). The full name is still held here as a string, as the
+  // nul-terminated name is the key of the lock-free TLS caches of ThreadLocalStoreImpl.
   // TODO(jmarantz): See https://github.com/envoyproxy/envoy/pull/3927 and
-  //  https://github.com/envoyproxy/envoy/issues/3585, which can help reorganize
-  // the heap stats using a ref-counted symbol table to compress the stat strings.
+  //  https://github.com/envoyproxy/envoy/issues/3585: the full name can also be symbolized once
+  // the scopes look stats up by StatName rather than by string.
   using StatSet = absl::flat_hash_set<HeapStatData*, HeapStatHash, HeapStatCompare>;
 
   // An unordered set of HeapStatData pointers which keys off the key()
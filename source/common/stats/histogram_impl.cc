@@ -10,10 +10,11 @@
 namespace Envoy {
 namespace Stats {
 
-HistogramStatisticsImpl::HistogramStatisticsImpl(const histogram_t* histogram_ptr)
-    : computed_quantiles_(supportedQuantiles().size(), 0.0) {
-  hist_approx_quantile(histogram_ptr, supportedQuantiles().data(), supportedQuantiles().size(),
-                       computed_quantiles_.data());
+HistogramStatisticsImpl::HistogramStatisticsImpl(const histogram_t* histogram_ptr,
+                                                 const std::vector<double>& supported_buckets)
+    : computed_quantiles_(supportedQuantiles().size(), 0.0), supported_buckets_(supported_buckets),
+      computed_buckets_(supported_buckets.size(), 0), sample_count_(0), sample_sum_(0) {
+  refresh(histogram_ptr);
 }
 
 const std::vector<double>& HistogramStatisticsImpl::supportedQuantiles() const {
@@ -22,6 +23,13 @@ const std::vector<double>& HistogramStatisticsImpl::supportedQuantiles() const {
   return supported_quantiles;
 }
 
+const std::vector<double>& HistogramStatisticsImpl::defaultSupportedBuckets() {
+  static const std::vector<double> default_buckets = {
+      0.5,  1,    5,     10,    25,    50,     100,    250,     500,    1000,
+      2500, 5000, 10000, 30000, 60000, 300000, 600000, 1800000, 3600000};
+  return default_buckets;
+}
+
 std::string HistogramStatisticsImpl::summary() const {
   std::vector<std::string> summary;
   const std::vector<double>& supported_quantiles_ref = supportedQuantiles();
@@ -41,6 +49,13 @@ void HistogramStatisticsImpl::refresh(const histogram_t* new_histogram_ptr) {
   ASSERT(supportedQuantiles().size() == computed_quantiles_.size());
   hist_approx_quantile(new_histogram_ptr, supportedQuantiles().data(), supportedQuantiles().size(),
                        computed_quantiles_.data());
+
+  ASSERT(supported_buckets_.size() == computed_buckets_.size());
+  for (size_t i = 0; i < supported_buckets_.size(); ++i) {
+    computed_buckets_[i] = hist_approx_count_below(new_histogram_ptr, supported_buckets_[i]);
+  }
+  sample_count_ = hist_sample_count(new_histogram_ptr);
+  sample_sum_ = hist_approx_sum(new_histogram_ptr);
 }
 
 } // namespace Stats
@@ -20,23 +20,42 @@ namespace Stats {
  */
 class HistogramStatisticsImpl : public HistogramStatistics, NonCopyable {
 public:
-  HistogramStatisticsImpl() : computed_quantiles_(supportedQuantiles().size(), 0.0) {}
+  HistogramStatisticsImpl(const std::vector<double>& supported_buckets = defaultSupportedBuckets())
+      : computed_quantiles_(supportedQuantiles().size(), 0.0),
+        supported_buckets_(supported_buckets), computed_buckets_(supported_buckets.size(), 0),
+        sample_count_(0), sample_sum_(0) {}
   /**
    * HistogramStatisticsImpl object is constructed using the passed in histogram.
    * @param histogram_ptr pointer to the histogram for which stats will be calculated. This pointer
    * will not be retained.
+   * @param supported_buckets the upper bounds of the buckets to compute the counts of, in
+   * ascending order. They are copied, so that they stay the same for the lifetime of the object.
    */
-  HistogramStatisticsImpl(const histogram_t* histogram_ptr);
+  HistogramStatisticsImpl(const histogram_t* histogram_ptr,
+                          const std::vector<double>& supported_buckets = defaultSupportedBuckets());
 
   void refresh(const histogram_t* new_histogram_ptr);
 
+  /**
+   * @return the upper bounds of the buckets used unless others are configured.
+   */
+  static const std::vector<double>& defaultSupportedBuckets();
+
   // HistogramStatistics
   std::string summary() const override;
   const std::vector<double>& supportedQuantiles() const override;
   const std::vector<double>& computedQuantiles() const override { return computed_quantiles_; }
+  const std::vector<double>& supportedBuckets() const override { return supported_buckets_; }
+  const std::vector<uint64_t>& computedBuckets() const override { return computed_buckets_; }
+  uint64_t sampleCount() const override { return sample_count_; }
+  double sampleSum() const override { return sample_sum_; }
 
 private:
   std::vector<double> computed_quantiles_;
+  const std::vector<double> supported_buckets_;
+  std::vector<uint64_t> computed_buckets_;
+  uint64_t sample_count_;
+  double sample_sum_;
 };
 
 /**
@@ -45,8 +64,10 @@ private:
 class HistogramImpl : public Histogram, public MetricImpl {
 public:
   HistogramImpl(const std::string& name, Store& parent, std::string&& tag_extracted_name,
-                std::vector<Tag>&& tags)
-      : MetricImpl(std::move(tag_extracted_name), std::move(tags)), parent_(parent), name_(name) {}
+                std::vector<Tag>&& tags, SymbolTable& symbol_table)
+      : MetricImpl(tag_extracted_name, tags, symbol_table), parent_(parent),
+        symbol_table_(symbol_table), name_(name) {}
+  ~HistogramImpl() { MetricImpl::clear(); }
 
   // Stats:;Metric
   std::string name() const override { return name_; }
@@ -57,9 +78,14 @@ public:
 
   bool used() const override { return true; }
 
+protected:
+  // MetricImpl
+  SymbolTable& symbolTable() const override { return symbol_table_; }
+
 private:
   // This is used for delivering the histogram data to sinks.
   Store& parent_;
+  SymbolTable& symbol_table_;
 
   const std::string name_;
 };
@@ -74,8 +100,8 @@ public:
   ~NullHistogramImpl() {}
   std::string name() const override { return ""; }
   const char* nameCStr() const override { return ""; }
-  const std::string& tagExtractedName() const override { CONSTRUCT_ON_FIRST_USE(std::string, ""); }
-  const std::vector<Tag>& tags() const override { CONSTRUCT_ON_FIRST_USE(std::vector<Tag>, {}); }
+  std::string tagExtractedName() const override { return ""; }
+  std::vector<Tag> tags() const override { return {}; }
   void recordValue(uint64_t) override {}
   bool used() const override { return false; }
 };
@@ -0,0 +1,79 @@
+#include "common/stats/metric_impl.h"
+
+namespace Envoy {
+namespace Stats {
+
+MetricImpl::MetricImpl(absl::string_view tag_extracted_name, const std::vector<Tag>& tags,
+                       SymbolTable& symbol_table) {
+  ASSERT(tags.size() <= UINT8_MAX);
+
+  // Encode all the names first, so that their storage can be allocated at once. The vector is
+  // sized up front, as SymbolEncoding must not be copied once it holds symbols.
+  std::vector<SymbolEncoding> encodings(1 + 2 * tags.size());
+  uint64_t num_bytes = 1;
+  auto encode = [&symbol_table, &num_bytes](absl::string_view name, SymbolEncoding& encoding) {
+    SymbolEncoding tmp = symbol_table.encode(name);
+    encoding.swap(tmp);
+    num_bytes += encoding.bytesRequired();
+  };
+  encode(tag_extracted_name, encodings[0]);
+  for (size_t i = 0; i < tags.size(); ++i) {
+    encode(tags[i].name_, encodings[1 + 2 * i]);
+    encode(tags[i].value_, encodings[2 + 2 * i]);
+  }
+
+  storage_ = std::make_unique<uint8_t[]>(num_bytes);
+  uint8_t* p = storage_.get();
+  *p++ = static_cast<uint8_t>(tags.size());
+  for (SymbolEncoding& encoding : encodings) {
+    p += encoding.moveToStorage(p);
+  }
+}
+
+MetricImpl::~MetricImpl() {
+  // Child classes must have called clear() to release the symbols.
+  ASSERT(storage_ == nullptr);
+}
+
+std::string MetricImpl::tagExtractedName() const {
+  return StatName(storage_.get() + 1).toString(symbolTable());
+}
+
+std::vector<Tag> MetricImpl::tags() const {
+  std::vector<Tag> tags;
+  tags.reserve(storage_[0]);
+  const SymbolTable& symbol_table = symbolTable();
+  bool is_name = true;
+  bool is_tag_extracted_name = true;
+  forEachStatName([&](StatName stat_name) {
+    if (is_tag_extracted_name) {
+      is_tag_extracted_name = false;
+    } else if (is_name) {
+      tags.emplace_back(Tag{stat_name.toString(symbol_table), ""});
+      is_name = false;
+    } else {
+      tags.back().value_ = stat_name.toString(symbol_table);
+      is_name = true;
+    }
+  });
+  return tags;
+}
+
+void MetricImpl::clear() {
+  SymbolTable& symbol_table = symbolTable();
+  forEachStatName([&symbol_table](StatName stat_name) { symbol_table.free(stat_name); });
+  storage_.reset();
+}
+
+void MetricImpl::forEachStatName(const std::function<void(StatName)>& fn) const {
+  const uint8_t* p = storage_.get();
+  const uint64_t num_stat_names = 1 + 2 * static_cast<uint64_t>(*p++);
+  for (uint64_t i = 0; i < num_stat_names; ++i) {
+    const StatName stat_name(p);
+    fn(stat_name);
+    p += stat_name.size();
+  }
+}
+
+} // namespace Stats
+} // namespace Envoy
@@ -1,12 +1,19 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "envoy/stats/stats.h"
+#include "envoy/stats/symbol_table.h"
 #include "envoy/stats/tag.h"
 
 #include "common/common/assert.h"
+#include "common/stats/symbol_table_impl.h"
+
+#include "absl/strings/string_view.h"
 
 namespace Envoy {
 namespace Stats {
@@ -17,26 +24,49 @@ namespace Stats {
  *
  * MetricImpl is not meant to be instantiated as-is. For performance reasons we keep name() virtual
  * and expect child classes to implement it.
+ *
+ * The tag-extracted name and the tags are held as StatNames packed into a single allocation, and
+ * are only elaborated into strings when they are exported. To save 8 bytes per stat, MetricImpl
+ * does not hold the SymbolTable: child classes provide it through symbolTable(), and must call
+ * clear() from their destructors to release the symbols.
  */
 class MetricImpl : public virtual Metric {
 public:
-  MetricImpl(std::string&& tag_extracted_name, std::vector<Tag>&& tags)
-      : tag_extracted_name_(std::move(tag_extracted_name)), tags_(std::move(tags)) {}
+  MetricImpl(absl::string_view tag_extracted_name, const std::vector<Tag>& tags,
+             SymbolTable& symbol_table);
+  ~MetricImpl();
 
-  const std::string& tagExtractedName() const override { return tag_extracted_name_; }
-  const std::vector<Tag>& tags() const override { return tags_; }
+  std::string tagExtractedName() const override;
+  std::vector<Tag> tags() const override;
 
 protected:
   /**
-   * Flags used by all stats types to figure out whether they have been used.
+   * Flags used by all stats types to figure out whether they have been used, and whether they
+   * changed since they were last flushed. Gauges also record whether they were ever set().
    */
   struct Flags {
     static const uint8_t Used = 0x1;
+    static const uint8_t Changed = 0x2;
+    static const uint8_t Set = 0x4;
   };
 
+  /**
+   * @return SymbolTable& the symbol table in which the tag-extracted name and tags are stored.
+   */
+  virtual SymbolTable& symbolTable() const PURE;
+
+  /**
+   * Releases the symbols of the tag-extracted name and tags. This must be called from the
+   * destructor of child classes, while symbolTable() can still be resolved.
+   */
+  void clear();
+
 private:
-  const std::string tag_extracted_name_;
-  const std::vector<Tag> tags_;
+  // Calls fn with the tag-extracted name, then with the name and value of each tag.
+  void forEachStatName(const std::function<void(StatName)>& fn) const;
+
+  // The number of tags, followed by the tag-extracted name and the name and value of each tag.
+  std::unique_ptr<uint8_t[]> storage_;
 };
 
 } // namespace Stats
@@ -0,0 +1,59 @@
+#include "common/stats/sharded_counter.h"
+
+#include <new>
+
+#include "common/common/macros.h"
+
+#include "absl/container/flat_hash_set.h"
+
+namespace Envoy {
+namespace Stats {
+
+namespace {
+
+// The tag-extracted names of the counters charged by every worker for every request, or every
+// read and write of a connection.
+const absl::flat_hash_set<absl::string_view>& hotCounterNames() {
+  CONSTRUCT_ON_FIRST_USE(absl::flat_hash_set<absl::string_view>,
+                         {"cluster.upstream_cx_rx_bytes_total",
+                          "cluster.upstream_cx_tx_bytes_total", "cluster.upstream_rq_completed",
+                          "cluster.upstream_rq_total", "http.downstream_cx_rx_bytes_total",
+                          "http.downstream_cx_tx_bytes_total", "http.downstream_rq_completed",
+                          "http.downstream_rq_total"});
+}
+
+} // namespace
+
+std::atomic<uint32_t> CounterShards::next_shard_index_{0};
+
+CounterShards::CounterShards() : storage_(new uint8_t[(NumShards + 1) * CacheLineSize]) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(storage_.get());
+  const uintptr_t aligned = (address + CacheLineSize - 1) & ~(CacheLineSize - 1);
+  shards_ = reinterpret_cast<Shard*>(aligned);
+  for (uint32_t i = 0; i < NumShards; ++i) {
+    new (&shards_[i]) Shard();
+  }
+}
+
+uint64_t CounterShards::sum() const {
+  uint64_t sum = 0;
+  for (uint32_t i = 0; i < NumShards; ++i) {
+    sum += shards_[i].value_.load(std::memory_order_relaxed);
+  }
+  return sum;
+}
+
+uint64_t CounterShards::latch() {
+  uint64_t sum = 0;
+  for (uint32_t i = 0; i < NumShards; ++i) {
+    sum += shards_[i].value_.exchange(0, std::memory_order_relaxed);
+  }
+  return sum;
+}
+
+bool CounterShards::isHotCounter(absl::string_view tag_extracted_name) {
+  return hotCounterNames().contains(tag_extracted_name);
+}
+
+} // namespace Stats
+} // namespace Envoy
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "common/common/non_copyable.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * Increments of a counter that every worker adds to, spread over slots of their own cache line so
+ * that the workers do not contend on a single atomic. Each thread always writes the same slot, and
+ * the slots are only summed when the counter is read or flushed.
+ */
+class CounterShards : NonCopyable {
+public:
+  CounterShards();
+
+  /**
+   * Adds to the slot of the calling thread.
+   * @param amount supplies the amount to add.
+   */
+  void add(uint64_t amount) {
+    shards_[shardIndex()].value_.fetch_add(amount, std::memory_order_relaxed);
+  }
+
+  /**
+   * @return uint64_t the sum of the slots.
+   */
+  uint64_t sum() const;
+
+  /**
+   * Empties the slots.
+   * @return uint64_t the sum the slots held.
+   */
+  uint64_t latch();
+
+  /**
+   * @return whether counters with the tag-extracted name are incremented by every worker for every
+   *         request or every read and write, and so are sharded.
+   */
+  static bool isHotCounter(absl::string_view tag_extracted_name);
+
+  static const uint32_t NumShards = 8;
+  static const size_t CacheLineSize = 64;
+
+private:
+  struct Shard {
+    std::atomic<uint64_t> value_{0};
+    char padding_[CacheLineSize - sizeof(std::atomic<uint64_t>)];
+  };
+  static_assert(sizeof(Shard) == CacheLineSize, "a shard must fill a cache line");
+
+  // Threads are given slots in the order they first increment a sharded counter, so that as long
+  // as there are no more workers than slots, no two workers share one.
+  static uint32_t shardIndex() {
+    static thread_local const uint32_t index = next_shard_index_++ % NumShards;
+    return index;
+  }
+
+  static std::atomic<uint32_t> next_shard_index_;
+
+  // C++14 does not honor the alignment of over-aligned types in new, so the shards are aligned to
+  // a cache line within storage_ by hand.
+  std::unique_ptr<uint8_t[]> storage_;
+  Shard* shards_;
+};
+
+} // namespace Stats
+} // namespace Envoy
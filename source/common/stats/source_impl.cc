@@ -24,10 +24,38 @@ std::vector<ParentHistogramSharedPtr>& SourceImpl::cachedHistograms() {
   return *histograms_;
 }
 
+std::vector<CounterSharedPtr>& SourceImpl::cachedChangedCounters() {
+  if (!changed_counters_) {
+    changed_counters_.emplace();
+    for (const CounterSharedPtr& counter : cachedCounters()) {
+      // The changed state is cleared even in a full flush, so that the next flush only sees the
+      // changes made after this one.
+      if (counter->latchChanged() || (full_flush_ && counter->used())) {
+        changed_counters_->push_back(counter);
+      }
+    }
+  }
+  return *changed_counters_;
+}
+
+std::vector<GaugeSharedPtr>& SourceImpl::cachedChangedGauges() {
+  if (!changed_gauges_) {
+    changed_gauges_.emplace();
+    for (const GaugeSharedPtr& gauge : cachedGauges()) {
+      if (gauge->latchChanged() || (full_flush_ && gauge->used())) {
+        changed_gauges_->push_back(gauge);
+      }
+    }
+  }
+  return *changed_gauges_;
+}
+
 void SourceImpl::clearCache() {
   counters_.reset();
   gauges_.reset();
   histograms_.reset();
+  changed_counters_.reset();
+  changed_gauges_.reset();
 }
 
 } // namespace Stats
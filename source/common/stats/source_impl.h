@@ -17,13 +17,19 @@ public:
   std::vector<CounterSharedPtr>& cachedCounters() override;
   std::vector<GaugeSharedPtr>& cachedGauges() override;
   std::vector<ParentHistogramSharedPtr>& cachedHistograms() override;
+  std::vector<CounterSharedPtr>& cachedChangedCounters() override;
+  std::vector<GaugeSharedPtr>& cachedChangedGauges() override;
+  void setFullFlush(bool full_flush) override { full_flush_ = full_flush; }
   void clearCache() override;
 
 private:
   Store& store_;
+  bool full_flush_{true};
   absl::optional<std::vector<CounterSharedPtr>> counters_;
   absl::optional<std::vector<GaugeSharedPtr>> gauges_;
   absl::optional<std::vector<ParentHistogramSharedPtr>> histograms_;
+  absl::optional<std::vector<CounterSharedPtr>> changed_counters_;
+  absl::optional<std::vector<GaugeSharedPtr>> changed_gauges_;
 };
 
 } // namespace Stats
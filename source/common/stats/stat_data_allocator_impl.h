@@ -1,13 +1,20 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "envoy/stats/stat_data_allocator.h"
 #include "envoy/stats/stats.h"
 
 #include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
 #include "common/stats/metric_impl.h"
+#include "common/stats/sharded_counter.h"
+#include "common/stats/symbol_table_impl.h"
 
 #include "absl/strings/string_view.h"
 
@@ -18,15 +25,9 @@ namespace Stats {
 // We templatize on StatData rather than defining a virtual base StatData class
 // for performance reasons; stat increment is on the hot path.
 //
-// The two production derivations cover using a fixed block of shared-memory for
-// hot restart stat continuity, and heap allocation for more efficient RAM usage
-// for when hot-restart is not required.
-//
-// Also note that RawStatData needs to live in a shared memory block, and it's
-// possible, but not obvious, that a vptr would be usable across processes. In
-// any case, RawStatData is allocated from a shared-memory block rather than via
-// new, so the usual C++ compiler assistance for setting up vptrs will not be
-// available. This could be resolved with placed new, or another nesting level.
+// The production derivation allocates the stats from the heap. Stats are carried
+// across hot restarts by the hot restart RPC channel rather than by sharing
+// their memory, see Stats::StatMerger.
 template <class StatData> class StatDataAllocatorImpl : public StatDataAllocator {
 public:
   // StatDataAllocator
@@ -34,6 +35,7 @@ public:
                                std::vector<Tag>&& tags) override;
   GaugeSharedPtr makeGauge(absl::string_view name, std::string&& tag_extracted_name,
                            std::vector<Tag>&& tags) override;
+  SymbolTable& symbolTable() override { return symbol_table_; }
 
   /**
    * @param name the full name of the stat.
@@ -45,11 +47,29 @@ public:
   virtual StatData* alloc(absl::string_view name) PURE;
 
   /**
-   * Free a raw stat data block. The allocator should handle reference counting and only truly
+   * Free a stat data block. The allocator should handle reference counting and only truly
    * free the block if it is no longer needed.
    * @param data the data returned by alloc().
    */
   virtual void free(StatData& data) PURE;
+
+  /**
+   * @param data the data of a sharded counter.
+   * @return the shards of the increments of the counters of data. All the counters of the same
+   *         data share them, so that they all report the same value.
+   */
+  std::shared_ptr<CounterShards> counterShards(const StatData& data);
+
+private:
+  // Holds the tag-extracted names and tags of the stats. It is declared in the base class so that
+  // it outlives the stats of any derived allocator.
+  SymbolTable symbol_table_;
+
+  Thread::MutexBasicLockable shards_mutex_;
+  // The shards of the sharded counters, by their data. An entry is removed once the last counter
+  // of its data is destroyed.
+  std::unordered_map<const StatData*, std::weak_ptr<CounterShards>>
+      counter_shards_ GUARDED_BY(shards_mutex_);
 };
 
 /**
@@ -63,8 +83,11 @@ template <class StatData> class CounterImpl : public Counter, public MetricImpl
 public:
   CounterImpl(StatData& data, StatDataAllocatorImpl<StatData>& alloc,
               std::string&& tag_extracted_name, std::vector<Tag>&& tags)
-      : MetricImpl(std::move(tag_extracted_name), std::move(tags)), data_(data), alloc_(alloc) {}
-  ~CounterImpl() { alloc_.free(data_); }
+      : MetricImpl(tag_extracted_name, tags, alloc.symbolTable()), data_(data), alloc_(alloc) {}
+  ~CounterImpl() {
+    alloc_.free(data_);
+    MetricImpl::clear();
+  }
 
   // Stats::Metric
   std::string name() const override { return std::string(data_.name()); }
@@ -74,7 +97,7 @@ public:
   void add(uint64_t amount) override {
     data_.value_ += amount;
     data_.pending_increment_ += amount;
-    data_.flags_ |= Flags::Used;
+    data_.flags_ |= Flags::Used | Flags::Changed;
   }
 
   void inc() override { add(1); }
@@ -82,12 +105,68 @@ public:
   void reset() override { data_.value_ = 0; }
   bool used() const override { return data_.flags_ & Flags::Used; }
   uint64_t value() const override { return data_.value_; }
+  bool latchChanged() override {
+    return data_.flags_.fetch_and(static_cast<uint16_t>(~Flags::Changed)) & Flags::Changed;
+  }
+
+protected:
+  // MetricImpl
+  SymbolTable& symbolTable() const override { return alloc_.symbolTable(); }
 
-private:
   StatData& data_;
+
+private:
   StatDataAllocatorImpl<StatData>& alloc_;
 };
 
+/**
+ * Counter implementation for counters that every worker adds to on the hot path (see
+ * CounterShards::isHotCounter()). Increments go to a slot of the calling thread, and are folded
+ * into the StatData when the counter is latched or destroyed. The shards are shared by all the
+ * counters of the same StatData, e.g. those of a scope and of the scope replacing it, so that
+ * they all report the same value.
+ */
+template <class StatData> class ShardedCounterImpl : public CounterImpl<StatData> {
+public:
+  ShardedCounterImpl(StatData& data, StatDataAllocatorImpl<StatData>& alloc,
+                     std::string&& tag_extracted_name, std::vector<Tag>&& tags)
+      : CounterImpl<StatData>(data, alloc, std::move(tag_extracted_name), std::move(tags)),
+        shards_(alloc.counterShards(data)) {}
+  ~ShardedCounterImpl() { fold(); }
+
+  // Stats::Counter
+  void add(uint64_t amount) override {
+    shards_->add(amount);
+    // Only write the flags when they need to change, so that workers don't contend on them either.
+    if ((this->data_.flags_.load(std::memory_order_relaxed) & UsedChanged) != UsedChanged) {
+      this->data_.flags_ |= UsedChanged;
+    }
+  }
+  void inc() override { add(1); }
+  uint64_t latch() override {
+    fold();
+    return this->data_.pending_increment_.exchange(0);
+  }
+  void reset() override {
+    shards_->latch();
+    this->data_.value_ = 0;
+  }
+  uint64_t value() const override { return this->data_.value_ + shards_->sum(); }
+
+private:
+  static const uint16_t UsedChanged = MetricImpl::Flags::Used | MetricImpl::Flags::Changed;
+
+  void fold() {
+    const uint64_t amount = shards_->latch();
+    if (amount > 0) {
+      this->data_.value_ += amount;
+      this->data_.pending_increment_ += amount;
+    }
+  }
+
+  const std::shared_ptr<CounterShards> shards_;
+};
+
 /**
  * Null counter implementation.
  * No-ops on all calls and requires no underlying metric or data.
@@ -98,14 +177,15 @@ public:
   ~NullCounterImpl() {}
   std::string name() const override { return ""; }
   const char* nameCStr() const override { return ""; }
-  const std::string& tagExtractedName() const override { CONSTRUCT_ON_FIRST_USE(std::string, ""); }
-  const std::vector<Tag>& tags() const override { CONSTRUCT_ON_FIRST_USE(std::vector<Tag>, {}); }
+  std::string tagExtractedName() const override { return ""; }
+  std::vector<Tag> tags() const override { return {}; }
   void add(uint64_t) override {}
   void inc() override {}
   uint64_t latch() override { return 0; }
   void reset() override {}
   bool used() const override { return false; }
   uint64_t value() const override { return 0; }
+  bool latchChanged() override { return false; }
 };
 
 /**
@@ -115,8 +195,11 @@ template <class StatData> class GaugeImpl : public Gauge, public MetricImpl {
 public:
   GaugeImpl(StatData& data, StatDataAllocatorImpl<StatData>& alloc,
             std::string&& tag_extracted_name, std::vector<Tag>&& tags)
-      : MetricImpl(std::move(tag_extracted_name), std::move(tags)), data_(data), alloc_(alloc) {}
-  ~GaugeImpl() { alloc_.free(data_); }
+      : MetricImpl(tag_extracted_name, tags, alloc.symbolTable()), data_(data), alloc_(alloc) {}
+  ~GaugeImpl() {
+    alloc_.free(data_);
+    MetricImpl::clear();
+  }
 
   // Stats::Metric
   std::string name() const override { return std::string(data_.name()); }
@@ -125,21 +208,34 @@ public:
   // Stats::Gauge
   virtual void add(uint64_t amount) override {
     data_.value_ += amount;
-    data_.flags_ |= Flags::Used;
+    data_.flags_ |= Flags::Used | Flags::Changed;
   }
   virtual void dec() override { sub(1); }
   virtual void inc() override { add(1); }
   virtual void set(uint64_t value) override {
-    data_.value_ = value;
-    data_.flags_ |= Flags::Used;
+    // Gauges are often set periodically to the same value, which is not a change.
+    if (data_.value_.exchange(value) != value) {
+      data_.flags_ |= Flags::Used | Flags::Changed | Flags::Set;
+    } else {
+      data_.flags_ |= Flags::Used | Flags::Set;
+    }
   }
   virtual void sub(uint64_t amount) override {
     ASSERT(data_.value_ >= amount);
     ASSERT(used());
     data_.value_ -= amount;
+    data_.flags_ |= Flags::Changed;
   }
   virtual uint64_t value() const override { return data_.value_; }
+  bool wasSet() const override { return data_.flags_ & Flags::Set; }
   bool used() const override { return data_.flags_ & Flags::Used; }
+  bool latchChanged() override {
+    return data_.flags_.fetch_and(static_cast<uint16_t>(~Flags::Changed)) & Flags::Changed;
+  }
+
+protected:
+  // MetricImpl
+  SymbolTable& symbolTable() const override { return alloc_.symbolTable(); }
 
 private:
   StatData& data_;
@@ -156,8 +252,8 @@ public:
   ~NullGaugeImpl() {}
   std::string name() const override { return ""; }
   const char* nameCStr() const override { return ""; }
-  const std::string& tagExtractedName() const override { CONSTRUCT_ON_FIRST_USE(std::string, ""); }
-  const std::vector<Tag>& tags() const override { CONSTRUCT_ON_FIRST_USE(std::vector<Tag>, {}); }
+  std::string tagExtractedName() const override { return ""; }
+  std::vector<Tag> tags() const override { return {}; }
   void add(uint64_t) override {}
   void inc() override {}
   void dec() override {}
@@ -165,6 +261,8 @@ public:
   void sub(uint64_t) override {}
   bool used() const override { return false; }
   uint64_t value() const override { return 0; }
+  bool wasSet() const override { return false; }
+  bool latchChanged() override { return false; }
 };
 
 template <class StatData>
@@ -175,10 +273,36 @@ CounterSharedPtr StatDataAllocatorImpl<StatData>::makeCounter(absl::string_view
   if (data == nullptr) {
     return nullptr;
   }
+  if (CounterShards::isHotCounter(tag_extracted_name)) {
+    return std::make_shared<ShardedCounterImpl<StatData>>(*data, *this,
+                                                          std::move(tag_extracted_name),
+                                                          std::move(tags));
+  }
   return std::make_shared<CounterImpl<StatData>>(*data, *this, std::move(tag_extracted_name),
                                                  std::move(tags));
 }
 
+template <class StatData>
+std::shared_ptr<CounterShards>
+StatDataAllocatorImpl<StatData>::counterShards(const StatData& data) {
+  Thread::LockGuard lock(shards_mutex_);
+  std::weak_ptr<CounterShards>& weak_shards = counter_shards_[&data];
+  std::shared_ptr<CounterShards> shards = weak_shards.lock();
+  if (shards == nullptr) {
+    shards.reset(new CounterShards(), [this, &data](CounterShards* expired_shards) {
+      delete expired_shards;
+      Thread::LockGuard lock(shards_mutex_);
+      // The entry may already hold the shards of a counter made since these expired.
+      const auto it = counter_shards_.find(&data);
+      if (it != counter_shards_.end() && it->second.expired()) {
+        counter_shards_.erase(it);
+      }
+    });
+    weak_shards = shards;
+  }
+  return shards;
+}
+
 template <class StatData>
 GaugeSharedPtr StatDataAllocatorImpl<StatData>::makeGauge(absl::string_view name,
                                                           std::string&& tag_extracted_name,
@@ -0,0 +1,51 @@
+#include "common/stats/stat_merger.h"
+
+#include <algorithm>
+
+namespace Envoy {
+namespace Stats {
+
+void StatMerger::mergeCounter(const std::string& name, uint64_t delta) {
+  if (delta > 0) {
+    target_store_.counter(name).add(delta);
+  }
+}
+
+void StatMerger::mergeGauge(const std::string& name, uint64_t value) {
+  Gauge& gauge = target_store_.gauge(name);
+  if (gauge.wasSet()) {
+    // The child's set() replaced whatever the parent had added, so there is nothing to take back
+    // out once the parent is gone.
+    parent_gauge_values_.erase(name);
+    return;
+  }
+
+  uint64_t& parent_value = parent_gauge_values_[name];
+  if (value > parent_value) {
+    gauge.add(value - parent_value);
+  } else if (value < parent_value) {
+    subtract(gauge, parent_value - value);
+  }
+  parent_value = value;
+}
+
+void StatMerger::removeParentGauges() {
+  for (const auto& parent_gauge : parent_gauge_values_) {
+    Gauge& gauge = target_store_.gauge(parent_gauge.first);
+    if (!gauge.wasSet()) {
+      subtract(gauge, parent_gauge.second);
+    }
+  }
+  parent_gauge_values_.clear();
+}
+
+void StatMerger::subtract(Gauge& gauge, uint64_t amount) {
+  // Clamped so that the gauge never wraps around, should the values of the processes not add up.
+  amount = std::min(amount, gauge.value());
+  if (amount > 0) {
+    gauge.sub(amount);
+  }
+}
+
+} // namespace Stats
+} // namespace Envoy
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "envoy/stats/store.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * Merges the counters and gauges of a hot restart parent into the store of the child process, so
+ * that stats survive a hot restart without the processes sharing their stat memory.
+ */
+class StatMerger {
+public:
+  StatMerger(Store& target_store) : target_store_(target_store) {}
+
+  /**
+   * Adds the increments the parent made to a counter since it last sent it.
+   * @param name supplies the name of the counter.
+   * @param delta supplies the latched increments of the parent's counter.
+   */
+  void mergeCounter(const std::string& name, uint64_t delta);
+
+  /**
+   * Moves the child's gauge by how much the parent's gauge moved since the parent last sent it,
+   * so that the child's gauge holds the sum of both processes. The parent only sends the gauges it
+   * never set(), and gauges that the child set() keep the child's value.
+   * @param name supplies the name of the gauge.
+   * @param value supplies the current value of the parent's gauge.
+   */
+  void mergeGauge(const std::string& name, uint64_t value);
+
+  /**
+   * Takes the parent's contribution back out of the child's gauges, once the parent is gone.
+   */
+  void removeParentGauges();
+
+private:
+  static void subtract(Gauge& gauge, uint64_t amount);
+
+  Store& target_store_;
+  // The last value of each merged gauge of the parent, to merge only how much it moved since.
+  std::unordered_map<std::string, uint64_t> parent_gauge_values_;
+};
+
+} // namespace Stats
+} // namespace Envoy
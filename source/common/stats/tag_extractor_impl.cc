@@ -2,6 +2,7 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <string>
 
 #include "envoy/common/exception.h"
@@ -17,8 +18,11 @@ namespace Stats {
 
 namespace {
 
+// Matches a dot, or an optional dot-led segment followed by a dot. The latter is how the default
+// tag extractors require a dot after their prefix without consuming it, as RE2 has no lookahead.
 bool regexStartsWithDot(absl::string_view regex) {
-  return absl::StartsWith(regex, "\\.") || absl::StartsWith(regex, "(?=\\.)");
+  return absl::StartsWith(regex, "\\.") || absl::StartsWith(regex, "(?:\\..*?)??\\.") ||
+         absl::StartsWith(regex, "(?:\\..*)?\\.");
 }
 
 } // namespace
@@ -26,7 +30,7 @@ bool regexStartsWithDot(absl::string_view regex) {
 TagExtractorImpl::TagExtractorImpl(const std::string& name, const std::string& regex,
                                    const std::string& substr)
     : name_(name), prefix_(std::string(extractRegexPrefix(regex))), substr_(substr),
-      regex_(RegexUtil::parseRegex(regex)) {}
+      regex_(regex, Regex::Utility::DefaultMaxProgramSize) {}
 
 std::string TagExtractorImpl::extractRegexPrefix(absl::string_view regex) {
   std::string prefix;
@@ -75,27 +79,32 @@ bool TagExtractorImpl::extractTag(const std::string& stat_name, std::vector<Tag>
     return false;
   }
 
-  std::smatch match;
   // The regex must match and contain one or more subexpressions (all after the first are ignored).
-  if (std::regex_search(stat_name, match, regex_) && match.size() > 1) {
+  const re2::RE2& regex = regex_.regex();
+  const int num_submatches = std::min(regex.NumberOfCapturingGroups(), 2) + 1;
+  re2::StringPiece match[3];
+  if (num_submatches > 1 && regex.Match(stat_name, 0, stat_name.size(), re2::RE2::UNANCHORED,
+                                        match, num_submatches)) {
     // remove_subexpr is the first submatch. It represents the portion of the string to be removed.
-    const auto& remove_subexpr = match[1];
+    const re2::StringPiece& remove_subexpr = match[1];
 
     // value_subexpr is the optional second submatch. It is usually inside the first submatch
     // (remove_subexpr) to allow the expression to strip off extra characters that should be removed
     // from the string but also not necessary in the tag value ("." for example). If there is no
     // second submatch, then the value_subexpr is the same as the remove_subexpr.
-    const auto& value_subexpr = match.size() > 2 ? match[2] : remove_subexpr;
+    const re2::StringPiece& value_subexpr = num_submatches > 2 ? match[2] : remove_subexpr;
 
     tags.emplace_back();
     Tag& tag = tags.back();
     tag.name_ = name_;
-    tag.value_ = value_subexpr.str();
+    tag.value_ = std::string(value_subexpr.data(), value_subexpr.size());
 
-    // Determines which characters to remove from stat_name to elide remove_subexpr.
-    std::string::size_type start = remove_subexpr.first - stat_name.begin();
-    std::string::size_type end = remove_subexpr.second - stat_name.begin();
-    remove_characters.insert(start, end);
+    // Determines which characters to remove from stat_name to elide remove_subexpr. A group that
+    // did not participate in the match has no position and removes nothing.
+    if (remove_subexpr.data() != nullptr) {
+      const std::string::size_type start = remove_subexpr.data() - stat_name.data();
+      remove_characters.insert(start, start + remove_subexpr.size());
+    }
     PERF_RECORD(perf, "re-match", name_);
     return true;
   }
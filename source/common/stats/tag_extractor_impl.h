@@ -1,11 +1,12 @@
 #pragma once
 
 #include <cstdint>
-#include <regex>
 #include <string>
 
 #include "envoy/stats/tag_extractor.h"
 
+#include "common/common/regex.h"
+
 #include "absl/strings/string_view.h"
 
 namespace Envoy {
@@ -50,7 +51,7 @@ private:
   const std::string name_;
   const std::string prefix_;
   const std::string substr_;
-  const std::regex regex_;
+  const Regex::CompiledGoogleReMatcher regex_;
 };
 
 } // namespace Stats
@@ -32,50 +32,83 @@ TagProducerImpl::TagProducerImpl(const envoy::config::metrics::v2::StatsConfig&
               "No regex specified for tag specifier and no default regex for name: '{}'", name));
         }
       } else {
-        addExtractor(Stats::TagExtractorImpl::createTagExtractor(name, tag_specifier.regex()));
+        addExtractor(name, tag_specifier.regex());
       }
     } else if (tag_specifier.tag_value_case() ==
                envoy::config::metrics::v2::TagSpecifier::kFixedValue) {
       default_tags_.emplace_back(Stats::Tag{name, tag_specifier.fixed_value()});
     }
   }
+  compileExtractorGroups();
 }
 
 int TagProducerImpl::addExtractorsMatching(absl::string_view name) {
   int num_found = 0;
   for (const auto& desc : Config::TagNames::get().descriptorVec()) {
     if (desc.name_ == name) {
-      addExtractor(
-          Stats::TagExtractorImpl::createTagExtractor(desc.name_, desc.regex_, desc.substr_));
+      addExtractor(desc.name_, desc.regex_, desc.substr_);
       ++num_found;
     }
   }
   return num_found;
 }
 
-void TagProducerImpl::addExtractor(TagExtractorPtr extractor) {
+void TagProducerImpl::addExtractor(const std::string& name, const std::string& regex,
+                                   const std::string& substr) {
+  TagExtractorPtr extractor = Stats::TagExtractorImpl::createTagExtractor(name, regex, substr);
   const absl::string_view prefix = extractor->prefixToken();
-  if (prefix.empty()) {
-    tag_extractors_without_prefix_.emplace_back(std::move(extractor));
-  } else {
-    tag_extractor_prefix_map_[prefix].emplace_back(std::move(extractor));
+  ExtractorGroup& group =
+      prefix.empty() ? tag_extractors_without_prefix_ : tag_extractor_prefix_map_[prefix];
+  group.extractors_.emplace_back(std::move(extractor));
+  group.regexes_.push_back(regex);
+}
+
+void TagProducerImpl::compileExtractorGroups() {
+  tag_extractors_without_prefix_.compile();
+  for (auto& prefix_and_group : tag_extractor_prefix_map_) {
+    prefix_and_group.second.compile();
   }
 }
 
-void TagProducerImpl::forEachExtractorMatching(
-    const std::string& stat_name, std::function<void(const TagExtractorPtr&)> f) const {
-  IntervalSetImpl<size_t> remove_characters;
-  for (const TagExtractorPtr& tag_extractor : tag_extractors_without_prefix_) {
+void TagProducerImpl::ExtractorGroup::compile() {
+  if (extractors_.size() > 1) {
+    try {
+      regex_set_ = std::make_unique<const Regex::CompiledGoogleReSet>(regexes_,
+                                                                       re2::RE2::UNANCHORED);
+    } catch (const EnvoyException&) {
+      // The regexes are valid on their own, so the set only fails to compile when it is too
+      // large. The extractors then all run their regex.
+    }
+  }
+  regexes_.clear();
+  regexes_.shrink_to_fit();
+}
+
+void TagProducerImpl::ExtractorGroup::forEachMatching(
+    const std::string& stat_name, const std::function<void(const TagExtractorPtr&)>& f) const {
+  if (regex_set_ != nullptr) {
+    std::vector<int> matches;
+    if (regex_set_->match(stat_name, matches)) {
+      for (const int index : matches) {
+        f(extractors_[index]);
+      }
+      return;
+    }
+  }
+  for (const TagExtractorPtr& tag_extractor : extractors_) {
     f(tag_extractor);
   }
+}
+
+void TagProducerImpl::forEachExtractorMatching(
+    const std::string& stat_name, std::function<void(const TagExtractorPtr&)> f) const {
+  tag_extractors_without_prefix_.forEachMatching(stat_name, f);
   const std::string::size_type dot = stat_name.find('.');
   if (dot != std::string::npos) {
     const absl::string_view token = absl::string_view(stat_name.data(), dot);
     const auto iter = tag_extractor_prefix_map_.find(token);
     if (iter != tag_extractor_prefix_map_.end()) {
-      for (const TagExtractorPtr& tag_extractor : iter->second) {
-        f(tag_extractor);
-      }
+      iter->second.forEachMatching(stat_name, f);
     }
   }
 }
@@ -101,8 +134,7 @@ TagProducerImpl::addDefaultExtractors(const envoy::config::metrics::v2::StatsCon
   if (!config.has_use_all_default_tags() || config.use_all_default_tags().value()) {
     for (const auto& desc : Config::TagNames::get().descriptorVec()) {
       names.emplace(desc.name_);
-      addExtractor(
-          Stats::TagExtractorImpl::createTagExtractor(desc.name_, desc.regex_, desc.substr_));
+      addExtractor(desc.name_, desc.regex_, desc.substr_);
     }
   }
   return names;
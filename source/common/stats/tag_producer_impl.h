@@ -13,6 +13,7 @@
 #include "envoy/stats/tag_producer.h"
 
 #include "common/common/hash.h"
+#include "common/common/regex.h"
 #include "common/common/utility.h"
 #include "common/config/well_known_names.h"
 #include "common/protobuf/protobuf.h"
@@ -42,12 +43,46 @@ public:
 private:
   friend class DefaultTagRegexTester;
 
+  /**
+   * Extractors that are tried on the same stat names, either because their regexes start with the
+   * same prefix or because they have no prefix. The regexes of a group of several extractors are
+   * also compiled into a set, which finds the extractors whose regex matches a stat name in a
+   * single pass over the name, so that only those extractors run their own regex.
+   */
+  struct ExtractorGroup {
+    /**
+     * Compiles the regex set of the group, once all its extractors are added.
+     */
+    void compile();
+
+    /**
+     * Calls f for each extractor of the group whose regex may match stat_name, in the order the
+     * extractors were added.
+     */
+    void forEachMatching(const std::string& stat_name,
+                         const std::function<void(const TagExtractorPtr&)>& f) const;
+
+    std::vector<TagExtractorPtr> extractors_;
+    std::vector<std::string> regexes_;
+    // Null if the group has a single extractor, or if the set could not be compiled.
+    Regex::CompiledGoogleReSetPtr regex_set_;
+  };
+
   /**
    * Adds a TagExtractor to the collection of tags, tracking prefixes to help make
    * produceTags run efficiently by trying only extractors that have a chance to match.
-   * @param extractor TagExtractorPtr the extractor to add.
+   * @param name std::string the tag name.
+   * @param regex std::string the regex of the extractor.
+   * @param substr std::string a substring that must be present in stat names for the regex to
+   *        be tried, or "".
+   */
+  void addExtractor(const std::string& name, const std::string& regex,
+                    const std::string& substr = "");
+
+  /**
+   * Compiles the regex sets of the extractor groups.
    */
-  void addExtractor(TagExtractorPtr extractor);
+  void compileExtractorGroups();
 
   /**
    * Adds all default extractors matching the specified tag name. In this model,
@@ -83,7 +118,8 @@ private:
    *   1. Finding the first '.' separated token in stat_name.
    *   2. Collecting the TagExtractors whose regexes have that same prefix "^prefix\\."
    *   3. Collecting also the TagExtractors whose regexes don't start with any prefix.
-   * In the future, we may also do substring searches in some cases.
+   *   4. Dropping the TagExtractors whose regexes the regex set of their group finds not to
+   *      match stat_name.
    * See DefaultTagRegexTester::produceTagsReverse in test/common/stats/stats_impl_test.cc.
    *
    * @param stat_name const std::string& the stat name.
@@ -92,13 +128,12 @@ private:
   void forEachExtractorMatching(const std::string& stat_name,
                                 std::function<void(const TagExtractorPtr&)> f) const;
 
-  std::vector<TagExtractorPtr> tag_extractors_without_prefix_;
+  ExtractorGroup tag_extractors_without_prefix_;
 
-  // Maps a prefix word extracted out of a regex to a vector of TagExtractors. Note that
+  // Maps a prefix word extracted out of a regex to a group of TagExtractors. Note that
   // the storage for the prefix string is owned by the TagExtractor, which, depending on
   // implementation, may need make a copy of the prefix.
-  std::unordered_map<absl::string_view, std::vector<TagExtractorPtr>, StringViewHash>
-      tag_extractor_prefix_map_;
+  std::unordered_map<absl::string_view, ExtractorGroup, StringViewHash> tag_extractor_prefix_map_;
   std::vector<Tag> default_tags_;
 };
 
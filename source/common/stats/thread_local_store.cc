@@ -1,5 +1,6 @@
 #include "common/stats/thread_local_store.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <list>
@@ -23,7 +24,9 @@ namespace Stats {
 
 ThreadLocalStoreImpl::ThreadLocalStoreImpl(const StatsOptions& stats_options,
                                            StatDataAllocator& alloc)
-    : stats_options_(stats_options), alloc_(alloc), default_scope_(createScope("")),
+    : stats_options_(stats_options), alloc_(alloc),
+      histogram_buckets_(HistogramStatisticsImpl::defaultSupportedBuckets()),
+      default_scope_(createScope("")),
       tag_producer_(std::make_unique<TagProducerImpl>()),
       stats_matcher_(std::make_unique<StatsMatcherImpl>()),
       num_last_resort_stats_(default_scope_->counter("stats.overflow")), source_(*this) {}
@@ -34,6 +37,17 @@ ThreadLocalStoreImpl::~ThreadLocalStoreImpl() {
   ASSERT(scopes_.empty());
 }
 
+void ThreadLocalStoreImpl::setHistogramBuckets(const std::vector<double>& buckets) {
+  if (buckets.empty()) {
+    histogram_buckets_ = HistogramStatisticsImpl::defaultSupportedBuckets();
+  } else {
+    histogram_buckets_ = buckets;
+    std::sort(histogram_buckets_.begin(), histogram_buckets_.end());
+    histogram_buckets_.erase(std::unique(histogram_buckets_.begin(), histogram_buckets_.end()),
+                             histogram_buckets_.end());
+  }
+}
+
 void ThreadLocalStoreImpl::setStatsMatcher(StatsMatcherPtr&& stats_matcher) {
   stats_matcher_ = std::move(stats_matcher);
 
@@ -116,7 +130,7 @@ std::vector<ParentHistogramSharedPtr> ThreadLocalStoreImpl::histograms() const {
   Thread::LockGuard lock(lock_);
   // TODO(ramaraochavali): As histograms don't share storage, there is a chance of duplicate names
   // here. We need to create global storage for histograms similar to how we have a central storage
-  // in shared memory for counters/gauges. In the interim, no de-dup is done here. This may result
+  // in the allocator for counters/gauges. In the interim, no de-dup is done here. This may result
   // in histograms with duplicate names, but until shared storage is implemented it's ultimately
   // less confusing for users who have such configs.
   for (ScopeImpl* scope : scopes_) {
@@ -392,7 +406,8 @@ Histogram& ThreadLocalStoreImpl::ScopeImpl::histogram(const std::string& name) {
     std::vector<Tag> tags;
     std::string tag_extracted_name = parent_.getTagsForName(final_name, tags);
     auto stat = std::make_shared<ParentHistogramImpl>(
-        final_name, parent_, *this, std::move(tag_extracted_name), std::move(tags));
+        final_name, parent_, *this, std::move(tag_extracted_name), std::move(tags),
+        parent_.alloc_.symbolTable(), parent_.histogram_buckets_);
     central_ref = &central_cache_.histograms_[stat->nameCStr()];
     *central_ref = stat;
   }
@@ -403,41 +418,37 @@ Histogram& ThreadLocalStoreImpl::ScopeImpl::histogram(const std::string& name) {
   return **central_ref;
 }
 
-Histogram& ThreadLocalStoreImpl::ScopeImpl::tlsHistogram(const std::string& name,
-                                                         ParentHistogramImpl& parent) {
-  if (parent_.rejects(name)) {
-    return null_histogram_;
-  }
-
-  // See comments in counter() which explains the logic here.
+Histogram& ThreadLocalStoreImpl::ScopeImpl::tlsHistogram(ParentHistogramImpl& parent) {
+  // See comments in counter() which explains the logic here. The TLS histogram is keyed by the
+  // name held by its parent, so that looking it up copies no string. A histogram found in the
+  // cache was already checked against the stats matcher when it was inserted.
 
   StatMap<TlsHistogramSharedPtr>* tls_cache = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
     tls_cache = &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].histograms_;
-    auto p = tls_cache->find(name.c_str());
+    auto p = tls_cache->find(parent.nameCStr());
     if (p != tls_cache->end()) {
       return *p->second;
     }
   }
 
-  std::vector<Tag> tags;
-  std::string tag_extracted_name = parent_.getTagsForName(name, tags);
-  TlsHistogramSharedPtr hist_tls_ptr = std::make_shared<ThreadLocalHistogramImpl>(
-      name, std::move(tag_extracted_name), std::move(tags));
+  if (parent_.rejects(parent.name())) {
+    return null_histogram_;
+  }
+
+  TlsHistogramSharedPtr hist_tls_ptr = std::make_shared<ThreadLocalHistogramImpl>(parent);
 
   parent.addTlsHistogram(hist_tls_ptr);
 
   if (tls_cache) {
-    tls_cache->insert(std::make_pair(hist_tls_ptr->nameCStr(), hist_tls_ptr));
+    tls_cache->insert(std::make_pair(parent.nameCStr(), hist_tls_ptr));
   }
   return *hist_tls_ptr;
 }
 
-ThreadLocalHistogramImpl::ThreadLocalHistogramImpl(const std::string& name,
-                                                   std::string&& tag_extracted_name,
-                                                   std::vector<Tag>&& tags)
-    : MetricImpl(std::move(tag_extracted_name), std::move(tags)), current_active_(0), flags_(0),
-      created_thread_id_(std::this_thread::get_id()), name_(name) {
+ThreadLocalHistogramImpl::ThreadLocalHistogramImpl(const ParentHistogramImpl& parent)
+    : current_active_(0), used_(false), created_thread_id_(std::this_thread::get_id()),
+      parent_(parent) {
   histograms_[0] = hist_alloc();
   histograms_[1] = hist_alloc();
 }
@@ -450,7 +461,7 @@ ThreadLocalHistogramImpl::~ThreadLocalHistogramImpl() {
 void ThreadLocalHistogramImpl::recordValue(uint64_t value) {
   ASSERT(std::this_thread::get_id() == created_thread_id_);
   hist_insert_intscale(histograms_[current_active_], value, 0, 1);
-  flags_ |= Flags::Used;
+  used_ = true;
 }
 
 void ThreadLocalHistogramImpl::merge(histogram_t* target) {
@@ -459,21 +470,35 @@ void ThreadLocalHistogramImpl::merge(histogram_t* target) {
   hist_clear(*other_histogram);
 }
 
+std::string ThreadLocalHistogramImpl::name() const { return parent_.name(); }
+
+const char* ThreadLocalHistogramImpl::nameCStr() const { return parent_.nameCStr(); }
+
+std::vector<Tag> ThreadLocalHistogramImpl::tags() const { return parent_.tags(); }
+
+std::string ThreadLocalHistogramImpl::tagExtractedName() const {
+  return parent_.tagExtractedName();
+}
+
 ParentHistogramImpl::ParentHistogramImpl(const std::string& name, Store& parent,
                                          TlsScope& tls_scope, std::string&& tag_extracted_name,
-                                         std::vector<Tag>&& tags)
-    : MetricImpl(std::move(tag_extracted_name), std::move(tags)), parent_(parent),
-      tls_scope_(tls_scope), interval_histogram_(hist_alloc()), cumulative_histogram_(hist_alloc()),
-      interval_statistics_(interval_histogram_), cumulative_statistics_(cumulative_histogram_),
-      merged_(false), name_(name) {}
+                                         std::vector<Tag>&& tags, SymbolTable& symbol_table,
+                                         const std::vector<double>& supported_buckets)
+    : MetricImpl(tag_extracted_name, tags, symbol_table), parent_(parent), tls_scope_(tls_scope),
+      symbol_table_(symbol_table), interval_histogram_(hist_alloc()),
+      cumulative_histogram_(hist_alloc()),
+      interval_statistics_(interval_histogram_, supported_buckets),
+      cumulative_statistics_(cumulative_histogram_, supported_buckets), merged_(false),
+      name_(name) {}
 
 ParentHistogramImpl::~ParentHistogramImpl() {
   hist_free(interval_histogram_);
   hist_free(cumulative_histogram_);
+  MetricImpl::clear();
 }
 
 void ParentHistogramImpl::recordValue(uint64_t value) {
-  Histogram& tls_histogram = tls_scope_.tlsHistogram(name(), *this);
+  Histogram& tls_histogram = tls_scope_.tlsHistogram(*this);
   tls_histogram.recordValue(value);
   parent_.deliverHistogramToSinks(*this, value);
 }
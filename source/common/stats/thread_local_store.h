@@ -21,15 +21,17 @@
 namespace Envoy {
 namespace Stats {
 
+class ParentHistogramImpl;
+
 /**
  * A histogram that is stored in TLS and used to record values per thread. This holds two
  * histograms, one to collect the values and other as backup that is used for merge process. The
- * swap happens during the merge process.
+ * swap happens during the merge process. The name and tags are those of the parent histogram, so
+ * that they are not copied for every worker.
  */
-class ThreadLocalHistogramImpl : public Histogram, public MetricImpl {
+class ThreadLocalHistogramImpl : public Histogram {
 public:
-  ThreadLocalHistogramImpl(const std::string& name, std::string&& tag_extracted_name,
-                           std::vector<Tag>&& tags);
+  ThreadLocalHistogramImpl(const ParentHistogramImpl& parent);
   ~ThreadLocalHistogramImpl();
 
   void merge(histogram_t* target);
@@ -46,19 +48,22 @@ public:
 
   // Stats::Histogram
   void recordValue(uint64_t value) override;
-  bool used() const override { return flags_ & Flags::Used; }
+  bool used() const override { return used_; }
 
   // Stats::Metric
-  std::string name() const override { return name_; }
-  const char* nameCStr() const override { return name_.c_str(); }
+  std::string name() const override;
+  const char* nameCStr() const override;
+  std::vector<Tag> tags() const override;
+  std::string tagExtractedName() const override;
 
 private:
   uint64_t otherHistogramIndex() const { return 1 - current_active_; }
   uint64_t current_active_;
   histogram_t* histograms_[2];
-  std::atomic<uint16_t> flags_;
+  std::atomic<bool> used_;
   std::thread::id created_thread_id_;
-  const std::string name_;
+  // The parent holds this histogram, and both are dropped with their scope.
+  const ParentHistogramImpl& parent_;
 };
 
 typedef std::shared_ptr<ThreadLocalHistogramImpl> TlsHistogramSharedPtr;
@@ -71,7 +76,8 @@ class TlsScope;
 class ParentHistogramImpl : public ParentHistogram, public MetricImpl {
 public:
   ParentHistogramImpl(const std::string& name, Store& parent, TlsScope& tlsScope,
-                      std::string&& tag_extracted_name, std::vector<Tag>&& tags);
+                      std::string&& tag_extracted_name, std::vector<Tag>&& tags,
+                      SymbolTable& symbol_table, const std::vector<double>& supported_buckets);
   ~ParentHistogramImpl();
 
   void addTlsHistogram(const TlsHistogramSharedPtr& hist_ptr);
@@ -96,11 +102,16 @@ public:
   std::string name() const override { return name_; }
   const char* nameCStr() const override { return name_.c_str(); }
 
+protected:
+  // MetricImpl
+  SymbolTable& symbolTable() const override { return symbol_table_; }
+
 private:
   bool usedLockHeld() const EXCLUSIVE_LOCKS_REQUIRED(merge_lock_);
 
   Store& parent_;
   TlsScope& tls_scope_;
+  SymbolTable& symbol_table_;
   histogram_t* interval_histogram_;
   histogram_t* cumulative_histogram_;
   HistogramStatisticsImpl interval_statistics_;
@@ -123,9 +134,9 @@ public:
   // TODO(ramaraochavali): Allow direct TLS access for the advanced consumers.
   /**
    * @return a ThreadLocalHistogram within the scope's namespace.
-   * @param name name of the histogram with scope prefix attached.
+   * @param parent the parent histogram, which holds the name with scope prefix attached.
    */
-  virtual Histogram& tlsHistogram(const std::string& name, ParentHistogramImpl& parent) PURE;
+  virtual Histogram& tlsHistogram(ParentHistogramImpl& parent) PURE;
 };
 
 /**
@@ -159,6 +170,7 @@ public:
     tag_producer_ = std::move(tag_producer);
   }
   void setStatsMatcher(StatsMatcherPtr&& stats_matcher) override;
+  void setHistogramBuckets(const std::vector<double>& buckets) override;
   void initializeThreading(Event::Dispatcher& main_thread_dispatcher,
                            ThreadLocal::Instance& tls) override;
   void shutdownThreading() override;
@@ -199,7 +211,7 @@ private:
     void deliverHistogramToSinks(const Histogram& histogram, uint64_t value) override;
     Gauge& gauge(const std::string& name) override;
     Histogram& histogram(const std::string& name) override;
-    Histogram& tlsHistogram(const std::string& name, ParentHistogramImpl& parent) override;
+    Histogram& tlsHistogram(ParentHistogramImpl& parent) override;
     const Stats::StatsOptions& statsOptions() const override { return parent_.statsOptions(); }
 
     template <class StatType>
@@ -258,6 +270,8 @@ private:
 
   const Stats::StatsOptions& stats_options_;
   StatDataAllocator& alloc_;
+  // The upper bounds of the buckets of the statistics of histograms, which the statistics refer to.
+  std::vector<double> histogram_buckets_;
   Event::Dispatcher* main_thread_dispatcher_{};
   ThreadLocal::SlotPtr tls_;
   mutable Thread::MutexBasicLockable lock_;
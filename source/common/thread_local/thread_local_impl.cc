@@ -110,6 +110,16 @@ void InstanceImpl::runOnAllThreads(Event::PostCb cb, Event::PostCb all_threads_c
   }
 }
 
+void InstanceImpl::SlotImpl::runOnAllThreads(ObjectCb cb) {
+  // Only the index is captured. The removal of the slot is posted to each thread after this
+  // callback, so the object at the index is still the one of this slot when the callback runs.
+  parent_.runOnAllThreads([index = index_, cb]() -> void {
+    if (index < thread_local_data_.data_.size() && thread_local_data_.data_[index] != nullptr) {
+      cb(*thread_local_data_.data_[index]);
+    }
+  });
+}
+
 void InstanceImpl::SlotImpl::set(InitializeCb cb) {
   ASSERT(std::this_thread::get_id() == parent_.main_thread_id_);
   ASSERT(!parent_.shutdown_);
@@ -38,6 +38,7 @@ private:
     void runOnAllThreads(Event::PostCb cb, Event::PostCb main_callback) override {
       parent_.runOnAllThreads(cb, main_callback);
     }
+    void runOnAllThreads(ObjectCb cb) override;
     void set(InitializeCb cb) override;
 
     InstanceImpl& parent_;
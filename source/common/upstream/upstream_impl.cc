@@ -18,6 +18,7 @@
 #include "envoy/stats/scope.h"
 #include "envoy/upstream/health_checker.h"
 
+#include "common/common/empty_string.h"
 #include "common/common/enum_to_int.h"
 #include "common/common/fmt.h"
 #include "common/common/utility.h"
@@ -608,6 +609,14 @@ HostsPerLocalityConstSharedPtr ClusterImplBase::createHostLists(const HostsPerLo
   return hosts.filter([&health](const Host& host) { return host.health() == health; });
 }
 
+const Http::CodeStats::ResponseCounters&
+ClusterInfoImpl::responseCounters(const Http::CodeStats& code_stats) const {
+  absl::call_once(response_counters_once_, [this, &code_stats] {
+    response_counters_ = code_stats.createResponseCounters(*stats_scope_, EMPTY_STRING);
+  });
+  return *response_counters_;
+}
+
 bool ClusterInfoImpl::maintenanceMode() const {
   return runtime_.snapshot().featureEnabled(maintenance_mode_runtime_key_, 0);
 }
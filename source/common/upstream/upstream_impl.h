@@ -42,6 +42,7 @@
 
 #include "server/init_manager_impl.h"
 
+#include "absl/base/call_once.h"
 #include "absl/synchronization/mutex.h"
 
 namespace Envoy {
@@ -450,6 +451,8 @@ public:
   }
   ClusterStats& stats() const override { return stats_; }
   Stats::Scope& statsScope() const override { return *stats_scope_; }
+  const Http::CodeStats::ResponseCounters&
+  responseCounters(const Http::CodeStats& code_stats) const override;
   ClusterLoadReportStats& loadReportStats() const override { return load_report_stats_; }
   const Network::Address::InstanceConstSharedPtr& sourceAddress() const override {
     return source_address_;
@@ -487,6 +490,8 @@ private:
   Network::TransportSocketFactoryPtr transport_socket_factory_;
   Stats::ScopePtr stats_scope_;
   mutable ClusterStats stats_;
+  mutable absl::once_flag response_counters_once_;
+  mutable Http::CodeStats::ResponseCountersPtr response_counters_;
   Stats::IsolatedStoreImpl load_report_stats_store_;
   mutable ClusterLoadReportStats load_report_stats_;
   const uint64_t features_;
@@ -0,0 +1,388 @@
+#include "extensions/filters/http/cache/cache_filter.h"
+
+#include <vector>
+
+#include "common/common/enum_to_int.h"
+#include "common/common/utility.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/headers.h"
+#include "common/http/utility.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/http/cache/cache_utility.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+namespace {
+
+// Default upper bound of the total cache size.
+const uint64_t DefaultMaxCacheSizeBytes = 64 * 1024 * 1024;
+
+// Default upper bound of the size of a single cached response.
+const uint64_t DefaultMaxEntrySizeBytes = 1024 * 1024;
+
+// Default number of cache shards.
+const uint32_t DefaultShards = 16;
+
+// Status codes that are cacheable by default (RFC 7231 section 6.1). Partial content is excluded as
+// range requests are not supported.
+bool isCacheableStatus(uint64_t status) {
+  switch (status) {
+  case 200:
+  case 203:
+  case 204:
+  case 300:
+  case 301:
+  case 404:
+  case 405:
+  case 410:
+  case 414:
+  case 501:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Headers of a 304 response that update the stored response (RFC 7234 section 4.3.4) and that are
+// sent in a 304 response generated from the cache (RFC 7232 section 4.1).
+const std::vector<Http::LowerCaseString>& validationHeaders() {
+  CONSTRUCT_ON_FIRST_USE(std::vector<Http::LowerCaseString>, Http::Headers::get().CacheControl,
+                         Http::Headers::get().Date, Http::Headers::get().Etag,
+                         Http::Headers::get().Expires, Http::Headers::get().LastModified,
+                         Http::Headers::get().Vary);
+}
+
+void copyHeader(const Http::HeaderMap& from, Http::HeaderMap& to,
+                const Http::LowerCaseString& key) {
+  const Http::HeaderEntry* entry = from.get(key);
+  if (entry != nullptr) {
+    to.remove(key);
+    to.addCopy(key, entry->value().c_str());
+  }
+}
+
+} // namespace
+
+CacheFilterConfig::CacheFilterConfig(
+    const envoy::config::filter::http::cache::v2alpha::Cache& config,
+    const std::string& stats_prefix, Stats::Scope& scope, TimeSource& time_source)
+    : stats_(generateStats(stats_prefix + "cache.", scope)),
+      cache_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_cache_size_bytes,
+                                             DefaultMaxCacheSizeBytes),
+             PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, shards, DefaultShards), stats_),
+      time_source_(time_source),
+      max_entry_size_bytes_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entry_size_bytes, DefaultMaxEntrySizeBytes)) {
+  for (const auto& header : config.allowed_vary_headers()) {
+    allowed_vary_headers_.insert(absl::AsciiStrToLower(header));
+  }
+}
+
+bool CacheFilterConfig::varyAllowed(const std::string& header) const {
+  if (header == Http::Headers::get().VaryValues.Wildcard) {
+    return false;
+  }
+  return allowed_vary_headers_.empty() ||
+         allowed_vary_headers_.find(header) != allowed_vary_headers_.end();
+}
+
+CachedBodyFragment::CachedBodyFragment(CachedResponseConstSharedPtr response)
+    : Buffer::BufferFragmentImpl(
+          response->body_.data(), response->body_.size(),
+          [](const void*, size_t, const Buffer::BufferFragmentImpl* fragment) { delete fragment; }),
+      response_(std::move(response)) {}
+
+CacheFilter::CacheFilter(const CacheFilterConfigSharedPtr& config) : config_(config) {}
+
+std::string CacheFilter::cacheKey(const Http::HeaderMap& request_headers) {
+  const Http::HeaderEntry* scheme = request_headers.ForwardedProto();
+  return absl::StrCat(scheme != nullptr ? scheme->value().c_str() : "", "://",
+                      request_headers.Host()->value().c_str(),
+                      request_headers.Path()->value().c_str());
+}
+
+Http::FilterHeadersStatus CacheFilter::decodeHeaders(Http::HeaderMap& headers, bool) {
+  const Http::HeaderEntry* method = headers.Method();
+  if (method == nullptr || headers.Path() == nullptr || headers.Host() == nullptr ||
+      headers.Authorization() != nullptr) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  head_request_ = method->value() == Http::Headers::get().MethodValues.Head.c_str();
+  if (!head_request_ && method->value() != Http::Headers::get().MethodValues.Get.c_str()) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  CacheControlDirectives request_directives;
+  if (headers.CacheControl() != nullptr) {
+    request_directives =
+        CacheUtility::parseCacheControl(headers.CacheControl()->value().getStringView());
+    if (request_directives.no_store_) {
+      return Http::FilterHeadersStatus::Continue;
+    }
+  }
+
+  request_headers_ = &headers;
+  key_ = cacheKey(headers);
+  state_ = State::Miss;
+
+  CachedResponseConstSharedPtr response = config_->cache().lookup(key_);
+  if (response == nullptr || !response->varyMatches(headers)) {
+    config_->stats().miss_.inc();
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  const std::chrono::seconds age = response->age(config_->timeSource().systemTime());
+  std::chrono::seconds lifetime = response->freshness_lifetime_;
+  if (request_directives.max_age_.has_value()) {
+    lifetime = std::min(lifetime, request_directives.max_age_.value());
+  }
+
+  const Http::HeaderEntry* if_none_match = headers.get(Http::Headers::get().IfNoneMatch);
+  const Http::HeaderEntry* etag = response->headers_->Etag();
+  if (!request_directives.no_cache_ && age < lifetime) {
+    const bool not_modified =
+        if_none_match != nullptr && etag != nullptr &&
+        CacheUtility::ifNoneMatch(if_none_match->value().getStringView(),
+                                  etag->value().getStringView());
+    serveFromCache(response, not_modified);
+    return Http::FilterHeadersStatus::StopIteration;
+  }
+
+  config_->stats().stale_.inc();
+  // Revalidate on behalf of the client if it is not already making a conditional request, in which
+  // case the origin's answer is passed through untouched.
+  if (etag != nullptr && if_none_match == nullptr && !head_request_) {
+    ENVOY_STREAM_LOG(debug, "cache: revalidating stale response for {}", *decoder_callbacks_, key_);
+    headers.addCopy(Http::Headers::get().IfNoneMatch, etag->value().c_str());
+    stale_response_ = std::move(response);
+    state_ = State::Validating;
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterHeadersStatus CacheFilter::encodeHeaders(Http::HeaderMap& headers, bool end_stream) {
+  if (state_ == State::Bypass || state_ == State::Served) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  const uint64_t status = Http::Utility::getResponseStatus(headers);
+  if (state_ == State::Validating && status == enumToInt(Http::Code::NotModified) && end_stream) {
+    serveValidated(headers);
+    return Http::FilterHeadersStatus::Continue;
+  }
+  stale_response_.reset();
+  state_ = State::Miss;
+
+  // Only complete responses to GET requests are stored; HEAD responses carry no body.
+  if (head_request_ || !startInsert(headers, config_->timeSource().systemTime())) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  if (end_stream) {
+    finishInsert();
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterDataStatus CacheFilter::encodeData(Buffer::Instance& data, bool end_stream) {
+  if (state_ != State::Inserting) {
+    return Http::FilterDataStatus::Continue;
+  }
+
+  if (pending_response_->body_.size() + data.length() > config_->maxEntrySizeBytes()) {
+    config_->stats().too_large_.inc();
+    pending_response_.reset();
+    state_ = State::Miss;
+    return Http::FilterDataStatus::Continue;
+  }
+
+  const uint64_t offset = pending_response_->body_.size();
+  pending_response_->body_.resize(offset + data.length());
+  data.copyOut(0, data.length(), &pending_response_->body_[offset]);
+  if (end_stream) {
+    finishInsert();
+  }
+  return Http::FilterDataStatus::Continue;
+}
+
+Http::FilterTrailersStatus CacheFilter::encodeTrailers(Http::HeaderMap&) {
+  // Trailers are not stored, so a response carrying them cannot be replayed faithfully.
+  if (state_ == State::Inserting) {
+    config_->stats().uncacheable_.inc();
+    pending_response_.reset();
+    state_ = State::Miss;
+  }
+  return Http::FilterTrailersStatus::Continue;
+}
+
+void CacheFilter::serveFromCache(const CachedResponseConstSharedPtr& response,
+                                 bool not_modified) {
+  state_ = State::Served;
+  Http::HeaderMapPtr headers;
+  if (not_modified) {
+    config_->stats().not_modified_.inc();
+    headers = std::make_unique<Http::HeaderMapImpl>();
+    headers->insertStatus().value(enumToInt(Http::Code::NotModified));
+    for (const Http::LowerCaseString& key : validationHeaders()) {
+      copyHeader(*response->headers_, *headers, key);
+    }
+  } else {
+    config_->stats().hit_.inc();
+    headers = std::make_unique<Http::HeaderMapImpl>(*response->headers_);
+  }
+  addAgeHeader(*headers, *response);
+
+  const bool headers_only = not_modified || head_request_ || response->body_.empty();
+  decoder_callbacks_->encodeHeaders(std::move(headers), headers_only);
+  if (!headers_only) {
+    Buffer::OwnedImpl body;
+    body.addBufferFragment(*new CachedBodyFragment(response));
+    decoder_callbacks_->encodeData(body, true);
+  }
+}
+
+void CacheFilter::serveValidated(Http::HeaderMap& response_headers) {
+  const SystemTime now = config_->timeSource().systemTime();
+  auto refreshed = std::make_shared<CachedResponse>();
+  refreshed->headers_ = std::make_unique<Http::HeaderMapImpl>(*stale_response_->headers_);
+  for (const Http::LowerCaseString& key : validationHeaders()) {
+    copyHeader(response_headers, *refreshed->headers_, key);
+  }
+  refreshed->body_ = stale_response_->body_;
+  refreshed->response_time_ = now;
+  refreshed->vary_values_ = decltype(refreshed->vary_values_)(stale_response_->vary_values_);
+  stale_response_.reset();
+
+  const CacheControlDirectives directives = CacheUtility::parseCacheControl(
+      refreshed->headers_->CacheControl() != nullptr
+          ? refreshed->headers_->CacheControl()->value().getStringView()
+          : absl::string_view());
+  const absl::optional<std::chrono::seconds> lifetime =
+      CacheUtility::freshnessLifetime(*refreshed->headers_, directives, now);
+  if (directives.no_store_ || directives.no_cache_ || directives.private_ ||
+      !lifetime.has_value()) {
+    // The origin no longer permits caching. The refreshed response is still used to answer the
+    // client, which did not ask for a 304.
+    config_->cache().remove(key_);
+    config_->stats().uncacheable_.inc();
+  } else {
+    refreshed->freshness_lifetime_ = lifetime.value();
+    config_->cache().insert(key_, refreshed);
+  }
+  config_->stats().validated_.inc();
+  const CachedResponseConstSharedPtr response = std::move(refreshed);
+
+  // The client did not make a conditional request, so turn the 304 into the full response.
+  std::vector<Http::LowerCaseString> keys;
+  response_headers.iterate(
+      [](const Http::HeaderEntry& header, void* context) -> Http::HeaderMap::Iterate {
+        static_cast<std::vector<Http::LowerCaseString>*>(context)->emplace_back(
+            header.key().c_str());
+        return Http::HeaderMap::Iterate::Continue;
+      },
+      &keys);
+  for (const Http::LowerCaseString& key : keys) {
+    response_headers.remove(key);
+  }
+  response->headers_->iterate(
+      [](const Http::HeaderEntry& header, void* context) -> Http::HeaderMap::Iterate {
+        static_cast<Http::HeaderMap*>(context)->addCopy(Http::LowerCaseString(header.key().c_str()),
+                                                        header.value().c_str());
+        return Http::HeaderMap::Iterate::Continue;
+      },
+      &response_headers);
+  addAgeHeader(response_headers, *response);
+
+  state_ = State::Served;
+  if (!response->body_.empty()) {
+    Buffer::OwnedImpl body;
+    body.addBufferFragment(*new CachedBodyFragment(response));
+    encoder_callbacks_->addEncodedData(body, true);
+  }
+}
+
+bool CacheFilter::startInsert(Http::HeaderMap& response_headers, SystemTime now) {
+  if (!isCacheableStatus(Http::Utility::getResponseStatus(response_headers)) ||
+      response_headers.get(Http::Headers::get().SetCookie) != nullptr) {
+    config_->stats().uncacheable_.inc();
+    return false;
+  }
+
+  const CacheControlDirectives directives = CacheUtility::parseCacheControl(
+      response_headers.CacheControl() != nullptr
+          ? response_headers.CacheControl()->value().getStringView()
+          : absl::string_view());
+  const absl::optional<std::chrono::seconds> lifetime =
+      CacheUtility::freshnessLifetime(response_headers, directives, now);
+  if (directives.no_store_ || directives.no_cache_ || directives.private_ ||
+      !lifetime.has_value() || lifetime.value() == std::chrono::seconds::zero()) {
+    config_->stats().uncacheable_.inc();
+    return false;
+  }
+
+  if (response_headers.ContentLength() != nullptr) {
+    uint64_t content_length;
+    if (StringUtil::atoul(response_headers.ContentLength()->value().c_str(), content_length) &&
+        content_length > config_->maxEntrySizeBytes()) {
+      config_->stats().too_large_.inc();
+      return false;
+    }
+  }
+
+  auto response = std::make_shared<CachedResponse>();
+  if (response_headers.Vary() != nullptr) {
+    for (const absl::string_view token :
+         StringUtil::splitToken(response_headers.Vary()->value().getStringView(), ",", false)) {
+      Http::LowerCaseString header{std::string(StringUtil::trim(token))};
+      if (!config_->varyAllowed(header.get())) {
+        config_->stats().uncacheable_.inc();
+        return false;
+      }
+      const Http::HeaderEntry* value = request_headers_->get(header);
+      response->vary_values_.emplace_back(std::move(header),
+                                          value != nullptr ? value->value().c_str() : "");
+    }
+  }
+
+  // Account for time the response has already spent in upstream caches.
+  uint64_t upstream_age = 0;
+  const Http::HeaderEntry* age = response_headers.get(Http::Headers::get().Age);
+  if (age != nullptr) {
+    StringUtil::atoul(age->value().c_str(), upstream_age);
+  }
+  response->headers_ = std::make_unique<Http::HeaderMapImpl>(response_headers);
+  response->headers_->remove(Http::Headers::get().Age);
+  response->response_time_ = now - std::chrono::seconds(upstream_age);
+  response->freshness_lifetime_ = lifetime.value();
+  pending_response_ = std::move(response);
+  state_ = State::Inserting;
+  return true;
+}
+
+void CacheFilter::finishInsert() {
+  ASSERT(state_ == State::Inserting);
+  if (config_->cache().insert(key_, std::move(pending_response_))) {
+    config_->stats().insert_.inc();
+  } else {
+    config_->stats().too_large_.inc();
+  }
+  pending_response_.reset();
+  state_ = State::Miss;
+}
+
+void CacheFilter::addAgeHeader(Http::HeaderMap& headers, const CachedResponse& response) {
+  headers.remove(Http::Headers::get().Age);
+  headers.addCopy(Http::Headers::get().Age,
+                  static_cast<uint64_t>(response.age(config_->timeSource().systemTime()).count()));
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "envoy/common/time.h"
+#include "envoy/config/filter/http/cache/v2alpha/cache.pb.h"
+#include "envoy/http/filter.h"
+#include "envoy/stats/scope.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/logger.h"
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "absl/container/flat_hash_set.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * Configuration for the cache filter. A single config, and therefore a single cache, is shared by
+ * all filter instances created from the same filter chain configuration.
+ */
+class CacheFilterConfig {
+public:
+  CacheFilterConfig(const envoy::config::filter::http::cache::v2alpha::Cache& config,
+                    const std::string& stats_prefix, Stats::Scope& scope,
+                    TimeSource& time_source);
+
+  HttpCache& cache() { return cache_; }
+  CacheStats& stats() { return stats_; }
+  TimeSource& timeSource() { return time_source_; }
+  uint64_t maxEntrySizeBytes() const { return max_entry_size_bytes_; }
+
+  /**
+   * @param header supplies a lower cased request header name listed in a response's Vary header.
+   * @return true if responses may be cached when they vary on the header.
+   */
+  bool varyAllowed(const std::string& header) const;
+
+private:
+  static CacheStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return CacheStats{ALL_CACHE_STATS(POOL_COUNTER_PREFIX(scope, prefix),
+                                      POOL_GAUGE_PREFIX(scope, prefix))};
+  }
+
+  CacheStats stats_;
+  HttpCache cache_;
+  TimeSource& time_source_;
+  const uint64_t max_entry_size_bytes_;
+  absl::flat_hash_set<std::string> allowed_vary_headers_;
+};
+typedef std::shared_ptr<CacheFilterConfig> CacheFilterConfigSharedPtr;
+
+/**
+ * A buffer fragment referencing the body of a cached response. The fragment holds a reference to
+ * the response so that a hit is served without copying the body, even if the entry is evicted
+ * while the body is still being written.
+ */
+class CachedBodyFragment : public Buffer::BufferFragmentImpl {
+public:
+  explicit CachedBodyFragment(CachedResponseConstSharedPtr response);
+
+private:
+  const CachedResponseConstSharedPtr response_;
+};
+
+/**
+ * A filter that serves GET and HEAD requests from an in-memory cache of upstream responses.
+ * Fresh hits are answered directly from decodeHeaders() without involving the upstream. Stale
+ * responses carrying an ETag are revalidated with a conditional request.
+ */
+class CacheFilter : public Http::StreamFilter, Logger::Loggable<Logger::Id::filter> {
+public:
+  CacheFilter(const CacheFilterConfigSharedPtr& config);
+
+  // Http::StreamFilterBase
+  void onDestroy() override {}
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus decodeData(Buffer::Instance&, bool) override {
+    return Http::FilterDataStatus::Continue;
+  }
+  Http::FilterTrailersStatus decodeTrailers(Http::HeaderMap&) override {
+    return Http::FilterTrailersStatus::Continue;
+  }
+  void setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callbacks) override {
+    decoder_callbacks_ = &callbacks;
+  }
+
+  // Http::StreamEncoderFilter
+  Http::FilterHeadersStatus encode100ContinueHeaders(Http::HeaderMap&) override {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus encodeData(Buffer::Instance& data, bool end_stream) override;
+  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap&) override;
+  void setEncoderFilterCallbacks(Http::StreamEncoderFilterCallbacks& callbacks) override {
+    encoder_callbacks_ = &callbacks;
+  }
+
+private:
+  enum class State {
+    // The request is not eligible for caching; the filter is a pass-through.
+    Bypass,
+    // The request missed the cache; a cacheable response will be stored.
+    Miss,
+    // A stale response is being revalidated with a conditional request.
+    Validating,
+    // The response is being buffered for insertion into the cache.
+    Inserting,
+    // The request was answered from the cache.
+    Served,
+  };
+
+  static std::string cacheKey(const Http::HeaderMap& request_headers);
+
+  void serveFromCache(const CachedResponseConstSharedPtr& response, bool not_modified);
+  void serveValidated(Http::HeaderMap& response_headers);
+  bool startInsert(Http::HeaderMap& response_headers, SystemTime now);
+  void finishInsert();
+  void addAgeHeader(Http::HeaderMap& headers, const CachedResponse& response);
+
+  CacheFilterConfigSharedPtr config_;
+  State state_{State::Bypass};
+  bool head_request_{};
+  std::string key_;
+  const Http::HeaderMap* request_headers_{};
+  CachedResponseConstSharedPtr stale_response_;
+  std::shared_ptr<CachedResponse> pending_response_;
+
+  Http::StreamDecoderFilterCallbacks* decoder_callbacks_{};
+  Http::StreamEncoderFilterCallbacks* encoder_callbacks_{};
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
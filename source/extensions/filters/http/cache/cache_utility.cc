@@ -0,0 +1,125 @@
+#include "extensions/filters/http/cache/cache_utility.h"
+
+#include <string>
+
+#include "common/common/utility.h"
+#include "common/http/headers.h"
+
+#include "absl/strings/numbers.h"
+#include "absl/time/time.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+namespace {
+
+// IMF-fixdate, the only HTTP-date format senders are permitted to generate (RFC 7231 7.1.1.1).
+const char HttpTimeFormat[] = "%a, %d %b %Y %H:%M:%S GMT";
+
+absl::optional<std::chrono::seconds> parseDeltaSeconds(absl::string_view value) {
+  if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+    value = value.substr(1, value.size() - 2);
+  }
+  uint64_t seconds;
+  if (value.empty() || !absl::SimpleAtoi(value, &seconds)) {
+    return absl::nullopt;
+  }
+  return std::chrono::seconds(seconds);
+}
+
+} // namespace
+
+CacheControlDirectives CacheUtility::parseCacheControl(absl::string_view value) {
+  const auto& values = Http::Headers::get().CacheControlValues;
+  CacheControlDirectives directives;
+  for (const absl::string_view token : StringUtil::splitToken(value, ",", false)) {
+    const absl::string_view::size_type equals = token.find('=');
+    const absl::string_view name = StringUtil::trim(token.substr(0, equals));
+    const absl::string_view argument = equals == absl::string_view::npos
+                                           ? absl::string_view()
+                                           : StringUtil::trim(token.substr(equals + 1));
+    if (StringUtil::caseCompare(name, values.NoStore)) {
+      directives.no_store_ = true;
+    } else if (StringUtil::caseCompare(name, values.NoCache)) {
+      directives.no_cache_ = true;
+    } else if (StringUtil::caseCompare(name, values.Private)) {
+      directives.private_ = true;
+    } else if (StringUtil::caseCompare(name, values.MaxAge)) {
+      directives.max_age_ = parseDeltaSeconds(argument);
+    } else if (StringUtil::caseCompare(name, values.SMaxAge)) {
+      directives.s_maxage_ = parseDeltaSeconds(argument);
+    }
+  }
+  return directives;
+}
+
+absl::optional<SystemTime> CacheUtility::parseHttpTime(absl::string_view value) {
+  absl::Time time;
+  std::string error;
+  if (!absl::ParseTime(HttpTimeFormat, std::string(StringUtil::trim(value)), &time, &error)) {
+    return absl::nullopt;
+  }
+  return absl::ToChronoTime(time);
+}
+
+absl::optional<std::chrono::seconds>
+CacheUtility::freshnessLifetime(const Http::HeaderMap& headers,
+                                const CacheControlDirectives& directives,
+                                SystemTime response_time) {
+  // A shared cache prefers s-maxage over max-age, and both over Expires.
+  if (directives.s_maxage_.has_value()) {
+    return directives.s_maxage_;
+  }
+  if (directives.max_age_.has_value()) {
+    return directives.max_age_;
+  }
+
+  const Http::HeaderEntry* expires_header = headers.get(Http::Headers::get().Expires);
+  if (expires_header == nullptr) {
+    return absl::nullopt;
+  }
+  // An invalid Expires value, e.g. "0", represents a time in the past.
+  const absl::optional<SystemTime> expires =
+      parseHttpTime(expires_header->value().getStringView());
+  if (!expires.has_value()) {
+    return std::chrono::seconds::zero();
+  }
+
+  SystemTime date = response_time;
+  if (headers.Date() != nullptr) {
+    date = parseHttpTime(headers.Date()->value().getStringView()).value_or(response_time);
+  }
+  if (expires.value() <= date) {
+    return std::chrono::seconds::zero();
+  }
+  return std::chrono::duration_cast<std::chrono::seconds>(expires.value() - date);
+}
+
+bool CacheUtility::ifNoneMatch(absl::string_view if_none_match, absl::string_view etag) {
+  const auto weakTag = [](absl::string_view tag) {
+    tag = StringUtil::trim(tag);
+    if (tag.size() >= 2 && (tag[0] == 'W' || tag[0] == 'w') && tag[1] == '/') {
+      tag.remove_prefix(2);
+    }
+    return tag;
+  };
+
+  const absl::string_view cached_tag = weakTag(etag);
+  if (cached_tag.empty()) {
+    return false;
+  }
+  for (const absl::string_view token : StringUtil::splitToken(if_none_match, ",", false)) {
+    const absl::string_view tag = weakTag(token);
+    if (tag == "*" || tag == cached_tag) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
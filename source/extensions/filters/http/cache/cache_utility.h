@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "envoy/common/time.h"
+#include "envoy/http/header_map.h"
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * The subset of Cache-Control directives (RFC 7234 section 5.2) that a shared cache acts upon.
+ */
+struct CacheControlDirectives {
+  bool no_store_{};
+  bool no_cache_{};
+  bool private_{};
+  absl::optional<std::chrono::seconds> max_age_;
+  absl::optional<std::chrono::seconds> s_maxage_;
+};
+
+class CacheUtility {
+public:
+  /**
+   * Parse a Cache-Control header value. Unknown directives are ignored, as are directives with
+   * malformed arguments.
+   * @param value supplies the raw header value.
+   * @return CacheControlDirectives the recognized directives.
+   */
+  static CacheControlDirectives parseCacheControl(absl::string_view value);
+
+  /**
+   * Parse an HTTP-date in the preferred IMF-fixdate format, e.g. "Sun, 06 Nov 1994 08:49:37 GMT".
+   * @param value supplies the raw header value.
+   * @return the parsed time or absl::nullopt if the value could not be parsed.
+   */
+  static absl::optional<SystemTime> parseHttpTime(absl::string_view value);
+
+  /**
+   * Compute the freshness lifetime of a response as described in RFC 7234 section 4.2.1. Only
+   * explicit expiration is honored; heuristic freshness is never assumed.
+   * @param headers supplies the response headers.
+   * @param directives supplies the parsed Cache-Control directives of the response.
+   * @param response_time supplies the time the response was received, used in place of a missing
+   *        or invalid Date header.
+   * @return the freshness lifetime or absl::nullopt if the response carries no explicit expiration.
+   */
+  static absl::optional<std::chrono::seconds>
+  freshnessLifetime(const Http::HeaderMap& headers, const CacheControlDirectives& directives,
+                    SystemTime response_time);
+
+  /**
+   * Weak comparison (RFC 7232 section 2.3.2) of an If-None-Match header against an entity tag.
+   * @param if_none_match supplies the raw If-None-Match request header value.
+   * @param etag supplies the entity tag of the cached response.
+   * @return true if any of the listed tags, or "*", matches the entity tag.
+   */
+  static bool ifNoneMatch(absl::string_view if_none_match, absl::string_view etag);
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,96 @@
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "common/common/assert.h"
+#include "common/common/hash.h"
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+bool CachedResponse::varyMatches(const Http::HeaderMap& request_headers) const {
+  for (const auto& vary_value : vary_values_) {
+    const Http::HeaderEntry* entry = request_headers.get(vary_value.first);
+    const absl::string_view value =
+        entry == nullptr ? absl::string_view() : entry->value().getStringView();
+    if (value != vary_value.second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+HttpCache::HttpCache(uint64_t max_size_bytes, uint32_t shard_count, CacheStats& stats)
+    : max_shard_size_bytes_(max_size_bytes / shard_count), stats_(stats) {
+  ASSERT(shard_count > 0);
+  shards_.reserve(shard_count);
+  for (uint32_t i = 0; i < shard_count; i++) {
+    shards_.emplace_back(std::make_unique<Shard>());
+  }
+}
+
+HttpCache::Shard& HttpCache::shardFor(absl::string_view key) {
+  return *shards_[HashUtil::xxHash64(key) % shards_.size()];
+}
+
+CachedResponseConstSharedPtr HttpCache::lookup(absl::string_view key) {
+  Shard& shard = shardFor(key);
+  Thread::LockGuard lock(shard.lock_);
+  auto it = shard.index_.find(key);
+  if (it == shard.index_.end()) {
+    return nullptr;
+  }
+  shard.lru_.splice(shard.lru_.begin(), shard.lru_, it->second);
+  return it->second->response_;
+}
+
+bool HttpCache::insert(const std::string& key, CachedResponseConstSharedPtr response) {
+  Shard& shard = shardFor(key);
+  Thread::LockGuard lock(shard.lock_);
+  auto it = shard.index_.find(key);
+  if (it != shard.index_.end()) {
+    eraseLockHeld(shard, it->second);
+  }
+
+  shard.lru_.emplace_front(key, std::move(response));
+  const uint64_t byte_size = shard.lru_.front().byte_size_;
+  if (byte_size > max_shard_size_bytes_) {
+    shard.lru_.pop_front();
+    return false;
+  }
+
+  while (shard.size_bytes_ + byte_size > max_shard_size_bytes_) {
+    ASSERT(shard.lru_.size() > 1);
+    eraseLockHeld(shard, std::prev(shard.lru_.end()));
+    stats_.evictions_.inc();
+  }
+
+  shard.index_.emplace(shard.lru_.front().key_, shard.lru_.begin());
+  shard.size_bytes_ += byte_size;
+  stats_.entries_.inc();
+  stats_.bytes_.add(byte_size);
+  return true;
+}
+
+void HttpCache::remove(absl::string_view key) {
+  Shard& shard = shardFor(key);
+  Thread::LockGuard lock(shard.lock_);
+  auto it = shard.index_.find(key);
+  if (it != shard.index_.end()) {
+    eraseLockHeld(shard, it->second);
+  }
+}
+
+void HttpCache::eraseLockHeld(Shard& shard, EntryList::iterator it) {
+  shard.index_.erase(it->key_);
+  shard.size_bytes_ -= it->byte_size_;
+  stats_.entries_.dec();
+  stats_.bytes_.sub(it->byte_size_);
+  shard.lru_.erase(it);
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/http/header_map.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/thread.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * All cache filter stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_CACHE_STATS(COUNTER, GAUGE)  \
+  COUNTER(hit)                           \
+  COUNTER(miss)                          \
+  COUNTER(stale)                         \
+  COUNTER(validated)                     \
+  COUNTER(not_modified)                  \
+  COUNTER(insert)                        \
+  COUNTER(evictions)                     \
+  COUNTER(uncacheable)                   \
+  COUNTER(too_large)                     \
+  GAUGE  (entries)                       \
+  GAUGE  (bytes)
+// clang-format on
+
+/**
+ * Struct definition for cache filter stats. @see stats_macros.h
+ */
+struct CacheStats {
+  ALL_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * A complete response as stored in the cache. Entries are immutable once inserted and are shared
+ * between the cache and any streams serving them, so an entry may be evicted or replaced while a
+ * hit is still being written downstream.
+ */
+struct CachedResponse {
+  Http::HeaderMapPtr headers_;
+  std::string body_;
+  // Time at which the response was generated by the origin, i.e. the time it was received less
+  // any Age reported by upstream caches.
+  SystemTime response_time_;
+  std::chrono::seconds freshness_lifetime_;
+  // Request header values selected by the response's Vary header, in header name order.
+  std::vector<std::pair<Http::LowerCaseString, std::string>> vary_values_;
+
+  /**
+   * @return the number of bytes accounted against the cache size for this entry.
+   */
+  uint64_t byteSize() const { return headers_->byteSize() + body_.size(); }
+
+  /**
+   * @param now supplies the current time.
+   * @return the current age of the response, per RFC 7234 section 4.2.3.
+   */
+  std::chrono::seconds age(SystemTime now) const {
+    return now > response_time_
+               ? std::chrono::duration_cast<std::chrono::seconds>(now - response_time_)
+               : std::chrono::seconds::zero();
+  }
+
+  /**
+   * @param request_headers supplies the headers of the request being looked up.
+   * @return true if the request selects this response given the response's Vary header.
+   */
+  bool varyMatches(const Http::HeaderMap& request_headers) const;
+};
+typedef std::shared_ptr<const CachedResponse> CachedResponseConstSharedPtr;
+
+/**
+ * An in-memory response cache bounded by total byte size. The cache is shared by all workers and
+ * is partitioned into independently locked shards, each of which evicts in LRU order.
+ */
+class HttpCache {
+public:
+  HttpCache(uint64_t max_size_bytes, uint32_t shard_count, CacheStats& stats);
+
+  /**
+   * Look up a response and mark it as most recently used.
+   * @param key supplies the cache key.
+   * @return the cached response or nullptr if there is none.
+   */
+  CachedResponseConstSharedPtr lookup(absl::string_view key);
+
+  /**
+   * Insert or replace a response, evicting least recently used entries of the shard as needed.
+   * A response larger than a whole shard is not inserted.
+   * @param key supplies the cache key.
+   * @param response supplies the response to store.
+   * @return true if the response was inserted.
+   */
+  bool insert(const std::string& key, CachedResponseConstSharedPtr response);
+
+  /**
+   * Remove a response if present.
+   * @param key supplies the cache key.
+   */
+  void remove(absl::string_view key);
+
+private:
+  struct Entry {
+    Entry(const std::string& key, CachedResponseConstSharedPtr&& response)
+        : key_(key), response_(std::move(response)),
+          byte_size_(key_.size() + response_->byteSize()) {}
+
+    const std::string key_;
+    CachedResponseConstSharedPtr response_;
+    const uint64_t byte_size_;
+  };
+  typedef std::list<Entry> EntryList;
+
+  struct Shard {
+    Thread::MutexBasicLockable lock_;
+    // Most recently used entries are at the front.
+    EntryList lru_ GUARDED_BY(lock_);
+    // Keys reference the key_ of the owning list element, which is stable for its lifetime.
+    absl::flat_hash_map<absl::string_view, EntryList::iterator> index_ GUARDED_BY(lock_);
+    uint64_t size_bytes_ GUARDED_BY(lock_){};
+  };
+
+  Shard& shardFor(absl::string_view key);
+  void eraseLockHeld(Shard& shard, EntryList::iterator it) EXCLUSIVE_LOCKS_REQUIRED(shard.lock_);
+
+  const uint64_t max_shard_size_bytes_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  CacheStats& stats_;
+};
+typedef std::shared_ptr<HttpCache> HttpCacheSharedPtr;
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,427 @@
+#include "extensions/filters/http/compressor/compressor_filter.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+#include "common/compressor/brotli_compressor_impl.h"
+#include "common/compressor/zstd_compressor_impl.h"
+#include "common/http/headers.h"
+#include "common/protobuf/utility.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+namespace {
+// Default zlib memory level.
+const uint64_t DefaultGzipMemoryLevel = 5;
+
+// Default zlib compression window size.
+const uint64_t DefaultGzipWindowBits = 12;
+
+// When summed to window bits, this sets a gzip header and trailer around the compressed data.
+const uint64_t GzipHeaderValue = 16;
+
+// Default Brotli compression quality. Higher qualities are much slower and better suited to
+// static content.
+const uint32_t DefaultBrotliQuality = 5;
+
+// Default Brotli compression window size.
+const uint32_t DefaultBrotliWindowBits = 22;
+
+// Default zstd compression level.
+const uint32_t DefaultZstdCompressionLevel = 3;
+
+// Minimum length of an upstream response that allows compression.
+const uint64_t MinimumContentLength = 30;
+
+// Quality values are kept in thousandths, which is the precision allowed by RFC 7231.
+const uint32_t MaxQvalue = 1000;
+
+// Default content types will be used if any is provided by the user.
+const std::vector<std::string>& defaultContentEncoding() {
+  CONSTRUCT_ON_FIRST_USE(std::vector<std::string>,
+                         {"text/html", "text/plain", "text/css", "application/javascript",
+                          "application/json", "image/svg+xml", "text/xml",
+                          "application/xhtml+xml"});
+}
+
+} // namespace
+
+EncodingConfig::EncodingConfig(const std::string& encoding, const std::string& stats_prefix,
+                               Stats::Scope& scope)
+    : encoding_(encoding), stats_(generateStats(stats_prefix + encoding + ".", scope)) {}
+
+GzipEncodingConfig::GzipEncodingConfig(
+    const envoy::config::filter::http::compressor::v2alpha::Compressor::Gzip& gzip,
+    const std::string& stats_prefix, Stats::Scope& scope)
+    : EncodingConfig(Http::Headers::get().ContentEncodingValues.Gzip, stats_prefix, scope),
+      compression_level_(compressionLevelEnum(gzip.compression_level())),
+      compression_strategy_(compressionStrategyEnum(gzip.compression_strategy())),
+      memory_level_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, memory_level, DefaultGzipMemoryLevel)),
+      window_bits_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(gzip, window_bits, DefaultGzipWindowBits) |
+                   GzipHeaderValue) {}
+
+Envoy::Compressor::CompressorPtr GzipEncodingConfig::createCompressor() const {
+  auto compressor = std::make_unique<Envoy::Compressor::ZlibCompressorImpl>();
+  compressor->init(compression_level_, compression_strategy_, window_bits_, memory_level_);
+  return std::move(compressor);
+}
+
+Envoy::Compressor::ZlibCompressorImpl::CompressionLevel GzipEncodingConfig::compressionLevelEnum(
+    envoy::config::filter::http::compressor::v2alpha::Compressor::Gzip::CompressionLevel
+        compression_level) {
+  switch (compression_level) {
+  case envoy::config::filter::http::compressor::v2alpha::Compressor::Gzip::BEST:
+    return Envoy::Compressor::ZlibCompressorImpl::CompressionLevel::Best;
+  case envoy::config::filter::http::compressor::v2alpha::Compressor::Gzip::SPEED:
+    return Envoy::Compressor::ZlibCompressorImpl::CompressionLevel::Speed;
+  default:
+    return Envoy::Compressor::ZlibCompressorImpl::CompressionLevel::Standard;
+  }
+}
+
+Envoy::Compressor::ZlibCompressorImpl::CompressionStrategy
+GzipEncodingConfig::compressionStrategyEnum(
+    envoy::config::filter::http::compressor::v2alpha::Compressor::Gzip::CompressionStrategy
+        compression_strategy) {
+  switch (compression_strategy) {
+  case envoy::config::filter::http::compressor::v2alpha::Compressor::Gzip::RLE:
+    return Envoy::Compressor::ZlibCompressorImpl::CompressionStrategy::Rle;
+  case envoy::config::filter::http::compressor::v2alpha::Compressor::Gzip::FILTERED:
+    return Envoy::Compressor::ZlibCompressorImpl::CompressionStrategy::Filtered;
+  case envoy::config::filter::http::compressor::v2alpha::Compressor::Gzip::HUFFMAN:
+    return Envoy::Compressor::ZlibCompressorImpl::CompressionStrategy::Huffman;
+  default:
+    return Envoy::Compressor::ZlibCompressorImpl::CompressionStrategy::Standard;
+  }
+}
+
+BrotliEncodingConfig::BrotliEncodingConfig(
+    const envoy::config::filter::http::compressor::v2alpha::Compressor::Brotli& brotli,
+    const std::string& stats_prefix, Stats::Scope& scope)
+    : EncodingConfig(Http::Headers::get().ContentEncodingValues.Brotli, stats_prefix, scope),
+      quality_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(brotli, quality, DefaultBrotliQuality)),
+      window_bits_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(brotli, window_bits, DefaultBrotliWindowBits)) {}
+
+Envoy::Compressor::CompressorPtr BrotliEncodingConfig::createCompressor() const {
+  return std::make_unique<Envoy::Compressor::BrotliCompressorImpl>(quality_, window_bits_);
+}
+
+ZstdEncodingConfig::ZstdEncodingConfig(
+    const envoy::config::filter::http::compressor::v2alpha::Compressor::Zstd& zstd,
+    const std::string& stats_prefix, Stats::Scope& scope)
+    : EncodingConfig(Http::Headers::get().ContentEncodingValues.Zstd, stats_prefix, scope),
+      compression_level_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(zstd, compression_level, DefaultZstdCompressionLevel)),
+      enable_checksum_(zstd.enable_checksum()) {}
+
+Envoy::Compressor::CompressorPtr ZstdEncodingConfig::createCompressor() const {
+  return std::make_unique<Envoy::Compressor::ZstdCompressorImpl>(compression_level_,
+                                                                 enable_checksum_);
+}
+
+CompressorFilterConfig::CompressorFilterConfig(
+    const envoy::config::filter::http::compressor::v2alpha::Compressor& compressor,
+    const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime)
+    : content_length_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(compressor, content_length, MinimumContentLength)),
+      content_type_values_(contentTypeSet(compressor.content_type())),
+      disable_on_etag_header_(compressor.disable_on_etag_header()),
+      remove_accept_encoding_header_(compressor.remove_accept_encoding_header()),
+      stats_(generateStats(stats_prefix + "compressor.", scope)), runtime_(runtime) {
+  const std::string encoding_stats_prefix = stats_prefix + "compressor.";
+  for (const auto& algorithm : compressor.algorithms()) {
+    EncodingConfigPtr encoding;
+    switch (algorithm.algorithm_type_case()) {
+    case envoy::config::filter::http::compressor::v2alpha::Compressor::Algorithm::kGzip:
+      encoding =
+          std::make_unique<GzipEncodingConfig>(algorithm.gzip(), encoding_stats_prefix, scope);
+      break;
+    case envoy::config::filter::http::compressor::v2alpha::Compressor::Algorithm::kBrotli:
+      encoding =
+          std::make_unique<BrotliEncodingConfig>(algorithm.brotli(), encoding_stats_prefix, scope);
+      break;
+    case envoy::config::filter::http::compressor::v2alpha::Compressor::Algorithm::kZstd:
+      encoding =
+          std::make_unique<ZstdEncodingConfig>(algorithm.zstd(), encoding_stats_prefix, scope);
+      break;
+    default:
+      NOT_REACHED_GCOVR_EXCL_LINE;
+    }
+
+    for (const EncodingConfigPtr& existing : encodings_) {
+      if (existing->encoding() == encoding->encoding()) {
+        throw EnvoyException(
+            fmt::format("compressor filter: duplicate content-coding '{}'", encoding->encoding()));
+      }
+    }
+    encodings_.push_back(std::move(encoding));
+  }
+}
+
+StringUtil::CaseUnorderedSet CompressorFilterConfig::contentTypeSet(
+    const Protobuf::RepeatedPtrField<Envoy::ProtobufTypes::String>& types) {
+  return types.empty() ? StringUtil::CaseUnorderedSet(defaultContentEncoding().begin(),
+                                                      defaultContentEncoding().end())
+                       : StringUtil::CaseUnorderedSet(types.cbegin(), types.cend());
+}
+
+bool CompressorFilterConfig::parseQvalue(absl::string_view params, uint32_t& qvalue) {
+  qvalue = MaxQvalue;
+  for (const absl::string_view param : StringUtil::splitToken(params, ";", false)) {
+    const absl::string_view name = StringUtil::trim(StringUtil::cropRight(param, "="));
+    if (!StringUtil::caseCompare(name, "q")) {
+      continue;
+    }
+
+    // qvalue = ( "0" [ "." 0*3DIGIT ] ) / ( "1" [ "." 0*3("0") ] )
+    const absl::string_view value = StringUtil::trim(StringUtil::cropLeft(param, "="));
+    if (value.empty() || value.size() > 5 || (value[0] != '0' && value[0] != '1') ||
+        (value.size() > 1 && value[1] != '.')) {
+      return false;
+    }
+    uint32_t result = value[0] == '1' ? MaxQvalue : 0;
+    uint32_t scale = MaxQvalue / 10;
+    for (size_t i = 2; i < value.size(); i++) {
+      if (!absl::ascii_isdigit(value[i])) {
+        return false;
+      }
+      result += (value[i] - '0') * scale;
+      scale /= 10;
+    }
+    if (result > MaxQvalue) {
+      return false;
+    }
+    qvalue = result;
+  }
+  return true;
+}
+
+EncodingConfig* CompressorFilterConfig::chooseEncoding(absl::string_view accept_encoding,
+                                                       bool& identity) const {
+  // A negative quality value means that the coding is not listed.
+  std::vector<int32_t> qvalues(encodings_.size(), -1);
+  int32_t wildcard_qvalue = -1;
+  int32_t identity_qvalue = -1;
+
+  for (const absl::string_view token : StringUtil::splitToken(accept_encoding, ",", false)) {
+    const absl::string_view coding = StringUtil::trim(StringUtil::cropRight(token, ";"));
+    const absl::string_view::size_type params_pos = token.find(';');
+    uint32_t qvalue = MaxQvalue;
+    if (params_pos != absl::string_view::npos &&
+        !parseQvalue(token.substr(params_pos + 1), qvalue)) {
+      // Ignore codings with a malformed quality value rather than guessing what the client meant.
+      continue;
+    }
+
+    if (coding == Http::Headers::get().AcceptEncodingValues.Wildcard) {
+      wildcard_qvalue = qvalue;
+    } else if (StringUtil::caseCompare(coding,
+                                       Http::Headers::get().AcceptEncodingValues.Identity)) {
+      identity_qvalue = qvalue;
+    } else {
+      for (size_t i = 0; i < encodings_.size(); i++) {
+        if (StringUtil::caseCompare(coding, encodings_[i]->encoding())) {
+          qvalues[i] = qvalue;
+          break;
+        }
+      }
+    }
+  }
+
+  EncodingConfig* best = nullptr;
+  int32_t best_qvalue = 0;
+  for (size_t i = 0; i < encodings_.size(); i++) {
+    const int32_t qvalue = qvalues[i] >= 0 ? qvalues[i] : wildcard_qvalue;
+    // Strictly greater, so that the configured order breaks ties.
+    if (qvalue > best_qvalue) {
+      best = encodings_[i].get();
+      best_qvalue = qvalue;
+    }
+  }
+
+  // The identity coding is always acceptable unless excluded, so it only matters here when the
+  // client explicitly prefers it.
+  identity = identity_qvalue > best_qvalue || (best == nullptr && identity_qvalue > 0);
+  return identity ? nullptr : best;
+}
+
+CompressorFilter::CompressorFilter(const CompressorFilterConfigSharedPtr& config)
+    : config_(config) {}
+
+Http::FilterHeadersStatus CompressorFilter::decodeHeaders(Http::HeaderMap& headers, bool) {
+  if (config_->runtime().snapshot().featureEnabled("compressor.filter_enabled", 100)) {
+    encoding_ = chooseEncoding(headers);
+  }
+
+  if (encoding_ != nullptr) {
+    if (config_->removeAcceptEncodingHeader()) {
+      headers.removeAcceptEncoding();
+    }
+  } else {
+    config_->stats().not_compressed_.inc();
+  }
+
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterHeadersStatus CompressorFilter::encodeHeaders(Http::HeaderMap& headers,
+                                                          bool end_stream) {
+  if (!end_stream && encoding_ != nullptr && isMinimumContentLength(headers) &&
+      isContentTypeAllowed(headers) && !hasCacheControlNoTransform(headers) &&
+      isEtagAllowed(headers) && isTransferEncodingAllowed(headers) && !headers.ContentEncoding()) {
+    sanitizeEtagHeader(headers);
+    insertVaryHeader(headers);
+    headers.removeContentLength();
+    headers.insertContentEncoding().value(encoding_->encoding());
+    compressor_ = encoding_->createCompressor();
+    encoding_->stats().compressed_.inc();
+  } else if (encoding_ != nullptr) {
+    encoding_ = nullptr;
+    config_->stats().not_compressed_.inc();
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterDataStatus CompressorFilter::encodeData(Buffer::Instance& data, bool end_stream) {
+  if (compressor_ != nullptr) {
+    encoding_->stats().total_uncompressed_bytes_.add(data.length());
+    compressor_->compress(data, end_stream ? Envoy::Compressor::State::Finish
+                                           : Envoy::Compressor::State::Flush);
+    encoding_->stats().total_compressed_bytes_.add(data.length());
+  }
+  return Http::FilterDataStatus::Continue;
+}
+
+Http::FilterTrailersStatus CompressorFilter::encodeTrailers(Http::HeaderMap&) {
+  if (compressor_ != nullptr) {
+    // The body did not end with the data, so the compressed stream is terminated here.
+    Buffer::OwnedImpl empty_buffer;
+    compressor_->compress(empty_buffer, Envoy::Compressor::State::Finish);
+    encoding_->stats().total_compressed_bytes_.add(empty_buffer.length());
+    encoder_callbacks_->addEncodedData(empty_buffer, true);
+  }
+  return Http::FilterTrailersStatus::Continue;
+}
+
+EncodingConfig* CompressorFilter::chooseEncoding(const Http::HeaderMap& headers) const {
+  const Http::HeaderEntry* accept_encoding = headers.AcceptEncoding();
+  if (accept_encoding == nullptr) {
+    config_->stats().no_accept_header_.inc();
+    return nullptr;
+  }
+
+  bool identity;
+  EncodingConfig* encoding =
+      config_->chooseEncoding(accept_encoding->value().getStringView(), identity);
+  if (encoding != nullptr) {
+    encoding->stats().header_selected_.inc();
+  } else if (identity) {
+    config_->stats().header_identity_.inc();
+  } else {
+    config_->stats().header_not_valid_.inc();
+  }
+  return encoding;
+}
+
+bool CompressorFilter::hasCacheControlNoTransform(const Http::HeaderMap& headers) const {
+  const Http::HeaderEntry* cache_control = headers.CacheControl();
+  if (cache_control) {
+    return StringUtil::caseFindToken(cache_control->value().c_str(), ",",
+                                     Http::Headers::get().CacheControlValues.NoTransform.c_str());
+  }
+
+  return false;
+}
+
+bool CompressorFilter::isContentTypeAllowed(const Http::HeaderMap& headers) const {
+  const Http::HeaderEntry* content_type = headers.ContentType();
+  if (content_type && !config_->contentTypeValues().empty()) {
+    std::string value{StringUtil::trim(StringUtil::cropRight(content_type->value().c_str(), ";"))};
+    return config_->contentTypeValues().find(value) != config_->contentTypeValues().end();
+  }
+
+  return true;
+}
+
+bool CompressorFilter::isEtagAllowed(const Http::HeaderMap& headers) const {
+  const bool is_etag_allowed = !(config_->disableOnEtagHeader() && headers.Etag());
+  if (!is_etag_allowed) {
+    config_->stats().not_compressed_etag_.inc();
+  }
+  return is_etag_allowed;
+}
+
+bool CompressorFilter::isMinimumContentLength(const Http::HeaderMap& headers) const {
+  const Http::HeaderEntry* content_length = headers.ContentLength();
+  if (content_length) {
+    uint64_t length;
+    const bool is_minimum_content_length =
+        StringUtil::atoul(content_length->value().c_str(), length) &&
+        length >= config_->minimumLength();
+    if (!is_minimum_content_length) {
+      config_->stats().content_length_too_small_.inc();
+    }
+    return is_minimum_content_length;
+  }
+
+  const Http::HeaderEntry* transfer_encoding = headers.TransferEncoding();
+  return (transfer_encoding &&
+          StringUtil::caseFindToken(transfer_encoding->value().c_str(), ",",
+                                    Http::Headers::get().TransferEncodingValues.Chunked.c_str()));
+}
+
+bool CompressorFilter::isTransferEncodingAllowed(const Http::HeaderMap& headers) const {
+  const Http::HeaderEntry* transfer_encoding = headers.TransferEncoding();
+  if (transfer_encoding) {
+    for (auto header_value :
+         StringUtil::splitToken(transfer_encoding->value().getStringView(), ",", true)) {
+      const auto trimmed_value = StringUtil::trim(header_value);
+      if (StringUtil::caseCompare(trimmed_value,
+                                  Http::Headers::get().TransferEncodingValues.Gzip) ||
+          StringUtil::caseCompare(trimmed_value,
+                                  Http::Headers::get().TransferEncodingValues.Deflate)) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+void CompressorFilter::insertVaryHeader(Http::HeaderMap& headers) {
+  const Http::HeaderEntry* vary = headers.Vary();
+  if (vary) {
+    if (!StringUtil::findToken(vary->value().c_str(), ",",
+                               Http::Headers::get().VaryValues.AcceptEncoding, true)) {
+      std::string new_header;
+      absl::StrAppend(&new_header, vary->value().c_str(), ", ",
+                      Http::Headers::get().VaryValues.AcceptEncoding);
+      headers.insertVary().value(new_header);
+    }
+  } else {
+    headers.insertVary().value(Http::Headers::get().VaryValues.AcceptEncoding);
+  }
+}
+
+// As in the gzip filter, weak etags are preserved and strong ones are removed, since the
+// compressed representation is not byte-for-byte identical to the original.
+void CompressorFilter::sanitizeEtagHeader(Http::HeaderMap& headers) {
+  const Http::HeaderEntry* etag = headers.Etag();
+  if (etag) {
+    absl::string_view value(etag->value().c_str());
+    if (value.length() > 2 && !((value[0] == 'w' || value[0] == 'W') && value[1] == '/')) {
+      headers.removeEtag();
+    }
+  }
+}
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/compressor/compressor.h"
+#include "envoy/config/filter/http/compressor/v2alpha/compressor.pb.h"
+#include "envoy/http/filter.h"
+#include "envoy/http/header_map.h"
+#include "envoy/runtime/runtime.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/utility.h"
+#include "common/compressor/zlib_compressor_impl.h"
+#include "common/protobuf/protobuf.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+/**
+ * All compressor filter stats that are not specific to a content-coding. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_COMPRESSOR_STATS(COUNTER)  \
+  COUNTER(not_compressed)              \
+  COUNTER(no_accept_header)            \
+  COUNTER(header_identity)             \
+  COUNTER(header_not_valid)            \
+  COUNTER(content_length_too_small)    \
+  COUNTER(not_compressed_etag)         \
+// clang-format on
+
+/**
+ * Struct definition for compressor stats. @see stats_macros.h
+ */
+struct CompressorStats {
+  ALL_COMPRESSOR_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Per content-coding compressor filter stats. @see stats_macros.h
+ * "total_uncompressed_bytes" only includes bytes from responses that were compressed with the
+ * content-coding.
+ */
+// clang-format off
+#define ALL_COMPRESSOR_ENCODING_STATS(COUNTER) \
+  COUNTER(header_selected)                     \
+  COUNTER(compressed)                          \
+  COUNTER(total_uncompressed_bytes)            \
+  COUNTER(total_compressed_bytes)              \
+// clang-format on
+
+/**
+ * Struct definition for per content-coding compressor stats. @see stats_macros.h
+ */
+struct CompressorEncodingStats {
+  ALL_COMPRESSOR_ENCODING_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * A content-coding offered by the filter, which creates a compressor for each response.
+ */
+class EncodingConfig {
+public:
+  EncodingConfig(const std::string& encoding, const std::string& stats_prefix,
+                 Stats::Scope& scope);
+  virtual ~EncodingConfig() {}
+
+  /**
+   * @return the content-coding token, as used in the accept-encoding and content-encoding headers.
+   */
+  const std::string& encoding() const { return encoding_; }
+
+  CompressorEncodingStats& stats() { return stats_; }
+
+  /**
+   * @return a new compressor producing the content-coding.
+   */
+  virtual Envoy::Compressor::CompressorPtr createCompressor() const PURE;
+
+private:
+  static CompressorEncodingStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return CompressorEncodingStats{
+        ALL_COMPRESSOR_ENCODING_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+  }
+
+  const std::string encoding_;
+  CompressorEncodingStats stats_;
+};
+typedef std::unique_ptr<EncodingConfig> EncodingConfigPtr;
+
+/**
+ * The gzip content-coding, backed by zlib.
+ */
+class GzipEncodingConfig : public EncodingConfig {
+public:
+  GzipEncodingConfig(
+      const envoy::config::filter::http::compressor::v2alpha::Compressor::Gzip& gzip,
+      const std::string& stats_prefix, Stats::Scope& scope);
+
+  // EncodingConfig
+  Envoy::Compressor::CompressorPtr createCompressor() const override;
+
+private:
+  static Envoy::Compressor::ZlibCompressorImpl::CompressionLevel compressionLevelEnum(
+      envoy::config::filter::http::compressor::v2alpha::Compressor::Gzip::CompressionLevel
+          compression_level);
+  static Envoy::Compressor::ZlibCompressorImpl::CompressionStrategy compressionStrategyEnum(
+      envoy::config::filter::http::compressor::v2alpha::Compressor::Gzip::CompressionStrategy
+          compression_strategy);
+
+  const Envoy::Compressor::ZlibCompressorImpl::CompressionLevel compression_level_;
+  const Envoy::Compressor::ZlibCompressorImpl::CompressionStrategy compression_strategy_;
+  const uint64_t memory_level_;
+  const uint64_t window_bits_;
+};
+
+/**
+ * The br content-coding.
+ */
+class BrotliEncodingConfig : public EncodingConfig {
+public:
+  BrotliEncodingConfig(
+      const envoy::config::filter::http::compressor::v2alpha::Compressor::Brotli& brotli,
+      const std::string& stats_prefix, Stats::Scope& scope);
+
+  // EncodingConfig
+  Envoy::Compressor::CompressorPtr createCompressor() const override;
+
+private:
+  const uint32_t quality_;
+  const uint32_t window_bits_;
+};
+
+/**
+ * The zstd content-coding.
+ */
+class ZstdEncodingConfig : public EncodingConfig {
+public:
+  ZstdEncodingConfig(
+      const envoy::config::filter::http::compressor::v2alpha::Compressor::Zstd& zstd,
+      const std::string& stats_prefix, Stats::Scope& scope);
+
+  // EncodingConfig
+  Envoy::Compressor::CompressorPtr createCompressor() const override;
+
+private:
+  const uint32_t compression_level_;
+  const bool enable_checksum_;
+};
+
+/**
+ * Configuration for the compressor filter.
+ */
+class CompressorFilterConfig {
+public:
+  CompressorFilterConfig(
+      const envoy::config::filter::http::compressor::v2alpha::Compressor& compressor,
+      const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime);
+
+  /**
+   * Picks the content-coding of a response from the request's accept-encoding header. The coding
+   * with the highest quality value wins, and ties are broken by the configured order. Codings
+   * that are not listed explicitly take the quality value of the wildcard, if any.
+   * @param accept_encoding supplies the value of the accept-encoding header.
+   * @param identity is set to true if the client prefers the identity coding over the offered
+   *        codings.
+   * @return the content-coding to use, or nullptr if the response must not be compressed.
+   */
+  EncodingConfig* chooseEncoding(absl::string_view accept_encoding, bool& identity) const;
+
+  Runtime::Loader& runtime() { return runtime_; }
+  CompressorStats& stats() { return stats_; }
+  const std::vector<EncodingConfigPtr>& encodings() const { return encodings_; }
+  const StringUtil::CaseUnorderedSet& contentTypeValues() const { return content_type_values_; }
+  bool disableOnEtagHeader() const { return disable_on_etag_header_; }
+  bool removeAcceptEncodingHeader() const { return remove_accept_encoding_header_; }
+  uint64_t minimumLength() const { return content_length_; }
+
+private:
+  static StringUtil::CaseUnorderedSet
+  contentTypeSet(const Protobuf::RepeatedPtrField<Envoy::ProtobufTypes::String>& types);
+  static bool parseQvalue(absl::string_view params, uint32_t& qvalue);
+
+  static CompressorStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return CompressorStats{ALL_COMPRESSOR_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+  }
+
+  const uint64_t content_length_;
+  const StringUtil::CaseUnorderedSet content_type_values_;
+  const bool disable_on_etag_header_;
+  const bool remove_accept_encoding_header_;
+  CompressorStats stats_;
+  std::vector<EncodingConfigPtr> encodings_;
+  Runtime::Loader& runtime_;
+};
+typedef std::shared_ptr<CompressorFilterConfig> CompressorFilterConfigSharedPtr;
+
+/**
+ * A filter that compresses data dispatched from the upstream with the content-coding that best
+ * matches the request's accept-encoding header.
+ */
+class CompressorFilter : public Http::StreamFilter {
+public:
+  CompressorFilter(const CompressorFilterConfigSharedPtr& config);
+
+  // Http::StreamFilterBase
+  void onDestroy() override {}
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus decodeData(Buffer::Instance&, bool) override {
+    return Http::FilterDataStatus::Continue;
+  }
+  Http::FilterTrailersStatus decodeTrailers(Http::HeaderMap&) override {
+    return Http::FilterTrailersStatus::Continue;
+  }
+  void setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks&) override {}
+
+  // Http::StreamEncoderFilter
+  Http::FilterHeadersStatus encode100ContinueHeaders(Http::HeaderMap&) override {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus encodeData(Buffer::Instance& buffer, bool end_stream) override;
+  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap&) override;
+  void setEncoderFilterCallbacks(Http::StreamEncoderFilterCallbacks& callbacks) override {
+    encoder_callbacks_ = &callbacks;
+  }
+
+private:
+  EncodingConfig* chooseEncoding(const Http::HeaderMap& headers) const;
+  bool hasCacheControlNoTransform(const Http::HeaderMap& headers) const;
+  bool isContentTypeAllowed(const Http::HeaderMap& headers) const;
+  bool isEtagAllowed(const Http::HeaderMap& headers) const;
+  bool isMinimumContentLength(const Http::HeaderMap& headers) const;
+  bool isTransferEncodingAllowed(const Http::HeaderMap& headers) const;
+
+  void sanitizeEtagHeader(Http::HeaderMap& headers);
+  void insertVaryHeader(Http::HeaderMap& headers);
+
+  CompressorFilterConfigSharedPtr config_;
+  // The content-coding negotiated in decodeHeaders(), or nullptr if the response is not compressed.
+  EncodingConfig* encoding_{};
+  Envoy::Compressor::CompressorPtr compressor_;
+
+  Http::StreamEncoderFilterCallbacks* encoder_callbacks_{};
+};
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
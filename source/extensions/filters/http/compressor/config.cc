@@ -0,0 +1,33 @@
+#include "extensions/filters/http/compressor/config.h"
+
+#include "envoy/config/filter/http/compressor/v2alpha/compressor.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "extensions/filters/http/compressor/compressor_filter.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+Http::FilterFactoryCb CompressorFilterFactory::createFilterFactoryFromProtoTyped(
+    const envoy::config::filter::http::compressor::v2alpha::Compressor& proto_config,
+    const std::string& stats_prefix, Server::Configuration::FactoryContext& context) {
+  CompressorFilterConfigSharedPtr config = std::make_shared<CompressorFilterConfig>(
+      proto_config, stats_prefix, context.scope(), context.runtime());
+  return [config](Http::FilterChainFactoryCallbacks& callbacks) -> void {
+    callbacks.addStreamFilter(std::make_shared<CompressorFilter>(config));
+  };
+}
+
+/**
+ * Static registration for the compressor filter. @see NamedHttpFilterConfigFactory.
+ */
+static Registry::RegisterFactory<CompressorFilterFactory,
+                                 Server::Configuration::NamedHttpFilterConfigFactory>
+    register_;
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "envoy/config/filter/http/compressor/v2alpha/compressor.pb.h"
+#include "envoy/config/filter/http/compressor/v2alpha/compressor.pb.validate.h"
+
+#include "extensions/filters/http/common/factory_base.h"
+#include "extensions/filters/http/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+
+/**
+ * Config registration for the compressor filter. @see NamedHttpFilterConfigFactory.
+ */
+class CompressorFilterFactory
+    : public Common::FactoryBase<envoy::config::filter::http::compressor::v2alpha::Compressor> {
+public:
+  CompressorFilterFactory() : FactoryBase(HttpFilterNames::get().Compressor) {}
+
+private:
+  Http::FilterFactoryCb createFilterFactoryFromProtoTyped(
+      const envoy::config::filter::http::compressor::v2alpha::Compressor& config,
+      const std::string& stats_prefix, Server::Configuration::FactoryContext& context) override;
+};
+
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
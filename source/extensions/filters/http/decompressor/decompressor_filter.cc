@@ -0,0 +1,195 @@
+#include "extensions/filters/http/decompressor/decompressor_filter.h"
+
+#include <algorithm>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/utility.h"
+#include "common/http/headers.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Decompressor {
+
+namespace {
+// Default upper bound of a decompressed body.
+const uint64_t DefaultMaxDecompressedBytes = 10 * 1024 * 1024;
+
+// Default and maximum zlib window size.
+const uint64_t DefaultWindowBits = 15;
+
+// When summed to window bits, zlib detects either a gzip or a zlib header.
+const uint64_t AutomaticHeaderDetectionValue = 32;
+
+// Compressed input is fed to zlib in pieces of at most this size, so that the decompressed size
+// can be checked before a single large piece of input expands past the limit. deflate cannot
+// expand input by more than ~1032:1, which bounds the overshoot to roughly 4MiB.
+const uint64_t MaxInputPieceBytes = 4096;
+
+// Used for verifying accept-encoding values.
+const char ZeroQvalueString[] = "q=0";
+
+} // namespace
+
+DirectionConfig::DirectionConfig(
+    const envoy::config::filter::http::decompressor::v2alpha::Decompressor::DirectionConfig&
+        config,
+    const std::string& stats_prefix, Stats::Scope& scope)
+    : enabled_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, enabled, true)),
+      max_decompressed_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_decompressed_bytes,
+                                                              DefaultMaxDecompressedBytes)),
+      stats_(generateStats(stats_prefix, scope)) {}
+
+DecompressorFilterConfig::DecompressorFilterConfig(
+    const envoy::config::filter::http::decompressor::v2alpha::Decompressor& decompressor,
+    const std::string& stats_prefix, Stats::Scope& scope)
+    : request_direction_(decompressor.request_direction_config(),
+                         stats_prefix + "decompressor.request.", scope),
+      response_direction_(decompressor.response_direction_config(),
+                          stats_prefix + "decompressor.response.", scope),
+      window_bits_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(decompressor, window_bits, DefaultWindowBits) |
+                   AutomaticHeaderDetectionValue) {}
+
+DecompressorFilter::DecompressorFilter(const DecompressorFilterConfigSharedPtr& config)
+    : config_(config), request_state_(config->requestDirection()),
+      response_state_(config->responseDirection()) {}
+
+Http::FilterHeadersStatus DecompressorFilter::decodeHeaders(Http::HeaderMap& headers,
+                                                            bool end_stream) {
+  if (config_->responseDirection().enabled() && headers.AcceptEncoding() != nullptr) {
+    accept_encoding_ = std::string(headers.AcceptEncoding()->value().getStringView());
+  }
+  maybeStart(request_state_, headers, end_stream);
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterDataStatus DecompressorFilter::decodeData(Buffer::Instance& data, bool) {
+  if (request_state_.failed_) {
+    data.drain(data.length());
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
+
+  switch (decompress(request_state_, data)) {
+  case Result::Ok:
+    return Http::FilterDataStatus::Continue;
+  case Result::TooLarge:
+    decoder_callbacks_->sendLocalReply(Http::Code::PayloadTooLarge,
+                                       "decompressed request body too large", nullptr,
+                                       absl::nullopt);
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  case Result::Error:
+    decoder_callbacks_->sendLocalReply(Http::Code::BadRequest, "malformed compressed request body",
+                                       nullptr, absl::nullopt);
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+Http::FilterHeadersStatus DecompressorFilter::encodeHeaders(Http::HeaderMap& headers,
+                                                            bool end_stream) {
+  // A client that accepts the content-coding gets the response as sent by the upstream.
+  if (headers.ContentEncoding() != nullptr &&
+      acceptsEncoding(StringUtil::trim(headers.ContentEncoding()->value().getStringView()))) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  maybeStart(response_state_, headers, end_stream);
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterDataStatus DecompressorFilter::encodeData(Buffer::Instance& data, bool) {
+  if (response_state_.failed_) {
+    data.drain(data.length());
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
+
+  if (decompress(response_state_, data) != Result::Ok) {
+    // The response headers are already on their way downstream, so the stream can only be reset.
+    data.drain(data.length());
+    encoder_callbacks_->resetStream();
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
+  return Http::FilterDataStatus::Continue;
+}
+
+void DecompressorFilter::maybeStart(DirectionState& state, Http::HeaderMap& headers,
+                                    bool end_stream) {
+  if (!state.config_.enabled() || end_stream || headers.ContentEncoding() == nullptr) {
+    return;
+  }
+
+  // Only a single coding is handled; a stack of codings such as "gzip, br" is left untouched.
+  const absl::string_view encoding =
+      StringUtil::trim(headers.ContentEncoding()->value().getStringView());
+  if (!StringUtil::caseCompare(encoding, Http::Headers::get().ContentEncodingValues.Gzip) &&
+      !StringUtil::caseCompare(encoding, Http::Headers::get().ContentEncodingValues.Deflate)) {
+    state.config_.stats().not_decompressed_.inc();
+    return;
+  }
+
+  state.decompressor_ = std::make_unique<Envoy::Decompressor::ZlibDecompressorImpl>();
+  state.decompressor_->init(config_->windowBits());
+  state.config_.stats().decompressed_.inc();
+
+  // The decompressed length is not known until the body ends, so the body is framed by the codec.
+  headers.removeContentEncoding();
+  headers.removeContentLength();
+}
+
+DecompressorFilter::Result DecompressorFilter::decompress(DirectionState& state,
+                                                          Buffer::Instance& data) {
+  if (state.decompressor_ == nullptr) {
+    return Result::Ok;
+  }
+
+  state.config_.stats().total_compressed_bytes_.add(data.length());
+  Buffer::OwnedImpl output;
+  while (data.length() > 0) {
+    Buffer::OwnedImpl piece;
+    piece.move(data, std::min(data.length(), MaxInputPieceBytes));
+    const uint64_t output_length = output.length();
+    state.decompressor_->decompress(piece, output);
+    state.decompressed_bytes_ += output.length() - output_length;
+    state.config_.stats().total_decompressed_bytes_.add(output.length() - output_length);
+
+    if (state.decompressor_->decompressionError()) {
+      state.config_.stats().decompression_error_.inc();
+      state.decompressor_.reset();
+      state.failed_ = true;
+      return Result::Error;
+    }
+    if (state.decompressed_bytes_ > state.config_.maxDecompressedBytes()) {
+      state.config_.stats().too_large_.inc();
+      state.decompressor_.reset();
+      state.failed_ = true;
+      return Result::TooLarge;
+    }
+  }
+
+  // Each chunk is passed on as soon as it is inflated, so the usual buffer limits and watermarks
+  // of the next hop apply to the decompressed data.
+  data.move(output);
+  return Result::Ok;
+}
+
+bool DecompressorFilter::acceptsEncoding(absl::string_view encoding) const {
+  bool is_wildcard = false;
+  for (const absl::string_view token : StringUtil::splitToken(accept_encoding_, ",", false)) {
+    const absl::string_view value = StringUtil::trim(StringUtil::cropRight(token, ";"));
+    const absl::string_view q_value = StringUtil::trim(StringUtil::cropLeft(token, ";"));
+    // An explicit entry for the coding takes precedence over the wildcard.
+    if (StringUtil::caseCompare(value, encoding)) {
+      return !StringUtil::caseCompare(q_value, ZeroQvalueString);
+    }
+    if (value == Http::Headers::get().AcceptEncodingValues.Wildcard) {
+      is_wildcard = !StringUtil::caseCompare(q_value, ZeroQvalueString);
+    }
+  }
+  return is_wildcard;
+}
+
+} // namespace Decompressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
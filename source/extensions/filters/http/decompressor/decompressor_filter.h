@@ -0,0 +1,154 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "envoy/config/filter/http/decompressor/v2alpha/decompressor.pb.h"
+#include "envoy/http/filter.h"
+#include "envoy/http/header_map.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/decompressor/zlib_decompressor_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Decompressor {
+
+/**
+ * All decompressor filter stats, kept separately for requests and responses. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_DECOMPRESSOR_STATS(COUNTER)  \
+  COUNTER(decompressed)                  \
+  COUNTER(not_decompressed)              \
+  COUNTER(total_compressed_bytes)        \
+  COUNTER(total_decompressed_bytes)      \
+  COUNTER(too_large)                     \
+  COUNTER(decompression_error)
+// clang-format on
+
+/**
+ * Struct definition for decompressor stats. @see stats_macros.h
+ */
+struct DecompressorStats {
+  ALL_DECOMPRESSOR_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Configuration of one direction of the decompressor filter.
+ */
+class DirectionConfig {
+public:
+  DirectionConfig(
+      const envoy::config::filter::http::decompressor::v2alpha::Decompressor::DirectionConfig&
+          config,
+      const std::string& stats_prefix, Stats::Scope& scope);
+
+  bool enabled() const { return enabled_; }
+  uint64_t maxDecompressedBytes() const { return max_decompressed_bytes_; }
+  DecompressorStats& stats() { return stats_; }
+
+private:
+  static DecompressorStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return DecompressorStats{ALL_DECOMPRESSOR_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+  }
+
+  const bool enabled_;
+  const uint64_t max_decompressed_bytes_;
+  DecompressorStats stats_;
+};
+
+/**
+ * Configuration for the decompressor filter.
+ */
+class DecompressorFilterConfig {
+public:
+  DecompressorFilterConfig(
+      const envoy::config::filter::http::decompressor::v2alpha::Decompressor& decompressor,
+      const std::string& stats_prefix, Stats::Scope& scope);
+
+  DirectionConfig& requestDirection() { return request_direction_; }
+  DirectionConfig& responseDirection() { return response_direction_; }
+  int64_t windowBits() const { return window_bits_; }
+
+private:
+  DirectionConfig request_direction_;
+  DirectionConfig response_direction_;
+  const int64_t window_bits_;
+};
+typedef std::shared_ptr<DecompressorFilterConfig> DecompressorFilterConfigSharedPtr;
+
+/**
+ * A filter that inflates gzip and deflate encoded request and response bodies as they stream
+ * through, so that neither the upstream nor the client has to.
+ */
+class DecompressorFilter : public Http::StreamFilter {
+public:
+  DecompressorFilter(const DecompressorFilterConfigSharedPtr& config);
+
+  // Http::StreamFilterBase
+  void onDestroy() override {}
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus decodeData(Buffer::Instance& data, bool end_stream) override;
+  Http::FilterTrailersStatus decodeTrailers(Http::HeaderMap&) override {
+    return Http::FilterTrailersStatus::Continue;
+  }
+  void setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callbacks) override {
+    decoder_callbacks_ = &callbacks;
+  }
+
+  // Http::StreamEncoderFilter
+  Http::FilterHeadersStatus encode100ContinueHeaders(Http::HeaderMap&) override {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus encodeData(Buffer::Instance& data, bool end_stream) override;
+  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap&) override {
+    return Http::FilterTrailersStatus::Continue;
+  }
+  void setEncoderFilterCallbacks(Http::StreamEncoderFilterCallbacks& callbacks) override {
+    encoder_callbacks_ = &callbacks;
+  }
+
+private:
+  /**
+   * Decompression state of one direction of the stream.
+   */
+  struct DirectionState {
+    DirectionState(DirectionConfig& config) : config_(config) {}
+
+    DirectionConfig& config_;
+    std::unique_ptr<Envoy::Decompressor::ZlibDecompressorImpl> decompressor_;
+    uint64_t decompressed_bytes_{};
+    // Set once the body could not be decompressed; the rest of it is discarded.
+    bool failed_{};
+  };
+
+  enum class Result { Ok, TooLarge, Error };
+
+  /**
+   * Starts decompressing a body if its headers carry a supported content-coding, in which case the
+   * headers are updated to describe the decompressed body.
+   */
+  void maybeStart(DirectionState& state, Http::HeaderMap& headers, bool end_stream);
+  Result decompress(DirectionState& state, Buffer::Instance& data);
+  bool acceptsEncoding(absl::string_view encoding) const;
+
+  DecompressorFilterConfigSharedPtr config_;
+  DirectionState request_state_;
+  DirectionState response_state_;
+  // The request's accept-encoding header, kept to decide whether the response is decompressed.
+  std::string accept_encoding_;
+
+  Http::StreamDecoderFilterCallbacks* decoder_callbacks_{};
+  Http::StreamEncoderFilterCallbacks* encoder_callbacks_{};
+};
+
+} // namespace Decompressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -119,7 +119,8 @@ void Filter::onComplete(Filters::Common::ExtAuthz::ResponsePtr&& response) {
                                            EMPTY_STRING,
                                            EMPTY_STRING,
                                            EMPTY_STRING,
-                                           false};
+                                           false,
+                                           nullptr};
     config_->httpContext().codeStats().chargeResponseStat(info);
     break;
   }
@@ -0,0 +1,67 @@
+#include "extensions/filters/http/gzip/compression_thread_pool.h"
+
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Gzip {
+
+CompressionThreadPool::CompressionThreadPool(Thread::ThreadFactory& thread_factory,
+                                             uint32_t thread_count, uint32_t max_queue_depth,
+                                             Stats::Gauge& queue_depth)
+    : max_queue_depth_(max_queue_depth), queue_depth_(queue_depth) {
+  for (uint32_t i = 0; i < thread_count; i++) {
+    threads_.emplace_back(thread_factory.createThread([this]() -> void { threadRoutine(); }));
+  }
+}
+
+CompressionThreadPool::~CompressionThreadPool() {
+  {
+    Thread::LockGuard lock(lock_);
+    shutdown_ = true;
+    queue_depth_.sub(queue_.size());
+    queue_.clear();
+  }
+  cond_var_.notifyAll();
+  for (Thread::ThreadPtr& thread : threads_) {
+    thread->join();
+  }
+}
+
+bool CompressionThreadPool::post(Job job) {
+  {
+    Thread::LockGuard lock(lock_);
+    if (queue_.size() >= max_queue_depth_) {
+      return false;
+    }
+    queue_.push_back(std::move(job));
+    queue_depth_.inc();
+  }
+  cond_var_.notifyOne();
+  return true;
+}
+
+void CompressionThreadPool::threadRoutine() {
+  while (true) {
+    Job job;
+    {
+      Thread::LockGuard lock(lock_);
+      while (!shutdown_ && queue_.empty()) {
+        cond_var_.wait(lock_);
+      }
+      if (shutdown_) {
+        return;
+      }
+      job = std::move(queue_.front());
+      queue_.pop_front();
+      queue_depth_.dec();
+    }
+    job();
+  }
+}
+
+} // namespace Gzip
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
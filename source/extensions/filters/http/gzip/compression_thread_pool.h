@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include <vector>
+
+#include "envoy/stats/stats.h"
+#include "envoy/thread/thread.h"
+
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Gzip {
+
+/**
+ * A fixed set of threads that runs compression jobs off the workers' event loops. The queue is
+ * bounded so that a burst of large responses cannot build up unbounded latency and memory; callers
+ * are expected to do the work inline when a job is refused.
+ */
+class CompressionThreadPool {
+public:
+  typedef std::function<void()> Job;
+
+  /**
+   * @param thread_factory supplies the factory used to create the pool's threads.
+   * @param thread_count supplies the number of threads to create.
+   * @param max_queue_depth supplies the maximum number of jobs waiting for a thread.
+   * @param queue_depth supplies the gauge tracking the number of jobs waiting for a thread.
+   */
+  CompressionThreadPool(Thread::ThreadFactory& thread_factory, uint32_t thread_count,
+                        uint32_t max_queue_depth, Stats::Gauge& queue_depth);
+
+  /**
+   * Stops and joins all threads. Jobs that have not started yet are dropped.
+   */
+  ~CompressionThreadPool();
+
+  /**
+   * Queues a job to be run on one of the pool's threads. The job must not refer to anything that
+   * may be destroyed before it runs, and must hand its result back to the caller's thread itself,
+   * e.g. via Event::Dispatcher::post().
+   * @param job supplies the job to run.
+   * @return false if the queue is full, in which case the job is not run.
+   */
+  bool post(Job job);
+
+private:
+  void threadRoutine();
+
+  const uint32_t max_queue_depth_;
+  Stats::Gauge& queue_depth_;
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar cond_var_;
+  std::list<Job> queue_ GUARDED_BY(lock_);
+  bool shutdown_ GUARDED_BY(lock_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+typedef std::shared_ptr<CompressionThreadPool> CompressionThreadPoolSharedPtr;
+
+} // namespace Gzip
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -1,8 +1,10 @@
 #include "extensions/filters/http/gzip/gzip_filter.h"
 
+#include "envoy/event/dispatcher.h"
 #include "envoy/stats/scope.h"
 
 #include "common/common/macros.h"
+#include "common/protobuf/utility.h"
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
@@ -26,6 +28,15 @@ const uint64_t MinimumContentLength = 30;
 // When summed to window bits, this sets a gzip header and trailer around the compressed data.
 const uint64_t GzipHeaderValue = 16;
 
+// Default minimum size of a response body chunk that is compressed on the thread pool.
+const uint64_t DefaultOffloadMinChunkSize = 64 * 1024;
+
+// Default number of compression threads.
+const uint32_t DefaultOffloadThreadCount = 2;
+
+// Default maximum number of chunks waiting for a compression thread.
+const uint32_t DefaultOffloadMaxQueueDepth = 64;
+
 // Used for verifying accept-encoding values.
 const char ZeroQvalueString[] = "q=0";
 
@@ -41,7 +52,8 @@ const std::vector<std::string>& defaultContentEncoding() {
 
 GzipFilterConfig::GzipFilterConfig(const envoy::config::filter::http::gzip::v2::Gzip& gzip,
                                    const std::string& stats_prefix, Stats::Scope& scope,
-                                   Runtime::Loader& runtime)
+                                   Runtime::Loader& runtime, TimeSource& time_source,
+                                   Thread::ThreadFactory& thread_factory)
     : compression_level_(compressionLevelEnum(gzip.compression_level())),
       compression_strategy_(compressionStrategyEnum(gzip.compression_strategy())),
       content_length_(contentLengthUint(gzip.content_length().value())),
@@ -50,7 +62,19 @@ GzipFilterConfig::GzipFilterConfig(const envoy::config::filter::http::gzip::v2::
       content_type_values_(contentTypeSet(gzip.content_type())),
       disable_on_etag_header_(gzip.disable_on_etag_header()),
       remove_accept_encoding_header_(gzip.remove_accept_encoding_header()),
-      stats_(generateStats(stats_prefix + "gzip.", scope)), runtime_(runtime) {}
+      stats_(generateStats(stats_prefix + "gzip.", scope)), runtime_(runtime),
+      time_source_(time_source) {
+  if (gzip.has_offload()) {
+    const auto& offload = gzip.offload();
+    offload_min_chunk_size_ =
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(offload, min_chunk_size, DefaultOffloadMinChunkSize);
+    thread_pool_ = std::make_unique<CompressionThreadPool>(
+        thread_factory,
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(offload, thread_count, DefaultOffloadThreadCount),
+        PROTOBUF_GET_WRAPPED_OR_DEFAULT(offload, max_queue_depth, DefaultOffloadMaxQueueDepth),
+        stats_.offload_queue_depth_);
+  }
+}
 
 Compressor::ZlibCompressorImpl::CompressionLevel GzipFilterConfig::compressionLevelEnum(
     envoy::config::filter::http::gzip::v2::Gzip_CompressionLevel_Enum compression_level) {
@@ -103,7 +127,12 @@ uint64_t GzipFilterConfig::windowBitsUint(Protobuf::uint32 window_bits) {
 }
 
 GzipFilter::GzipFilter(const GzipFilterConfigSharedPtr& config)
-    : skip_compression_{true}, compressed_data_(), compressor_(), config_(config) {}
+    : skip_compression_{true}, compressed_data_(), config_(config) {}
+
+void GzipFilter::onDestroy() {
+  // Drop the results of any chunk still being compressed.
+  offload_handle_.reset();
+}
 
 Http::FilterHeadersStatus GzipFilter::decodeHeaders(Http::HeaderMap& headers, bool) {
   if (config_->runtime().snapshot().featureEnabled("gzip.filter_enabled", 100) &&
@@ -127,8 +156,9 @@ Http::FilterHeadersStatus GzipFilter::encodeHeaders(Http::HeaderMap& headers, bo
     insertVaryHeader(headers);
     headers.removeContentLength();
     headers.insertContentEncoding().value(Http::Headers::get().ContentEncodingValues.Gzip);
-    compressor_.init(config_->compressionLevel(), config_->compressionStrategy(),
-                     config_->windowBits(), config_->memoryLevel());
+    compressor_ = std::make_shared<Compressor::ZlibCompressorImpl>();
+    compressor_->init(config_->compressionLevel(), config_->compressionStrategy(),
+                      config_->windowBits(), config_->memoryLevel());
     config_->stats().compressed_.inc();
   } else if (!skip_compression_) {
     skip_compression_ = true;
@@ -138,14 +168,119 @@ Http::FilterHeadersStatus GzipFilter::encodeHeaders(Http::HeaderMap& headers, bo
 }
 
 Http::FilterDataStatus GzipFilter::encodeData(Buffer::Instance& data, bool end_stream) {
-  if (!skip_compression_) {
-    config_->stats().total_uncompressed_bytes_.add(data.length());
-    compressor_.compress(data, end_stream ? Compressor::State::Finish : Compressor::State::Flush);
-    config_->stats().total_compressed_bytes_.add(data.length());
+  if (skip_compression_) {
+    return Http::FilterDataStatus::Continue;
+  }
+
+  config_->stats().total_uncompressed_bytes_.add(data.length());
+  if (offload_in_flight_) {
+    offload_pending_data_.move(data);
+    offload_pending_end_stream_ = end_stream;
+    updatePendingWatermark();
+    return Http::FilterDataStatus::StopIterationNoBuffer;
   }
+
+  if (config_->threadPool() != nullptr && data.length() >= config_->offloadMinChunkSize() &&
+      offloadCompression(data, end_stream)) {
+    return Http::FilterDataStatus::StopIterationNoBuffer;
+  }
+
+  compress(data, end_stream);
   return Http::FilterDataStatus::Continue;
 }
 
+Http::FilterTrailersStatus GzipFilter::encodeTrailers(Http::HeaderMap&) {
+  // Trailers are released by continueEncoding() once the body is out.
+  return offload_in_flight_ ? Http::FilterTrailersStatus::StopIteration
+                            : Http::FilterTrailersStatus::Continue;
+}
+
+void GzipFilter::compress(Buffer::Instance& data, bool end_stream) {
+  compressor_->compress(data, end_stream ? Compressor::State::Finish : Compressor::State::Flush);
+  config_->stats().total_compressed_bytes_.add(data.length());
+}
+
+bool GzipFilter::offloadCompression(Buffer::Instance& data, bool end_stream) {
+  if (offload_handle_ == nullptr) {
+    offload_handle_ = std::make_shared<OffloadHandle>(*this);
+  }
+
+  // The job only holds on to what it shares with the filter and to server-wide objects that
+  // outlive the pool's threads.
+  auto input = std::make_shared<Buffer::OwnedImpl>();
+  input->move(data);
+  std::shared_ptr<Compressor::ZlibCompressorImpl> compressor = compressor_;
+  const Compressor::State state = end_stream ? Compressor::State::Finish : Compressor::State::Flush;
+  std::weak_ptr<OffloadHandle> weak_handle = offload_handle_;
+  Event::Dispatcher& dispatcher = encoder_callbacks_->dispatcher();
+  TimeSource& time_source = config_->timeSource();
+  const MonotonicTime queued = time_source.monotonicTime();
+
+  const bool posted = config_->threadPool()->post([input, compressor, state, weak_handle,
+                                                   &dispatcher, &time_source, queued]() -> void {
+    const MonotonicTime started = time_source.monotonicTime();
+    compressor->compress(*input, state);
+    const MonotonicTime finished = time_source.monotonicTime();
+    const auto queue_time = std::chrono::duration_cast<std::chrono::milliseconds>(started - queued);
+    const auto compression_time =
+        std::chrono::duration_cast<std::chrono::milliseconds>(finished - started);
+    dispatcher.post([input, weak_handle, queue_time, compression_time]() -> void {
+      std::shared_ptr<OffloadHandle> handle = weak_handle.lock();
+      if (handle != nullptr) {
+        handle->parent_.onOffloadComplete(*input, queue_time, compression_time);
+      }
+    });
+  });
+
+  if (!posted) {
+    config_->stats().offload_rejected_.inc();
+    data.move(*input);
+    return false;
+  }
+  config_->stats().offloaded_.inc();
+  offload_in_flight_ = true;
+  return true;
+}
+
+void GzipFilter::onOffloadComplete(Buffer::Instance& output, std::chrono::milliseconds queue_time,
+                                   std::chrono::milliseconds compression_time) {
+  ASSERT(offload_in_flight_);
+  offload_in_flight_ = false;
+  config_->stats().offload_queue_time_ms_.recordValue(queue_time.count());
+  config_->stats().offload_compression_time_ms_.recordValue(compression_time.count());
+  config_->stats().total_compressed_bytes_.add(output.length());
+  encoder_callbacks_->addEncodedData(output, true);
+
+  if (offload_pending_data_.length() > 0 || offload_pending_end_stream_) {
+    Buffer::OwnedImpl data;
+    data.move(offload_pending_data_);
+    const bool end_stream = offload_pending_end_stream_;
+    offload_pending_end_stream_ = false;
+    updatePendingWatermark();
+    if (data.length() < config_->offloadMinChunkSize() || !offloadCompression(data, end_stream)) {
+      compress(data, end_stream);
+      encoder_callbacks_->addEncodedData(data, true);
+    }
+  }
+
+  // While another chunk is in flight the output stays buffered, as continuing now would end the
+  // stream early if the end of the body has already been seen.
+  if (!offload_in_flight_) {
+    encoder_callbacks_->continueEncoding();
+  }
+}
+
+void GzipFilter::updatePendingWatermark() {
+  const uint32_t limit = encoder_callbacks_->encoderBufferLimit();
+  if (!offload_above_high_watermark_ && limit > 0 && offload_pending_data_.length() > limit) {
+    offload_above_high_watermark_ = true;
+    encoder_callbacks_->onEncoderFilterAboveWriteBufferHighWatermark();
+  } else if (offload_above_high_watermark_ && offload_pending_data_.length() == 0) {
+    offload_above_high_watermark_ = false;
+    encoder_callbacks_->onEncoderFilterBelowWriteBufferLowWatermark();
+  }
+}
+
 bool GzipFilter::hasCacheControlNoTransform(Http::HeaderMap& headers) const {
   const Http::HeaderEntry* cache_control = headers.CacheControl();
   if (cache_control) {
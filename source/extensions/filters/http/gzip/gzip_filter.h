@@ -1,5 +1,6 @@
 #pragma once
 
+#include "envoy/common/time.h"
 #include "envoy/config/filter/http/gzip/v2/gzip.pb.h"
 #include "envoy/http/filter.h"
 #include "envoy/http/header_map.h"
@@ -7,6 +8,7 @@
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
+#include "envoy/thread/thread.h"
 
 #include "common/buffer/buffer_impl.h"
 #include "common/compressor/zlib_compressor_impl.h"
@@ -15,6 +17,8 @@
 #include "common/json/json_validator.h"
 #include "common/protobuf/protobuf.h"
 
+#include "extensions/filters/http/gzip/compression_thread_pool.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace HttpFilters {
@@ -28,28 +32,34 @@ namespace Gzip {
  * the filter increments "not_compressed", but does
  * not add to "total_uncompressed_bytes". This way,
  * the user can measure the memory performance of the
- * compression.
+ * compression. The "offload" stats are only
+ * updated when compression offload is configured.
  */
 // clang-format off
-#define ALL_GZIP_STATS(COUNTER)    \
-  COUNTER(compressed)              \
-  COUNTER(not_compressed)          \
-  COUNTER(no_accept_header)        \
-  COUNTER(header_identity)         \
-  COUNTER(header_gzip)             \
-  COUNTER(header_wildcard)         \
-  COUNTER(header_not_valid)        \
-  COUNTER(total_uncompressed_bytes)\
-  COUNTER(total_compressed_bytes)  \
-  COUNTER(content_length_too_small)\
-  COUNTER(not_compressed_etag)     \
+#define ALL_GZIP_STATS(COUNTER, GAUGE, HISTOGRAM) \
+  COUNTER(compressed)                             \
+  COUNTER(not_compressed)                         \
+  COUNTER(no_accept_header)                       \
+  COUNTER(header_identity)                        \
+  COUNTER(header_gzip)                            \
+  COUNTER(header_wildcard)                        \
+  COUNTER(header_not_valid)                       \
+  COUNTER(total_uncompressed_bytes)               \
+  COUNTER(total_compressed_bytes)                 \
+  COUNTER(content_length_too_small)               \
+  COUNTER(not_compressed_etag)                    \
+  COUNTER(offloaded)                              \
+  COUNTER(offload_rejected)                       \
+  GAUGE(offload_queue_depth)                      \
+  HISTOGRAM(offload_queue_time_ms)                \
+  HISTOGRAM(offload_compression_time_ms)
 // clang-format on
 
 /**
  * Struct definition for gzip stats. @see stats_macros.h
  */
 struct GzipStats {
-  ALL_GZIP_STATS(GENERATE_COUNTER_STRUCT)
+  ALL_GZIP_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 /**
@@ -59,8 +69,8 @@ class GzipFilterConfig {
 
 public:
   GzipFilterConfig(const envoy::config::filter::http::gzip::v2::Gzip& gzip,
-                   const std::string& stats_prefix,
-                   Stats::Scope& scope, Runtime::Loader& runtime);
+                   const std::string& stats_prefix, Stats::Scope& scope, Runtime::Loader& runtime,
+                   TimeSource& time_source, Thread::ThreadFactory& thread_factory);
 
   Compressor::ZlibCompressorImpl::CompressionLevel compressionLevel() const {
     return compression_level_;
@@ -77,6 +87,13 @@ public:
   uint64_t memoryLevel() const { return memory_level_; }
   uint64_t minimumLength() const { return content_length_; }
   uint64_t windowBits() const { return window_bits_; }
+  TimeSource& timeSource() { return time_source_; }
+
+  /**
+   * @return the compression thread pool, or nullptr if compression offload is not configured.
+   */
+  CompressionThreadPool* threadPool() { return thread_pool_.get(); }
+  uint64_t offloadMinChunkSize() const { return offload_min_chunk_size_; }
 
 private:
   static Compressor::ZlibCompressorImpl::CompressionLevel compressionLevelEnum(
@@ -91,7 +108,9 @@ private:
   static uint64_t windowBitsUint(Protobuf::uint32 window_bits);
 
   static GzipStats generateStats(const std::string& prefix, Stats::Scope& scope) {
-    return GzipStats{ALL_GZIP_STATS(POOL_COUNTER_PREFIX(scope, prefix))};
+    return GzipStats{ALL_GZIP_STATS(POOL_COUNTER_PREFIX(scope, prefix),
+                                    POOL_GAUGE_PREFIX(scope, prefix),
+                                    POOL_HISTOGRAM_PREFIX(scope, prefix))};
   }
 
   Compressor::ZlibCompressorImpl::CompressionLevel compression_level_;
@@ -106,6 +125,10 @@ private:
   bool remove_accept_encoding_header_;
   GzipStats stats_;
   Runtime::Loader& runtime_;
+  TimeSource& time_source_;
+  uint64_t offload_min_chunk_size_{};
+  // Declared after the stats so that the pool's threads are joined before the gauge goes away.
+  std::unique_ptr<CompressionThreadPool> thread_pool_;
 };
 typedef std::shared_ptr<GzipFilterConfig> GzipFilterConfigSharedPtr;
 
@@ -117,7 +140,7 @@ public:
   GzipFilter(const GzipFilterConfigSharedPtr& config);
 
   // Http::StreamFilterBase
-  void onDestroy() override{};
+  void onDestroy() override;
 
   // Http::StreamDecoderFilter
   Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
@@ -137,9 +160,7 @@ public:
   }
   Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
   Http::FilterDataStatus encodeData(Buffer::Instance& buffer, bool end_stream) override;
-  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap&) override {
-    return Http::FilterTrailersStatus::Continue;
-  }
+  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap&) override;
   void setEncoderFilterCallbacks(Http::StreamEncoderFilterCallbacks& callbacks) override {
     encoder_callbacks_ = &callbacks;
   }
@@ -149,6 +170,16 @@ private:
   // the logic in these private member functions would be availale in another class.
   friend class GzipFilterTest;
 
+  /**
+   * Owned by the filter and only weakly referenced by offloaded compression jobs, so that results
+   * completing after the stream is gone are dropped.
+   */
+  struct OffloadHandle {
+    OffloadHandle(GzipFilter& parent) : parent_(parent) {}
+
+    GzipFilter& parent_;
+  };
+
   bool hasCacheControlNoTransform(Http::HeaderMap& headers) const;
   bool isAcceptEncodingAllowed(Http::HeaderMap& headers) const;
   bool isContentTypeAllowed(Http::HeaderMap& headers) const;
@@ -159,11 +190,26 @@ private:
   void sanitizeEtagHeader(Http::HeaderMap& headers);
   void insertVaryHeader(Http::HeaderMap& headers);
 
+  void compress(Buffer::Instance& data, bool end_stream);
+  bool offloadCompression(Buffer::Instance& data, bool end_stream);
+  void onOffloadComplete(Buffer::Instance& output, std::chrono::milliseconds queue_time,
+                         std::chrono::milliseconds compression_time);
+  void updatePendingWatermark();
+
   bool skip_compression_;
   Buffer::OwnedImpl compressed_data_;
-  Compressor::ZlibCompressorImpl compressor_;
+  // Shared with offloaded compression jobs, which may outlive the filter.
+  std::shared_ptr<Compressor::ZlibCompressorImpl> compressor_;
   GzipFilterConfigSharedPtr config_;
 
+  // At most one chunk per stream is compressed on the thread pool at a time. Data arriving in the
+  // meantime is held back and compressed after it, which keeps the output in order.
+  std::shared_ptr<OffloadHandle> offload_handle_;
+  bool offload_in_flight_{};
+  Buffer::OwnedImpl offload_pending_data_;
+  bool offload_pending_end_stream_{};
+  bool offload_above_high_watermark_{};
+
   Http::StreamDecoderFilterCallbacks* decoder_callbacks_{nullptr};
   Http::StreamEncoderFilterCallbacks* encoder_callbacks_{nullptr};
 };
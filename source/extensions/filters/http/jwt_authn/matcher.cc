@@ -1,5 +1,6 @@
 #include "extensions/filters/http/jwt_authn/matcher.h"
 
+#include "common/common/regex.h"
 #include "common/router/config_impl.h"
 
 #include "absl/strings/match.h"
@@ -126,13 +127,14 @@ public:
                    const Protobuf::Map<ProtobufTypes::String, JwtProvider>& providers,
                    const AuthFactory& factory, const Extractor& extractor)
       : BaseMatcherImpl(rule, providers, factory, extractor),
-        regex_(RegexUtil::parseRegex(rule.match().regex())), regex_str_(rule.match().regex()) {}
+        regex_(Regex::Utility::parseRegex(rule.match().regex())),
+        regex_str_(rule.match().regex()) {}
 
   bool matches(const Http::HeaderMap& headers) const override {
     if (BaseMatcherImpl::matchRoute(headers)) {
       const Http::HeaderString& path = headers.Path()->value();
       const char* query_string_start = Http::Utility::findQueryStringStart(path);
-      if (std::regex_match(path.c_str(), query_string_start, regex_)) {
+      if (regex_->match(absl::string_view(path.c_str(), query_string_start - path.c_str()))) {
         ENVOY_LOG(debug, "Regex requirement '{}' matched.", regex_str_);
         return true;
       }
@@ -142,7 +144,7 @@ public:
 
 private:
   // regex object
-  const std::regex regex_;
+  const Regex::CompiledMatcherPtr regex_;
   // raw regex string, for logging.
   const std::string regex_str_;
 };
@@ -136,7 +136,8 @@ void Filter::complete(Filters::Common::RateLimit::LimitStatus status,
                                            EMPTY_STRING,
                                            EMPTY_STRING,
                                            EMPTY_STRING,
-                                           false};
+                                           false,
+                                           nullptr};
     httpContext().codeStats().chargeResponseStat(info);
     headers_to_add_->insertEnvoyRateLimited().value(
         Http::Headers::get().EnvoyRateLimitedValues.True);
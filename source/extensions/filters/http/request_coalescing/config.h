@@ -0,0 +1,32 @@
+#pragma once
+
+#include "envoy/config/filter/http/request_coalescing/v2alpha/request_coalescing.pb.h"
+#include "envoy/config/filter/http/request_coalescing/v2alpha/request_coalescing.pb.validate.h"
+
+#include "extensions/filters/http/common/factory_base.h"
+#include "extensions/filters/http/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace RequestCoalescing {
+
+/**
+ * Config registration for the request coalescing filter. @see NamedHttpFilterConfigFactory.
+ */
+class RequestCoalescingFilterFactory
+    : public Common::FactoryBase<
+          envoy::config::filter::http::request_coalescing::v2alpha::RequestCoalescing> {
+public:
+  RequestCoalescingFilterFactory() : FactoryBase(HttpFilterNames::get().RequestCoalescing) {}
+
+private:
+  Http::FilterFactoryCb createFilterFactoryFromProtoTyped(
+      const envoy::config::filter::http::request_coalescing::v2alpha::RequestCoalescing& config,
+      const std::string& stats_prefix, Server::Configuration::FactoryContext& context) override;
+};
+
+} // namespace RequestCoalescing
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
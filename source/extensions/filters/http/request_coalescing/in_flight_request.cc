@@ -0,0 +1,188 @@
+#include "extensions/filters/http/request_coalescing/in_flight_request.h"
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/http/header_map_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace RequestCoalescing {
+
+BodyChunkFragment::BodyChunkFragment(BodyChunkConstSharedPtr chunk)
+    : Buffer::BufferFragmentImpl(
+          chunk->data(), chunk->size(),
+          [](const void*, size_t, const Buffer::BufferFragmentImpl* fragment) { delete fragment; }),
+      chunk_(std::move(chunk)) {}
+
+InFlightRequest::InFlightRequest(uint32_t max_waiters, uint64_t max_buffered_bytes,
+                                 RequestCoalescingStats& stats)
+    : max_waiters_(max_waiters), max_buffered_bytes_(max_buffered_bytes), stats_(stats) {}
+
+InFlightRequest::~InFlightRequest() {
+  Thread::LockGuard lock(lock_);
+  stats_.rq_waiting_.sub(waiters_.size());
+}
+
+bool InFlightRequest::addWaiter(Event::Dispatcher& dispatcher, const WaiterSharedPtr& waiter) {
+  Thread::LockGuard lock(lock_);
+  if (failed_) {
+    return false;
+  }
+  if (waiters_.size() >= max_waiters_) {
+    stats_.rq_too_many_waiters_.inc();
+    return false;
+  }
+  waiters_.push_back({&dispatcher, waiter, waiter.get()});
+  stats_.rq_coalesced_.inc();
+  stats_.rq_waiting_.inc();
+  return true;
+}
+
+void InFlightRequest::removeWaiter(const Waiter& waiter) {
+  Thread::LockGuard lock(lock_);
+  for (auto it = waiters_.begin(); it != waiters_.end(); ++it) {
+    if (it->key_ == &waiter) {
+      waiters_.erase(it);
+      stats_.rq_waiting_.dec();
+      return;
+    }
+  }
+}
+
+InFlightRequest::Progress InFlightRequest::progress(bool headers_consumed,
+                                                    uint64_t chunks_consumed) const {
+  Progress progress;
+  Thread::LockGuard lock(lock_);
+  if (failed_) {
+    progress.failed_ = true;
+    return progress;
+  }
+  if (!headers_consumed) {
+    progress.headers_ = headers_;
+  }
+  if (headers_ != nullptr) {
+    ASSERT(chunks_consumed <= chunks_.size());
+    progress.chunks_.assign(chunks_.begin() + chunks_consumed, chunks_.end());
+    progress.trailers_ = trailers_;
+    progress.complete_ = complete_;
+  }
+  return progress;
+}
+
+void InFlightRequest::publishHeaders(const Http::HeaderMap& headers, bool end_stream) {
+  // Copy outside of the lock; the copy is immutable from here on and read concurrently by the
+  // waiters.
+  std::shared_ptr<const Http::HeaderMap> copy = std::make_shared<Http::HeaderMapImpl>(headers);
+  std::list<WaiterEntry> waiters;
+  {
+    Thread::LockGuard lock(lock_);
+    ASSERT(headers_ == nullptr);
+    if (failed_) {
+      return;
+    }
+    headers_ = std::move(copy);
+    complete_ = end_stream;
+    waiters = waiters_;
+  }
+  notify(std::move(waiters));
+}
+
+bool InFlightRequest::publishData(const Buffer::Instance& data, bool end_stream) {
+  BodyChunkConstSharedPtr chunk;
+  if (data.length() > 0) {
+    std::string body(data.length(), '\0');
+    data.copyOut(0, data.length(), &body[0]);
+    chunk = std::make_shared<const std::string>(std::move(body));
+  }
+
+  std::list<WaiterEntry> waiters;
+  bool result = true;
+  {
+    Thread::LockGuard lock(lock_);
+    if (failed_) {
+      return false;
+    }
+    if (buffered_bytes_ + data.length() > max_buffered_bytes_) {
+      failed_ = true;
+      result = false;
+    } else {
+      if (chunk != nullptr) {
+        buffered_bytes_ += chunk->size();
+        chunks_.push_back(std::move(chunk));
+      }
+      complete_ = end_stream;
+    }
+    waiters = waiters_;
+  }
+  notify(std::move(waiters));
+  return result;
+}
+
+void InFlightRequest::publishTrailers(const Http::HeaderMap& trailers) {
+  std::shared_ptr<const Http::HeaderMap> copy = std::make_shared<Http::HeaderMapImpl>(trailers);
+  std::list<WaiterEntry> waiters;
+  {
+    Thread::LockGuard lock(lock_);
+    if (failed_) {
+      return;
+    }
+    trailers_ = std::move(copy);
+    complete_ = true;
+    waiters = waiters_;
+  }
+  notify(std::move(waiters));
+}
+
+void InFlightRequest::fail() {
+  std::list<WaiterEntry> waiters;
+  {
+    Thread::LockGuard lock(lock_);
+    if (failed_ || complete_) {
+      return;
+    }
+    failed_ = true;
+    waiters = waiters_;
+  }
+  notify(std::move(waiters));
+}
+
+void InFlightRequest::notify(std::list<WaiterEntry> waiters) {
+  for (const WaiterEntry& entry : waiters) {
+    std::weak_ptr<Waiter> weak_waiter = entry.waiter_;
+    entry.dispatcher_->post([weak_waiter]() -> void {
+      // The waiter is destroyed on its own worker, so it cannot go away while it is called here.
+      WaiterSharedPtr waiter = weak_waiter.lock();
+      if (waiter != nullptr) {
+        waiter->onResponseUpdated();
+      }
+    });
+  }
+}
+
+std::pair<InFlightRequestSharedPtr, bool>
+InFlightRequestTable::findOrCreate(const std::string& key) {
+  Thread::LockGuard lock(lock_);
+  InFlightRequestSharedPtr& request = requests_[key];
+  if (request != nullptr) {
+    return {request, false};
+  }
+  request = std::make_shared<InFlightRequest>(max_waiters_, max_buffered_bytes_, stats_);
+  stats_.in_flight_.inc();
+  stats_.rq_upstream_.inc();
+  return {request, true};
+}
+
+void InFlightRequestTable::remove(const std::string& key, const InFlightRequest& request) {
+  Thread::LockGuard lock(lock_);
+  auto it = requests_.find(key);
+  if (it != requests_.end() && it->second.get() == &request) {
+    requests_.erase(it);
+    stats_.in_flight_.dec();
+  }
+}
+
+} // namespace RequestCoalescing
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
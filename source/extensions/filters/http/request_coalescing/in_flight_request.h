@@ -0,0 +1,190 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/http/header_map.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/thread.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace RequestCoalescing {
+
+/**
+ * All request coalescing filter stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_REQUEST_COALESCING_STATS(COUNTER, GAUGE)  \
+  COUNTER(rq_upstream)                                \
+  COUNTER(rq_coalesced)                               \
+  COUNTER(rq_released)                                \
+  COUNTER(rq_reset)                                   \
+  COUNTER(rq_too_many_waiters)                        \
+  COUNTER(response_not_shareable)                     \
+  COUNTER(response_too_large)                         \
+  GAUGE  (rq_waiting)                                 \
+  GAUGE  (in_flight)
+// clang-format on
+
+/**
+ * Struct definition for request coalescing filter stats. @see stats_macros.h
+ */
+struct RequestCoalescingStats {
+  ALL_REQUEST_COALESCING_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+typedef std::shared_ptr<const std::string> BodyChunkConstSharedPtr;
+
+/**
+ * A buffer fragment referencing a chunk of a shared response body, so that the body is fanned out
+ * to all waiting streams without copying it once per stream.
+ */
+class BodyChunkFragment : public Buffer::BufferFragmentImpl {
+public:
+  explicit BodyChunkFragment(BodyChunkConstSharedPtr chunk);
+
+private:
+  const BodyChunkConstSharedPtr chunk_;
+};
+
+/**
+ * An upstream request sent on behalf of a set of identical concurrent requests. The stream that
+ * created it (the leader) publishes the response as it is received from the upstream, on its own
+ * worker. Waiting streams may live on any worker: they are notified through their dispatcher and
+ * replay the response from the start, at their own pace. The response is retained until the last
+ * reference to the request is dropped, so that slow waiters and late joiners can be served.
+ */
+class InFlightRequest {
+public:
+  /**
+   * A stream waiting for the response.
+   */
+  class Waiter {
+  public:
+    virtual ~Waiter() {}
+
+    /**
+     * Called on the waiter's dispatcher after the response has progressed or failed.
+     */
+    virtual void onResponseUpdated() PURE;
+  };
+  typedef std::shared_ptr<Waiter> WaiterSharedPtr;
+
+  /**
+   * The part of the response a waiter has not consumed yet.
+   */
+  struct Progress {
+    // Set if the waiter has not consumed the headers and they are available.
+    std::shared_ptr<const Http::HeaderMap> headers_;
+    std::vector<BodyChunkConstSharedPtr> chunks_;
+    std::shared_ptr<const Http::HeaderMap> trailers_;
+    // The response is complete; nothing beyond what is returned will follow.
+    bool complete_{};
+    // The response cannot be shared; the waiter must fend for itself.
+    bool failed_{};
+  };
+
+  InFlightRequest(uint32_t max_waiters, uint64_t max_buffered_bytes,
+                  RequestCoalescingStats& stats);
+  ~InFlightRequest();
+
+  /**
+   * Register a waiter. Waiters are notified through a post to their dispatcher and are only
+   * weakly referenced, so a waiter that is destroyed is never called.
+   * @param dispatcher supplies the dispatcher of the waiter's worker.
+   * @param waiter supplies the waiter.
+   * @return false if the request has failed or already has the maximum number of waiters.
+   */
+  bool addWaiter(Event::Dispatcher& dispatcher, const WaiterSharedPtr& waiter);
+
+  /**
+   * Unregister a waiter added with addWaiter(). This is a no-op for unknown waiters.
+   */
+  void removeWaiter(const Waiter& waiter);
+
+  /**
+   * @param headers_consumed supplies whether the waiter already consumed the response headers.
+   * @param chunks_consumed supplies the number of body chunks the waiter already consumed.
+   * @return the response progress beyond what the waiter consumed.
+   */
+  Progress progress(bool headers_consumed, uint64_t chunks_consumed) const;
+
+  // Called by the leader as the upstream response is received.
+  void publishHeaders(const Http::HeaderMap& headers, bool end_stream);
+  /**
+   * @return false if the body exceeded the buffer limit, in which case the request is failed.
+   */
+  bool publishData(const Buffer::Instance& data, bool end_stream);
+  void publishTrailers(const Http::HeaderMap& trailers);
+  void fail();
+
+private:
+  struct WaiterEntry {
+    Event::Dispatcher* dispatcher_;
+    std::weak_ptr<Waiter> waiter_;
+    const Waiter* key_;
+  };
+
+  void notify(std::list<WaiterEntry> waiters);
+
+  const uint32_t max_waiters_;
+  const uint64_t max_buffered_bytes_;
+  RequestCoalescingStats& stats_;
+  mutable Thread::MutexBasicLockable lock_;
+  std::list<WaiterEntry> waiters_ GUARDED_BY(lock_);
+  std::shared_ptr<const Http::HeaderMap> headers_ GUARDED_BY(lock_);
+  std::vector<BodyChunkConstSharedPtr> chunks_ GUARDED_BY(lock_);
+  std::shared_ptr<const Http::HeaderMap> trailers_ GUARDED_BY(lock_);
+  uint64_t buffered_bytes_ GUARDED_BY(lock_){};
+  bool complete_ GUARDED_BY(lock_){};
+  bool failed_ GUARDED_BY(lock_){};
+};
+typedef std::shared_ptr<InFlightRequest> InFlightRequestSharedPtr;
+
+/**
+ * The set of in-flight requests, keyed by coalescing key. The table is shared by all workers.
+ * A request is in the table from the time its leader sends it upstream until the response has
+ * been received completely or the request failed.
+ */
+class InFlightRequestTable {
+public:
+  InFlightRequestTable(uint32_t max_waiters, uint64_t max_buffered_bytes,
+                       RequestCoalescingStats& stats)
+      : max_waiters_(max_waiters), max_buffered_bytes_(max_buffered_bytes), stats_(stats) {}
+
+  /**
+   * Find the in-flight request for a key, or create it if there is none.
+   * @param key supplies the coalescing key.
+   * @return the request, and true if it was created, in which case the caller is its leader.
+   */
+  std::pair<InFlightRequestSharedPtr, bool> findOrCreate(const std::string& key);
+
+  /**
+   * Remove a request from the table, unless the key has since been taken by another request.
+   * Waiters that already joined the request keep their reference to it.
+   */
+  void remove(const std::string& key, const InFlightRequest& request);
+
+private:
+  const uint32_t max_waiters_;
+  const uint64_t max_buffered_bytes_;
+  RequestCoalescingStats& stats_;
+  Thread::MutexBasicLockable lock_;
+  absl::flat_hash_map<std::string, InFlightRequestSharedPtr> requests_ GUARDED_BY(lock_);
+};
+
+} // namespace RequestCoalescing
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
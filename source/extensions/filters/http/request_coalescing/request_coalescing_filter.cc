@@ -0,0 +1,298 @@
+#include "extensions/filters/http/request_coalescing/request_coalescing_filter.h"
+
+#include <algorithm>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/utility.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/headers.h"
+#include "common/protobuf/utility.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace RequestCoalescing {
+
+namespace {
+
+// Default upper bound of the response body retained for fan out.
+const uint64_t DefaultMaxBufferedBytes = 1024 * 1024;
+
+// Default upper bound of the number of requests waiting on a single upstream request.
+const uint32_t DefaultMaxWaiters = 1024;
+
+} // namespace
+
+RequestCoalescingFilterConfig::RequestCoalescingFilterConfig(
+    const envoy::config::filter::http::request_coalescing::v2alpha::RequestCoalescing& config,
+    const std::string& stats_prefix, Stats::Scope& scope)
+    : stats_(generateStats(stats_prefix + "request_coalescing.", scope)),
+      table_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_waiters, DefaultMaxWaiters),
+             PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_buffered_bytes, DefaultMaxBufferedBytes),
+             stats_) {
+  for (const auto& header : config.key_headers()) {
+    key_headers_.emplace_back(header);
+  }
+}
+
+bool RequestCoalescingFilterConfig::isKeyHeader(const std::string& header) const {
+  return std::any_of(key_headers_.begin(), key_headers_.end(),
+                     [&header](const Http::LowerCaseString& key) { return key.get() == header; });
+}
+
+RequestCoalescingFilter::RequestCoalescingFilter(
+    const RequestCoalescingFilterConfigSharedPtr& config)
+    : config_(config) {}
+
+void RequestCoalescingFilter::onDestroy() {
+  if (state_ == State::Leading) {
+    // The stream was reset before the response was complete.
+    stopLeading(false);
+  } else if (state_ == State::Waiting) {
+    stopWaiting();
+  }
+}
+
+Http::FilterHeadersStatus RequestCoalescingFilter::decodeHeaders(Http::HeaderMap& headers,
+                                                                 bool end_stream) {
+  if (!end_stream || !eligible(headers)) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  key_ = coalescingKey(headers);
+  std::pair<InFlightRequestSharedPtr, bool> result = config_->table().findOrCreate(key_);
+  if (result.second) {
+    state_ = State::Leading;
+    in_flight_ = std::move(result.first);
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  waiter_ = std::make_shared<WaiterImpl>(*this);
+  if (!result.first->addWaiter(decoder_callbacks_->dispatcher(), waiter_)) {
+    waiter_.reset();
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  ENVOY_STREAM_LOG(debug, "request coalescing: waiting for in-flight request", *decoder_callbacks_);
+  state_ = State::Waiting;
+  in_flight_ = std::move(result.first);
+  decoder_callbacks_->addDownstreamWatermarkCallbacks(watermark_callbacks_);
+  watermark_callbacks_added_ = true;
+  // Part of the response may already be available. Replay it from the dispatcher rather than from
+  // here, as the request may also have to be released upstream, which cannot be done from under
+  // decodeHeaders().
+  postResponseUpdated();
+  return Http::FilterHeadersStatus::StopIteration;
+}
+
+Http::FilterHeadersStatus RequestCoalescingFilter::encodeHeaders(Http::HeaderMap& headers,
+                                                                 bool end_stream) {
+  if (state_ != State::Leading) {
+    return Http::FilterHeadersStatus::Continue;
+  }
+
+  if (!shareable(headers)) {
+    config_->stats().response_not_shareable_.inc();
+    stopLeading(false);
+    return Http::FilterHeadersStatus::Continue;
+  }
+  in_flight_->publishHeaders(headers, end_stream);
+  if (end_stream) {
+    stopLeading(true);
+  }
+  return Http::FilterHeadersStatus::Continue;
+}
+
+Http::FilterDataStatus RequestCoalescingFilter::encodeData(Buffer::Instance& data,
+                                                           bool end_stream) {
+  if (state_ != State::Leading) {
+    return Http::FilterDataStatus::Continue;
+  }
+
+  if (!in_flight_->publishData(data, end_stream)) {
+    config_->stats().response_too_large_.inc();
+    stopLeading(false);
+  } else if (end_stream) {
+    stopLeading(true);
+  }
+  return Http::FilterDataStatus::Continue;
+}
+
+Http::FilterTrailersStatus RequestCoalescingFilter::encodeTrailers(Http::HeaderMap& trailers) {
+  if (state_ == State::Leading) {
+    in_flight_->publishTrailers(trailers);
+    stopLeading(true);
+  }
+  return Http::FilterTrailersStatus::Continue;
+}
+
+bool RequestCoalescingFilter::eligible(const Http::HeaderMap& headers) const {
+  const Http::HeaderEntry* method = headers.Method();
+  if (method == nullptr || headers.Path() == nullptr || headers.Host() == nullptr ||
+      headers.Authorization() != nullptr) {
+    return false;
+  }
+  if (method->value() != Http::Headers::get().MethodValues.Get.c_str() &&
+      method->value() != Http::Headers::get().MethodValues.Head.c_str()) {
+    return false;
+  }
+  // Cookies usually select a personalized response, so only requests that are keyed on them are
+  // coalesced.
+  return headers.get(Http::Headers::get().Cookie) == nullptr ||
+         config_->isKeyHeader(Http::Headers::get().Cookie.get());
+}
+
+bool RequestCoalescingFilter::shareable(const Http::HeaderMap& response_headers) const {
+  if (response_headers.get(Http::Headers::get().SetCookie) != nullptr) {
+    return false;
+  }
+
+  if (response_headers.CacheControl() != nullptr) {
+    const auto& values = Http::Headers::get().CacheControlValues;
+    for (const absl::string_view token : StringUtil::splitToken(
+             response_headers.CacheControl()->value().getStringView(), ",", false)) {
+      const absl::string_view directive = StringUtil::trim(StringUtil::cropRight(token, "="));
+      if (StringUtil::caseCompare(directive, values.Private) ||
+          StringUtil::caseCompare(directive, values.NoStore)) {
+        return false;
+      }
+    }
+  }
+
+  // A response may only be shared between requests that agree on every header it varies on.
+  if (response_headers.Vary() != nullptr) {
+    for (const absl::string_view token :
+         StringUtil::splitToken(response_headers.Vary()->value().getStringView(), ",", false)) {
+      const Http::LowerCaseString header{std::string(StringUtil::trim(token))};
+      if (!config_->isKeyHeader(header.get())) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+std::string RequestCoalescingFilter::coalescingKey(const Http::HeaderMap& headers) const {
+  std::string key =
+      absl::StrCat(headers.Method()->value().getStringView(), "\n",
+                   headers.Host()->value().getStringView(), "\n",
+                   headers.Path()->value().getStringView());
+  for (const Http::LowerCaseString& header : config_->keyHeaders()) {
+    const Http::HeaderEntry* entry = headers.get(header);
+    // Distinguish an absent header from an empty one.
+    if (entry == nullptr) {
+      absl::StrAppend(&key, "\n");
+    } else {
+      absl::StrAppend(&key, "\n=", entry->value().getStringView());
+    }
+  }
+  return key;
+}
+
+void RequestCoalescingFilter::postResponseUpdated() {
+  std::weak_ptr<WaiterImpl> weak_waiter = waiter_;
+  decoder_callbacks_->dispatcher().post([weak_waiter]() -> void {
+    std::shared_ptr<WaiterImpl> waiter = weak_waiter.lock();
+    if (waiter != nullptr) {
+      waiter->onResponseUpdated();
+    }
+  });
+}
+
+void RequestCoalescingFilter::onResponseUpdated() {
+  // Encoding below may push the downstream over its high watermark, or end or reset the stream,
+  // so this is checked before each step.
+  const auto blocked = [this]() -> bool {
+    return state_ != State::Waiting || end_stream_sent_ || high_watermark_count_ > 0;
+  };
+  if (blocked()) {
+    return;
+  }
+
+  const InFlightRequest::Progress progress = in_flight_->progress(headers_sent_, chunks_sent_);
+  if (progress.failed_) {
+    const bool headers_sent = headers_sent_;
+    stopWaiting();
+    if (!headers_sent) {
+      ENVOY_STREAM_LOG(debug, "request coalescing: in-flight request failed, sending upstream",
+                       *decoder_callbacks_);
+      config_->stats().rq_released_.inc();
+      decoder_callbacks_->continueDecoding();
+    } else {
+      ENVOY_STREAM_LOG(debug, "request coalescing: in-flight request failed, resetting",
+                       *decoder_callbacks_);
+      config_->stats().rq_reset_.inc();
+      decoder_callbacks_->resetStream();
+    }
+    return;
+  }
+
+  if (progress.headers_ != nullptr) {
+    headers_sent_ = true;
+    end_stream_sent_ =
+        progress.complete_ && progress.chunks_.empty() && progress.trailers_ == nullptr;
+    decoder_callbacks_->encodeHeaders(std::make_unique<Http::HeaderMapImpl>(*progress.headers_),
+                                      end_stream_sent_);
+  }
+
+  for (size_t i = 0; i < progress.chunks_.size(); i++) {
+    if (blocked()) {
+      return;
+    }
+    chunks_sent_++;
+    end_stream_sent_ =
+        progress.complete_ && i + 1 == progress.chunks_.size() && progress.trailers_ == nullptr;
+    Buffer::OwnedImpl data;
+    data.addBufferFragment(*new BodyChunkFragment(progress.chunks_[i]));
+    decoder_callbacks_->encodeData(data, end_stream_sent_);
+  }
+
+  if (progress.trailers_ != nullptr && !blocked()) {
+    end_stream_sent_ = true;
+    decoder_callbacks_->encodeTrailers(std::make_unique<Http::HeaderMapImpl>(*progress.trailers_));
+  }
+}
+
+void RequestCoalescingFilter::stopWaiting() {
+  ASSERT(state_ == State::Waiting);
+  if (watermark_callbacks_added_) {
+    decoder_callbacks_->removeDownstreamWatermarkCallbacks(watermark_callbacks_);
+    watermark_callbacks_added_ = false;
+  }
+  in_flight_->removeWaiter(*waiter_);
+  in_flight_.reset();
+  waiter_.reset();
+  state_ = State::Bypass;
+}
+
+void RequestCoalescingFilter::stopLeading(bool complete) {
+  ASSERT(state_ == State::Leading);
+  // Remove the request first so that new requests are not attached to a failed request.
+  config_->table().remove(key_, *in_flight_);
+  if (!complete) {
+    in_flight_->fail();
+  }
+  in_flight_.reset();
+  state_ = State::Bypass;
+}
+
+void RequestCoalescingFilter::WatermarkCallbacks::onAboveWriteBufferHighWatermark() {
+  parent_.high_watermark_count_++;
+}
+
+void RequestCoalescingFilter::WatermarkCallbacks::onBelowWriteBufferLowWatermark() {
+  ASSERT(parent_.high_watermark_count_ > 0);
+  if (--parent_.high_watermark_count_ == 0) {
+    // Resume from the dispatcher, as the stream may end while replaying, and watermark callbacks
+    // must not be removed from under their own stack.
+    parent_.postResponseUpdated();
+  }
+}
+
+} // namespace RequestCoalescing
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/config/filter/http/request_coalescing/v2alpha/request_coalescing.pb.h"
+#include "envoy/http/codec.h"
+#include "envoy/http/filter.h"
+#include "envoy/stats/scope.h"
+
+#include "common/common/logger.h"
+
+#include "extensions/filters/http/request_coalescing/in_flight_request.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace RequestCoalescing {
+
+/**
+ * Configuration for the request coalescing filter. The in-flight request table is owned by the
+ * config and is therefore shared by all workers.
+ */
+class RequestCoalescingFilterConfig {
+public:
+  RequestCoalescingFilterConfig(
+      const envoy::config::filter::http::request_coalescing::v2alpha::RequestCoalescing& config,
+      const std::string& stats_prefix, Stats::Scope& scope);
+
+  InFlightRequestTable& table() { return table_; }
+  RequestCoalescingStats& stats() { return stats_; }
+  const std::vector<Http::LowerCaseString>& keyHeaders() const { return key_headers_; }
+
+  /**
+   * @param header supplies a lower cased request header name.
+   * @return true if the header is part of the coalescing key.
+   */
+  bool isKeyHeader(const std::string& header) const;
+
+private:
+  static RequestCoalescingStats generateStats(const std::string& prefix, Stats::Scope& scope) {
+    return RequestCoalescingStats{ALL_REQUEST_COALESCING_STATS(POOL_COUNTER_PREFIX(scope, prefix),
+                                                               POOL_GAUGE_PREFIX(scope, prefix))};
+  }
+
+  RequestCoalescingStats stats_;
+  std::vector<Http::LowerCaseString> key_headers_;
+  InFlightRequestTable table_;
+};
+typedef std::shared_ptr<RequestCoalescingFilterConfig> RequestCoalescingFilterConfigSharedPtr;
+
+/**
+ * A filter that collapses identical concurrent GET and HEAD requests into a single upstream
+ * request. The first request for a key is forwarded as usual and its response is fanned out to
+ * the requests that arrive while it is in flight, each of which is answered directly from
+ * decodeHeaders() at the pace of its own downstream connection.
+ */
+class RequestCoalescingFilter : public Http::StreamFilter,
+                                Logger::Loggable<Logger::Id::filter> {
+public:
+  RequestCoalescingFilter(const RequestCoalescingFilterConfigSharedPtr& config);
+
+  // Http::StreamFilterBase
+  void onDestroy() override;
+
+  // Http::StreamDecoderFilter
+  Http::FilterHeadersStatus decodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus decodeData(Buffer::Instance&, bool) override {
+    return Http::FilterDataStatus::Continue;
+  }
+  Http::FilterTrailersStatus decodeTrailers(Http::HeaderMap&) override {
+    return Http::FilterTrailersStatus::Continue;
+  }
+  void setDecoderFilterCallbacks(Http::StreamDecoderFilterCallbacks& callbacks) override {
+    decoder_callbacks_ = &callbacks;
+  }
+
+  // Http::StreamEncoderFilter
+  Http::FilterHeadersStatus encode100ContinueHeaders(Http::HeaderMap&) override {
+    return Http::FilterHeadersStatus::Continue;
+  }
+  Http::FilterHeadersStatus encodeHeaders(Http::HeaderMap& headers, bool end_stream) override;
+  Http::FilterDataStatus encodeData(Buffer::Instance& data, bool end_stream) override;
+  Http::FilterTrailersStatus encodeTrailers(Http::HeaderMap& trailers) override;
+  void setEncoderFilterCallbacks(Http::StreamEncoderFilterCallbacks&) override {}
+
+private:
+  enum class State {
+    // The request is not coalesced; the filter is a pass-through.
+    Bypass,
+    // The request was sent upstream and its response is published to waiting requests.
+    Leading,
+    // The request is answered with the response to another request.
+    Waiting,
+  };
+
+  /**
+   * Forwards notifications to the filter. It is owned by the filter and only weakly referenced
+   * by the in-flight request, so posted notifications are dropped once the filter is destroyed.
+   */
+  class WaiterImpl : public InFlightRequest::Waiter {
+  public:
+    WaiterImpl(RequestCoalescingFilter& parent) : parent_(parent) {}
+
+    // InFlightRequest::Waiter
+    void onResponseUpdated() override { parent_.onResponseUpdated(); }
+
+  private:
+    RequestCoalescingFilter& parent_;
+  };
+
+  /**
+   * Pauses replaying the response while the downstream is above its write buffer high watermark.
+   */
+  class WatermarkCallbacks : public Http::DownstreamWatermarkCallbacks {
+  public:
+    WatermarkCallbacks(RequestCoalescingFilter& parent) : parent_(parent) {}
+
+    // Http::DownstreamWatermarkCallbacks
+    void onAboveWriteBufferHighWatermark() override;
+    void onBelowWriteBufferLowWatermark() override;
+
+  private:
+    RequestCoalescingFilter& parent_;
+  };
+
+  bool eligible(const Http::HeaderMap& headers) const;
+  bool shareable(const Http::HeaderMap& response_headers) const;
+  std::string coalescingKey(const Http::HeaderMap& headers) const;
+  void postResponseUpdated();
+  void onResponseUpdated();
+  void stopWaiting();
+  void stopLeading(bool complete);
+
+  RequestCoalescingFilterConfigSharedPtr config_;
+  State state_{State::Bypass};
+  std::string key_;
+  InFlightRequestSharedPtr in_flight_;
+
+  // Waiting state.
+  std::shared_ptr<WaiterImpl> waiter_;
+  WatermarkCallbacks watermark_callbacks_{*this};
+  bool watermark_callbacks_added_{};
+  uint32_t high_watermark_count_{};
+  bool headers_sent_{};
+  uint64_t chunks_sent_{};
+  bool end_stream_sent_{};
+
+  Http::StreamDecoderFilterCallbacks* decoder_callbacks_{};
+};
+
+} // namespace RequestCoalescing
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -14,8 +14,14 @@ class HttpFilterNameValues {
 public:
   // Buffer filter
   const std::string Buffer = "envoy.buffer";
+  // HTTP cache filter
+  const std::string Cache = "envoy.filters.http.cache";
+  // Compressor filter
+  const std::string Compressor = "envoy.filters.http.compressor";
   // CORS filter
   const std::string Cors = "envoy.cors";
+  // Decompressor filter
+  const std::string Decompressor = "envoy.filters.http.decompressor";
   // Dynamo filter
   const std::string Dynamo = "envoy.http_dynamo_filter";
   // Fault filter
@@ -48,6 +54,8 @@ public:
   const std::string JwtAuthn = "envoy.filters.http.jwt_authn";
   // Header to metadata filter
   const std::string HeaderToMetadata = "envoy.filters.http.header_to_metadata";
+  // Request coalescing filter
+  const std::string RequestCoalescing = "envoy.filters.http.request_coalescing";
 
   // Converts names from v1 to v2
   const Config::V1Converter v1_converter_;
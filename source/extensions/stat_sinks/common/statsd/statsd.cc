@@ -20,7 +20,8 @@ namespace StatSinks {
 namespace Common {
 namespace Statsd {
 
-Writer::Writer(Network::Address::InstanceConstSharedPtr address) {
+Writer::Writer(Network::Address::InstanceConstSharedPtr address, uint64_t max_bytes_per_datagram)
+    : max_bytes_per_datagram_(max_bytes_per_datagram) {
   fd_ = address->socket(Network::Address::SocketType::Datagram);
   ASSERT(fd_ != -1);
 
@@ -38,40 +39,121 @@ void Writer::write(const std::string& message) {
   ::send(fd_, message.c_str(), message.size(), MSG_DONTWAIT);
 }
 
+void Writer::buffer(const std::string& message) {
+  if (max_bytes_per_datagram_ == 0) {
+    write(message);
+    return;
+  }
+  // A message that does not fit in a datagram with others is sent in a datagram of its own.
+  if (!current_datagram_.empty() &&
+      current_datagram_.size() + 1 + message.size() > max_bytes_per_datagram_) {
+    datagrams_.push_back(std::move(current_datagram_));
+    current_datagram_.clear();
+    if (datagrams_.size() == MaxBatchDatagrams) {
+      writeBuffered();
+    }
+  }
+  if (!current_datagram_.empty()) {
+    current_datagram_.push_back('\n');
+  }
+  current_datagram_.append(message);
+}
+
+void Writer::flush() {
+  if (!current_datagram_.empty()) {
+    datagrams_.push_back(std::move(current_datagram_));
+    current_datagram_.clear();
+  }
+  writeBuffered();
+}
+
+void Writer::writeBuffered() {
+  if (!datagrams_.empty()) {
+    writeBatch(datagrams_);
+    datagrams_.clear();
+  }
+}
+
+void Writer::writeBatch(const std::vector<std::string>& datagrams) {
+#if defined(__linux__)
+  // Write the datagrams with one system call per batch rather than one per datagram. As with
+  // write(), datagrams that the socket cannot take without blocking are dropped.
+  std::vector<struct iovec> iovecs(datagrams.size());
+  std::vector<struct mmsghdr> messages(datagrams.size());
+  for (size_t i = 0; i < datagrams.size(); ++i) {
+    iovecs[i].iov_base = const_cast<char*>(datagrams[i].data());
+    iovecs[i].iov_len = datagrams[i].size();
+    messages[i] = {};
+    messages[i].msg_hdr.msg_iov = &iovecs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+  }
+  size_t sent = 0;
+  while (sent < messages.size()) {
+    const int rc = ::sendmmsg(fd_, messages.data() + sent, messages.size() - sent, MSG_DONTWAIT);
+    if (rc <= 0) {
+      break;
+    }
+    sent += rc;
+  }
+#else
+  for (const std::string& datagram : datagrams) {
+    write(datagram);
+  }
+#endif
+}
+
 UdpStatsdSink::UdpStatsdSink(ThreadLocal::SlotAllocator& tls,
                              Network::Address::InstanceConstSharedPtr address, const bool use_tag,
-                             const std::string& prefix)
+                             const std::string& prefix, uint64_t max_bytes_per_datagram,
+                             bool batch_histogram_samples)
     : tls_(tls.allocateSlot()), server_address_(std::move(address)), use_tag_(use_tag),
-      prefix_(prefix.empty() ? Statsd::getDefaultPrefix() : prefix) {
-  tls_->set([this](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
-    return std::make_shared<Writer>(this->server_address_);
+      prefix_(prefix.empty() ? Statsd::getDefaultPrefix() : prefix),
+      max_bytes_per_datagram_(max_bytes_per_datagram),
+      batch_histogram_samples_(batch_histogram_samples) {
+  tls_->set([address = server_address_, max_bytes_per_datagram](
+                Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+    return std::make_shared<Writer>(address, max_bytes_per_datagram);
   });
 }
 
 void UdpStatsdSink::flush(Stats::Source& source) {
   Writer& writer = tls_->getTyped<Writer>();
-  for (const Stats::CounterSharedPtr& counter : source.cachedCounters()) {
+  for (const Stats::CounterSharedPtr& counter : source.cachedChangedCounters()) {
     if (counter->used()) {
       uint64_t delta = counter->latch();
-      writer.write(fmt::format("{}.{}:{}|c{}", prefix_, getName(*counter), delta,
-                               buildTagStr(counter->tags())));
+      writer.buffer(fmt::format("{}.{}:{}|c{}", prefix_, getName(*counter), delta,
+                                buildTagStr(*counter)));
     }
   }
 
-  for (const Stats::GaugeSharedPtr& gauge : source.cachedGauges()) {
+  for (const Stats::GaugeSharedPtr& gauge : source.cachedChangedGauges()) {
     if (gauge->used()) {
-      writer.write(fmt::format("{}.{}:{}|g{}", prefix_, getName(*gauge), gauge->value(),
-                               buildTagStr(gauge->tags())));
+      writer.buffer(fmt::format("{}.{}:{}|g{}", prefix_, getName(*gauge), gauge->value(),
+                                buildTagStr(*gauge)));
     }
   }
+
+  if (batch_histogram_samples_) {
+    // Also writes the histogram samples buffered on this thread. The callback is only handed the
+    // writer of each thread, as the sink may be destroyed before it runs on the workers.
+    tls_->runOnAllThreads([](ThreadLocal::ThreadLocalObject& writer) -> void {
+      dynamic_cast<Writer&>(writer).flush();
+    });
+  } else {
+    writer.flush();
+  }
 }
 
 void UdpStatsdSink::onHistogramComplete(const Stats::Histogram& histogram, uint64_t value) {
   // For statsd histograms are all timers.
   const std::string message(fmt::format("{}.{}:{}|ms{}", prefix_, getName(histogram),
                                         std::chrono::milliseconds(value).count(),
-                                        buildTagStr(histogram.tags())));
-  tls_->getTyped<Writer>().write(message);
+                                        buildTagStr(histogram)));
+  if (batch_histogram_samples_) {
+    tls_->getTyped<Writer>().buffer(message);
+  } else {
+    tls_->getTyped<Writer>().write(message);
+  }
 }
 
 const std::string UdpStatsdSink::getName(const Stats::Metric& metric) {
@@ -82,8 +164,14 @@ const std::string UdpStatsdSink::getName(const Stats::Metric& metric) {
   }
 }
 
-const std::string UdpStatsdSink::buildTagStr(const std::vector<Stats::Tag>& tags) {
-  if (!use_tag_ || tags.empty()) {
+const std::string UdpStatsdSink::buildTagStr(const Stats::Metric& metric) {
+  // The tags are decoded from the symbol table of the store under its lock, and this is called for
+  // every histogram sample on every worker, so they are only read when they are sent.
+  if (!use_tag_) {
+    return "";
+  }
+  const std::vector<Stats::Tag> tags = metric.tags();
+  if (tags.empty()) {
     return "";
   }
 
@@ -113,13 +201,13 @@ TcpStatsdSink::TcpStatsdSink(const LocalInfo::LocalInfo& local_info,
 void TcpStatsdSink::flush(Stats::Source& source) {
   TlsSink& tls_sink = tls_->getTyped<TlsSink>();
   tls_sink.beginFlush(true);
-  for (const Stats::CounterSharedPtr& counter : source.cachedCounters()) {
+  for (const Stats::CounterSharedPtr& counter : source.cachedChangedCounters()) {
     if (counter->used()) {
       tls_sink.flushCounter(counter->name(), counter->latch());
     }
   }
 
-  for (const Stats::GaugeSharedPtr& gauge : source.cachedGauges()) {
+  for (const Stats::GaugeSharedPtr& gauge : source.cachedChangedGauges()) {
     if (gauge->used()) {
       tls_sink.flushGauge(gauge->name(), gauge->value());
     }
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "envoy/local_info/local_info.h"
 #include "envoy/network/connection.h"
 #include "envoy/stats/histogram.h"
@@ -23,21 +26,59 @@ namespace Statsd {
 static const std::string& getDefaultPrefix() { CONSTRUCT_ON_FIRST_USE(std::string, "envoy"); }
 
 /**
- * This is a simple UDP localhost writer for statsd messages.
+ * This is a simple UDP localhost writer for statsd messages. Messages are either written in a
+ * datagram of their own, or buffered and packed into newline separated datagrams that are written
+ * in batches.
  */
 class Writer : public ThreadLocal::ThreadLocalObject {
 public:
-  Writer(Network::Address::InstanceConstSharedPtr address);
+  /**
+   * @param max_bytes_per_datagram supplies the size that buffered messages are packed into
+   *        datagrams up to. 0 disables buffering, so that each message is written as it is
+   *        buffered.
+   */
+  Writer(Network::Address::InstanceConstSharedPtr address, uint64_t max_bytes_per_datagram = 0);
   // For testing.
-  Writer() : fd_(-1) {}
+  explicit Writer(uint64_t max_bytes_per_datagram = 0)
+      : fd_(-1), max_bytes_per_datagram_(max_bytes_per_datagram) {}
   virtual ~Writer();
 
+  /**
+   * Writes a message in a datagram of its own.
+   */
   virtual void write(const std::string& message);
+
+  /**
+   * Buffers a message. Full datagrams are written once MaxBatchDatagrams of them are buffered, and
+   * the others by flush().
+   */
+  void buffer(const std::string& message);
+
+  /**
+   * Writes all buffered messages.
+   */
+  void flush();
+
   // Called in unit test to validate address.
   int getFdForTests() const { return fd_; };
 
+  // The number of datagrams written by a single sendmmsg(2) call.
+  static constexpr uint32_t MaxBatchDatagrams = 64;
+
+protected:
+  /**
+   * Writes each of the datagrams.
+   */
+  virtual void writeBatch(const std::vector<std::string>& datagrams);
+
 private:
+  void writeBuffered();
+
   int fd_;
+  const uint64_t max_bytes_per_datagram_;
+  // The datagram being filled and the full ones, which are written by writeBuffered().
+  std::string current_datagram_;
+  std::vector<std::string> datagrams_;
 };
 
 /**
@@ -45,13 +86,22 @@ private:
  */
 class UdpStatsdSink : public Stats::Sink {
 public:
+  /**
+   * @param max_bytes_per_datagram supplies the size that flushed counters and gauges are packed
+   *        into datagrams up to. 0 writes each of them in a datagram of its own.
+   * @param batch_histogram_samples supplies whether the histogram samples recorded on each thread
+   *        are buffered until the next flush, instead of being written as they are recorded.
+   */
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, Network::Address::InstanceConstSharedPtr address,
-                const bool use_tag, const std::string& prefix = getDefaultPrefix());
+                const bool use_tag, const std::string& prefix = getDefaultPrefix(),
+                uint64_t max_bytes_per_datagram = 0, bool batch_histogram_samples = false);
   // For testing.
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, const std::shared_ptr<Writer>& writer,
-                const bool use_tag, const std::string& prefix = getDefaultPrefix())
+                const bool use_tag, const std::string& prefix = getDefaultPrefix(),
+                bool batch_histogram_samples = false)
       : tls_(tls.allocateSlot()), use_tag_(use_tag),
-        prefix_(prefix.empty() ? getDefaultPrefix() : prefix) {
+        prefix_(prefix.empty() ? getDefaultPrefix() : prefix), max_bytes_per_datagram_(0),
+        batch_histogram_samples_(batch_histogram_samples) {
     tls_->set(
         [writer](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr { return writer; });
   }
@@ -67,13 +117,15 @@ public:
 
 private:
   const std::string getName(const Stats::Metric& metric);
-  const std::string buildTagStr(const std::vector<Stats::Tag>& tags);
+  const std::string buildTagStr(const Stats::Metric& metric);
 
   ThreadLocal::SlotPtr tls_;
   Network::Address::InstanceConstSharedPtr server_address_;
   const bool use_tag_;
   // Prefix for all flushed stats.
   const std::string prefix_;
+  const uint64_t max_bytes_per_datagram_;
+  const bool batch_histogram_samples_;
 };
 
 /**
@@ -61,31 +61,54 @@ void MetricsServiceSink::flushGauge(const Stats::Gauge& gauge) {
   gauage_metric->set_value(gauge.value());
 }
 void MetricsServiceSink::flushHistogram(const Stats::ParentHistogram& histogram) {
-  io::prometheus::client::MetricFamily* metrics_family = message_.add_envoy_metrics();
-  metrics_family->set_type(io::prometheus::client::MetricType::SUMMARY);
-  metrics_family->set_name(histogram.name());
-  auto* metric = metrics_family->add_metric();
-  metric->set_timestamp_ms(std::chrono::duration_cast<std::chrono::milliseconds>(
-                               time_system_.systemTime().time_since_epoch())
-                               .count());
-  auto* summary_metric = metric->mutable_summary();
-  const Stats::HistogramStatistics& hist_stats = histogram.intervalStatistics();
-  for (size_t i = 0; i < hist_stats.supportedQuantiles().size(); i++) {
-    auto* quantile = summary_metric->add_quantile();
-    quantile->set_quantile(hist_stats.supportedQuantiles()[i]);
-    quantile->set_value(hist_stats.computedQuantiles()[i]);
+  const int64_t timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   time_system_.systemTime().time_since_epoch())
+                                   .count();
+
+  // The quantiles of the flush interval are sent as a summary.
+  io::prometheus::client::MetricFamily* summary_family = message_.add_envoy_metrics();
+  summary_family->set_type(io::prometheus::client::MetricType::SUMMARY);
+  summary_family->set_name(histogram.name());
+  auto* summary_metric = summary_family->add_metric();
+  summary_metric->set_timestamp_ms(timestamp_ms);
+  auto* summary = summary_metric->mutable_summary();
+  const Stats::HistogramStatistics& interval_stats = histogram.intervalStatistics();
+  for (size_t i = 0; i < interval_stats.supportedQuantiles().size(); i++) {
+    auto* quantile = summary->add_quantile();
+    quantile->set_quantile(interval_stats.supportedQuantiles()[i]);
+    quantile->set_value(interval_stats.computedQuantiles()[i]);
+  }
+  summary->set_sample_count(interval_stats.sampleCount());
+  summary->set_sample_sum(interval_stats.sampleSum());
+
+  // The cumulative bucket counts are sent as a histogram, which, unlike quantiles, can be
+  // aggregated across proxies. Its name is suffixed so that it does not clash with the summary's.
+  io::prometheus::client::MetricFamily* histogram_family = message_.add_envoy_metrics();
+  histogram_family->set_type(io::prometheus::client::MetricType::HISTOGRAM);
+  histogram_family->set_name(histogram.name() + "_bucket");
+  auto* histogram_metric = histogram_family->add_metric();
+  histogram_metric->set_timestamp_ms(timestamp_ms);
+  auto* buckets = histogram_metric->mutable_histogram();
+  const Stats::HistogramStatistics& cumulative_stats = histogram.cumulativeStatistics();
+  for (size_t i = 0; i < cumulative_stats.supportedBuckets().size(); i++) {
+    auto* bucket = buckets->add_bucket();
+    bucket->set_upper_bound(cumulative_stats.supportedBuckets()[i]);
+    bucket->set_cumulative_count(cumulative_stats.computedBuckets()[i]);
   }
+  buckets->set_sample_count(cumulative_stats.sampleCount());
+  buckets->set_sample_sum(cumulative_stats.sampleSum());
 }
 
 void MetricsServiceSink::flush(Stats::Source& source) {
   message_.clear_envoy_metrics();
-  const std::vector<Stats::CounterSharedPtr>& counters = source.cachedCounters();
-  const std::vector<Stats::GaugeSharedPtr>& gauges = source.cachedGauges();
+  const std::vector<Stats::CounterSharedPtr>& counters = source.cachedChangedCounters();
+  const std::vector<Stats::GaugeSharedPtr>& gauges = source.cachedChangedGauges();
   const std::vector<Stats::ParentHistogramSharedPtr>& histograms = source.cachedHistograms();
   // TODO(mrice32): there's probably some more sophisticated preallocation we can do here where we
   // actually preallocate the submessages and then pass ownership to the proto (rather than just
   // preallocating the pointer array).
-  message_.mutable_envoy_metrics()->Reserve(counters.size() + gauges.size() + histograms.size());
+  message_.mutable_envoy_metrics()->Reserve(counters.size() + gauges.size() +
+                                            2 * histograms.size());
   for (const Stats::CounterSharedPtr& counter : counters) {
     if (counter->used()) {
       flushCounter(*counter);
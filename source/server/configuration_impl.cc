@@ -72,6 +72,8 @@ void MainImpl::initialize(const envoy::config::bootstrap::v2::Bootstrap& bootstr
 
   stats_flush_interval_ =
       std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(bootstrap, stats_flush_interval, 5000));
+  stats_full_flush_interval_ = std::chrono::milliseconds(
+      PROTOBUF_GET_MS_OR_DEFAULT(bootstrap, stats_full_flush_interval, 0));
 
   const auto& watchdog = bootstrap.watchdog();
   watchdog_miss_timeout_ =
@@ -19,8 +19,6 @@
 #include "common/common/lock_guard.h"
 #include "common/common/utility.h"
 #include "common/network/utility.h"
-#include "common/stats/raw_stat_data.h"
-#include "common/stats/stats_options_impl.h"
 
 #include "absl/strings/string_view.h"
 
@@ -29,22 +27,12 @@ namespace Server {
 
 // Increment this whenever there is a shared memory / RPC change that will prevent a hot restart
 // from working. Operations code can then cope with this and do a full restart.
-const uint64_t SharedMemory::VERSION = 10;
+const uint64_t SharedMemory::VERSION = 11;
 
-static BlockMemoryHashSetOptions blockMemHashOptions(uint64_t max_stats) {
-  BlockMemoryHashSetOptions hash_set_options;
-  hash_set_options.capacity = max_stats;
-
-  // https://stackoverflow.com/questions/3980117/hash-table-why-size-should-be-prime
-  hash_set_options.num_slots = Primes::findPrimeLargerThan(hash_set_options.capacity / 2);
-  return hash_set_options;
-}
-
-SharedMemory& SharedMemory::initialize(uint64_t stats_set_size, Options& options) {
+SharedMemory& SharedMemory::initialize(Options& options) {
   Api::OsSysCalls& os_sys_calls = Api::OsSysCallsSingleton::get();
 
-  const uint64_t entry_size = Stats::RawStatData::structSizeWithOptions(options.statsOptions());
-  const uint64_t total_size = sizeof(SharedMemory) + stats_set_size;
+  const uint64_t total_size = sizeof(SharedMemory);
 
   int flags = O_RDWR;
   const std::string shmem_name = fmt::format("/envoy_shared_memory_{}", options.baseId());
@@ -77,24 +65,14 @@ SharedMemory& SharedMemory::initialize(uint64_t stats_set_size, Options& options
   if (options.restartEpoch() == 0) {
     shmem->size_ = total_size;
     shmem->version_ = VERSION;
-    shmem->max_stats_ = options.maxStats();
-    shmem->entry_size_ = entry_size;
     shmem->initializeMutex(shmem->log_lock_);
     shmem->initializeMutex(shmem->access_log_lock_);
-    shmem->initializeMutex(shmem->stat_lock_);
     shmem->initializeMutex(shmem->init_lock_);
   } else {
     RELEASE_ASSERT(shmem->size_ == total_size, "");
     RELEASE_ASSERT(shmem->version_ == VERSION, "");
-    RELEASE_ASSERT(shmem->max_stats_ == options.maxStats(), "");
-    RELEASE_ASSERT(shmem->entry_size_ == entry_size, "");
   }
 
-  // Stats::RawStatData must be naturally aligned for atomics to work properly.
-  RELEASE_ASSERT(
-      (reinterpret_cast<uintptr_t>(shmem->stats_set_data_) % alignof(Stats::RawStatDataSet)) == 0,
-      "");
-
   // Here we catch the case where a new Envoy starts up when the current Envoy has not yet fully
   // initialized. The startup logic is quite complicated, and it's not worth trying to handle this
   // in a finer way. This will cause the startup to fail with an error code early, without
@@ -116,28 +94,11 @@ void SharedMemory::initializeMutex(pthread_mutex_t& mutex) {
   pthread_mutex_init(&mutex, &attribute);
 }
 
-std::string SharedMemory::version(uint64_t max_num_stats,
-                                  const Stats::StatsOptions& stats_options) {
-  return fmt::format("{}.{}.{}.{}", VERSION, sizeof(SharedMemory), max_num_stats,
-                     stats_options.maxNameLength());
-}
+std::string SharedMemory::version() { return fmt::format("{}.{}", VERSION, sizeof(SharedMemory)); }
 
 HotRestartImpl::HotRestartImpl(Options& options)
-    : options_(options), stats_set_options_(blockMemHashOptions(options.maxStats())),
-      shmem_(SharedMemory::initialize(
-          Stats::RawStatDataSet::numBytes(stats_set_options_, options_.statsOptions()), options_)),
-      log_lock_(shmem_.log_lock_), access_log_lock_(shmem_.access_log_lock_),
-      stat_lock_(shmem_.stat_lock_), init_lock_(shmem_.init_lock_) {
-  {
-    // We must hold the stat lock when attaching to an existing memory segment
-    // because it might be actively written to while we sanityCheck it.
-    Thread::LockGuard lock(stat_lock_);
-    stats_set_ =
-        std::make_unique<Stats::RawStatDataSet>(stats_set_options_, options.restartEpoch() == 0,
-                                                shmem_.stats_set_data_, options_.statsOptions());
-  }
-  stats_allocator_ = std::make_unique<Stats::RawStatDataAllocator>(stat_lock_, *stats_set_,
-                                                                   options_.statsOptions());
+    : options_(options), shmem_(SharedMemory::initialize(options_)), log_lock_(shmem_.log_lock_),
+      access_log_lock_(shmem_.access_log_lock_), init_lock_(shmem_.init_lock_) {
   my_domain_socket_ = bindDomainSocket(options.restartEpoch());
   child_address_ = createDomainSocketAddress((options.restartEpoch() + 1));
   initDomainSocketAddress(&parent_address_);
@@ -243,6 +204,44 @@ void HotRestartImpl::getParentStats(GetParentStatsInfo& info) {
   RpcGetStatsReply* reply = receiveTypedRpc<RpcGetStatsReply, RpcMessageType::GetStatsReply>();
   info.memory_allocated_ = reply->memory_allocated_;
   info.num_connections_ = reply->num_connections_;
+  receiveStatsValues();
+}
+
+void HotRestartImpl::receiveStatsValues() {
+  while (true) {
+    RpcBase* base_message = receiveRpc(true);
+    RELEASE_ASSERT(base_message->type_ == RpcMessageType::StatsValues, "");
+    RELEASE_ASSERT(base_message->length_ >= RpcStatsValues::HEADER_LENGTH, "");
+    const RpcStatsValues* rpc = reinterpret_cast<RpcStatsValues*>(base_message);
+
+    const uint64_t data_length = rpc->length_ - RpcStatsValues::HEADER_LENGTH;
+    uint64_t offset = 0;
+    while (offset < data_length) {
+      RELEASE_ASSERT(offset + sizeof(StatsValueHeader) <= data_length, "");
+      StatsValueHeader header;
+      memcpy(&header, rpc->data_ + offset, sizeof(header));
+      offset += sizeof(header);
+      RELEASE_ASSERT(offset + header.name_length_ <= data_length, "");
+      const std::string name(reinterpret_cast<const char*>(rpc->data_ + offset),
+                             header.name_length_);
+      offset += header.name_length_;
+
+      switch (header.type_) {
+      case StatsValueType::CounterDelta:
+        stat_merger_->mergeCounter(name, header.value_);
+        break;
+      case StatsValueType::GaugeValue:
+        stat_merger_->mergeGauge(name, header.value_);
+        break;
+      default:
+        RELEASE_ASSERT(false, "");
+      }
+    }
+
+    if (rpc->last_) {
+      return;
+    }
+  }
 }
 
 void HotRestartImpl::initialize(Event::Dispatcher& dispatcher, Server::Instance& server) {
@@ -254,6 +253,7 @@ void HotRestartImpl::initialize(Event::Dispatcher& dispatcher, Server::Instance&
                                  },
                                  Event::FileTriggerType::Edge, Event::FileReadyType::Read);
   server_ = &server;
+  stat_merger_ = std::make_unique<Stats::StatMerger>(server.stats());
 }
 
 HotRestartImpl::RpcBase* HotRestartImpl::receiveRpc(bool block) {
@@ -329,6 +329,59 @@ void HotRestartImpl::sendMessage(sockaddr_un& address, RpcBase& rpc) {
   RELEASE_ASSERT(rc != -1, "");
 }
 
+void HotRestartImpl::sendStatsValues() {
+  // The values may take many messages. Block while sending them so that a child reading them
+  // slower than we send them throttles us rather than overflowing the socket.
+  int rc = fcntl(my_domain_socket_, F_SETFL, 0);
+  RELEASE_ASSERT(rc != -1, "");
+
+  RpcStatsValues rpc;
+  uint64_t data_length = 0;
+  auto add_value = [this, &rpc, &data_length](StatsValueType type, const std::string& name,
+                                              uint64_t value) {
+    const uint64_t value_length = sizeof(StatsValueHeader) + name.size();
+    if (value_length > sizeof(rpc.data_)) {
+      ENVOY_LOG(warn, "not sending stat '{}' to the child: its name is too long", name);
+      return;
+    }
+    if (data_length + value_length > sizeof(rpc.data_)) {
+      rpc.length_ = RpcStatsValues::HEADER_LENGTH + data_length;
+      sendMessage(child_address_, rpc);
+      data_length = 0;
+    }
+
+    StatsValueHeader header;
+    header.type_ = type;
+    header.value_ = value;
+    header.name_length_ = name.size();
+    memcpy(rpc.data_ + data_length, &header, sizeof(header));
+    memcpy(rpc.data_ + data_length + sizeof(header), name.data(), name.size());
+    data_length += value_length;
+  };
+
+  // We no longer flush stats to sinks once our admin has been shut down, so the child takes over
+  // the increments latched here and flushes them as its own.
+  for (const Stats::CounterSharedPtr& counter : server_->stats().counters()) {
+    const uint64_t delta = counter->latch();
+    if (delta > 0) {
+      add_value(StatsValueType::CounterDelta, counter->name(), delta);
+    }
+  }
+  // A gauge that was set() holds a value of our own, such as our uptime, which the child has too.
+  for (const Stats::GaugeSharedPtr& gauge : server_->stats().gauges()) {
+    if (gauge->used() && !gauge->wasSet()) {
+      add_value(StatsValueType::GaugeValue, gauge->name(), gauge->value());
+    }
+  }
+
+  rpc.last_ = 1;
+  rpc.length_ = RpcStatsValues::HEADER_LENGTH + data_length;
+  sendMessage(child_address_, rpc);
+
+  rc = fcntl(my_domain_socket_, F_SETFL, O_NONBLOCK);
+  RELEASE_ASSERT(rc != -1, "");
+}
+
 void HotRestartImpl::onGetListenSocket(RpcGetListenSocketRequest& rpc) {
   RpcGetListenSocketReply reply;
   reply.fd_ = -1;
@@ -403,6 +456,7 @@ void HotRestartImpl::onSocketEvent() {
       rpc.memory_allocated_ = info.memory_allocated_;
       rpc.num_connections_ = info.num_connections_;
       sendMessage(child_address_, rpc);
+      sendStatsValues();
       break;
     }
 
@@ -448,37 +502,19 @@ void HotRestartImpl::terminateParent() {
   RpcBase rpc(RpcMessageType::TerminateRequest);
   sendMessage(parent_address_, rpc);
   parent_terminated_ = true;
-}
-
-void HotRestartImpl::shutdown() { socket_event_.reset(); }
 
-std::string HotRestartImpl::version() {
-  Thread::LockGuard lock(stat_lock_);
-  return versionHelper(shmem_.maxStats(), options_.statsOptions(), *stats_set_);
+  // The parent's connections and requests go away with it.
+  if (stat_merger_ != nullptr) {
+    stat_merger_->removeParentGauges();
+  }
 }
 
-// Called from envoy --hot-restart-version -- needs to instantiate a RawStatDataSet so it
-// can generate the version string.
-std::string HotRestartImpl::hotRestartVersion(uint64_t max_num_stats, uint64_t max_stat_name_len) {
-  Stats::StatsOptionsImpl stats_options;
-  stats_options.max_obj_name_length_ = max_stat_name_len - stats_options.maxStatSuffixLength();
-
-  const BlockMemoryHashSetOptions hash_set_options = blockMemHashOptions(max_num_stats);
-  const uint64_t bytes = Stats::RawStatDataSet::numBytes(hash_set_options, stats_options);
-  std::unique_ptr<uint8_t[]> mem_buffer_for_dry_run_(new uint8_t[bytes]);
-
-  Stats::RawStatDataSet stats_set(hash_set_options, true /* init */, mem_buffer_for_dry_run_.get(),
-                                  stats_options);
+void HotRestartImpl::shutdown() { socket_event_.reset(); }
 
-  return versionHelper(max_num_stats, stats_options, stats_set);
-}
+std::string HotRestartImpl::version() { return SharedMemory::version(); }
 
-std::string HotRestartImpl::versionHelper(uint64_t max_num_stats,
-                                          const Stats::StatsOptions& stats_options,
-                                          Stats::RawStatDataSet& stats_set) {
-  return SharedMemory::version(max_num_stats, stats_options) + "." +
-         stats_set.version(stats_options);
-}
+// Called from envoy --hot-restart-version.
+std::string HotRestartImpl::hotRestartVersion() { return SharedMemory::version(); }
 
 } // namespace Server
 } // namespace Envoy
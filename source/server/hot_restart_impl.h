@@ -11,35 +11,32 @@
 #include "envoy/common/platform.h"
 #include "envoy/server/hot_restart.h"
 #include "envoy/server/options.h"
-#include "envoy/stats/stats_options.h"
 
 #include "common/common/assert.h"
-#include "common/stats/raw_stat_data.h"
+#include "common/stats/heap_stat_data.h"
+#include "common/stats/stat_merger.h"
 
 namespace Envoy {
 namespace Server {
 
 /**
  * Shared memory segment. This structure is laid directly into shared memory and is used amongst
- * all running envoy processes.
+ * all running envoy processes. Stats are not kept here: each process allocates its own from the
+ * heap, and the parent sends its counters and gauges to the child over the RPC channel.
  */
 class SharedMemory {
 public:
-  static void configure(uint64_t max_num_stats, uint64_t max_stat_name_len);
-  static std::string version(uint64_t max_num_stats, const Stats::StatsOptions& stats_options);
+  static std::string version();
 
   // Made public for testing.
   static const uint64_t VERSION;
 
-  int64_t maxStats() const { return max_stats_; }
-
 private:
   struct Flags {
     static const uint64_t INITIALIZING = 0x1;
   };
 
-  // Due to the flexible-array-length of stats_set_data_, c-style allocation
-  // and initialization are necessary.
+  // The segment is mapped rather than constructed, so c-style initialization is necessary.
   SharedMemory() = delete;
   ~SharedMemory() = delete;
 
@@ -47,7 +44,7 @@ private:
    * Initialize the shared memory segment, depending on whether we should be the first running
    * envoy, or a host restarted envoy process.
    */
-  static SharedMemory& initialize(uint64_t stats_set_size, Options& options);
+  static SharedMemory& initialize(Options& options);
 
   /**
    * Initialize a pthread mutex for process shared locking.
@@ -56,14 +53,10 @@ private:
 
   uint64_t size_;
   uint64_t version_;
-  uint64_t max_stats_;
-  uint64_t entry_size_;
   std::atomic<uint64_t> flags_;
   pthread_mutex_t log_lock_;
   pthread_mutex_t access_log_lock_;
-  pthread_mutex_t stat_lock_;
   pthread_mutex_t init_lock_;
-  alignas(BlockMemoryHashSet<Stats::RawStatData>) uint8_t stats_set_data_[];
 
   friend class HotRestartImpl;
 };
@@ -127,13 +120,12 @@ public:
   std::string version() override;
   Thread::BasicLockable& logLock() override { return log_lock_; }
   Thread::BasicLockable& accessLogLock() override { return access_log_lock_; }
-  Stats::RawStatDataAllocator& statsAllocator() override { return *stats_allocator_; }
+  Stats::StatDataAllocator& statsAllocator() override { return stats_allocator_; }
 
   /**
-   * envoy --hot_restart_version doesn't initialize Envoy, but computes the version string
-   * based on the configured options.
+   * envoy --hot_restart_version doesn't initialize Envoy, but computes the version string.
    */
-  static std::string hotRestartVersion(uint64_t max_num_stats, uint64_t max_stat_name_len);
+  static std::string hotRestartVersion();
 
 private:
   enum class RpcMessageType {
@@ -145,9 +137,13 @@ private:
     TerminateRequest = 6,
     UnknownRequestReply = 7,
     GetStatsRequest = 8,
-    GetStatsReply = 9
+    GetStatsReply = 9,
+    StatsValues = 10
   };
 
+  // The largest message of the RPC protocol. Stats values are sent in messages of up to this size.
+  static const uint64_t MAX_RPC_LENGTH = 64 * 1024;
+
   PACKED_STRUCT(struct RpcBase {
     RpcBase(RpcMessageType type, uint64_t length = sizeof(RpcBase))
         : type_(type), length_(length) {}
@@ -189,6 +185,27 @@ private:
                   uint64_t unused_[16]{0};
                 });
 
+  enum class StatsValueType : uint8_t { CounterDelta = 1, GaugeValue = 2 };
+
+  // Each stats value of an RpcStatsValues is this header, followed by the name of the stat.
+  PACKED_STRUCT(struct StatsValueHeader {
+    StatsValueType type_;
+    uint64_t value_;
+    uint32_t name_length_;
+  });
+
+  // A GetStatsReply is followed by one or more of these, the last of which has last_ set. Only
+  // the first length_ bytes of the message are sent.
+  PACKED_STRUCT(struct RpcStatsValues
+                : public RpcBase {
+                  RpcStatsValues() : RpcBase(RpcMessageType::StatsValues, HEADER_LENGTH) {}
+
+                  static const uint64_t HEADER_LENGTH = sizeof(RpcBase) + sizeof(uint8_t);
+
+                  uint8_t last_{0};
+                  uint8_t data_[MAX_RPC_LENGTH - HEADER_LENGTH];
+                });
+
   template <class rpc_class, RpcMessageType rpc_type> rpc_class* receiveTypedRpc() {
     RpcBase* base_message = receiveRpc(true);
     RELEASE_ASSERT(base_message->length_ == sizeof(rpc_class), "");
@@ -202,24 +219,22 @@ private:
   void onGetListenSocket(RpcGetListenSocketRequest& rpc);
   void onSocketEvent();
   RpcBase* receiveRpc(bool block);
+  void receiveStatsValues();
   void sendMessage(sockaddr_un& address, RpcBase& rpc);
-  static std::string versionHelper(uint64_t max_num_stats, const Stats::StatsOptions& stats_options,
-                                   Stats::RawStatDataSet& stats_set);
+  void sendStatsValues();
 
   Options& options_;
-  BlockMemoryHashSetOptions stats_set_options_;
   SharedMemory& shmem_;
-  std::unique_ptr<Stats::RawStatDataSet> stats_set_ GUARDED_BY(stat_lock_);
-  std::unique_ptr<Stats::RawStatDataAllocator> stats_allocator_;
+  Stats::HeapStatDataAllocator stats_allocator_;
+  std::unique_ptr<Stats::StatMerger> stat_merger_;
   ProcessSharedMutex log_lock_;
   ProcessSharedMutex access_log_lock_;
-  ProcessSharedMutex stat_lock_;
   ProcessSharedMutex init_lock_;
   int my_domain_socket_{-1};
   sockaddr_un parent_address_;
   sockaddr_un child_address_;
   Event::FileEventPtr socket_event_;
-  std::array<uint8_t, 4096> rpc_buffer_;
+  std::array<uint8_t, MAX_RPC_LENGTH> rpc_buffer_;
   Server::Instance* server_{};
   bool parent_terminated_{};
 };
@@ -2,8 +2,8 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
-#include <regex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -51,6 +51,7 @@
 
 #include "extensions/access_loggers/file/file_access_log_impl.h"
 
+#include "absl/strings/ascii.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
@@ -136,8 +137,6 @@ const char AdminHtmlEnd[] = R"(
 </body>
 )";
 
-const std::regex PromRegex("[^a-zA-Z0-9_]");
-
 void populateFallbackResponseHeaders(Http::Code code, Http::HeaderMap& header_map) {
   header_map.insertStatus().value(std::to_string(enumToInt(code)));
   const auto& headers = Http::Headers::get();
@@ -601,77 +600,244 @@ Http::Code AdminImpl::handlerServerInfo(absl::string_view, Http::HeaderMap& head
   return Http::Code::OK;
 }
 
+bool AdminImpl::parseStatsFilter(const Http::Utility::QueryParams& params,
+                                 std::unique_ptr<Regex::CompiledGoogleReMatcher>& filter,
+                                 Buffer::Instance& response) {
+  const auto filter_it = params.find("filter");
+  if (filter_it == params.end()) {
+    return true;
+  }
+  try {
+    filter = std::make_unique<Regex::CompiledGoogleReMatcher>(
+        filter_it->second, Regex::Utility::DefaultMaxProgramSize);
+  } catch (const EnvoyException& e) {
+    response.add(fmt::format("{}\n", e.what()));
+    return false;
+  }
+  return true;
+}
+
 Http::Code AdminImpl::handlerStats(absl::string_view url, Http::HeaderMap& response_headers,
                                    Buffer::Instance& response, AdminStream& admin_stream) {
-  Http::Code rc = Http::Code::OK;
   const Http::Utility::QueryParams params = Http::Utility::parseQueryString(url);
 
+  const auto format_it = params.find("format");
+  if (format_it != params.end() && format_it->second == "prometheus") {
+    return handlerPrometheusStats(url, response_headers, response, admin_stream);
+  }
+  if (format_it != params.end() && format_it->second != "json") {
+    response.add("usage: /stats?format=json  or /stats?format=prometheus \n");
+    response.add("\n");
+    return Http::Code::NotFound;
+  }
+
   const bool used_only = params.find("usedonly") != params.end();
-  const bool has_format = !(params.find("format") == params.end());
-  const absl::optional<std::regex> regex =
-      (params.find("filter") != params.end())
-          ? absl::optional<std::regex>{std::regex(params.at("filter"))}
-          : absl::nullopt;
+  std::unique_ptr<Regex::CompiledGoogleReMatcher> filter;
+  if (!parseStatsFilter(params, filter, response)) {
+    return Http::Code::BadRequest;
+  }
+
+  if (format_it == params.end()) { // Display plain stats if format query param is not there.
+    std::make_shared<StatsStreamer>(server_.stats(), StatsStreamer::Format::Text, used_only,
+                                    std::move(filter))
+        ->start(response, admin_stream);
+    return Http::Code::OK;
+  }
 
   std::map<std::string, uint64_t> all_stats;
   for (const Stats::CounterSharedPtr& counter : server_.stats().counters()) {
-    if (shouldShowMetric(counter, used_only, regex)) {
+    if (StatsStreamer::shouldShowMetric(*counter, used_only, filter.get())) {
       all_stats.emplace(counter->name(), counter->value());
     }
   }
 
   for (const Stats::GaugeSharedPtr& gauge : server_.stats().gauges()) {
-    if (shouldShowMetric(gauge, used_only, regex)) {
+    if (StatsStreamer::shouldShowMetric(*gauge, used_only, filter.get())) {
       all_stats.emplace(gauge->name(), gauge->value());
     }
   }
 
-  if (has_format) {
-    const std::string format_value = params.at("format");
-    if (format_value == "json") {
-      response_headers.insertContentType().value().setReference(
-          Http::Headers::get().ContentTypeValues.Json);
-      response.add(
-          AdminImpl::statsAsJson(all_stats, server_.stats().histograms(), used_only, regex));
-    } else if (format_value == "prometheus") {
-      return handlerPrometheusStats(url, response_headers, response, admin_stream);
-    } else {
-      response.add("usage: /stats?format=json  or /stats?format=prometheus \n");
-      response.add("\n");
-      rc = Http::Code::NotFound;
+  response_headers.insertContentType().value().setReference(
+      Http::Headers::get().ContentTypeValues.Json);
+  response.add(
+      AdminImpl::statsAsJson(all_stats, server_.stats().histograms(), used_only, filter.get()));
+  return Http::Code::OK;
+}
+
+Http::Code AdminImpl::handlerPrometheusStats(absl::string_view url, Http::HeaderMap&,
+                                             Buffer::Instance& response,
+                                             AdminStream& admin_stream) {
+  const Http::Utility::QueryParams params = Http::Utility::parseQueryString(url);
+  const bool used_only = params.find("usedonly") != params.end();
+  std::unique_ptr<Regex::CompiledGoogleReMatcher> filter;
+  if (!parseStatsFilter(params, filter, response)) {
+    return Http::Code::BadRequest;
+  }
+
+  std::make_shared<StatsStreamer>(server_.stats(), StatsStreamer::Format::Prometheus, used_only,
+                                  std::move(filter), prometheus_name_cache_)
+      ->start(response, admin_stream);
+  return Http::Code::OK;
+}
+
+StatsStreamer::StatsStreamer(Stats::Store& store, Format format, bool used_only,
+                             std::unique_ptr<Regex::CompiledGoogleReMatcher>&& filter,
+                             PrometheusNameCacheSharedPtr name_cache, uint32_t chunk_size)
+    : format_(format), used_only_(used_only), filter_(std::move(filter)),
+      name_cache_(std::move(name_cache)), chunk_size_(chunk_size), counters_(store.counters()),
+      gauges_(store.gauges()), histograms_(store.histograms()) {
+  ASSERT(chunk_size_ > 0);
+  ASSERT(format_ != Format::Prometheus || name_cache_ != nullptr);
+  if (format_ == Format::Text) {
+    const auto by_name = [](const auto& lhs, const auto& rhs) {
+      return strcmp(lhs->nameCStr(), rhs->nameCStr()) < 0;
+    };
+    // Stable sorts keep the store order of histograms with the same name. See the comment in
+    // ThreadLocalStoreImpl::histograms() for why there may be duplicates.
+    std::sort(counters_.begin(), counters_.end(), by_name);
+    std::sort(gauges_.begin(), gauges_.end(), by_name);
+    std::stable_sort(histograms_.begin(), histograms_.end(), by_name);
+  }
+}
+
+bool StatsStreamer::renderChunk(Buffer::Instance& response) {
+  uint32_t visited = 0;
+  if (format_ == Format::Text) {
+    // Counters and gauges are merged in name order. As the previous map based output did, a gauge
+    // with the same name as a counter is hidden by it.
+    while (visited < chunk_size_ &&
+           (next_counter_ < counters_.size() || next_gauge_ < gauges_.size())) {
+      ++visited;
+      int order = 1;
+      if (next_gauge_ == gauges_.size()) {
+        order = -1;
+      } else if (next_counter_ < counters_.size()) {
+        order = strcmp(counters_[next_counter_]->nameCStr(), gauges_[next_gauge_]->nameCStr());
+      }
+      const Stats::Metric* metric;
+      uint64_t value;
+      if (order <= 0) {
+        const Stats::Counter& counter = *counters_[next_counter_++];
+        if (order == 0) {
+          ++next_gauge_;
+        }
+        metric = &counter;
+        value = counter.value();
+      } else {
+        const Stats::Gauge& gauge = *gauges_[next_gauge_++];
+        metric = &gauge;
+        value = gauge.value();
+      }
+      if (shouldShow(*metric)) {
+        response.add(fmt::format("{}: {}\n", metric->nameCStr(), value));
+      }
     }
-  } else { // Display plain stats if format query param is not there.
-    for (auto stat : all_stats) {
-      response.add(fmt::format("{}: {}\n", stat.first, stat.second));
+    for (; visited < chunk_size_ && next_histogram_ < histograms_.size(); ++visited) {
+      const Stats::ParentHistogram& histogram = *histograms_[next_histogram_++];
+      if (shouldShow(histogram)) {
+        response.add(fmt::format("{}: {}\n", histogram.nameCStr(), histogram.summary()));
+      }
     }
-    // TODO(ramaraochavali): See the comment in ThreadLocalStoreImpl::histograms() for why we use a
-    // multimap here. This makes sure that duplicate histograms get output. When shared storage is
-    // implemented this can be switched back to a normal map.
-    std::multimap<std::string, std::string> all_histograms;
-    for (const Stats::ParentHistogramSharedPtr& histogram : server_.stats().histograms()) {
-      if (shouldShowMetric(histogram, used_only, regex)) {
-        all_histograms.emplace(histogram->name(), histogram->summary());
+  } else {
+    for (; visited < chunk_size_ && next_counter_ < counters_.size(); ++visited) {
+      const Stats::CounterSharedPtr& counter = counters_[next_counter_++];
+      if (shouldShow(*counter)) {
+        PrometheusStatsFormatter::addCounter(counter, *name_cache_, metric_type_tracker_,
+                                             response);
       }
     }
-    for (auto histogram : all_histograms) {
-      response.add(fmt::format("{}: {}\n", histogram.first, histogram.second));
+    for (; visited < chunk_size_ && next_gauge_ < gauges_.size(); ++visited) {
+      const Stats::GaugeSharedPtr& gauge = gauges_[next_gauge_++];
+      if (shouldShow(*gauge)) {
+        PrometheusStatsFormatter::addGauge(gauge, *name_cache_, metric_type_tracker_, response);
+      }
+    }
+    // Unused histograms have no samples to report.
+    for (; visited < chunk_size_ && next_histogram_ < histograms_.size(); ++visited) {
+      const Stats::ParentHistogramSharedPtr& histogram = histograms_[next_histogram_++];
+      if (histogram->used() && shouldShow(*histogram)) {
+        PrometheusStatsFormatter::addHistogram(histogram, *name_cache_, metric_type_tracker_,
+                                               response);
+      }
     }
   }
-  return rc;
+  const bool done = next_counter_ == counters_.size() && next_gauge_ == gauges_.size() &&
+                    next_histogram_ == histograms_.size();
+  if (done && name_cache_ != nullptr) {
+    name_cache_->removeExpired();
+  }
+  return done;
 }
 
-Http::Code AdminImpl::handlerPrometheusStats(absl::string_view, Http::HeaderMap&,
-                                             Buffer::Instance& response, AdminStream&) {
-  PrometheusStatsFormatter::statsAsPrometheus(server_.stats().counters(), server_.stats().gauges(),
-                                              response);
-  return Http::Code::OK;
+void StatsStreamer::start(Buffer::Instance& response, AdminStream& admin_stream) {
+  if (renderChunk(response)) {
+    return;
+  }
+  if (!admin_stream.canStream()) {
+    while (!renderChunk(response)) {
+    }
+    return;
+  }
+
+  // The first chunk is encoded by the admin filter along with the headers, and the following ones
+  // are encoded as they are rendered.
+  admin_stream.setEndStreamOnComplete(false);
+  callbacks_ = &admin_stream.getDecoderFilterCallbacks();
+  callbacks_->addDownstreamWatermarkCallbacks(*this);
+  // The streamer is kept alive by the posted chunks and by this callback, which stops the
+  // streaming when the stream goes away.
+  std::shared_ptr<StatsStreamer> self = shared_from_this();
+  admin_stream.addOnDestroyCallback([self]() {
+    self->destroyed_ = true;
+    self->callbacks_->removeDownstreamWatermarkCallbacks(*self);
+  });
+  scheduleNextChunk();
+}
+
+void StatsStreamer::scheduleNextChunk() {
+  std::shared_ptr<StatsStreamer> self = shared_from_this();
+  callbacks_->dispatcher().post([self]() { self->streamNextChunk(); });
+}
+
+void StatsStreamer::streamNextChunk() {
+  if (destroyed_) {
+    return;
+  }
+  if (high_watermark_count_ > 0) {
+    // Resumed once the downstream connection has drained.
+    paused_ = true;
+    return;
+  }
+  Buffer::OwnedImpl chunk;
+  const bool done = renderChunk(chunk);
+  if (chunk.length() > 0 || done) {
+    callbacks_->encodeData(chunk, done);
+  }
+  if (!done) {
+    scheduleNextChunk();
+  }
+}
+
+void StatsStreamer::onAboveWriteBufferHighWatermark() { ++high_watermark_count_; }
+
+void StatsStreamer::onBelowWriteBufferLowWatermark() {
+  ASSERT(high_watermark_count_ > 0);
+  if (--high_watermark_count_ == 0 && paused_) {
+    paused_ = false;
+    scheduleNextChunk();
+  }
 }
 
 std::string PrometheusStatsFormatter::sanitizeName(const std::string& name) {
   // The name must match the regex [a-zA-Z_][a-zA-Z0-9_]* as required by
   // prometheus. Refer to https://prometheus.io/docs/concepts/data_model/.
-  std::string stats_name = std::regex_replace(name, PromRegex, "_");
-  if (stats_name[0] >= '0' && stats_name[0] <= '9') {
+  std::string stats_name = name;
+  for (char& c : stats_name) {
+    if (!absl::ascii_isalnum(c) && c != '_') {
+      c = '_';
+    }
+  }
+  if (absl::ascii_isdigit(stats_name[0])) {
     return fmt::format("_{}", stats_name);
   } else {
     return stats_name;
@@ -693,38 +859,116 @@ std::string PrometheusStatsFormatter::metricName(const std::string& extractedNam
   return sanitizeName(fmt::format("envoy_{0}", extractedName));
 }
 
-// TODO(ramaraochavali): Add summary histogram output for Prometheus.
-uint64_t
-PrometheusStatsFormatter::statsAsPrometheus(const std::vector<Stats::CounterSharedPtr>& counters,
-                                            const std::vector<Stats::GaugeSharedPtr>& gauges,
+std::string PrometheusStatsFormatter::formattedHistogram(const std::string& metric_name,
+                                                         const std::string& tags,
+                                                         const Stats::HistogramStatistics& stats) {
+  const std::string bucket_tags = tags.empty() ? "" : fmt::format("{},", tags);
+  std::string output;
+  const std::vector<double>& supported_buckets = stats.supportedBuckets();
+  const std::vector<uint64_t>& computed_buckets = stats.computedBuckets();
+  for (size_t i = 0; i < supported_buckets.size(); ++i) {
+    output += fmt::format("{0}_bucket{{{1}le=\"{2}\"}} {3}\n", metric_name, bucket_tags,
+                          supported_buckets[i], computed_buckets[i]);
+  }
+  output += fmt::format("{0}_bucket{{{1}le=\"+Inf\"}} {2}\n", metric_name, bucket_tags,
+                        stats.sampleCount());
+  output += fmt::format("{0}_sum{{{1}}} {2}\n", metric_name, tags, stats.sampleSum());
+  output += fmt::format("{0}_count{{{1}}} {2}\n", metric_name, tags, stats.sampleCount());
+  return output;
+}
+
+void PrometheusStatsFormatter::addCounter(const Stats::CounterSharedPtr& counter,
+                                          PrometheusNameCache& name_cache,
+                                          std::unordered_set<std::string>& metric_type_tracker,
+                                          Buffer::Instance& response) {
+  const PrometheusNameCache::Entry& names = name_cache.get(counter);
+  if (metric_type_tracker.insert(names.metric_name_).second) {
+    response.add(fmt::format("# TYPE {0} counter\n", names.metric_name_));
+  }
+  response.add(fmt::format("{0} {1}\n", names.series_, counter->value()));
+}
+
+void PrometheusStatsFormatter::addGauge(const Stats::GaugeSharedPtr& gauge,
+                                        PrometheusNameCache& name_cache,
+                                        std::unordered_set<std::string>& metric_type_tracker,
+                                        Buffer::Instance& response) {
+  const PrometheusNameCache::Entry& names = name_cache.get(gauge);
+  if (metric_type_tracker.insert(names.metric_name_).second) {
+    response.add(fmt::format("# TYPE {0} gauge\n", names.metric_name_));
+  }
+  response.add(fmt::format("{0} {1}\n", names.series_, gauge->value()));
+}
+
+void PrometheusStatsFormatter::addHistogram(const Stats::ParentHistogramSharedPtr& histogram,
+                                            PrometheusNameCache& name_cache,
+                                            std::unordered_set<std::string>& metric_type_tracker,
                                             Buffer::Instance& response) {
+  // Prometheus histograms are cumulative, so they are output from the cumulative statistics of
+  // the histograms, which accumulate the histograms merged from the workers at every flush.
+  const PrometheusNameCache::Entry& names = name_cache.get(histogram);
+  if (metric_type_tracker.insert(names.metric_name_).second) {
+    response.add(fmt::format("# TYPE {0} histogram\n", names.metric_name_));
+  }
+  response.add(
+      formattedHistogram(names.metric_name_, names.tags_, histogram->cumulativeStatistics()));
+}
+
+uint64_t PrometheusStatsFormatter::statsAsPrometheus(
+    const std::vector<Stats::CounterSharedPtr>& counters,
+    const std::vector<Stats::GaugeSharedPtr>& gauges,
+    const std::vector<Stats::ParentHistogramSharedPtr>& histograms, Buffer::Instance& response) {
+  PrometheusNameCache name_cache;
+  return statsAsPrometheus(counters, gauges, histograms, name_cache, response);
+}
+
+uint64_t PrometheusStatsFormatter::statsAsPrometheus(
+    const std::vector<Stats::CounterSharedPtr>& counters,
+    const std::vector<Stats::GaugeSharedPtr>& gauges,
+    const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
+    PrometheusNameCache& name_cache, Buffer::Instance& response) {
   std::unordered_set<std::string> metric_type_tracker;
   for (const auto& counter : counters) {
-    const std::string tags = formattedTags(counter->tags());
-    const std::string metric_name = metricName(counter->tagExtractedName());
-    if (metric_type_tracker.find(metric_name) == metric_type_tracker.end()) {
-      metric_type_tracker.insert(metric_name);
-      response.add(fmt::format("# TYPE {0} counter\n", metric_name));
-    }
-    response.add(fmt::format("{0}{{{1}}} {2}\n", metric_name, tags, counter->value()));
+    addCounter(counter, name_cache, metric_type_tracker, response);
   }
-
   for (const auto& gauge : gauges) {
-    const std::string tags = formattedTags(gauge->tags());
-    const std::string metric_name = metricName(gauge->tagExtractedName());
-    if (metric_type_tracker.find(metric_name) == metric_type_tracker.end()) {
-      metric_type_tracker.insert(metric_name);
-      response.add(fmt::format("# TYPE {0} gauge\n", metric_name));
+    addGauge(gauge, name_cache, metric_type_tracker, response);
+  }
+  for (const auto& histogram : histograms) {
+    if (histogram->used()) {
+      addHistogram(histogram, name_cache, metric_type_tracker, response);
     }
-    response.add(fmt::format("{0}{{{1}}} {2}\n", metric_name, tags, gauge->value()));
   }
   return metric_type_tracker.size();
 }
 
+const PrometheusNameCache::Entry&
+PrometheusNameCache::get(const std::shared_ptr<const Stats::Metric>& metric) {
+  CachedEntry& cached = entries_[metric.get()];
+  // A stat freed since it was cached may have been replaced by a new one at the same address.
+  if (cached.metric_.expired()) {
+    cached.metric_ = metric;
+    cached.entry_.metric_name_ = PrometheusStatsFormatter::metricName(metric->tagExtractedName());
+    cached.entry_.tags_ = PrometheusStatsFormatter::formattedTags(metric->tags());
+    cached.entry_.series_ =
+        fmt::format("{0}{{{1}}}", cached.entry_.metric_name_, cached.entry_.tags_);
+  }
+  return cached.entry_;
+}
+
+void PrometheusNameCache::removeExpired() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.metric_.expired()) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
 std::string
 AdminImpl::statsAsJson(const std::map<std::string, uint64_t>& all_stats,
                        const std::vector<Stats::ParentHistogramSharedPtr>& all_histograms,
-                       const bool used_only, const absl::optional<std::regex> regex,
+                       const bool used_only, const Regex::CompiledGoogleReMatcher* filter,
                        const bool pretty_print) {
   rapidjson::Document document;
   document.SetObject();
@@ -752,7 +996,7 @@ AdminImpl::statsAsJson(const std::map<std::string, uint64_t>& all_stats,
   rapidjson::Value histogram_array(rapidjson::kArrayType);
 
   for (const Stats::ParentHistogramSharedPtr& histogram : all_histograms) {
-    if (shouldShowMetric(histogram, used_only, regex)) {
+    if (StatsStreamer::shouldShowMetric(*histogram, used_only, filter)) {
       if (!found_used_histogram) {
         // It is not possible for the supported quantiles to differ across histograms, so it is ok
         // to send them once.
@@ -1045,7 +1289,8 @@ AdminImpl::AdminImpl(const std::string& profile_path, Server::Instance& server)
            false, true},
       },
       date_provider_(server.dispatcher().timeSystem()),
-      admin_filter_chain_(std::make_shared<AdminFilterChain>()) {}
+      admin_filter_chain_(std::make_shared<AdminFilterChain>()),
+      prometheus_name_cache_(std::make_shared<PrometheusNameCache>()) {}
 
 Http::ServerConnectionPtr AdminImpl::createCodec(Network::Connection& connection,
                                                  const Buffer::Instance&,
@@ -4,6 +4,7 @@
 #include <list>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -22,6 +23,7 @@
 #include "common/common/empty_string.h"
 #include "common/common/logger.h"
 #include "common/common/macros.h"
+#include "common/common/regex.h"
 #include "common/http/conn_manager_impl.h"
 #include "common/http/date_provider_impl.h"
 #include "common/http/default_server_string.h"
@@ -36,6 +38,47 @@
 namespace Envoy {
 namespace Server {
 
+/**
+ * Caches the Prometheus metric names and label strings of stats, so that scrapes do not sanitize
+ * and format them again. The name and tags of a stat never change once it is created, so an entry
+ * stays valid for as long as its stat is alive.
+ */
+class PrometheusNameCache {
+public:
+  struct Entry {
+    // The sanitized metric name, prefixed with "envoy_".
+    std::string metric_name_;
+    // The comma-separated <tag_name>="<tag_value>" pairs.
+    std::string tags_;
+    // metric_name_{tags_}, which precedes the value of a counter or gauge.
+    std::string series_;
+  };
+
+  /**
+   * @return const Entry& the cached names of a stat, formatting them on the first call for the
+   *         stat. The reference is valid until the next call to a non-const method.
+   */
+  const Entry& get(const std::shared_ptr<const Stats::Metric>& metric);
+
+  /**
+   * Drops the entries of stats that have been freed.
+   */
+  void removeExpired();
+
+  size_t size() const { return entries_.size(); }
+
+private:
+  struct CachedEntry {
+    // Tells whether the stat at the key address is still the one the entry was formatted for.
+    std::weak_ptr<const Stats::Metric> metric_;
+    Entry entry_;
+  };
+
+  std::unordered_map<const Stats::Metric*, CachedEntry> entries_;
+};
+
+typedef std::shared_ptr<PrometheusNameCache> PrometheusNameCacheSharedPtr;
+
 class AdminInternalAddressConfig : public Http::InternalAddressConfig {
   bool isInternalAddress(const Network::Address::Instance&) const override { return false; }
 };
@@ -178,16 +221,19 @@ private:
   void writeClustersAsJson(Buffer::Instance& response);
   void writeClustersAsText(Buffer::Instance& response);
 
-  static bool shouldShowMetric(const std::shared_ptr<Stats::Metric>& metric, const bool used_only,
-                               const absl::optional<std::regex>& regex) {
-    return ((!used_only || metric->used()) &&
-            (!regex.has_value() || std::regex_search(metric->name(), regex.value())));
-  }
   static std::string statsAsJson(const std::map<std::string, uint64_t>& all_stats,
                                  const std::vector<Stats::ParentHistogramSharedPtr>& all_histograms,
                                  bool used_only,
-                                 const absl::optional<std::regex> regex = absl::nullopt,
+                                 const Regex::CompiledGoogleReMatcher* filter = nullptr,
                                  bool pretty_print = false);
+  /**
+   * Parses the filter query parameter of the stats handlers.
+   * @param filter receives the compiled filter, or nullptr if there is none.
+   * @return bool false if the filter is invalid, in which case the error is added to the response.
+   */
+  static bool parseStatsFilter(const Http::Utility::QueryParams& params,
+                               std::unique_ptr<Regex::CompiledGoogleReMatcher>& filter,
+                               Buffer::Instance& response);
   static std::string
   runtimeAsJson(const std::vector<std::pair<std::string, Runtime::Snapshot::Entry>>& entries);
   std::vector<const UrlHandler*> sortedHandlers() const;
@@ -314,6 +360,8 @@ private:
   Network::SocketPtr socket_;
   AdminListenerPtr listener_;
   const AdminInternalAddressConfig internal_address_config_;
+  // Shared with the Prometheus stats streamers, which may outlive a scrape's handler call.
+  const PrometheusNameCacheSharedPtr prometheus_name_cache_;
 };
 
 /**
@@ -341,6 +389,7 @@ public:
   void addOnDestroyCallback(std::function<void()> cb) override;
   Http::StreamDecoderFilterCallbacks& getDecoderFilterCallbacks() const override;
   const Http::HeaderMap& getRequestHeaders() const override;
+  bool canStream() const override { return callbacks_ != nullptr; }
 
 private:
   /**
@@ -366,13 +415,18 @@ private:
 class PrometheusStatsFormatter {
 public:
   /**
-   * Extracts counters and gauges and relevant tags, appending them to
+   * Extracts counters, gauges and histograms and relevant tags, appending them to
    * the response buffer after sanitizing the metric / label names.
    * @return uint64_t total number of metric types inserted in response.
    */
   static uint64_t statsAsPrometheus(const std::vector<Stats::CounterSharedPtr>& counters,
                                     const std::vector<Stats::GaugeSharedPtr>& gauges,
+                                    const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
                                     Buffer::Instance& response);
+  static uint64_t statsAsPrometheus(const std::vector<Stats::CounterSharedPtr>& counters,
+                                    const std::vector<Stats::GaugeSharedPtr>& gauges,
+                                    const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
+                                    PrometheusNameCache& name_cache, Buffer::Instance& response);
   /**
    * Format the given tags, returning a string as a comma-separated list
    * of <tag_name>="<tag_value>" pairs.
@@ -382,6 +436,27 @@ public:
    * Format the given metric name, prefixed with "envoy_".
    */
   static std::string metricName(const std::string& extractedName);
+  /**
+   * Format the cumulative buckets, sum and count of a histogram.
+   */
+  static std::string formattedHistogram(const std::string& metric_name, const std::string& tags,
+                                        const Stats::HistogramStatistics& stats);
+  /**
+   * Append a counter, gauge or histogram to the response, preceded by the type of its metric if it
+   * is the first of its metric to be appended.
+   * @param name_cache supplies the cache of the Prometheus names of the stats.
+   * @param metric_type_tracker supplies the names of the metrics appended so far.
+   */
+  static void addCounter(const Stats::CounterSharedPtr& counter, PrometheusNameCache& name_cache,
+                         std::unordered_set<std::string>& metric_type_tracker,
+                         Buffer::Instance& response);
+  static void addGauge(const Stats::GaugeSharedPtr& gauge, PrometheusNameCache& name_cache,
+                       std::unordered_set<std::string>& metric_type_tracker,
+                       Buffer::Instance& response);
+  static void addHistogram(const Stats::ParentHistogramSharedPtr& histogram,
+                           PrometheusNameCache& name_cache,
+                           std::unordered_set<std::string>& metric_type_tracker,
+                           Buffer::Instance& response);
 
 private:
   /**
@@ -390,5 +465,80 @@ private:
   static std::string sanitizeName(const std::string& name);
 };
 
+/**
+ * Renders the stats of a store for the /stats and /stats/prometheus admin endpoints. The stats are
+ * rendered a chunk at a time, each chunk being posted to the main thread once the previous one has
+ * been written, and the rendering pauses while the downstream connection is backed up. Large stores
+ * therefore neither stall the main thread nor have their whole output buffered at once.
+ */
+class StatsStreamer : public Http::DownstreamWatermarkCallbacks,
+                      public std::enable_shared_from_this<StatsStreamer> {
+public:
+  enum class Format { Text, Prometheus };
+
+  /**
+   * @param used_only supplies whether to only render the stats that have been used.
+   * @param filter supplies the regex that the names of the rendered stats must contain a match of,
+   *        or nullptr to render all stats.
+   * @param name_cache supplies the cache of the Prometheus names of the stats. It is required by
+   *        the Prometheus format.
+   * @param chunk_size supplies the number of stats to go through per chunk.
+   */
+  StatsStreamer(Stats::Store& store, Format format, bool used_only,
+                std::unique_ptr<Regex::CompiledGoogleReMatcher>&& filter,
+                PrometheusNameCacheSharedPtr name_cache = nullptr,
+                uint32_t chunk_size = DefaultChunkSize);
+
+  /**
+   * Renders the first chunk of stats into the response, and streams the following chunks through
+   * the admin stream. If the admin stream cannot stream, all the stats are rendered into the
+   * response instead.
+   */
+  void start(Buffer::Instance& response, AdminStream& admin_stream);
+
+  static bool shouldShowMetric(const Stats::Metric& metric, bool used_only,
+                               const Regex::CompiledGoogleReMatcher* filter) {
+    return (!used_only || metric.used()) &&
+           (filter == nullptr || re2::RE2::PartialMatch(metric.nameCStr(), filter->regex()));
+  }
+
+  // Http::DownstreamWatermarkCallbacks
+  void onAboveWriteBufferHighWatermark() override;
+  void onBelowWriteBufferLowWatermark() override;
+
+  static const uint32_t DefaultChunkSize = 1000;
+
+private:
+  /**
+   * Renders the next chunk of stats into the response.
+   * @return bool whether all the stats have been rendered.
+   */
+  bool renderChunk(Buffer::Instance& response);
+  void scheduleNextChunk();
+  void streamNextChunk();
+  bool shouldShow(const Stats::Metric& metric) const {
+    return shouldShowMetric(metric, used_only_, filter_.get());
+  }
+
+  const Format format_;
+  const bool used_only_;
+  const std::unique_ptr<Regex::CompiledGoogleReMatcher> filter_;
+  const PrometheusNameCacheSharedPtr name_cache_;
+  const uint32_t chunk_size_;
+  // Snapshots of the stats taken when the request is received. They are sorted by name for the
+  // text format.
+  std::vector<Stats::CounterSharedPtr> counters_;
+  std::vector<Stats::GaugeSharedPtr> gauges_;
+  std::vector<Stats::ParentHistogramSharedPtr> histograms_;
+  size_t next_counter_{};
+  size_t next_gauge_{};
+  size_t next_histogram_{};
+  std::unordered_set<std::string> metric_type_tracker_;
+  Http::StreamDecoderFilterCallbacks* callbacks_{};
+  uint32_t high_watermark_count_{};
+  bool paused_{};
+  bool destroyed_{};
+};
+
 } // namespace Server
 } // namespace Envoy
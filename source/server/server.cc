@@ -125,7 +125,8 @@ void InstanceImpl::drainListeners() {
 }
 
 void InstanceImpl::failHealthcheck(bool fail) {
-  // We keep liveness state in shared memory so the parent process sees the same state.
+  // Liveness state is kept in a gauge of this process. It is not merged across a hot restart, so
+  // a draining parent keeps its own.
   server_stats_->live_.set(!fail);
 }
 
@@ -154,6 +155,16 @@ void InstanceImpl::flushStats() {
     server_stats_->total_connections_.set(numConnections() + info.num_connections_);
     server_stats_->days_until_first_cert_expiring_.set(
         sslContextManager().daysUntilFirstCertExpires());
+
+    // Between full flushes, sinks only receive the stats that changed since the previous flush.
+    const MonotonicTime now = time_system_.monotonicTime();
+    const std::chrono::milliseconds full_flush_interval = config_.statsFullFlushInterval();
+    const bool full_flush = full_flush_interval.count() == 0 || !last_full_stats_flush_ ||
+                            now - last_full_stats_flush_.value() >= full_flush_interval;
+    if (full_flush) {
+      last_full_stats_flush_ = now;
+    }
+    stats_store_.source().setFullFlush(full_flush);
     InstanceUtil::flushMetricsToSinks(config_.statsSinks(), stats_store_.source());
     // TODO(ramaraochavali): consider adding different flush interval for histograms.
     if (stat_flush_timer_ != nullptr) {
@@ -236,6 +247,9 @@ void InstanceImpl::initialize(Options& options,
   // stats.
   stats_store_.setTagProducer(Config::Utility::createTagProducer(bootstrap_));
   stats_store_.setStatsMatcher(Config::Utility::createStatsMatcher(bootstrap_));
+  const auto& histogram_buckets = bootstrap_.stats_config().histogram_buckets();
+  stats_store_.setHistogramBuckets(
+      std::vector<double>(histogram_buckets.begin(), histogram_buckets.end()));
 
   server_stats_ = std::make_unique<ServerStats>(
       ServerStats{ALL_SERVER_STATS(POOL_GAUGE_PREFIX(stats_store_, "server."))});
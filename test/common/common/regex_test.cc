@@ -0,0 +1,89 @@
+#include <string>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/regex.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Regex {
+namespace {
+
+TEST(RegexTest, FullMatch) {
+  CompiledMatcherPtr matcher = Utility::parseRegex("/b[io]t");
+  EXPECT_TRUE(matcher->match("/bit"));
+  EXPECT_TRUE(matcher->match("/bot"));
+  EXPECT_FALSE(matcher->match("/bite"));
+  EXPECT_FALSE(matcher->match("/bit/bot"));
+  EXPECT_FALSE(matcher->match(""));
+}
+
+TEST(RegexTest, MatchStringView) {
+  CompiledMatcherPtr matcher = Utility::parseRegex("/rides/\\d+");
+  const std::string path = "/rides/123?x=y";
+  EXPECT_TRUE(matcher->match(absl::string_view(path).substr(0, path.find('?'))));
+  EXPECT_FALSE(matcher->match(path));
+}
+
+TEST(RegexTest, InvalidRegex) {
+  EXPECT_THROW_WITH_REGEX(Utility::parseRegex("(+invalid)"), EnvoyException,
+                          "Invalid regex '\\(\\+invalid\\)': .*");
+  // RE2 does not support lookahead.
+  EXPECT_THROW_WITH_REGEX(Utility::parseRegex("^foo(?=\\.)"), EnvoyException, "Invalid regex.*");
+}
+
+TEST(RegexTest, ProgramSizeLimit) {
+  EXPECT_THROW_WITH_REGEX(Utility::parseRegex("/asdf/.{1,2000}"), EnvoyException,
+                          "Regex '/asdf/.\\{1,2000\\}' program size of [0-9]+ > max program size "
+                          "of 1000");
+  EXPECT_THROW_WITH_REGEX(CompiledGoogleReMatcher("/asdf/.*", 1), EnvoyException,
+                          "program size of [0-9]+ > max program size of 1");
+  EXPECT_NO_THROW(CompiledGoogleReMatcher("/asdf/.{1,2000}", 100000));
+}
+
+// Nested quantifiers that backtrack exponentially under std::regex run in linear time.
+TEST(RegexTest, PathologicalInput) {
+  CompiledMatcherPtr matcher = Utility::parseRegex("(a+)+b");
+  EXPECT_FALSE(matcher->match(std::string(10000, 'a')));
+  EXPECT_TRUE(matcher->match(std::string(10000, 'a') + "b"));
+}
+
+TEST(RegexSetTest, Match) {
+  CompiledGoogleReSet set({"/rides/\\d+", "/rides/.*", "/users", "/rides/1"});
+  std::vector<int> matches;
+  EXPECT_TRUE(set.match("/rides/1", matches));
+  EXPECT_EQ(std::vector<int>({0, 1, 3}), matches);
+
+  matches.clear();
+  EXPECT_TRUE(set.match("/rides/abc", matches));
+  EXPECT_EQ(std::vector<int>({1}), matches);
+
+  // Regexes must match the whole value.
+  matches.clear();
+  EXPECT_TRUE(set.match("/users/1", matches));
+  EXPECT_TRUE(matches.empty());
+}
+
+TEST(RegexSetTest, MatchUnanchored) {
+  CompiledGoogleReSet set({"\\.rides\\.", "^users\\.", "\\d+$"}, re2::RE2::UNANCHORED);
+  std::vector<int> matches;
+  EXPECT_TRUE(set.match("users.rides.1", matches));
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), matches);
+
+  matches.clear();
+  EXPECT_TRUE(set.match("drivers.users.rides", matches));
+  EXPECT_TRUE(matches.empty());
+}
+
+TEST(RegexSetTest, InvalidRegex) {
+  EXPECT_THROW_WITH_REGEX(CompiledGoogleReSet({"/foo", "(+invalid)"}), EnvoyException,
+                          "Invalid regex '\\(\\+invalid\\)': .*");
+}
+
+} // namespace
+} // namespace Regex
+} // namespace Envoy
@@ -0,0 +1,101 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/compressor/brotli_compressor_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "brotli/decode.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Compressor {
+namespace {
+
+class BrotliCompressorImplTest : public testing::Test {
+protected:
+  // Decompresses a complete Brotli stream with the reference decoder.
+  static std::string decompress(const Buffer::Instance& compressed) {
+    const std::string input = compressed.toString();
+    std::unique_ptr<BrotliDecoderState, decltype(&BrotliDecoderDestroyInstance)> state(
+        BrotliDecoderCreateInstance(nullptr, nullptr, nullptr), &BrotliDecoderDestroyInstance);
+    size_t avail_in = input.size();
+    const uint8_t* next_in = reinterpret_cast<const uint8_t*>(input.data());
+    std::string output;
+    BrotliDecoderResult result;
+    do {
+      uint8_t chunk[4096];
+      size_t avail_out = sizeof(chunk);
+      uint8_t* next_out = chunk;
+      result = BrotliDecoderDecompressStream(state.get(), &avail_in, &next_in, &avail_out,
+                                             &next_out, nullptr);
+      output.append(reinterpret_cast<const char*>(chunk), sizeof(chunk) - avail_out);
+    } while (result == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT);
+    EXPECT_EQ(BROTLI_DECODER_RESULT_SUCCESS, result);
+    EXPECT_EQ(0, avail_in);
+    return output;
+  }
+
+  static const uint32_t default_quality{5};
+  static const uint32_t default_window_bits{22};
+  static const uint64_t default_input_size{796};
+};
+
+TEST_F(BrotliCompressorImplTest, CallingFinishOnly) {
+  Buffer::OwnedImpl buffer;
+  BrotliCompressorImpl compressor(default_quality, default_window_bits);
+
+  TestUtility::feedBufferWithRandomCharacters(buffer, 4096);
+  const std::string original = buffer.toString();
+  compressor.compress(buffer, State::Finish);
+  EXPECT_NE(original, buffer.toString());
+  EXPECT_EQ(original, decompress(buffer));
+}
+
+TEST_F(BrotliCompressorImplTest, EmptyInput) {
+  Buffer::OwnedImpl buffer;
+  BrotliCompressorImpl compressor(default_quality, default_window_bits);
+
+  compressor.compress(buffer, State::Finish);
+  EXPECT_NE(0, buffer.length());
+  EXPECT_EQ("", decompress(buffer));
+}
+
+// Flushed output can be concatenated and decompressed once the stream is finished.
+TEST_F(BrotliCompressorImplTest, CompressWithSmallChunkSize) {
+  Buffer::OwnedImpl buffer;
+  Buffer::OwnedImpl accumulation_buffer;
+  std::string original;
+
+  BrotliCompressorImpl compressor(default_quality, default_window_bits, 8);
+  for (uint64_t i = 0; i < 10; i++) {
+    TestUtility::feedBufferWithRandomCharacters(buffer, default_input_size * i, i);
+    ASSERT_EQ(default_input_size * i, buffer.length());
+    original += buffer.toString();
+    compressor.compress(buffer, State::Flush);
+    accumulation_buffer.add(buffer);
+    buffer.drain(buffer.length());
+  }
+
+  compressor.compress(buffer, State::Finish);
+  accumulation_buffer.add(buffer);
+  EXPECT_EQ(original, decompress(accumulation_buffer));
+}
+
+TEST_F(BrotliCompressorImplTest, CompressWithNotCommonParams) {
+  Buffer::OwnedImpl buffer;
+  BrotliCompressorImpl compressor(0, 10);
+
+  // Repetitive input spread over several slices.
+  std::string original;
+  for (uint64_t i = 0; i < 100; i++) {
+    const std::string line = "{\"id\":" + std::to_string(i) + ",\"name\":\"envoy\"}\n";
+    buffer.add(line);
+    original += line;
+  }
+  compressor.compress(buffer, State::Finish);
+  EXPECT_LT(buffer.length(), original.size());
+  EXPECT_EQ(original, decompress(buffer));
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace Envoy
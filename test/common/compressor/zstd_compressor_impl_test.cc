@@ -0,0 +1,88 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/compressor/zstd_compressor_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+#include "zstd.h"
+
+namespace Envoy {
+namespace Compressor {
+namespace {
+
+class ZstdCompressorImplTest : public testing::Test {
+protected:
+  // Decompresses a complete zstd frame with the reference decoder.
+  static std::string decompress(const Buffer::Instance& compressed, uint64_t expected_size) {
+    const std::string input = compressed.toString();
+    std::string output(expected_size, '\0');
+    const size_t result = ZSTD_decompress(&output[0], output.size(), input.data(), input.size());
+    EXPECT_FALSE(ZSTD_isError(result)) << ZSTD_getErrorName(result);
+    EXPECT_EQ(expected_size, result);
+    return output;
+  }
+
+  static const uint32_t default_compression_level{3};
+  static const uint64_t default_input_size{796};
+};
+
+TEST_F(ZstdCompressorImplTest, CallingFinishOnly) {
+  Buffer::OwnedImpl buffer;
+  ZstdCompressorImpl compressor(default_compression_level, false);
+
+  TestUtility::feedBufferWithRandomCharacters(buffer, 4096);
+  const std::string original = buffer.toString();
+  compressor.compress(buffer, State::Finish);
+  EXPECT_NE(original, buffer.toString());
+  EXPECT_EQ(original, decompress(buffer, original.size()));
+}
+
+TEST_F(ZstdCompressorImplTest, EmptyInput) {
+  Buffer::OwnedImpl buffer;
+  ZstdCompressorImpl compressor(default_compression_level, false);
+
+  compressor.compress(buffer, State::Finish);
+  EXPECT_NE(0, buffer.length());
+  EXPECT_EQ("", decompress(buffer, 0));
+}
+
+// Flushed output can be concatenated and decompressed once the frame is finished.
+TEST_F(ZstdCompressorImplTest, CompressWithSmallChunkSize) {
+  Buffer::OwnedImpl buffer;
+  Buffer::OwnedImpl accumulation_buffer;
+  std::string original;
+
+  ZstdCompressorImpl compressor(default_compression_level, true, 8);
+  for (uint64_t i = 0; i < 10; i++) {
+    TestUtility::feedBufferWithRandomCharacters(buffer, default_input_size * i, i);
+    ASSERT_EQ(default_input_size * i, buffer.length());
+    original += buffer.toString();
+    compressor.compress(buffer, State::Flush);
+    accumulation_buffer.add(buffer);
+    buffer.drain(buffer.length());
+  }
+
+  compressor.compress(buffer, State::Finish);
+  accumulation_buffer.add(buffer);
+  EXPECT_EQ(original, decompress(accumulation_buffer, original.size()));
+}
+
+TEST_F(ZstdCompressorImplTest, CompressWithNotCommonParams) {
+  Buffer::OwnedImpl buffer;
+  ZstdCompressorImpl compressor(19, true);
+
+  // Repetitive input spread over several slices.
+  std::string original;
+  for (uint64_t i = 0; i < 100; i++) {
+    const std::string line = "{\"id\":" + std::to_string(i) + ",\"name\":\"envoy\"}\n";
+    buffer.add(line);
+    original += line;
+  }
+  compressor.compress(buffer, State::Finish);
+  EXPECT_LT(buffer.length(), original.size());
+  EXPECT_EQ(original, decompress(buffer, original.size()));
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace Envoy
@@ -251,6 +251,56 @@ TEST_F(ZlibDecompressorImplTest, CompressDecompressOfMultipleSlices) {
   EXPECT_EQ(original_text, decompressed_text);
 }
 
+// Exercises decompression of one stream fed in many small pieces, so that most calls end in a
+// partially filled output chunk.
+TEST_F(ZlibDecompressorImplTest, DecompressInPieces) {
+  Buffer::OwnedImpl buffer;
+  Buffer::OwnedImpl accumulation_buffer;
+
+  Envoy::Compressor::ZlibCompressorImpl compressor;
+  compressor.init(Envoy::Compressor::ZlibCompressorImpl::CompressionLevel::Standard,
+                  Envoy::Compressor::ZlibCompressorImpl::CompressionStrategy::Standard,
+                  gzip_window_bits, memory_level);
+
+  TestUtility::feedBufferWithRandomCharacters(buffer, 10000);
+  const std::string original_text{buffer.toString()};
+  compressor.compress(buffer, Compressor::State::Finish);
+  accumulation_buffer.add(buffer);
+  drainBuffer(buffer);
+
+  ZlibDecompressorImpl decompressor(256);
+  decompressor.init(gzip_window_bits);
+
+  while (accumulation_buffer.length() > 0) {
+    Buffer::OwnedImpl piece;
+    piece.move(accumulation_buffer, std::min<uint64_t>(accumulation_buffer.length(), 100));
+    decompressor.decompress(piece, buffer);
+  }
+  std::string decompressed_text{buffer.toString()};
+
+  ASSERT_EQ(compressor.checksum(), decompressor.checksum());
+  ASSERT_EQ(original_text.length(), decompressed_text.length());
+  EXPECT_EQ(original_text, decompressed_text);
+}
+
+// Malformed input is reported rather than fatal.
+TEST_F(ZlibDecompressorImplTest, DecompressMalformedInput) {
+  Buffer::OwnedImpl input_buffer("this is not a gzip stream");
+  Buffer::OwnedImpl output_buffer;
+
+  ZlibDecompressorImpl decompressor;
+  decompressor.init(gzip_window_bits);
+  EXPECT_FALSE(decompressor.decompressionError());
+  decompressor.decompress(input_buffer, output_buffer);
+  EXPECT_TRUE(decompressor.decompressionError());
+
+  // Further input is ignored.
+  Buffer::OwnedImpl more_input("more");
+  decompressor.decompress(more_input, output_buffer);
+  EXPECT_TRUE(decompressor.decompressionError());
+  EXPECT_EQ(0, output_buffer.length());
+}
+
 } // namespace
 } // namespace Decompressor
 } // namespace Envoy
@@ -26,7 +26,8 @@ public:
                    const std::string& to_az = EMPTY_STRING) {
     Http::CodeStats::ResponseStatInfo info{
         global_store_,      cluster_scope_,        "prefix.", code,  internal_request,
-        request_vhost_name, request_vcluster_name, from_az,   to_az, canary};
+        request_vhost_name, request_vcluster_name, from_az,   to_az, canary,
+        counters_.get()};
 
     code_stats_.chargeResponseStat(info);
   }
@@ -43,6 +44,10 @@ public:
     addResponse(200, false, false, "", "", "from_az", "to_az");
   }
 
+  void useResponseCounters() {
+    counters_ = code_stats_.createResponseCounters(cluster_scope_, "prefix.");
+  }
+
   void responseTiming() {
     Http::CodeStats::ResponseTimingInfo info{
         global_store_, cluster_scope_, "prefix.",    std::chrono::milliseconds(5),
@@ -54,6 +59,7 @@ public:
   Stats::IsolatedStoreImpl global_store_;
   Stats::IsolatedStoreImpl cluster_scope_;
   Http::CodeStatsImpl code_stats_;
+  Http::CodeStats::ResponseCountersPtr counters_;
 };
 
 } // namespace Http
@@ -68,6 +74,16 @@ static void BM_AddResponses(benchmark::State& state) {
 }
 BENCHMARK(BM_AddResponses);
 
+static void BM_AddResponsesWithCounters(benchmark::State& state) {
+  Envoy::Http::CodeUtilitySpeedTest context;
+  context.useResponseCounters();
+
+  for (auto _ : state) {
+    context.addResponses();
+  }
+}
+BENCHMARK(BM_AddResponsesWithCounters);
+
 static void BM_ResponseTiming(benchmark::State& state) {
   Envoy::Http::CodeUtilitySpeedTest context;
 
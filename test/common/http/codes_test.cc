@@ -1,5 +1,6 @@
 #include <chrono>
 #include <cstdint>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -31,7 +32,7 @@ public:
                    const std::string& to_az = EMPTY_STRING) {
     Http::CodeStats::ResponseStatInfo info{
         global_store_,      cluster_scope_,        "prefix.", code,  internal_request,
-        request_vhost_name, request_vcluster_name, from_az,   to_az, canary};
+        request_vhost_name, request_vcluster_name, from_az,   to_az, canary, nullptr};
 
     code_stats_.chargeResponseStat(info);
   }
@@ -197,6 +198,39 @@ TEST_F(CodeUtilityTest, PerZoneStats) {
   EXPECT_EQ(1U, cluster_scope_.counter("prefix.zone.from_az.to_az.upstream_rq_2xx").value());
 }
 
+// Charging through ResponseCounters must produce exactly the counters charged by name.
+TEST_F(CodeUtilityTest, ResponseCounters) {
+  Stats::IsolatedStoreImpl counters_scope;
+  CodeStats::ResponseCountersPtr counters =
+      code_stats_.createResponseCounters(counters_scope, "prefix.");
+
+  for (const uint64_t code : {100, 200, 201, 206, 226, 304, 308, 404, 418, 429, 503, 599, 600}) {
+    for (const bool canary : {false, true}) {
+      for (const bool internal_request : {false, true}) {
+        addResponse(code, canary, internal_request, "", "", "from_az", "to_az");
+
+        Http::CodeStats::ResponseStatInfo info{
+            global_store_, counters_scope, "prefix.", code,    internal_request,
+            EMPTY_STRING,  EMPTY_STRING,   "from_az", "to_az", canary,
+            counters.get()};
+        code_stats_.chargeResponseStat(info);
+      }
+    }
+  }
+
+  std::map<std::string, uint64_t> expected;
+  for (const Stats::CounterSharedPtr& counter : cluster_scope_.counters()) {
+    expected[counter->name()] = counter->value();
+  }
+  std::map<std::string, uint64_t> actual;
+  for (const Stats::CounterSharedPtr& counter : counters_scope.counters()) {
+    actual[counter->name()] = counter->value();
+  }
+  EXPECT_EQ(expected, actual);
+  EXPECT_EQ(4U, actual["prefix.upstream_rq_404"]);
+  EXPECT_EQ(2U, actual["prefix.canary.upstream_rq_600"]);
+}
+
 TEST(CodeUtilityResponseTimingTest, All) {
   Stats::MockStore global_store;
   Stats::MockStore cluster_scope;
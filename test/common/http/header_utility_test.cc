@@ -403,6 +403,53 @@ invert_match: true
   EXPECT_FALSE(HeaderUtility::matchHeaders(unmatching_headers, header_data));
 }
 
+TEST(MatchHeadersTest, InlineHeaderData) {
+  TestHeaderMapImpl headers{{":method", "GET"}, {"host", "lyft.com"}};
+
+  const HeaderUtility::HeaderData method(parseHeaderMatcherFromYaml("{name: \":method\"}"));
+  EXPECT_NE(nullptr, method.inline_header_);
+  const HeaderUtility::HeaderData host(
+      parseHeaderMatcherFromYaml("{name: host, exact_match: lyft.com}"));
+  EXPECT_NE(nullptr, host.inline_header_);
+  const HeaderUtility::HeaderData other(parseHeaderMatcherFromYaml("{name: x-other}"));
+  EXPECT_EQ(nullptr, other.inline_header_);
+
+  EXPECT_TRUE(HeaderUtility::matchHeaders(headers, method));
+  EXPECT_TRUE(HeaderUtility::matchHeaders(headers, host));
+  EXPECT_FALSE(HeaderUtility::matchHeaders(headers, other));
+}
+
+TEST(MatchHeadersTest, HeaderDataList) {
+  Protobuf::RepeatedPtrField<envoy::api::v2::route::HeaderMatcher> config;
+  for (const std::string& yaml : {
+           "{name: \":method\", exact_match: GET}",
+           "{name: x-first, exact_match: a}",
+           "{name: x-second, range_match: {start: 1, end: 10}}",
+           "{name: x-second, prefix_match: \"5\"}",
+           "{name: x-absent, present_match: true, invert_match: true}",
+       }) {
+    *config.Add() = parseHeaderMatcherFromYaml(yaml);
+  }
+  const HeaderUtility::HeaderDataList header_data(config);
+
+  EXPECT_TRUE(header_data.matches(
+      TestHeaderMapImpl{{":method", "GET"}, {"x-second", "5"}, {"x-first", "a"}}));
+  // The first header with a name is matched, like HeaderMap::get().
+  EXPECT_TRUE(header_data.matches(TestHeaderMapImpl{
+      {":method", "GET"}, {"x-first", "a"}, {"x-second", "5"}, {"x-second", "20"}}));
+  EXPECT_FALSE(header_data.matches(TestHeaderMapImpl{
+      {":method", "GET"}, {"x-first", "a"}, {"x-second", "20"}, {"x-second", "5"}}));
+  EXPECT_FALSE(header_data.matches(
+      TestHeaderMapImpl{{":method", "POST"}, {"x-first", "a"}, {"x-second", "5"}}));
+  EXPECT_FALSE(header_data.matches(TestHeaderMapImpl{{":method", "GET"}, {"x-second", "5"}}));
+  EXPECT_FALSE(header_data.matches(TestHeaderMapImpl{
+      {":method", "GET"}, {"x-first", "a"}, {"x-second", "5"}, {"x-absent", "1"}}));
+
+  const HeaderUtility::HeaderDataList empty_header_data(
+      Protobuf::RepeatedPtrField<envoy::api::v2::route::HeaderMatcher>{});
+  EXPECT_TRUE(empty_header_data.matches(TestHeaderMapImpl{}));
+}
+
 TEST(HeaderAddTest, HeaderAdd) {
   TestHeaderMapImpl headers{{"myheader1", "123value"}};
   TestHeaderMapImpl headers_to_add{{"myheader2", "456value"}};
@@ -37,6 +37,7 @@ using testing::MockFunction;
 using testing::NiceMock;
 using testing::Return;
 using testing::ReturnRef;
+using testing::SaveArg;
 using testing::StrNe;
 
 namespace Envoy {
@@ -257,7 +258,7 @@ TEST(RouteMatcherTest, TestRoutes) {
         {"pattern": "^/rides$", "method": "POST", "name": "ride_request"},
         {"pattern": "^/rides/\\d+$", "method": "PUT", "name": "update_ride"},
         {"pattern": "^/users/\\d+/chargeaccounts$", "method": "POST", "name": "cc_add"},
-        {"pattern": "^/users/\\d+/chargeaccounts/(?!validate)\\w+$", "method": "PUT",
+        {"pattern": "^/users/\\d+/chargeaccounts/[a-uw-zA-Z0-9_]\\w*$", "method": "PUT",
          "name": "cc_add"},
         {"pattern": "^/users$", "method": "POST", "name": "create_user_login"},
         {"pattern": "^/users/\\d+$", "method": "PUT", "name": "update_user"},
@@ -564,6 +565,395 @@ virtual_hosts:
             config.route(genHeaders("example.com", "/", "GET"), 0)->routeEntry()->clusterName());
 }
 
+// Unchanged virtual hosts are reused by a configuration built from a previous one, and outlive it.
+TEST(RouteMatcherTest, ReuseUnchangedVirtualHosts) {
+  const std::string yaml = R"EOF(
+name: foo
+virtual_hosts:
+  - name: unchanged
+    domains: ["unchanged.lyft.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "unchanged" }
+  - name: changed
+    domains: ["changed.lyft.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "before" }
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  auto previous_config =
+      std::make_unique<ConfigImpl>(parseRouteConfigurationFromV2Yaml(yaml), factory_context,
+                                   true, nullptr);
+  EXPECT_EQ(0, previous_config->virtualHostsReused());
+  EXPECT_EQ(2, previous_config->virtualHostsBuilt());
+  const RouteConstSharedPtr unchanged_route =
+      previous_config->route(genHeaders("unchanged.lyft.com", "/", "GET"), 0);
+
+  auto route_config = parseRouteConfigurationFromV2Yaml(yaml);
+  route_config.mutable_virtual_hosts(1)->mutable_routes(0)->mutable_route()->set_cluster("after");
+  ConfigImpl config(route_config, factory_context, true, previous_config.get());
+  EXPECT_EQ(1, config.virtualHostsReused());
+  EXPECT_EQ(1, config.virtualHostsBuilt());
+  previous_config.reset();
+
+  EXPECT_EQ(unchanged_route, config.route(genHeaders("unchanged.lyft.com", "/", "GET"), 0));
+  EXPECT_EQ("after", config.route(genHeaders("changed.lyft.com", "/", "GET"), 0)
+                         ->routeEntry()
+                         ->clusterName());
+  EXPECT_EQ("foo", unchanged_route->routeEntry()->virtualHost().routeConfig().name());
+
+  // Nothing is reused once the part of the configuration shared by virtual hosts changes.
+  route_config.add_internal_only_headers("x-lyft-user-id");
+  ConfigImpl next_config(route_config, factory_context, true, &config);
+  EXPECT_EQ(0, next_config.virtualHostsReused());
+  EXPECT_EQ(2, next_config.virtualHostsBuilt());
+  EXPECT_EQ(1, next_config.internalOnlyHeaders().size());
+}
+
+// The shared part of a configuration is compared field by field, ignoring the virtual hosts.
+TEST(RouteMatcherTest, CommonConfigBuiltFrom) {
+  const std::string yaml = R"EOF(
+name: foo
+internal_only_headers: ["x-lyft-user-id"]
+virtual_hosts:
+  - name: www
+    domains: ["www.lyft.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "www" }
+  )EOF";
+
+  auto route_config = parseRouteConfigurationFromV2Yaml(yaml);
+  const CommonConfigImpl common_config(route_config);
+  EXPECT_TRUE(common_config.builtFrom(route_config));
+
+  route_config.mutable_virtual_hosts(0)->add_domains("lyft.com");
+  EXPECT_TRUE(common_config.builtFrom(route_config));
+
+  route_config.add_response_headers_to_remove("x-envoy-upstream-canary");
+  EXPECT_FALSE(common_config.builtFrom(route_config));
+}
+
+TEST(RouteMatcherTest, LazyVirtualHosts) {
+  const std::string yaml = R"EOF(
+name: foo
+lazy_virtual_hosts:
+  idle_timeout: 1s
+  max_cached_virtual_hosts: 2
+virtual_hosts:
+  - name: first
+    domains: ["first.lyft.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "first" }
+  - name: second
+    domains: ["second.lyft.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "second" }
+  - name: third
+    domains: ["*"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "third" }
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context, false);
+  auto& stats = factory_context.scope_;
+  const auto virtual_host = [&config](const std::string& host) -> const VirtualHost* {
+    return &config.route(genHeaders(host, "/", "GET"), 0)->routeEntry()->virtualHost();
+  };
+
+  // Virtual hosts are built on their first request and then kept.
+  const RouteConstSharedPtr first_route = config.route(genHeaders("first.lyft.com", "/", "GET"), 0);
+  EXPECT_EQ("first", first_route->routeEntry()->clusterName());
+  const VirtualHost* first = &first_route->routeEntry()->virtualHost();
+  // Holding the routes keeps their virtual hosts alive, so that a rebuilt one has a new address.
+  const RouteConstSharedPtr second_route =
+      config.route(genHeaders("second.lyft.com", "/", "GET"), 0);
+  const VirtualHost* second = &second_route->routeEntry()->virtualHost();
+  EXPECT_EQ(first, virtual_host("first.lyft.com"));
+  EXPECT_EQ(2U, stats.counter("lazy_virtual_hosts.foo.built").value());
+
+  // Once two are kept, the least recently used one is evicted to make room for another.
+  EXPECT_EQ("third",
+            config.route(genHeaders("www.lyft.com", "/", "GET"), 0)->routeEntry()->clusterName());
+  EXPECT_EQ(1U, stats.counter("lazy_virtual_hosts.foo.evicted").value());
+  EXPECT_EQ(first, virtual_host("first.lyft.com"));
+  EXPECT_NE(second, virtual_host("second.lyft.com"));
+  EXPECT_EQ(4U, stats.counter("lazy_virtual_hosts.foo.built").value());
+  EXPECT_EQ(2U, stats.counter("lazy_virtual_hosts.foo.evicted").value());
+
+  // Once idle, the first virtual host is evicted by a lookup of another one, and then rebuilt.
+  factory_context.timeSystem().sleep(std::chrono::seconds(2));
+  virtual_host("second.lyft.com");
+  EXPECT_EQ(3U, stats.counter("lazy_virtual_hosts.foo.evicted").value());
+  EXPECT_NE(first, virtual_host("first.lyft.com"));
+  EXPECT_EQ(5U, stats.counter("lazy_virtual_hosts.foo.built").value());
+
+  // Routes keep their virtual host alive after it is evicted.
+  EXPECT_EQ("first", first_route->routeEntry()->virtualHost().name());
+  EXPECT_EQ("second", second_route->routeEntry()->virtualHost().name());
+  EXPECT_EQ(0U, stats.counter("lazy_virtual_hosts.foo.build_failed").value());
+}
+
+// An invalid virtual host rejects the configuration, even though it is built lazily.
+TEST(RouteMatcherTest, LazyVirtualHostsInvalid) {
+  const std::string yaml = R"EOF(
+lazy_virtual_hosts: {}
+virtual_hosts:
+  - name: invalid
+    domains: ["*"]
+    routes:
+      - match: { regex: "/(foo" }
+        route: { cluster: "invalid" }
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  EXPECT_THROW(TestConfigImpl(parseRouteConfigurationFromV2Yaml(yaml), factory_context, false),
+               EnvoyException);
+}
+
+TEST(RouteMatcherTest, RouteCache) {
+  const std::string yaml = R"EOF(
+name: foo
+route_cache:
+  max_entries: 2
+virtual_hosts:
+  - name: cached
+    domains: ["cached.lyft.com"]
+    routes:
+      - match: { prefix: "/", headers: [{ name: x-version, exact_match: "2" }] }
+        route: { cluster: "v2" }
+      - match: { prefix: "/" }
+        route: { cluster: "v1" }
+  - name: weighted
+    domains: ["weighted.lyft.com"]
+    routes:
+      - match: { prefix: "/" }
+        route:
+          weighted_clusters:
+            clusters:
+              - { name: "a", weight: 50 }
+              - { name: "b", weight: 50 }
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context, false);
+  auto& stats = factory_context.scope_;
+
+  // The header the routes match on is part of the key.
+  EXPECT_EQ("v1", config.route(genHeaders("cached.lyft.com", "/", "GET"), 0)
+                      ->routeEntry()
+                      ->clusterName());
+  Http::TestHeaderMapImpl v2_headers = genHeaders("cached.lyft.com", "/", "GET");
+  v2_headers.addCopy("x-version", "2");
+  EXPECT_EQ("v2", config.route(v2_headers, 0)->routeEntry()->clusterName());
+  EXPECT_EQ("v1", config.route(genHeaders("cached.lyft.com", "/", "GET"), 0)
+                      ->routeEntry()
+                      ->clusterName());
+  EXPECT_EQ("v2", config.route(v2_headers, 0)->routeEntry()->clusterName());
+  EXPECT_EQ(2U, stats.counter("route_cache.foo.miss").value());
+  EXPECT_EQ(2U, stats.counter("route_cache.foo.hit").value());
+
+  // Weighted clusters are picked for each request.
+  EXPECT_EQ("a", config.route(genHeaders("weighted.lyft.com", "/", "GET"), 0)
+                     ->routeEntry()
+                     ->clusterName());
+  EXPECT_EQ("b", config.route(genHeaders("weighted.lyft.com", "/", "GET"), 99)
+                     ->routeEntry()
+                     ->clusterName());
+  EXPECT_EQ(2U, stats.counter("route_cache.foo.bypass").value());
+
+  // The cache is cleared once full.
+  EXPECT_EQ(nullptr, config.route(genHeaders("unknown.lyft.com", "/", "GET"), 0));
+  EXPECT_EQ(1U, stats.counter("route_cache.foo.overflow").value());
+  EXPECT_EQ(nullptr, config.route(genHeaders("unknown.lyft.com", "/", "GET"), 0));
+  EXPECT_EQ(3U, stats.counter("route_cache.foo.hit").value());
+}
+
+// A missing header does not share its key with a present one, whatever its value.
+TEST(RouteMatcherTest, RouteCacheMissingHeader) {
+  const std::string yaml = R"EOF(
+route_cache: {}
+virtual_hosts:
+  - name: cached
+    domains: ["*"]
+    routes:
+      - match: { prefix: "/", headers: [{ name: x-version }] }
+        route: { cluster: "present" }
+      - match: { prefix: "/" }
+        route: { cluster: "missing" }
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context, false);
+  Http::TestHeaderMapImpl present_headers = genHeaders("cached.lyft.com", "/", "GET");
+  present_headers.addCopy("x-version", "\x01");
+  EXPECT_EQ("present", config.route(present_headers, 0)->routeEntry()->clusterName());
+  EXPECT_EQ("missing", config.route(genHeaders("cached.lyft.com", "/", "GET"), 0)
+                           ->routeEntry()
+                           ->clusterName());
+  EXPECT_EQ(2U, factory_context.scope_.counter("route_cache.miss").value());
+}
+
+// The routes of an evicted lazy virtual host are dropped from the cache, so that they do not keep
+// it alive.
+TEST(RouteMatcherTest, RouteCacheLazyVirtualHostEvicted) {
+  const std::string yaml = R"EOF(
+route_cache: {}
+lazy_virtual_hosts:
+  max_cached_virtual_hosts: 1
+virtual_hosts:
+  - name: first
+    domains: ["first.lyft.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "first" }
+  - name: second
+    domains: ["second.lyft.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "second" }
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context, false);
+  std::weak_ptr<const Route> first_route =
+      config.route(genHeaders("first.lyft.com", "/", "GET"), 0);
+  EXPECT_FALSE(first_route.expired());
+
+  // Building the second virtual host evicts the first one, whose route is dropped by the next
+  // lookup.
+  config.route(genHeaders("second.lyft.com", "/", "GET"), 0);
+  EXPECT_EQ(1U, factory_context.scope_.counter("lazy_virtual_hosts.evicted").value());
+  EXPECT_EQ("second", config.route(genHeaders("second.lyft.com", "/", "GET"), 0)
+                          ->routeEntry()
+                          ->clusterName());
+  EXPECT_TRUE(first_route.expired());
+}
+
+// The route cache's slot is freed on the main thread when the last reference to the config is
+// dropped on a worker.
+TEST(RouteMatcherTest, RouteCacheFreedOnMainThread) {
+  const std::string yaml = R"EOF(
+route_cache: {}
+virtual_hosts:
+  - name: cached
+    domains: ["cached.lyft.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "v1" }
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  std::shared_ptr<const ConfigImpl> config = std::make_shared<const ConfigImpl>(
+      parseRouteConfigurationFromV2Yaml(yaml), factory_context, false);
+  EXPECT_EQ("v1", config->route(genHeaders("cached.lyft.com", "/", "GET"), 0)
+                      ->routeEntry()
+                      ->clusterName());
+  ThreadLocal::ThreadLocalObjectSharedPtr& cache = factory_context.thread_local_.data_.back();
+  EXPECT_NE(nullptr, cache);
+
+  Event::PostCb free_slot;
+  EXPECT_CALL(factory_context.dispatcher_, post(_)).WillOnce(SaveArg<0>(&free_slot));
+  Thread::ThreadPtr worker =
+      Thread::threadFactoryForTest().createThread([&config]() { config.reset(); });
+  worker->join();
+  EXPECT_NE(nullptr, cache);
+
+  free_slot();
+  EXPECT_EQ(nullptr, cache);
+}
+
+TEST(RouteMatcherTest, TestPrefixWildcardDomains) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+  - name: prefix
+    domains: ["api.*"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "prefix" }
+  - name: suffix
+    domains: ["*.solo.io"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "suffix" }
+  - name: default
+    domains: ["*"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: "default" }
+  )EOF";
+
+  const auto proto_config = parseRouteConfigurationFromV2Yaml(yaml);
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  TestConfigImpl config(proto_config, factory_context, true);
+
+  EXPECT_EQ("prefix",
+            config.route(genHeaders("API.lyft.com", "/", "GET"), 0)->routeEntry()->clusterName());
+  EXPECT_EQ("suffix",
+            config.route(genHeaders("api.solo.io", "/", "GET"), 0)->routeEntry()->clusterName());
+  EXPECT_EQ("default",
+            config.route(genHeaders("api.", "/", "GET"), 0)->routeEntry()->clusterName());
+}
+
+// Routes are matched in config order regardless of their kind, including when a later route has
+// a longer matching prefix or an earlier one fails on a non-path condition.
+TEST(RouteMatcherTest, TestRoutesMatchInConfigOrder) {
+  const std::string yaml = R"EOF(
+name: foo
+virtual_hosts:
+  - name: default
+    domains: ["*"]
+    routes:
+      - match:
+          prefix: "/api"
+          headers:
+            - name: x-canary
+              exact_match: "true"
+        route: { cluster: "canary" }
+      - match: { regex: "/api/v[0-9]+/users" }
+        route: { cluster: "regex" }
+      - match: { prefix: "/API/V1", case_sensitive: false }
+        route: { cluster: "v1_insensitive" }
+      - match: { path: "/api/v2/items" }
+        route: { cluster: "v2_items" }
+      - match: { path: "/API/V2/ITEMS/ALL", case_sensitive: false }
+        route: { cluster: "v2_items_all" }
+      - match: { prefix: "/api/v2" }
+        route: { cluster: "v2" }
+      - match: { prefix: "/api/v2/items" }
+        route: { cluster: "unreachable" }
+      - match: { prefix: "" }
+        route: { cluster: "default" }
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context, true);
+
+  auto cluster = [&config](const std::string& path) -> std::string {
+    return config.route(genHeaders("www.lyft.com", path, "GET"), 0)->routeEntry()->clusterName();
+  };
+
+  Http::TestHeaderMapImpl canary_headers = genHeaders("www.lyft.com", "/api/v2/items", "GET");
+  canary_headers.addCopy("x-canary", "true");
+  EXPECT_EQ("canary", config.route(canary_headers, 0)->routeEntry()->clusterName());
+  EXPECT_EQ("regex", cluster("/api/v1/users"));
+  EXPECT_EQ("v1_insensitive", cluster("/api/v1/items"));
+  EXPECT_EQ("v1_insensitive", cluster("/Api/V1"));
+  EXPECT_EQ("v2_items", cluster("/api/v2/items"));
+  EXPECT_EQ("v2_items", cluster("/api/v2/items?all=true"));
+  EXPECT_EQ("v2_items_all", cluster("/api/v2/items/all?x=1"));
+  EXPECT_EQ("v2", cluster("/api/v2/items/other"));
+  EXPECT_EQ("v2", cluster("/api/v2/ITEMS"));
+  EXPECT_EQ("default", cluster("/API/v2"));
+  EXPECT_EQ("default", cluster("/"));
+}
+
 TEST(RouteMatcherTest, TestRoutesWithInvalidRegex) {
   std::string invalid_route = R"EOF(
 virtual_hosts:
@@ -5218,6 +5608,37 @@ public:
   NiceMock<Server::Configuration::MockFactoryContext> factory_context_;
 };
 
+// Lazy virtual hosts with per filter configs are built once, on the main thread, and kept.
+TEST_F(PerFilterConfigsTest, LazyVirtualHostKeptBuilt) {
+  const std::string yaml = R"EOF(
+name: foo
+lazy_virtual_hosts:
+  max_cached_virtual_hosts: 1
+virtual_hosts:
+  - name: bar
+    domains: ["www.foo.com"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: baz }
+    per_filter_config: { test.filter: { seconds: 456 } }
+  - name: other
+    domains: ["*"]
+    routes:
+      - match: { prefix: "/" }
+        route: { cluster: other }
+)EOF";
+
+  const TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context_, true);
+  const VirtualHost& vhost =
+      config.route(genHeaders("www.foo.com", "/", "GET"), 0)->routeEntry()->virtualHost();
+  check(vhost.perFilterConfigTyped<DerivedFilterConfig>(factory_.name()), 456, "virtual host");
+
+  config.route(genHeaders("other.foo.com", "/", "GET"), 0);
+  EXPECT_EQ(&vhost,
+            &config.route(genHeaders("www.foo.com", "/", "GET"), 0)->routeEntry()->virtualHost());
+  EXPECT_EQ(1U, factory_context_.scope_.counter("lazy_virtual_hosts.foo.built").value());
+}
+
 TEST_F(PerFilterConfigsTest, UnknownFilter) {
   const std::string yaml = R"EOF(
 name: foo
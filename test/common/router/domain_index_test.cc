@@ -0,0 +1,68 @@
+#include "common/router/domain_index.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+TEST(DomainIndexTest, Empty) {
+  DomainIndex index;
+  EXPECT_TRUE(index.empty());
+  EXPECT_EQ(-1, index.find("www.lyft.com"));
+  EXPECT_EQ(-1, index.find(""));
+}
+
+TEST(DomainIndexTest, Exact) {
+  DomainIndex index;
+  EXPECT_TRUE(index.add("www.lyft.com", 0));
+  EXPECT_TRUE(index.add("lyft.com", 1));
+  EXPECT_FALSE(index.add("WWW.lyft.com", 2));
+  EXPECT_FALSE(index.empty());
+
+  EXPECT_EQ(0, index.find("www.lyft.com"));
+  EXPECT_EQ(0, index.find("WWW.Lyft.COM"));
+  EXPECT_EQ(1, index.find("lyft.com"));
+  EXPECT_EQ(-1, index.find("api.lyft.com"));
+  EXPECT_EQ(-1, index.find("yft.com"));
+}
+
+TEST(DomainIndexTest, SuffixWildcards) {
+  DomainIndex index;
+  EXPECT_TRUE(index.add("*.lyft.com", 0));
+  EXPECT_TRUE(index.add("*-bar.baz.com", 1));
+  EXPECT_TRUE(index.add("*.baz.com", 2));
+  EXPECT_TRUE(index.add("*.LYFT.com", 3));
+  EXPECT_TRUE(index.add("www.lyft.com", 4));
+
+  EXPECT_EQ(0, index.find("api.lyft.com"));
+  EXPECT_EQ(0, index.find("a.b.Lyft.com"));
+  EXPECT_EQ(4, index.find("www.lyft.com"));
+  // The wildcard does not match the empty string.
+  EXPECT_EQ(-1, index.find(".lyft.com"));
+  EXPECT_EQ(-1, index.find("lyft.com"));
+  // The longest wildcard wins.
+  EXPECT_EQ(1, index.find("foo-bar.baz.com"));
+  EXPECT_EQ(2, index.find("-bar.baz.com"));
+  EXPECT_EQ(2, index.find("foo.baz.com"));
+}
+
+TEST(DomainIndexTest, PrefixWildcards) {
+  DomainIndex index;
+  EXPECT_TRUE(index.add("api.*", 0));
+  EXPECT_TRUE(index.add("api.lyft.*", 1));
+  EXPECT_TRUE(index.add("*.com", 2));
+  EXPECT_TRUE(index.add("api.lyft.net", 3));
+
+  EXPECT_EQ(0, index.find("api.foo"));
+  EXPECT_EQ(1, index.find("API.lyft.org"));
+  EXPECT_EQ(-1, index.find("api."));
+  EXPECT_EQ(-1, index.find("www.foo"));
+  // Exact domains and suffix wildcards are preferred over prefix wildcards.
+  EXPECT_EQ(3, index.find("api.lyft.net"));
+  EXPECT_EQ(2, index.find("api.lyft.com"));
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
@@ -41,6 +41,11 @@ public:
       auto f = StreamInfoHeaderFormatter(variable, false);
       const std::string formatted_string = f.format(stream_info);
       EXPECT_EQ(expected_output, formatted_string);
+      EXPECT_EQ(nullptr, f.constantValue());
+
+      std::string buf = "prefix:";
+      f.formatInto(stream_info, buf);
+      EXPECT_EQ("prefix:" + expected_output, buf);
     }
   }
 
@@ -518,6 +523,39 @@ request_headers_to_add:
   req_header_parser->evaluateHeaders(header_map, stream_info);
   EXPECT_TRUE(header_map.has("static-header"));
   EXPECT_EQ("static-value", header_map.get_("static-header"));
+  // Constant values are added by reference.
+  EXPECT_EQ(Http::HeaderString::Type::Reference,
+            header_map.get(Http::LowerCaseString("static-header"))->value().type());
+}
+
+// The headers to add are moved as their vector grows, and constant values must still be added by
+// reference afterwards.
+TEST(HeaderParserTest, EvaluateManyStaticHeaders) {
+  envoy::api::v2::route::Route route;
+  for (int i = 0; i < 20; ++i) {
+    auto* header_value_option = route.mutable_request_headers_to_add()->Add();
+    header_value_option->mutable_header()->set_key(fmt::format("static-header-{}", i));
+    header_value_option->mutable_header()->set_value(fmt::format("static-value-{}", i));
+  }
+  auto* header_value_option = route.mutable_request_headers_to_add()->Add();
+  header_value_option->mutable_header()->set_key("x-protocol");
+  header_value_option->mutable_header()->set_value("%PROTOCOL%");
+
+  HeaderParserPtr req_header_parser = HeaderParser::configure(route.request_headers_to_add());
+  Http::TestHeaderMapImpl header_map{{":method", "POST"}};
+  NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info;
+  absl::optional<Envoy::Http::Protocol> protocol = Envoy::Http::Protocol::Http11;
+  ON_CALL(stream_info, protocol()).WillByDefault(ReturnPointee(&protocol));
+  req_header_parser->evaluateHeaders(header_map, stream_info);
+
+  for (int i = 0; i < 20; ++i) {
+    const Http::HeaderEntry* header =
+        header_map.get(Http::LowerCaseString(fmt::format("static-header-{}", i)));
+    ASSERT_NE(nullptr, header);
+    EXPECT_EQ(fmt::format("static-value-{}", i), header->value().c_str());
+    EXPECT_EQ(Http::HeaderString::Type::Reference, header->value().type());
+  }
+  EXPECT_EQ("HTTP/1.1", header_map.get_("x-protocol"));
 }
 
 TEST(HeaderParserTest, EvaluateCompoundHeaders) {
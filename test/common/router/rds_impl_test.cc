@@ -246,9 +246,10 @@ TEST_F(RdsImplTest, Basic) {
   expectRequest();
   interval_timer_->callback_();
 
-  // Load the config and verified shared count.
+  // Load the config and verified shared count. The provider keeps a reference to reuse its virtual
+  // hosts on the next update.
   ConfigConstSharedPtr config = rds_->config();
-  EXPECT_EQ(2, config.use_count());
+  EXPECT_EQ(3, config.use_count());
 
   // Third request.
   const std::string response2_json = R"EOF(
@@ -298,6 +299,70 @@ TEST_F(RdsImplTest, Basic) {
             factory_context_.scope_.counter("foo.rds.foo_route_config.update_success").value());
   EXPECT_EQ(8808926191882896258U,
             factory_context_.scope_.gauge("foo.rds.foo_route_config.version").value());
+  EXPECT_EQ(1UL, factory_context_.scope_.counter("foo.rds.foo_route_config.virtual_host_rebuilt")
+                     .value());
+  EXPECT_EQ(0UL, factory_context_.scope_.counter("foo.rds.foo_route_config.virtual_host_reused")
+                     .value());
+
+  expectRequest();
+  interval_timer_->callback_();
+
+  // Fourth request adds a virtual host and leaves the existing one unchanged.
+  const std::string response3_json = R"EOF(
+  {
+    "virtual_hosts": [
+    {
+      "name": "local_service",
+      "domains": ["*"],
+      "routes": [
+        {
+          "prefix": "/foo",
+          "cluster_header": ":authority"
+        },
+        {
+          "prefix": "/bar",
+          "cluster": "bar"
+        }
+      ]
+    },
+    {
+      "name": "other_service",
+      "domains": ["other"],
+      "routes": [
+        {
+          "prefix": "/",
+          "cluster": "other"
+        }
+      ]
+    }
+  ]
+  }
+  )EOF";
+
+  message = std::make_unique<Http::ResponseMessageImpl>(
+      Http::HeaderMapPtr{new Http::TestHeaderMapImpl{{":status", "200"}}});
+  message->body() = std::make_unique<Buffer::OwnedImpl>(response3_json);
+
+  const Route* foo_route =
+      rds_->config()
+          ->route(Http::TestHeaderMapImpl{{":authority", "foo"}, {":path", "/bar"}}, 0)
+          .get();
+  EXPECT_CALL(*interval_timer_, enableTimer(_));
+  callbacks_->onSuccess(std::move(message));
+  EXPECT_EQ(foo_route,
+            rds_->config()
+                ->route(Http::TestHeaderMapImpl{{":authority", "foo"}, {":path", "/bar"}}, 0)
+                .get());
+  EXPECT_EQ("other", rds_->config()
+                         ->route(Http::TestHeaderMapImpl{{":authority", "other"}, {":path", "/"}},
+                                 0)
+                         ->routeEntry()
+                         ->clusterName());
+
+  EXPECT_EQ(2UL, factory_context_.scope_.counter("foo.rds.foo_route_config.virtual_host_rebuilt")
+                     .value());
+  EXPECT_EQ(1UL, factory_context_.scope_.counter("foo.rds.foo_route_config.virtual_host_reused")
+                     .value());
 }
 
 TEST_F(RdsImplTest, Failure) {
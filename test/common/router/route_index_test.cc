@@ -0,0 +1,92 @@
+#include "common/router/route_index.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+RouteIndex::Candidates findCandidates(const RouteIndex& index, absl::string_view path) {
+  RouteIndex::Candidates candidates;
+  index.findCandidates(path, candidates);
+  return candidates;
+}
+
+TEST(RouteIndexTest, Empty) {
+  RouteIndex index;
+  EXPECT_THAT(findCandidates(index, "/foo"), IsEmpty());
+  EXPECT_THAT(findCandidates(index, ""), IsEmpty());
+}
+
+TEST(RouteIndexTest, Prefixes) {
+  RouteIndex index;
+  index.addPrefix(0, "/foo/bar", true);
+  index.addPrefix(1, "/foo", true);
+  index.addPrefix(2, "/baz", true);
+  index.addPrefix(3, "/", true);
+  index.addPrefix(4, "/foo", true);
+  index.addPrefix(5, "", true);
+
+  EXPECT_THAT(findCandidates(index, "/foo/bar/baz"), ElementsAre(0, 1, 3, 4, 5));
+  EXPECT_THAT(findCandidates(index, "/foo?bar"), ElementsAre(1, 3, 4, 5));
+  EXPECT_THAT(findCandidates(index, "/fo"), ElementsAre(3, 5));
+  EXPECT_THAT(findCandidates(index, "/Foo"), ElementsAre(3, 5));
+  EXPECT_THAT(findCandidates(index, ""), ElementsAre(5));
+}
+
+TEST(RouteIndexTest, CaseInsensitivePrefixes) {
+  RouteIndex index;
+  index.addPrefix(0, "/Foo", false);
+  index.addPrefix(1, "/foo", true);
+
+  EXPECT_THAT(findCandidates(index, "/foo"), ElementsAre(0, 1));
+  EXPECT_THAT(findCandidates(index, "/FOO/bar"), ElementsAre(0));
+  EXPECT_THAT(findCandidates(index, "/bar"), IsEmpty());
+}
+
+TEST(RouteIndexTest, Paths) {
+  RouteIndex index;
+  index.addPath(0, "/foo", true);
+  index.addPath(1, "/Foo", false);
+  index.addPath(2, "/foo", true);
+
+  EXPECT_THAT(findCandidates(index, "/foo"), ElementsAre(0, 1, 2));
+  EXPECT_THAT(findCandidates(index, "/foo?bar=baz"), ElementsAre(0, 1, 2));
+  EXPECT_THAT(findCandidates(index, "/FOO"), ElementsAre(1));
+  EXPECT_THAT(findCandidates(index, "/foo/"), IsEmpty());
+}
+
+TEST(RouteIndexTest, Regexes) {
+  RouteIndex index;
+  index.addRegex(0, "/foo/\\d+");
+  index.addRegex(1, "/foo/.*");
+  index.addRegex(2, "/bar");
+  index.compile();
+
+  EXPECT_THAT(findCandidates(index, "/foo/123"), ElementsAre(0, 1));
+  EXPECT_THAT(findCandidates(index, "/foo/123?baz"), ElementsAre(0, 1));
+  EXPECT_THAT(findCandidates(index, "/foo/abc"), ElementsAre(1));
+  EXPECT_THAT(findCandidates(index, "/bar"), ElementsAre(2));
+  EXPECT_THAT(findCandidates(index, "/bar/baz"), IsEmpty());
+}
+
+TEST(RouteIndexTest, Mixed) {
+  RouteIndex index;
+  index.addRegex(0, "/.*");
+  index.addPath(1, "/foo", true);
+  index.addPrefix(2, "/f", true);
+  index.addRegex(3, "/fo+");
+  index.addPrefix(4, "/F", false);
+  index.compile();
+
+  EXPECT_THAT(findCandidates(index, "/foo"), ElementsAre(0, 1, 2, 3, 4));
+  EXPECT_THAT(findCandidates(index, "/bar"), ElementsAre(0));
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
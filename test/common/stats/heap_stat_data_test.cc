@@ -11,7 +11,6 @@ namespace Envoy {
 namespace Stats {
 
 // No truncation occurs in the implementation of HeapStatData.
-// Note: a similar test using RawStatData* is in raw_stat_data_test.cc.
 TEST(HeapStatDataTest, HeapNoTruncate) {
   StatsOptionsImpl stats_options;
   HeapStatDataAllocator alloc;
@@ -22,7 +21,6 @@ TEST(HeapStatDataTest, HeapNoTruncate) {
   alloc.free(*stat);
 }
 
-// Note: a similar test using RawStatData* is in raw_stat_data_test.cc.
 TEST(HeapStatDataTest, HeapAlloc) {
   HeapStatDataAllocator alloc;
   HeapStatData* stat_1 = alloc.alloc("ref_name");
@@ -0,0 +1,67 @@
+// Note: this should be run with --compilation_mode=opt, and on a box with many cores, as it
+// measures contention between the threads incrementing the same counter.
+//
+// NOLINT(namespace-envoy)
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/stats/heap_stat_data.h"
+
+#include "test/test_common/utility.h"
+
+#include "absl/synchronization/blocking_counter.h"
+#include "testing/base/public/benchmark.h"
+
+// Increments a counter from state.range(0) threads at once. The tag-extracted name determines
+// whether the counter is a plain or a sharded one.
+static void incrementFromThreads(benchmark::State& state, const std::string& tag_extracted_name) {
+  Envoy::Thread::ThreadFactory& thread_factory = Envoy::Thread::threadFactoryForTest();
+  Envoy::Stats::HeapStatDataAllocator alloc;
+  Envoy::Stats::CounterSharedPtr counter =
+      alloc.makeCounter("cluster.c1.upstream_rq_total", std::string(tag_extracted_name), {});
+
+  const int num_threads = state.range(0);
+  const uint64_t num_increments = 1000000;
+  for (auto _ : state) {
+    std::vector<Envoy::Thread::ThreadPtr> threads;
+    Envoy::ConditionalInitializer start;
+    absl::BlockingCounter done(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+      threads.push_back(thread_factory.createThread([&counter, &start, &done, num_increments]() {
+        start.wait();
+        for (uint64_t j = 0; j < num_increments; ++j) {
+          counter->inc();
+        }
+        done.DecrementCount();
+      }));
+    }
+    start.setReady();
+    done.Wait();
+    for (auto& thread : threads) {
+      thread->join();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * num_threads * num_increments);
+}
+
+static void BM_PlainCounter(benchmark::State& state) {
+  incrementFromThreads(state, "cluster.c1.upstream_rq_total");
+}
+BENCHMARK(BM_PlainCounter)->Arg(1)->Arg(4)->Arg(16)->Arg(32)->UseRealTime();
+
+static void BM_ShardedCounter(benchmark::State& state) {
+  incrementFromThreads(state, "cluster.upstream_rq_total");
+}
+BENCHMARK(BM_ShardedCounter)->Arg(1)->Arg(4)->Arg(16)->Arg(32)->UseRealTime();
+
+int main(int argc, char** argv) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logger_context(spdlog::level::warn,
+                                        Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,103 @@
+#include <string>
+#include <vector>
+
+#include "common/stats/heap_stat_data.h"
+#include "common/stats/sharded_counter.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Stats {
+
+TEST(CounterShardsTest, ConcurrentAdds) {
+  CounterShards shards;
+  constexpr int num_threads = 16;
+  constexpr uint64_t num_adds = 10000;
+  std::vector<Thread::ThreadPtr> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.push_back(Thread::threadFactoryForTest().createThread([&shards]() {
+      for (uint64_t j = 0; j < num_adds; ++j) {
+        shards.add(1);
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+
+  EXPECT_EQ(num_threads * num_adds, shards.sum());
+  EXPECT_EQ(num_threads * num_adds, shards.latch());
+  EXPECT_EQ(0, shards.sum());
+  EXPECT_EQ(0, shards.latch());
+}
+
+TEST(CounterShardsTest, HotCounters) {
+  EXPECT_TRUE(CounterShards::isHotCounter("cluster.upstream_rq_total"));
+  EXPECT_TRUE(CounterShards::isHotCounter("http.downstream_cx_rx_bytes_total"));
+  EXPECT_FALSE(CounterShards::isHotCounter("cluster.c1.upstream_rq_total"));
+  EXPECT_FALSE(CounterShards::isHotCounter("cluster.upstream_cx_total"));
+}
+
+TEST(ShardedCounterTest, HotCountersAreSharded) {
+  HeapStatDataAllocator alloc;
+  CounterSharedPtr hot =
+      alloc.makeCounter("cluster.c1.upstream_rq_total", "cluster.upstream_rq_total", {});
+  CounterSharedPtr cold =
+      alloc.makeCounter("cluster.c1.upstream_cx_total", "cluster.upstream_cx_total", {});
+  EXPECT_NE(nullptr, dynamic_cast<ShardedCounterImpl<HeapStatData>*>(hot.get()));
+  EXPECT_EQ(nullptr, dynamic_cast<ShardedCounterImpl<HeapStatData>*>(cold.get()));
+}
+
+TEST(ShardedCounterTest, AddAndLatch) {
+  HeapStatDataAllocator alloc;
+  CounterSharedPtr counter =
+      alloc.makeCounter("cluster.c1.upstream_rq_total", "cluster.upstream_rq_total", {});
+  EXPECT_FALSE(counter->used());
+
+  counter->inc();
+  counter->add(4);
+  EXPECT_TRUE(counter->used());
+  EXPECT_TRUE(counter->latchChanged());
+  EXPECT_FALSE(counter->latchChanged());
+  EXPECT_EQ(5, counter->value());
+  EXPECT_EQ(5, counter->latch());
+  EXPECT_EQ(5, counter->value());
+  EXPECT_EQ(0, counter->latch());
+
+  counter->add(2);
+  EXPECT_EQ(7, counter->value());
+  counter->reset();
+  EXPECT_EQ(0, counter->value());
+}
+
+// Counters of the same name, e.g. of a scope and of the scope replacing it, share their shards and
+// so report the same value. The increments are kept once one of them is destroyed.
+TEST(ShardedCounterTest, SharedByCountersOfTheSameName) {
+  HeapStatDataAllocator alloc;
+  CounterSharedPtr counter1 =
+      alloc.makeCounter("cluster.c1.upstream_rq_total", "cluster.upstream_rq_total", {});
+  CounterSharedPtr counter2 =
+      alloc.makeCounter("cluster.c1.upstream_rq_total", "cluster.upstream_rq_total", {});
+  counter1->add(2);
+  counter2->add(3);
+  EXPECT_EQ(5, counter1->value());
+  EXPECT_EQ(5, counter2->value());
+
+  counter2.reset();
+  EXPECT_EQ(5, counter1->value());
+  EXPECT_EQ(5, counter1->latch());
+
+  // Once all the counters of a name are destroyed, a new one starts from zero with shards of its
+  // own.
+  counter1.reset();
+  CounterSharedPtr counter3 =
+      alloc.makeCounter("cluster.c1.upstream_rq_total", "cluster.upstream_rq_total", {});
+  EXPECT_EQ(0, counter3->value());
+  counter3->inc();
+  EXPECT_EQ(1, counter3->value());
+}
+
+} // namespace Stats
+} // namespace Envoy
@@ -1,5 +1,6 @@
 #include <vector>
 
+#include "common/stats/isolated_store_impl.h"
 #include "common/stats/source_impl.h"
 
 #include "test/mocks/stats/mocks.h"
@@ -47,5 +48,48 @@ TEST(SourceImplTest, Caching) {
   EXPECT_EQ(source.cachedHistograms(), stored_histograms);
 }
 
+TEST(SourceImplTest, ChangedMetrics) {
+  IsolatedStoreImpl store;
+  SourceImpl source(store);
+  source.setFullFlush(false);
+
+  Counter& c1 = store.counter("c1");
+  Counter& c2 = store.counter("c2");
+  store.counter("unused");
+  Gauge& g1 = store.gauge("g1");
+  Gauge& g2 = store.gauge("g2");
+  c1.inc();
+  c2.inc();
+  g1.set(1);
+  g2.set(2);
+  EXPECT_EQ(2UL, source.cachedChangedCounters().size());
+  EXPECT_EQ(2UL, source.cachedChangedGauges().size());
+  source.clearCache();
+
+  // Setting a gauge to its current value is not a change.
+  c1.inc();
+  g1.set(1);
+  g2.sub(1);
+  ASSERT_EQ(1UL, source.cachedChangedCounters().size());
+  EXPECT_EQ("c1", source.cachedChangedCounters()[0]->name());
+  ASSERT_EQ(1UL, source.cachedChangedGauges().size());
+  EXPECT_EQ("g2", source.cachedChangedGauges()[0]->name());
+  source.clearCache();
+
+  EXPECT_TRUE(source.cachedChangedCounters().empty());
+  EXPECT_TRUE(source.cachedChangedGauges().empty());
+  source.clearCache();
+
+  // A full flush includes every used metric, and still clears the changed state.
+  c2.inc();
+  source.setFullFlush(true);
+  EXPECT_EQ(2UL, source.cachedChangedCounters().size());
+  EXPECT_EQ(2UL, source.cachedChangedGauges().size());
+  source.clearCache();
+  source.setFullFlush(false);
+  EXPECT_TRUE(source.cachedChangedCounters().empty());
+  EXPECT_TRUE(source.cachedChangedGauges().empty());
+}
+
 } // namespace Stats
 } // namespace Envoy
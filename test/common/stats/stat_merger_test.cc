@@ -0,0 +1,102 @@
+#include <string>
+
+#include "common/stats/isolated_store_impl.h"
+#include "common/stats/stat_merger.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Stats {
+
+class StatMergerTest : public testing::Test {
+public:
+  StatMergerTest() : stat_merger_(store_) {}
+
+  IsolatedStoreImpl store_;
+  StatMerger stat_merger_;
+};
+
+TEST_F(StatMergerTest, CounterDeltas) {
+  store_.counter("cluster.c1.upstream_rq_total").add(10);
+
+  stat_merger_.mergeCounter("cluster.c1.upstream_rq_total", 5);
+  EXPECT_EQ(15, store_.counter("cluster.c1.upstream_rq_total").value());
+  stat_merger_.mergeCounter("cluster.c1.upstream_rq_total", 2);
+  EXPECT_EQ(17, store_.counter("cluster.c1.upstream_rq_total").value());
+
+  // Counters the child doesn't have yet are created.
+  stat_merger_.mergeCounter("cluster.c2.upstream_rq_total", 3);
+  EXPECT_EQ(3, store_.counter("cluster.c2.upstream_rq_total").value());
+
+  // The merged increments are flushed by the child.
+  EXPECT_EQ(17, store_.counter("cluster.c1.upstream_rq_total").latch());
+}
+
+TEST_F(StatMergerTest, GaugesAccumulate) {
+  Gauge& gauge = store_.gauge("listener.0.0.0.0_80.downstream_cx_active");
+  gauge.add(4);
+
+  stat_merger_.mergeGauge("listener.0.0.0.0_80.downstream_cx_active", 10);
+  EXPECT_EQ(14, gauge.value());
+
+  // Only how much the parent's gauge moved is merged.
+  stat_merger_.mergeGauge("listener.0.0.0.0_80.downstream_cx_active", 6);
+  EXPECT_EQ(10, gauge.value());
+  stat_merger_.mergeGauge("listener.0.0.0.0_80.downstream_cx_active", 7);
+  EXPECT_EQ(11, gauge.value());
+
+  gauge.inc();
+  stat_merger_.removeParentGauges();
+  EXPECT_EQ(5, gauge.value());
+
+  // Once removed, the parent's gauges are merged from scratch.
+  stat_merger_.mergeGauge("listener.0.0.0.0_80.downstream_cx_active", 2);
+  EXPECT_EQ(7, gauge.value());
+}
+
+// Gauges that the child set() hold a value of the child's own.
+TEST_F(StatMergerTest, GaugesSetByChild) {
+  store_.gauge("server.uptime").set(3);
+  store_.gauge("cluster.c1.membership_total").set(2);
+
+  stat_merger_.mergeGauge("server.uptime", 1000);
+  stat_merger_.mergeGauge("cluster.c1.membership_total", 2);
+  EXPECT_EQ(3, store_.gauge("server.uptime").value());
+  EXPECT_EQ(2, store_.gauge("cluster.c1.membership_total").value());
+
+  stat_merger_.removeParentGauges();
+  EXPECT_EQ(3, store_.gauge("server.uptime").value());
+  EXPECT_EQ(2, store_.gauge("cluster.c1.membership_total").value());
+}
+
+// A gauge that the child only set() after the parent's value was merged, like the circuit breaker
+// gauges, is not taken below what the child set it to once the parent is removed.
+TEST_F(StatMergerTest, GaugeSetAfterMerge) {
+  stat_merger_.mergeGauge("cluster.c1.circuit_breakers.default.cx_open", 1);
+  EXPECT_EQ(1, store_.gauge("cluster.c1.circuit_breakers.default.cx_open").value());
+
+  store_.gauge("cluster.c1.circuit_breakers.default.cx_open").set(0);
+  stat_merger_.mergeGauge("cluster.c1.circuit_breakers.default.cx_open", 1);
+  EXPECT_EQ(0, store_.gauge("cluster.c1.circuit_breakers.default.cx_open").value());
+
+  stat_merger_.removeParentGauges();
+  EXPECT_EQ(0, store_.gauge("cluster.c1.circuit_breakers.default.cx_open").value());
+
+  store_.gauge("cluster.c1.circuit_breakers.default.cx_open").set(1);
+  stat_merger_.removeParentGauges();
+  EXPECT_EQ(1, store_.gauge("cluster.c1.circuit_breakers.default.cx_open").value());
+}
+
+// Taking the parent's contribution out never wraps a gauge around.
+TEST_F(StatMergerTest, GaugeNotSubtractedBelowZero) {
+  Gauge& gauge = store_.gauge("cluster.c1.upstream_cx_active");
+  stat_merger_.mergeGauge("cluster.c1.upstream_cx_active", 5);
+  EXPECT_EQ(5, gauge.value());
+
+  gauge.sub(3);
+  stat_merger_.removeParentGauges();
+  EXPECT_EQ(0, gauge.value());
+}
+
+} // namespace Stats
+} // namespace Envoy
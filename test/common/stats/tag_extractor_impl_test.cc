@@ -338,7 +338,9 @@ TEST(TagExtractorTest, ExtractRegexPrefix) {
 
   EXPECT_EQ("", extractRegexPrefix("^prefix(foo)."));
   EXPECT_EQ("prefix", extractRegexPrefix("^prefix\\.foo"));
-  EXPECT_EQ("prefix_optional", extractRegexPrefix("^prefix_optional(?=\\.)"));
+  EXPECT_EQ("prefix_optional", extractRegexPrefix("^prefix_optional(?:\\..*?)??\\.foo"));
+  EXPECT_EQ("prefix_greedy", extractRegexPrefix("^prefix_greedy(?:\\..*)?\\.foo"));
+  EXPECT_EQ("", extractRegexPrefix("^prefix_unsure(?:\\.foo)?bar"));
   EXPECT_EQ("", extractRegexPrefix("^notACompleteToken"));   //
   EXPECT_EQ("onlyToken", extractRegexPrefix("^onlyToken$")); //
   EXPECT_EQ("", extractRegexPrefix("(prefix)"));
@@ -55,5 +55,49 @@ TEST(TagProducerTest, CheckConstructor) {
       "No regex specified for tag specifier and no default regex for name: 'test_extractor'");
 }
 
+// Several extractors without a prefix are matched with a regex set, along with the default ones.
+TEST(TagProducerTest, ExtractorsWithoutPrefix) {
+  envoy::config::metrics::v2::StatsConfig stats_config;
+  auto* tag_specifier = stats_config.mutable_stats_tags()->Add();
+  tag_specifier->set_tag_name("tenant");
+  tag_specifier->set_regex("\\.(tenant_(\\w+?)\\.)");
+  tag_specifier = stats_config.mutable_stats_tags()->Add();
+  tag_specifier->set_tag_name("zone");
+  tag_specifier->set_regex("\\.(zone_(\\w+?)\\.)");
+  tag_specifier = stats_config.mutable_stats_tags()->Add();
+  tag_specifier->set_tag_name("canary");
+  tag_specifier->set_regex("(\\.(canary))$");
+  TagProducerImpl producer{stats_config};
+
+  using TagPairs = std::vector<std::pair<std::string, std::string>>;
+  const auto produce_tags = [&producer](const std::string& stat_name,
+                                        std::string& tag_extracted_name) {
+    std::vector<Tag> tags;
+    tag_extracted_name = producer.produceTags(stat_name, tags);
+    TagPairs tag_pairs;
+    for (const Tag& tag : tags) {
+      tag_pairs.emplace_back(tag.name_, tag.value_);
+    }
+    return tag_pairs;
+  };
+
+  std::string name;
+  EXPECT_EQ((TagPairs{{Config::TagNames::get().RESPONSE_CODE, "200"},
+                      {"tenant", "acme"},
+                      {"zone", "east"},
+                      {Config::TagNames::get().CLUSTER_NAME, "foo"}}),
+            produce_tags("cluster.foo.tenant_acme.zone_east.upstream_rq_200", name));
+  EXPECT_EQ("cluster.upstream_rq", name);
+
+  EXPECT_EQ((TagPairs{{"zone", "west"},
+                      {"canary", "canary"},
+                      {Config::TagNames::get().HTTP_CONN_MANAGER_PREFIX, "ingress"}}),
+            produce_tags("http.ingress.zone_west.downstream_rq_total.canary", name));
+  EXPECT_EQ("http.downstream_rq_total", name);
+
+  EXPECT_TRUE(produce_tags("server.live", name).empty());
+  EXPECT_EQ("server.live", name);
+}
+
 } // namespace Stats
 } // namespace Envoy
@@ -0,0 +1,57 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// NOLINT(namespace-envoy)
+
+#include "envoy/config/metrics/v2/stats.pb.h"
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/stats/tag_producer_impl.h"
+
+#include "test/test_common/utility.h"
+
+#include "fmt/format.h"
+#include "testing/base/public/benchmark.h"
+
+// Extracts the tags of cluster and HTTP connection manager stats with the default tag extractors
+// and the number of custom extractors without a prefix given by the benchmark's range.
+static void BM_ProduceTags(benchmark::State& state) {
+  envoy::config::metrics::v2::StatsConfig stats_config;
+  for (int i = 0; i < state.range(0); ++i) {
+    auto* tag_specifier = stats_config.mutable_stats_tags()->Add();
+    tag_specifier->set_tag_name(fmt::format("custom_{}", i));
+    tag_specifier->set_regex(fmt::format("\\.(custom{}_(\\w+?)\\.)", i));
+  }
+  Envoy::Stats::TagProducerImpl producer(stats_config);
+
+  std::vector<std::string> stat_names;
+  for (int i = 0; i < 100; ++i) {
+    stat_names.push_back(fmt::format("cluster.service_{}.upstream_rq_200", i));
+    stat_names.push_back(fmt::format("cluster.service_{}.custom{}_x.upstream_cx_active", i, i));
+    stat_names.push_back(fmt::format("cluster.service_{}.grpc.svc.method.success", i));
+    stat_names.push_back(fmt::format("http.ingress_{}.downstream_rq_2xx", i));
+    stat_names.push_back(fmt::format("listener.127.0.0.1_{}.http.ingress.downstream_rq_5xx", i));
+  }
+
+  std::vector<Envoy::Stats::Tag> tags;
+  for (auto _ : state) {
+    for (const std::string& stat_name : stat_names) {
+      tags.clear();
+      benchmark::DoNotOptimize(producer.produceTags(stat_name, tags));
+    }
+  }
+}
+BENCHMARK(BM_ProduceTags)->Arg(0)->Arg(10)->Arg(40);
+
+int main(int argc, char** argv) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logger_context(spdlog::level::warn,
+                                        Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
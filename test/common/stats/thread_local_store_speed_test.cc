@@ -4,6 +4,7 @@
 #include "common/common/logger.h"
 #include "common/common/thread.h"
 #include "common/event/dispatcher_impl.h"
+#include "common/memory/stats.h"
 #include "common/stats/heap_stat_data.h"
 #include "common/stats/stats_options_impl.h"
 #include "common/stats/tag_producer_impl.h"
@@ -36,6 +37,16 @@ public:
         1000, [this](absl::string_view name) { store_.counter(std::string(name)); });
   }
 
+  // Creates the sample stats for num_clusters clusters, returning the number of stats.
+  uint64_t createCounters(int num_clusters) {
+    uint64_t num_stats = 0;
+    Stats::TestUtil::forEachSampleStat(num_clusters, [this, &num_stats](absl::string_view name) {
+      store_.counter(std::string(name));
+      ++num_stats;
+    });
+    return num_stats;
+  }
+
   void initThreading() {
     dispatcher_ = std::make_unique<Event::DispatcherImpl>(time_system_, *api_);
     tls_ = std::make_unique<ThreadLocal::InstanceImpl>();
@@ -79,12 +90,33 @@ static void BM_StatsWithTls(benchmark::State& state) {
 }
 BENCHMARK(BM_StatsWithTls);
 
+// Reports the bytes retained per stat, including its name, tag-extracted name and tags, when
+// creating the stats of 1000 clusters. This requires a malloc library with usable stats, such as
+// tcmalloc, and reports no counters otherwise.
+static void BM_StatsMemory(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto context = std::make_unique<Envoy::ThreadLocalStorePerf>();
+    context->initThreading();
+    const uint64_t start_mem = Envoy::Memory::Stats::totalCurrentlyAllocated();
+    state.ResumeTiming();
+
+    const uint64_t num_stats = context->createCounters(1000);
+
+    state.PauseTiming();
+    const uint64_t end_mem = Envoy::Memory::Stats::totalCurrentlyAllocated();
+    if (start_mem != 0) {
+      state.counters["bytes_per_stat"] = static_cast<double>(end_mem - start_mem) / num_stats;
+    }
+    context.reset();
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_StatsMemory)->Unit(benchmark::kMillisecond);
+
 // TODO(jmarantz): add multi-threaded variant of this test, that aggressively
 // looks up stats in multiple threads to try to trigger contention issues.
 
-// TODO(jmarantz): add version using the RawStatDataAllocator, or better yet,
-// the full hot-restart mechanism so that actual shared-memory is used.
-
 // Boilerplate main(), which discovers benchmarks in the same file and runs them.
 int main(int argc, char** argv) {
   benchmark::Initialize(&argc, argv);
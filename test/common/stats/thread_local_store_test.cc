@@ -36,7 +36,7 @@ namespace Stats {
 class StatsThreadLocalStoreTest : public testing::Test {
 public:
   void SetUp() override {
-    alloc_ = std::make_unique<MockedTestAllocator>(options_);
+    alloc_ = std::make_unique<MockedTestAllocator>();
     resetStoreWithAlloc(*alloc_);
   }
 
@@ -75,8 +75,6 @@ class HistogramTest : public testing::Test {
 public:
   typedef std::map<std::string, ParentHistogramSharedPtr> NameHistogramMap;
 
-  HistogramTest() : alloc_(options_) {}
-
   void SetUp() override {
     store_ = std::make_unique<ThreadLocalStoreImpl>(options_, alloc_);
     store_->addSink(sink_);
@@ -157,9 +155,6 @@ public:
     }
   }
 
-  MOCK_METHOD1(alloc, RawStatData*(const std::string& name));
-  MOCK_METHOD1(free, void(RawStatData& data));
-
   NiceMock<Event::MockDispatcher> main_thread_dispatcher_;
   NiceMock<ThreadLocal::MockInstance> tls_;
   StatsOptionsImpl options_;
@@ -427,7 +422,7 @@ TEST_F(StatsThreadLocalStoreTest, HotRestartTruncation) {
   InSequence s;
   store_->initializeThreading(main_thread_dispatcher_, tls_);
 
-  // First, with a successful RawStatData allocation:
+  // First, with a successful allocation:
   const uint64_t max_name_length = options_.maxNameLength();
   const std::string name_1(max_name_length + 1, 'A');
 
@@ -461,8 +456,8 @@ TEST_F(StatsThreadLocalStoreTest, HotRestartTruncation) {
   store_->shutdownThreading();
   tls_.shutdownThread();
 
-  // Includes overflow, and the first raw-allocated stat, but not the failsafe stat which we
-  // allocated from the heap.
+  // Includes overflow, and the first allocated stat, but not the failsafe stat which we
+  // allocated from the store's own heap allocator.
   EXPECT_CALL(*alloc_, free(_)).Times(2);
 }
 
@@ -619,7 +614,7 @@ public:
   void SetUp() override {
     resetStoreWithAlloc(heap_alloc_);
     // Note: we do not call StatsThreadLocalStoreTest::SetUp here as that
-    // sets up a thread_local_store with raw stat alloc.
+    // sets up a thread_local_store with the mocked test allocator.
   }
   void TearDown() override {
     store_->shutdownThreading();
@@ -675,6 +670,36 @@ TEST_F(HeapStatsThreadLocalStoreTest, NonHotRestartNoTruncation) {
   EXPECT_NE(nullptr, TestUtility::findCounter(*store_, name_1).get());
 }
 
+// Tests that tag-extracted names and tags round-trip through the symbol table of the allocator.
+TEST_F(HeapStatsThreadLocalStoreTest, SymbolizedTags) {
+  envoy::config::metrics::v2::StatsConfig stats_config;
+  store_->setTagProducer(std::make_unique<TagProducerImpl>(stats_config));
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+  const uint64_t start_symbols = heap_alloc_.symbolTable().numSymbols();
+
+  Counter& counter = store_->counter("cluster.c1.upstream_rq_total");
+  EXPECT_EQ("cluster.c1.upstream_rq_total", counter.name());
+  EXPECT_EQ("cluster.upstream_rq_total", counter.tagExtractedName());
+  std::vector<Tag> tags = counter.tags();
+  ASSERT_EQ(1, tags.size());
+  EXPECT_EQ("envoy.cluster_name", tags[0].name_);
+  EXPECT_EQ("c1", tags[0].value_);
+
+  // The tokens shared with the counter are not symbolized again.
+  Gauge& gauge = store_->gauge("cluster.c1.upstream_cx_active");
+  EXPECT_EQ("cluster.upstream_cx_active", gauge.tagExtractedName());
+  EXPECT_EQ(start_symbols + 6, heap_alloc_.symbolTable().numSymbols());
+
+  // Histograms, and their per-thread histograms, share the names of their parent.
+  Histogram& histogram = store_->histogram("cluster.c1.upstream_rq_time");
+  EXPECT_CALL(sink_, onHistogramComplete(Ref(histogram), 5));
+  histogram.recordValue(5);
+  EXPECT_EQ("cluster.upstream_rq_time", histogram.tagExtractedName());
+  tags = histogram.tags();
+  ASSERT_EQ(1, tags.size());
+  EXPECT_EQ("c1", tags[0].value_);
+}
+
 // Tests how much memory is consumed allocating 100k stats.
 TEST_F(HeapStatsThreadLocalStoreTest, MemoryWithoutTls) {
   if (!TestUtil::hasDeterministicMallocStats()) {
@@ -916,9 +941,50 @@ TEST_F(HistogramTest, BasicHistogramUsed) {
   }
 }
 
+TEST_F(HistogramTest, HistogramBuckets) {
+  // The buckets are sorted and deduplicated.
+  store_->setHistogramBuckets({100, 10, 100, 1000});
+
+  Histogram& h1 = store_->histogram("h1");
+  expectCallAndAccumulate(h1, 5);
+  expectCallAndAccumulate(h1, 50);
+  expectCallAndAccumulate(h1, 5000);
+  store_->mergeHistograms([]() -> void {});
+  expectCallAndAccumulate(h1, 500);
+  store_->mergeHistograms([]() -> void {});
+
+  NameHistogramMap name_histogram_map = makeHistogramMap(store_->histograms());
+  const HistogramStatistics& cumulative = name_histogram_map["h1"]->cumulativeStatistics();
+  EXPECT_EQ(std::vector<double>({10, 100, 1000}), cumulative.supportedBuckets());
+  EXPECT_EQ(std::vector<uint64_t>({1, 2, 3}), cumulative.computedBuckets());
+  EXPECT_EQ(4, cumulative.sampleCount());
+
+  const HistogramStatistics& interval = name_histogram_map["h1"]->intervalStatistics();
+  EXPECT_EQ(std::vector<uint64_t>({0, 0, 1}), interval.computedBuckets());
+  EXPECT_EQ(1, interval.sampleCount());
+
+  // An empty list restores the default buckets for the histograms created afterwards. Existing
+  // histograms keep theirs, so their bucket counts always match their buckets.
+  store_->setHistogramBuckets({});
+  EXPECT_EQ(std::vector<double>({10, 100, 1000}), cumulative.supportedBuckets());
+  EXPECT_EQ(3, cumulative.computedBuckets().size());
+
+  Histogram& h2 = store_->histogram("h2");
+  expectCallAndAccumulate(h2, 5);
+  store_->mergeHistograms([]() -> void {});
+  EXPECT_EQ(std::vector<double>({10, 100, 1000}), cumulative.supportedBuckets());
+  EXPECT_EQ(3, cumulative.computedBuckets().size());
+
+  name_histogram_map = makeHistogramMap(store_->histograms());
+  const HistogramStatistics& h2_cumulative = name_histogram_map["h2"]->cumulativeStatistics();
+  EXPECT_EQ(HistogramStatisticsImpl::defaultSupportedBuckets(), h2_cumulative.supportedBuckets());
+  EXPECT_EQ(HistogramStatisticsImpl::defaultSupportedBuckets().size(),
+            h2_cumulative.computedBuckets().size());
+}
+
 class TruncatingAllocTest : public HeapStatsThreadLocalStoreTest {
 protected:
-  TruncatingAllocTest() : test_alloc_(options_), long_name_(options_.maxNameLength() + 1, 'A') {}
+  TruncatingAllocTest() : long_name_(options_.maxNameLength() + 1, 'A') {}
 
   void SetUp() override {
     store_ = std::make_unique<ThreadLocalStoreImpl>(options_, test_alloc_);
@@ -12,6 +12,7 @@ using testing::_;
 using testing::InSequence;
 using testing::Ref;
 using testing::ReturnPointee;
+using testing::SaveArg;
 
 namespace Envoy {
 namespace ThreadLocal {
@@ -113,6 +114,35 @@ TEST_F(ThreadLocalInstanceImplTest, RunOnAllThreads) {
   tls_.shutdownThread();
 }
 
+// Callbacks run with the object of the slot on each thread, including once the slot is freed.
+TEST_F(ThreadLocalInstanceImplTest, RunOnAllThreadsWithObject) {
+  SlotPtr slot = tls_.allocateSlot();
+  TestThreadLocalObject& object_ref = setObject(*slot);
+
+  uint64_t calls = 0;
+  EXPECT_CALL(thread_dispatcher_, post(_));
+  slot->runOnAllThreads([&calls, &object_ref](ThreadLocalObject& object) -> void {
+    EXPECT_EQ(&object_ref, &object);
+    ++calls;
+  });
+  EXPECT_EQ(2, calls);
+
+  // A callback reaching a thread after the slot is freed does not use the slot, and is skipped
+  // once the object is freed on that thread.
+  Event::PostCb thread_callback;
+  EXPECT_CALL(thread_dispatcher_, post(_)).WillOnce(SaveArg<0>(&thread_callback));
+  slot->runOnAllThreads([&calls](ThreadLocalObject&) -> void { ++calls; });
+  EXPECT_EQ(3, calls);
+  EXPECT_CALL(thread_dispatcher_, post(_));
+  EXPECT_CALL(object_ref, onDestroy());
+  slot.reset();
+  thread_callback();
+  EXPECT_EQ(3, calls);
+
+  tls_.shutdownGlobalThreading();
+  tls_.shutdownThread();
+}
+
 // Validate ThreadLocal::InstanceImpl's dispatcher() behavior.
 TEST(ThreadLocalInstanceImplDispatcherTest, Dispatcher) {
   InstanceImpl tls;
@@ -0,0 +1,314 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/cache/cache_filter.h"
+#include "extensions/filters/http/cache/config.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+class CacheFilterTest : public testing::Test {
+public:
+  CacheFilterTest() { setUpConfig("{}"); }
+
+  void setUpConfig(const std::string& yaml) {
+    envoy::config::filter::http::cache::v2alpha::Cache proto_config;
+    MessageUtil::loadFromYaml(yaml, proto_config);
+    config_ = std::make_shared<CacheFilterConfig>(proto_config, "test.", stats_, time_system_);
+  }
+
+  std::unique_ptr<CacheFilter> makeFilter() {
+    auto filter = std::make_unique<CacheFilter>(config_);
+    filter->setDecoderFilterCallbacks(decoder_callbacks_);
+    filter->setEncoderFilterCallbacks(encoder_callbacks_);
+    return filter;
+  }
+
+  // Run a request that misses the cache through a new filter, with the given response.
+  void populate(Http::TestHeaderMapImpl&& response_headers, const std::string& body) {
+    auto filter = makeFilter();
+    Http::TestHeaderMapImpl request_headers = request_headers_;
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter->decodeHeaders(request_headers, true));
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              filter->encodeHeaders(response_headers, body.empty()));
+    if (!body.empty()) {
+      Buffer::OwnedImpl data(body);
+      EXPECT_EQ(Http::FilterDataStatus::Continue, filter->encodeData(data, true));
+    }
+  }
+
+  // Expect a new filter to answer the request from the cache.
+  void expectHit(Http::TestHeaderMapImpl&& request_headers, const std::string& status,
+                 const std::string& body) {
+    auto filter = makeFilter();
+    EXPECT_CALL(decoder_callbacks_, encodeHeaders_(_, body.empty()))
+        .WillOnce(Invoke([&](Http::HeaderMap& headers, bool) {
+          EXPECT_STREQ(status.c_str(), headers.Status()->value().c_str());
+          EXPECT_NE(nullptr, headers.get(Http::Headers::get().Age));
+        }));
+    if (!body.empty()) {
+      EXPECT_CALL(decoder_callbacks_, encodeData(_, true))
+          .WillOnce(
+              Invoke([&](Buffer::Instance& data, bool) { EXPECT_EQ(body, data.toString()); }));
+    }
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+              filter->decodeHeaders(request_headers, true));
+  }
+
+  // Expect a new filter to forward the request upstream.
+  void expectMiss(Http::TestHeaderMapImpl&& request_headers) {
+    auto filter = makeFilter();
+    EXPECT_CALL(decoder_callbacks_, encodeHeaders_(_, _)).Times(0);
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter->decodeHeaders(request_headers, true));
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Stats::IsolatedStoreImpl stats_;
+  CacheFilterConfigSharedPtr config_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+  const Http::TestHeaderMapImpl request_headers_{
+      {":method", "GET"}, {":path", "/catalog"}, {":authority", "host"}};
+};
+
+TEST_F(CacheFilterTest, MissThenHit) {
+  expectMiss(Http::TestHeaderMapImpl(request_headers_));
+  populate(Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=60"}}, "hello");
+  EXPECT_EQ(2U, stats_.counter("test.cache.miss").value());
+  EXPECT_EQ(1U, stats_.counter("test.cache.insert").value());
+  EXPECT_EQ(1U, stats_.gauge("test.cache.entries").value());
+
+  expectHit(Http::TestHeaderMapImpl(request_headers_), "200", "hello");
+  EXPECT_EQ(1U, stats_.counter("test.cache.hit").value());
+
+  // HEAD requests are answered with the headers only.
+  expectHit(
+      Http::TestHeaderMapImpl{{":method", "HEAD"}, {":path", "/catalog"}, {":authority", "host"}},
+      "200", "");
+  EXPECT_EQ(2U, stats_.counter("test.cache.hit").value());
+
+  // Other paths and hosts do not match.
+  expectMiss(
+      Http::TestHeaderMapImpl{{":method", "GET"}, {":path", "/other"}, {":authority", "host"}});
+  expectMiss(
+      Http::TestHeaderMapImpl{{":method", "GET"}, {":path", "/catalog"}, {":authority", "b"}});
+}
+
+TEST_F(CacheFilterTest, Expiration) {
+  populate(Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=60"}}, "hello");
+  time_system_.sleep(std::chrono::seconds(59));
+  expectHit(Http::TestHeaderMapImpl(request_headers_), "200", "hello");
+
+  time_system_.sleep(std::chrono::seconds(1));
+  expectMiss(Http::TestHeaderMapImpl(request_headers_));
+  EXPECT_EQ(1U, stats_.counter("test.cache.stale").value());
+}
+
+TEST_F(CacheFilterTest, UpstreamAgeReducesFreshness) {
+  populate(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=60"}, {"age", "50"}},
+      "hello");
+  time_system_.sleep(std::chrono::seconds(10));
+  expectMiss(Http::TestHeaderMapImpl(request_headers_));
+  EXPECT_EQ(1U, stats_.counter("test.cache.stale").value());
+}
+
+TEST_F(CacheFilterTest, RequestCacheControl) {
+  populate(Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=60"}}, "hello");
+  time_system_.sleep(std::chrono::seconds(10));
+
+  Http::TestHeaderMapImpl no_cache = request_headers_;
+  no_cache.addCopy("cache-control", "no-cache");
+  expectMiss(std::move(no_cache));
+
+  Http::TestHeaderMapImpl max_age = request_headers_;
+  max_age.addCopy("cache-control", "max-age=5");
+  expectMiss(std::move(max_age));
+  EXPECT_EQ(2U, stats_.counter("test.cache.stale").value());
+
+  // no-store bypasses the cache entirely.
+  Http::TestHeaderMapImpl no_store = request_headers_;
+  no_store.addCopy("cache-control", "no-store");
+  expectMiss(std::move(no_store));
+  EXPECT_EQ(2U, stats_.counter("test.cache.stale").value());
+  EXPECT_EQ(1U, stats_.counter("test.cache.miss").value());
+}
+
+TEST_F(CacheFilterTest, ExpiresHeader) {
+  time_system_.setSystemTime(std::chrono::seconds(784111777));
+  populate(Http::TestHeaderMapImpl{{":status", "200"},
+                                   {"date", "Sun, 06 Nov 1994 08:49:37 GMT"},
+                                   {"expires", "Sun, 06 Nov 1994 08:50:37 GMT"}},
+           "hello");
+  expectHit(Http::TestHeaderMapImpl(request_headers_), "200", "hello");
+  time_system_.sleep(std::chrono::seconds(60));
+  expectMiss(Http::TestHeaderMapImpl(request_headers_));
+}
+
+TEST_F(CacheFilterTest, UncacheableResponses) {
+  populate(Http::TestHeaderMapImpl{{":status", "200"}}, "hello");
+  populate(Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=60, no-store"}},
+           "hello");
+  populate(Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=60, private"}},
+           "hello");
+  populate(Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=0"}}, "hello");
+  populate(Http::TestHeaderMapImpl{
+               {":status", "200"}, {"cache-control", "max-age=60"}, {"set-cookie", "a=b"}},
+           "hello");
+  populate(Http::TestHeaderMapImpl{{":status", "206"}, {"cache-control", "max-age=60"}}, "hello");
+  populate(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=60"}, {"vary", "*"}},
+      "hello");
+  EXPECT_EQ(7U, stats_.counter("test.cache.uncacheable").value());
+  EXPECT_EQ(0U, stats_.counter("test.cache.insert").value());
+
+  // Responses with trailers are not stored.
+  auto filter = makeFilter();
+  Http::TestHeaderMapImpl request_headers = request_headers_;
+  filter->decodeHeaders(request_headers, true);
+  Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"cache-control", "max-age=60"}};
+  filter->encodeHeaders(response_headers, false);
+  Buffer::OwnedImpl data("hello");
+  filter->encodeData(data, false);
+  Http::TestHeaderMapImpl trailers;
+  filter->encodeTrailers(trailers);
+  EXPECT_EQ(8U, stats_.counter("test.cache.uncacheable").value());
+  EXPECT_EQ(0U, stats_.counter("test.cache.insert").value());
+}
+
+TEST_F(CacheFilterTest, UncacheableRequests) {
+  populate(Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=60"}}, "hello");
+
+  Http::TestHeaderMapImpl authorized = request_headers_;
+  authorized.addCopy("authorization", "token");
+  expectMiss(std::move(authorized));
+  expectMiss(
+      Http::TestHeaderMapImpl{{":method", "POST"}, {":path", "/catalog"}, {":authority", "host"}});
+  EXPECT_EQ(1U, stats_.counter("test.cache.miss").value());
+  EXPECT_EQ(0U, stats_.counter("test.cache.hit").value());
+}
+
+TEST_F(CacheFilterTest, TooLarge) {
+  setUpConfig("max_entry_size_bytes: 4");
+  populate(Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=60"}}, "hello");
+  populate(Http::TestHeaderMapImpl{
+               {":status", "200"}, {"cache-control", "max-age=60"}, {"content-length", "5"}},
+           "hello");
+  EXPECT_EQ(2U, stats_.counter("test.cache.too_large").value());
+  EXPECT_EQ(0U, stats_.counter("test.cache.insert").value());
+}
+
+TEST_F(CacheFilterTest, Vary) {
+  populate(Http::TestHeaderMapImpl{
+               {":status", "200"}, {"cache-control", "max-age=60"}, {"vary", "X-Tenant"}},
+           "hello");
+
+  expectMiss(Http::TestHeaderMapImpl{
+      {":method", "GET"}, {":path", "/catalog"}, {":authority", "host"}, {"x-tenant", "a"}});
+  expectHit(Http::TestHeaderMapImpl(request_headers_), "200", "hello");
+}
+
+TEST_F(CacheFilterTest, VaryNotAllowed) {
+  setUpConfig("allowed_vary_headers: [\"Accept-Encoding\"]");
+  populate(Http::TestHeaderMapImpl{
+               {":status", "200"}, {"cache-control", "max-age=60"}, {"vary", "x-tenant"}},
+           "hello");
+  EXPECT_EQ(1U, stats_.counter("test.cache.uncacheable").value());
+
+  populate(Http::TestHeaderMapImpl{
+               {":status", "200"}, {"cache-control", "max-age=60"}, {"vary", "accept-encoding"}},
+           "hello");
+  EXPECT_EQ(1U, stats_.counter("test.cache.insert").value());
+}
+
+TEST_F(CacheFilterTest, ClientConditionalRequest) {
+  populate(Http::TestHeaderMapImpl{
+               {":status", "200"}, {"cache-control", "max-age=60"}, {"etag", "\"v1\""}},
+           "hello");
+
+  Http::TestHeaderMapImpl matching = request_headers_;
+  matching.addCopy("if-none-match", "\"v1\"");
+  auto filter = makeFilter();
+  EXPECT_CALL(decoder_callbacks_, encodeHeaders_(_, true))
+      .WillOnce(Invoke([](Http::HeaderMap& headers, bool) {
+        EXPECT_STREQ("304", headers.Status()->value().c_str());
+        EXPECT_STREQ("\"v1\"", headers.Etag()->value().c_str());
+        EXPECT_STREQ("max-age=60", headers.CacheControl()->value().c_str());
+      }));
+  EXPECT_CALL(decoder_callbacks_, encodeData(_, _)).Times(0);
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration, filter->decodeHeaders(matching, true));
+  EXPECT_EQ(1U, stats_.counter("test.cache.not_modified").value());
+
+  Http::TestHeaderMapImpl other = request_headers_;
+  other.addCopy("if-none-match", "\"v0\"");
+  expectHit(std::move(other), "200", "hello");
+}
+
+TEST_F(CacheFilterTest, Revalidation) {
+  populate(Http::TestHeaderMapImpl{
+               {":status", "200"}, {"cache-control", "max-age=60"}, {"etag", "\"v1\""}},
+           "hello");
+  time_system_.sleep(std::chrono::seconds(61));
+
+  auto filter = makeFilter();
+  Http::TestHeaderMapImpl request_headers = request_headers_;
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter->decodeHeaders(request_headers, true));
+  EXPECT_STREQ("\"v1\"", request_headers.get_("if-none-match").c_str());
+
+  EXPECT_CALL(encoder_callbacks_, addEncodedData(_, true))
+      .WillOnce(Invoke([](Buffer::Instance& data, bool) { EXPECT_EQ("hello", data.toString()); }));
+  Http::TestHeaderMapImpl response_headers{
+      {":status", "304"}, {"cache-control", "max-age=120"}, {"etag", "\"v1\""}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter->encodeHeaders(response_headers, true));
+  EXPECT_STREQ("200", response_headers.Status()->value().c_str());
+  EXPECT_STREQ("max-age=120", response_headers.CacheControl()->value().c_str());
+  EXPECT_EQ(1U, stats_.counter("test.cache.validated").value());
+
+  // The refreshed entry is fresh for the new lifetime.
+  time_system_.sleep(std::chrono::seconds(100));
+  expectHit(Http::TestHeaderMapImpl(request_headers_), "200", "hello");
+}
+
+TEST_F(CacheFilterTest, RevalidationReplacedByNewResponse) {
+  populate(Http::TestHeaderMapImpl{
+               {":status", "200"}, {"cache-control", "max-age=60"}, {"etag", "\"v1\""}},
+           "hello");
+  time_system_.sleep(std::chrono::seconds(61));
+
+  populate(Http::TestHeaderMapImpl{
+               {":status", "200"}, {"cache-control", "max-age=60"}, {"etag", "\"v2\""}},
+           "world");
+  EXPECT_EQ(0U, stats_.counter("test.cache.validated").value());
+  expectHit(Http::TestHeaderMapImpl(request_headers_), "200", "world");
+}
+
+TEST(CacheFilterFactoryTest, CreateFilter) {
+  envoy::config::filter::http::cache::v2alpha::Cache proto_config;
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  CacheFilterFactory factory;
+  Http::FilterFactoryCb cb = factory.createFilterFactoryFromProto(proto_config, "stats", context);
+  Http::MockFilterChainFactoryCallbacks filter_callback;
+  EXPECT_CALL(filter_callback, addStreamFilter(_));
+  cb(filter_callback);
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
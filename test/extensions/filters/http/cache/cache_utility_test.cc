@@ -0,0 +1,96 @@
+#include "extensions/filters/http/cache/cache_utility.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+// Sun, 06 Nov 1994 08:49:37 GMT
+const SystemTime ReferenceTime = SystemTime(std::chrono::seconds(784111777));
+
+TEST(CacheUtilityTest, ParseCacheControl) {
+  {
+    const CacheControlDirectives directives = CacheUtility::parseCacheControl("");
+    EXPECT_FALSE(directives.no_store_);
+    EXPECT_FALSE(directives.no_cache_);
+    EXPECT_FALSE(directives.private_);
+    EXPECT_FALSE(directives.max_age_.has_value());
+    EXPECT_FALSE(directives.s_maxage_.has_value());
+  }
+  {
+    const CacheControlDirectives directives =
+        CacheUtility::parseCacheControl("public, Max-Age=60, s-maxage=\"120\", no-transform");
+    EXPECT_EQ(std::chrono::seconds(60), directives.max_age_.value());
+    EXPECT_EQ(std::chrono::seconds(120), directives.s_maxage_.value());
+    EXPECT_FALSE(directives.no_store_);
+  }
+  {
+    const CacheControlDirectives directives =
+        CacheUtility::parseCacheControl("no-store,no-cache , private=\"set-cookie\"");
+    EXPECT_TRUE(directives.no_store_);
+    EXPECT_TRUE(directives.no_cache_);
+    EXPECT_TRUE(directives.private_);
+  }
+  {
+    const CacheControlDirectives directives = CacheUtility::parseCacheControl("max-age=abc");
+    EXPECT_FALSE(directives.max_age_.has_value());
+  }
+}
+
+TEST(CacheUtilityTest, ParseHttpTime) {
+  EXPECT_EQ(ReferenceTime, CacheUtility::parseHttpTime("Sun, 06 Nov 1994 08:49:37 GMT").value());
+  EXPECT_FALSE(CacheUtility::parseHttpTime("0").has_value());
+  EXPECT_FALSE(CacheUtility::parseHttpTime("").has_value());
+}
+
+TEST(CacheUtilityTest, FreshnessLifetime) {
+  {
+    Http::TestHeaderMapImpl headers{{"cache-control", "max-age=10, s-maxage=20"}};
+    EXPECT_EQ(std::chrono::seconds(20),
+              CacheUtility::freshnessLifetime(
+                  headers, CacheUtility::parseCacheControl("max-age=10, s-maxage=20"),
+                  ReferenceTime)
+                  .value());
+  }
+  {
+    Http::TestHeaderMapImpl headers{{"date", "Sun, 06 Nov 1994 08:49:37 GMT"},
+                                    {"expires", "Sun, 06 Nov 1994 08:50:37 GMT"}};
+    EXPECT_EQ(std::chrono::seconds(60),
+              CacheUtility::freshnessLifetime(headers, {}, SystemTime()).value());
+  }
+  {
+    // Without a Date header the response time is used.
+    Http::TestHeaderMapImpl headers{{"expires", "Sun, 06 Nov 1994 08:50:37 GMT"}};
+    EXPECT_EQ(std::chrono::seconds(60),
+              CacheUtility::freshnessLifetime(headers, {}, ReferenceTime).value());
+  }
+  {
+    Http::TestHeaderMapImpl headers{{"expires", "0"}};
+    EXPECT_EQ(std::chrono::seconds(0),
+              CacheUtility::freshnessLifetime(headers, {}, ReferenceTime).value());
+  }
+  {
+    Http::TestHeaderMapImpl headers;
+    EXPECT_FALSE(CacheUtility::freshnessLifetime(headers, {}, ReferenceTime).has_value());
+  }
+}
+
+TEST(CacheUtilityTest, IfNoneMatch) {
+  EXPECT_TRUE(CacheUtility::ifNoneMatch("\"abc\"", "\"abc\""));
+  EXPECT_TRUE(CacheUtility::ifNoneMatch("\"xyz\", W/\"abc\"", "\"abc\""));
+  EXPECT_TRUE(CacheUtility::ifNoneMatch("\"abc\"", "W/\"abc\""));
+  EXPECT_TRUE(CacheUtility::ifNoneMatch("*", "\"abc\""));
+  EXPECT_FALSE(CacheUtility::ifNoneMatch("\"xyz\"", "\"abc\""));
+  EXPECT_FALSE(CacheUtility::ifNoneMatch("\"abc\"", ""));
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,103 @@
+#include "common/http/header_map_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+class HttpCacheTest : public testing::Test {
+public:
+  HttpCacheTest()
+      : stats_{ALL_CACHE_STATS(POOL_COUNTER_PREFIX(store_, "cache."),
+                               POOL_GAUGE_PREFIX(store_, "cache."))} {}
+
+  CachedResponseConstSharedPtr makeResponse(uint64_t body_size) {
+    auto response = std::make_shared<CachedResponse>();
+    response->headers_ = std::make_unique<Http::TestHeaderMapImpl>();
+    response->body_ = std::string(body_size, 'a');
+    return response;
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  CacheStats stats_;
+};
+
+TEST_F(HttpCacheTest, InsertLookupRemove) {
+  HttpCache cache(1024, 1, stats_);
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+
+  CachedResponseConstSharedPtr response = makeResponse(10);
+  EXPECT_TRUE(cache.insert("a", response));
+  EXPECT_EQ(response, cache.lookup("a"));
+  EXPECT_EQ(1, stats_.entries_.value());
+  EXPECT_EQ(11, stats_.bytes_.value());
+
+  // Replacing an entry releases the old one.
+  CachedResponseConstSharedPtr replacement = makeResponse(20);
+  EXPECT_TRUE(cache.insert("a", replacement));
+  EXPECT_EQ(replacement, cache.lookup("a"));
+  EXPECT_EQ(1, stats_.entries_.value());
+  EXPECT_EQ(21, stats_.bytes_.value());
+
+  cache.remove("a");
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  EXPECT_EQ(0, stats_.entries_.value());
+  EXPECT_EQ(0, stats_.bytes_.value());
+  EXPECT_EQ(0, stats_.evictions_.value());
+}
+
+TEST_F(HttpCacheTest, EvictLeastRecentlyUsedBySize) {
+  HttpCache cache(100, 1, stats_);
+  EXPECT_TRUE(cache.insert("a", makeResponse(39)));
+  EXPECT_TRUE(cache.insert("b", makeResponse(39)));
+
+  // Touch "a" so that "b" is the least recently used entry.
+  EXPECT_NE(nullptr, cache.lookup("a"));
+  EXPECT_TRUE(cache.insert("c", makeResponse(39)));
+  EXPECT_NE(nullptr, cache.lookup("a"));
+  EXPECT_EQ(nullptr, cache.lookup("b"));
+  EXPECT_NE(nullptr, cache.lookup("c"));
+  EXPECT_EQ(1, stats_.evictions_.value());
+  EXPECT_EQ(2, stats_.entries_.value());
+  EXPECT_EQ(80, stats_.bytes_.value());
+
+  // A single large entry may evict several small ones.
+  EXPECT_TRUE(cache.insert("d", makeResponse(99)));
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  EXPECT_EQ(nullptr, cache.lookup("c"));
+  EXPECT_EQ(3, stats_.evictions_.value());
+  EXPECT_EQ(1, stats_.entries_.value());
+}
+
+TEST_F(HttpCacheTest, RejectLargerThanShard) {
+  HttpCache cache(100, 2, stats_);
+  EXPECT_FALSE(cache.insert("a", makeResponse(50)));
+  EXPECT_EQ(nullptr, cache.lookup("a"));
+  EXPECT_EQ(0, stats_.entries_.value());
+  EXPECT_EQ(0, stats_.bytes_.value());
+}
+
+TEST_F(HttpCacheTest, VaryMatches) {
+  CachedResponse response;
+  response.vary_values_.emplace_back(Http::LowerCaseString("accept-encoding"), "gzip");
+  response.vary_values_.emplace_back(Http::LowerCaseString("x-tenant"), "");
+
+  EXPECT_TRUE(response.varyMatches(Http::TestHeaderMapImpl{{"accept-encoding", "gzip"}}));
+  EXPECT_FALSE(response.varyMatches(Http::TestHeaderMapImpl{{"accept-encoding", "br"}}));
+  EXPECT_FALSE(response.varyMatches(
+      Http::TestHeaderMapImpl{{"accept-encoding", "gzip"}, {"x-tenant", "a"}}));
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
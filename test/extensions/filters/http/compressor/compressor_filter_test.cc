@@ -0,0 +1,327 @@
+#include <memory>
+
+#include "common/decompressor/zlib_decompressor_impl.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/http/compressor/compressor_filter.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "brotli/decode.h"
+#include "gtest/gtest.h"
+#include "zstd.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+namespace {
+
+const std::string AllAlgorithmsConfig = R"EOF(
+algorithms:
+  - zstd: {}
+  - brotli: {}
+  - gzip: {}
+)EOF";
+
+class CompressorFilterTest : public testing::Test {
+protected:
+  CompressorFilterTest() {
+    ON_CALL(runtime_.snapshot_, featureEnabled("compressor.filter_enabled", 100))
+        .WillByDefault(Return(true));
+  }
+
+  void SetUp() override { setUpFilter(AllAlgorithmsConfig); }
+
+  void setUpFilter(const std::string& yaml) {
+    envoy::config::filter::http::compressor::v2alpha::Compressor compressor;
+    MessageUtil::loadFromYaml(yaml, compressor);
+    config_ = std::make_shared<CompressorFilterConfig>(compressor, "test.", stats_, runtime_);
+    filter_ = std::make_unique<CompressorFilter>(config_);
+    filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+  }
+
+  // Returns the content-coding chosen for an accept-encoding value, or "identity" if the response
+  // would not be compressed because the client prefers it, or "" otherwise.
+  std::string chooseEncoding(const std::string& accept_encoding) {
+    bool identity;
+    EncodingConfig* encoding = config_->chooseEncoding(accept_encoding, identity);
+    if (identity) {
+      EXPECT_EQ(nullptr, encoding);
+      return "identity";
+    }
+    return encoding == nullptr ? "" : encoding->encoding();
+  }
+
+  void doRequest(Http::TestHeaderMapImpl&& headers) {
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers, true));
+  }
+
+  std::string decompress(const std::string& encoding, const Buffer::Instance& data,
+                         uint64_t expected_size) {
+    const std::string compressed = data.toString();
+    std::string output(expected_size, '\0');
+    if (encoding == "gzip") {
+      Decompressor::ZlibDecompressorImpl decompressor;
+      decompressor.init(31);
+      Buffer::OwnedImpl input(compressed);
+      Buffer::OwnedImpl decompressed;
+      decompressor.decompress(input, decompressed);
+      return decompressed.toString();
+    } else if (encoding == "br") {
+      size_t size = output.size();
+      EXPECT_EQ(BROTLI_DECODER_RESULT_SUCCESS,
+                BrotliDecoderDecompress(compressed.size(),
+                                        reinterpret_cast<const uint8_t*>(compressed.data()),
+                                        &size, reinterpret_cast<uint8_t*>(&output[0])));
+      output.resize(size);
+    } else {
+      const size_t size =
+          ZSTD_decompress(&output[0], output.size(), compressed.data(), compressed.size());
+      EXPECT_FALSE(ZSTD_isError(size));
+      output.resize(size);
+    }
+    return output;
+  }
+
+  void doResponseCompression(const std::string& encoding, Http::TestHeaderMapImpl&& headers) {
+    Buffer::OwnedImpl data;
+    TestUtility::feedBufferWithRandomCharacters(data, 256);
+    const std::string expected = data.toString();
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+    EXPECT_EQ("", headers.get_("content-length"));
+    EXPECT_EQ(encoding, headers.get_("content-encoding"));
+    EXPECT_EQ("Accept-Encoding", headers.get_("vary"));
+    EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, true));
+    EXPECT_EQ(expected, decompress(encoding, data, expected.size()));
+    const std::string prefix = "test.compressor." + encoding + ".";
+    EXPECT_EQ(1U, stats_.counter(prefix + "compressed").value());
+    EXPECT_EQ(256U, stats_.counter(prefix + "total_uncompressed_bytes").value());
+    EXPECT_EQ(data.length(), stats_.counter(prefix + "total_compressed_bytes").value());
+  }
+
+  void doResponseNoCompression(Http::TestHeaderMapImpl&& headers) {
+    Buffer::OwnedImpl data;
+    TestUtility::feedBufferWithRandomCharacters(data, 256);
+    const std::string expected = data.toString();
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+    EXPECT_EQ("", headers.get_("content-encoding"));
+    EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, false));
+    EXPECT_EQ(expected, data.toString());
+    Http::TestHeaderMapImpl trailers;
+    EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_->encodeTrailers(trailers));
+    EXPECT_EQ(1U, stats_.counter("test.compressor.not_compressed").value());
+  }
+
+  CompressorFilterConfigSharedPtr config_;
+  std::unique_ptr<CompressorFilter> filter_;
+  Stats::IsolatedStoreImpl stats_;
+  NiceMock<Runtime::MockLoader> runtime_;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+};
+
+TEST_F(CompressorFilterTest, DefaultConfigValues) {
+  EXPECT_EQ(30, config_->minimumLength());
+  EXPECT_FALSE(config_->disableOnEtagHeader());
+  EXPECT_FALSE(config_->removeAcceptEncodingHeader());
+  EXPECT_EQ(8, config_->contentTypeValues().size());
+  ASSERT_EQ(3, config_->encodings().size());
+  EXPECT_EQ("zstd", config_->encodings()[0]->encoding());
+  EXPECT_EQ("br", config_->encodings()[1]->encoding());
+  EXPECT_EQ("gzip", config_->encodings()[2]->encoding());
+}
+
+TEST_F(CompressorFilterTest, DuplicateEncoding) {
+  EXPECT_THROW_WITH_MESSAGE(setUpFilter(R"EOF(
+algorithms:
+  - gzip: {}
+  - brotli: {}
+  - gzip: {}
+)EOF"),
+                            EnvoyException,
+                            "compressor filter: duplicate content-coding 'gzip'");
+}
+
+// Codings are chosen by quality value, then by the configured order.
+TEST_F(CompressorFilterTest, ChooseEncoding) {
+  EXPECT_EQ("zstd", chooseEncoding("gzip, br, zstd"));
+  EXPECT_EQ("br", chooseEncoding("gzip, deflate, br"));
+  EXPECT_EQ("gzip", chooseEncoding("gzip"));
+  EXPECT_EQ("gzip", chooseEncoding("GZIP"));
+  EXPECT_EQ("gzip", chooseEncoding("gzip;q=1.0, br;q=0.9, zstd;q=0.5"));
+  EXPECT_EQ("br", chooseEncoding("gzip;q=0.5, br ; q=0.501"));
+  EXPECT_EQ("zstd", chooseEncoding("*"));
+  EXPECT_EQ("br", chooseEncoding("zstd;q=0, *"));
+  EXPECT_EQ("gzip", chooseEncoding("*;q=0.1, gzip;q=0.2"));
+  EXPECT_EQ("", chooseEncoding(""));
+  EXPECT_EQ("", chooseEncoding("deflate"));
+  EXPECT_EQ("", chooseEncoding("gzip;q=0"));
+  EXPECT_EQ("", chooseEncoding("*;q=0"));
+  EXPECT_EQ("", chooseEncoding("identity;q=0"));
+  EXPECT_EQ("identity", chooseEncoding("identity"));
+  EXPECT_EQ("identity", chooseEncoding("gzip;q=0.5, identity"));
+  EXPECT_EQ("gzip", chooseEncoding("gzip, identity"));
+}
+
+// Codings with a malformed quality value are ignored.
+TEST_F(CompressorFilterTest, ChooseEncodingInvalidQvalue) {
+  EXPECT_EQ("gzip", chooseEncoding("br;q=2, gzip"));
+  EXPECT_EQ("gzip", chooseEncoding("br;q=1.5, gzip"));
+  EXPECT_EQ("gzip", chooseEncoding("br;q=0.1234, gzip"));
+  EXPECT_EQ("gzip", chooseEncoding("br;q=, gzip"));
+  EXPECT_EQ("gzip", chooseEncoding("br;q=0.x, gzip"));
+  EXPECT_EQ("gzip", chooseEncoding("br;q=-1, gzip"));
+  EXPECT_EQ("br", chooseEncoding("br;q=1.000, gzip"));
+  EXPECT_EQ("br", chooseEncoding("br;level=1, gzip"));
+}
+
+TEST_F(CompressorFilterTest, RuntimeDisabled) {
+  EXPECT_CALL(runtime_.snapshot_, featureEnabled("compressor.filter_enabled", 100))
+      .WillOnce(Return(false));
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}});
+  doResponseNoCompression({{":method", "get"}, {"content-length", "256"}});
+}
+
+TEST_F(CompressorFilterTest, CompressZstd) {
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip, br, zstd"}});
+  EXPECT_EQ(1U, stats_.counter("test.compressor.zstd.header_selected").value());
+  doResponseCompression("zstd", {{":method", "get"}, {"content-length", "256"}});
+}
+
+TEST_F(CompressorFilterTest, CompressBrotli) {
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip;q=0.8, br"}});
+  EXPECT_EQ(1U, stats_.counter("test.compressor.br.header_selected").value());
+  doResponseCompression("br", {{":method", "get"}, {"content-length", "256"}});
+}
+
+TEST_F(CompressorFilterTest, CompressGzip) {
+  doRequest({{":method", "get"}, {"accept-encoding", "deflate, gzip"}});
+  EXPECT_EQ(1U, stats_.counter("test.compressor.gzip.header_selected").value());
+  doResponseCompression("gzip", {{":method", "get"}, {"content-length", "256"}});
+}
+
+TEST_F(CompressorFilterTest, NoAcceptEncoding) {
+  doRequest({{":method", "get"}});
+  EXPECT_EQ(1U, stats_.counter("test.compressor.no_accept_header").value());
+  doResponseNoCompression({{":method", "get"}, {"content-length", "256"}});
+}
+
+TEST_F(CompressorFilterTest, IdentityPreferred) {
+  doRequest({{":method", "get"}, {"accept-encoding", "identity, gzip;q=0.5"}});
+  EXPECT_EQ(1U, stats_.counter("test.compressor.header_identity").value());
+  doResponseNoCompression({{":method", "get"}, {"content-length", "256"}});
+}
+
+TEST_F(CompressorFilterTest, NoAcceptableEncoding) {
+  doRequest({{":method", "get"}, {"accept-encoding", "deflate"}});
+  EXPECT_EQ(1U, stats_.counter("test.compressor.header_not_valid").value());
+  doResponseNoCompression({{":method", "get"}, {"content-length", "256"}});
+}
+
+TEST_F(CompressorFilterTest, RemoveAcceptEncodingHeader) {
+  setUpFilter(R"EOF(
+algorithms:
+  - brotli: {}
+remove_accept_encoding_header: true
+)EOF");
+  Http::TestHeaderMapImpl headers{{":method", "get"}, {"accept-encoding", "br"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers, true));
+  EXPECT_FALSE(headers.has("accept-encoding"));
+  doResponseCompression("br", {{":method", "get"}, {"content-length", "256"}});
+}
+
+TEST_F(CompressorFilterTest, ContentLengthTooSmall) {
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}});
+  doResponseNoCompression({{":method", "get"}, {"content-length", "10"}});
+  EXPECT_EQ(1U, stats_.counter("test.compressor.content_length_too_small").value());
+}
+
+TEST_F(CompressorFilterTest, ContentTypeNotAllowed) {
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}});
+  doResponseNoCompression(
+      {{":method", "get"}, {"content-length", "256"}, {"content-type", "image/jpeg"}});
+}
+
+TEST_F(CompressorFilterTest, CacheControlNoTransform) {
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}});
+  doResponseNoCompression(
+      {{":method", "get"}, {"content-length", "256"}, {"cache-control", "No-Transform"}});
+}
+
+TEST_F(CompressorFilterTest, AlreadyEncoded) {
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}});
+  doResponseNoCompression(
+      {{":method", "get"}, {"content-length", "256"}, {"content-encoding", "deflate"}});
+}
+
+TEST_F(CompressorFilterTest, TransferEncodingNotAllowed) {
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}});
+  doResponseNoCompression(
+      {{":method", "get"}, {"content-length", "256"}, {"transfer-encoding", "chunked, deflate"}});
+}
+
+TEST_F(CompressorFilterTest, EtagDisabled) {
+  setUpFilter(R"EOF(
+algorithms:
+  - gzip: {}
+disable_on_etag_header: true
+)EOF");
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}});
+  doResponseNoCompression({{":method", "get"}, {"content-length", "256"}, {"etag", "\"abc\""}});
+  EXPECT_EQ(1U, stats_.counter("test.compressor.not_compressed_etag").value());
+}
+
+// Strong etags are removed and weak ones preserved.
+TEST_F(CompressorFilterTest, EtagSanitized) {
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}});
+  Http::TestHeaderMapImpl headers{{":method", "get"}, {"content-length", "256"}, {"etag", "\"a\""}};
+  filter_->encodeHeaders(headers, false);
+  EXPECT_FALSE(headers.has("etag"));
+
+  setUpFilter(AllAlgorithmsConfig);
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}});
+  headers = {{":method", "get"}, {"content-length", "256"}, {"etag", "W/\"a\""}};
+  filter_->encodeHeaders(headers, false);
+  EXPECT_EQ("W/\"a\"", headers.get_("etag"));
+}
+
+TEST_F(CompressorFilterTest, VaryAppended) {
+  doRequest({{":method", "get"}, {"accept-encoding", "gzip"}});
+  Http::TestHeaderMapImpl headers{
+      {":method", "get"}, {"content-length", "256"}, {"vary", "Cookie"}};
+  filter_->encodeHeaders(headers, false);
+  EXPECT_EQ("Cookie, Accept-Encoding", headers.get_("vary"));
+}
+
+// A response ending with trailers has its compressed stream terminated before the trailers.
+TEST_F(CompressorFilterTest, Trailers) {
+  doRequest({{":method", "get"}, {"accept-encoding", "zstd"}});
+  Http::TestHeaderMapImpl headers{{":method", "get"}, {"content-length", "256"}};
+  filter_->encodeHeaders(headers, false);
+
+  Buffer::OwnedImpl data;
+  TestUtility::feedBufferWithRandomCharacters(data, 256);
+  const std::string expected = data.toString();
+  Buffer::OwnedImpl compressed;
+  filter_->encodeData(data, false);
+  compressed.move(data);
+
+  EXPECT_CALL(encoder_callbacks_, addEncodedData(_, true))
+      .WillOnce(Invoke([&compressed](Buffer::Instance& data, bool) { compressed.move(data); }));
+  Http::TestHeaderMapImpl trailers{{"grpc-status", "0"}};
+  EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_->encodeTrailers(trailers));
+  EXPECT_EQ(expected, decompress("zstd", compressed, expected.size()));
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,47 @@
+#include "extensions/filters/http/compressor/config.h"
+
+#include "test/mocks/server/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Compressor {
+namespace {
+
+TEST(CompressorFilterFactoryTest, CreateFilter) {
+  const std::string yaml = R"EOF(
+algorithms:
+  - brotli:
+      quality: 4
+  - gzip: {}
+)EOF";
+  envoy::config::filter::http::compressor::v2alpha::Compressor proto_config;
+  MessageUtil::loadFromYaml(yaml, proto_config);
+
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  CompressorFilterFactory factory;
+  Http::FilterFactoryCb cb = factory.createFilterFactoryFromProto(proto_config, "stats.", context);
+  Http::MockFilterChainFactoryCallbacks filter_callback;
+  EXPECT_CALL(filter_callback, addStreamFilter(_));
+  cb(filter_callback);
+}
+
+TEST(CompressorFilterFactoryTest, NoAlgorithms) {
+  envoy::config::filter::http::compressor::v2alpha::Compressor proto_config;
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  CompressorFilterFactory factory;
+  EXPECT_THROW(factory.createFilterFactoryFromProto(proto_config, "stats.", context),
+               ProtoValidationException);
+}
+
+} // namespace
+} // namespace Compressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
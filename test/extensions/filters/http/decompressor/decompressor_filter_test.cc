@@ -0,0 +1,267 @@
+#include <memory>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/compressor/zlib_compressor_impl.h"
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/http/decompressor/decompressor_filter.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Decompressor {
+namespace {
+
+class DecompressorFilterTest : public testing::Test {
+protected:
+  void SetUp() override { setUpFilter("{}"); }
+
+  void setUpFilter(const std::string& yaml) {
+    envoy::config::filter::http::decompressor::v2alpha::Decompressor decompressor;
+    MessageUtil::loadFromYaml(yaml, decompressor);
+    config_ = std::make_shared<DecompressorFilterConfig>(decompressor, "test.", stats_);
+    filter_ = std::make_unique<DecompressorFilter>(config_);
+    filter_->setDecoderFilterCallbacks(decoder_callbacks_);
+    filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+  }
+
+  // Compresses the data in place with the given window bits; 31 produces gzip and 15 produces
+  // deflate (zlib) framing.
+  static void compress(Buffer::Instance& data, int64_t window_bits = 31) {
+    Envoy::Compressor::ZlibCompressorImpl compressor;
+    compressor.init(Envoy::Compressor::ZlibCompressorImpl::CompressionLevel::Standard,
+                    Envoy::Compressor::ZlibCompressorImpl::CompressionStrategy::Standard,
+                    window_bits, 8);
+    compressor.compress(data, Envoy::Compressor::State::Finish);
+  }
+
+  void expectLocalReply(const std::string& status) {
+    EXPECT_CALL(decoder_callbacks_, encodeHeaders_(_, false))
+        .WillOnce(Invoke([status](Http::HeaderMap& headers, bool) -> void {
+          EXPECT_EQ(status, headers.Status()->value().getStringView());
+        }));
+  }
+
+  uint64_t counter(const std::string& name) { return stats_.counter("test." + name).value(); }
+
+  DecompressorFilterConfigSharedPtr config_;
+  std::unique_ptr<DecompressorFilter> filter_;
+  Stats::IsolatedStoreImpl stats_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> decoder_callbacks_;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+};
+
+TEST_F(DecompressorFilterTest, DefaultConfigValues) {
+  EXPECT_TRUE(config_->requestDirection().enabled());
+  EXPECT_TRUE(config_->responseDirection().enabled());
+  EXPECT_EQ(10 * 1024 * 1024, config_->requestDirection().maxDecompressedBytes());
+  EXPECT_EQ(47, config_->windowBits());
+}
+
+// The body is inflated chunk by chunk and the headers describe the decompressed body.
+TEST_F(DecompressorFilterTest, DecompressRequest) {
+  Http::TestHeaderMapImpl headers{
+      {":method", "post"}, {"content-encoding", "gzip"}, {"content-length", "100"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(headers, false));
+  EXPECT_FALSE(headers.has("content-encoding"));
+  EXPECT_FALSE(headers.has("content-length"));
+
+  Buffer::OwnedImpl data;
+  TestUtility::feedBufferWithRandomCharacters(data, 10000);
+  const std::string original = data.toString();
+  compress(data);
+  const uint64_t compressed_length = data.length();
+
+  // Split the compressed body in two chunks.
+  Buffer::OwnedImpl first;
+  first.move(data, compressed_length / 2);
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(first, false));
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(data, true));
+  EXPECT_EQ(original, first.toString() + data.toString());
+
+  EXPECT_EQ(1U, counter("decompressor.request.decompressed"));
+  EXPECT_EQ(compressed_length, counter("decompressor.request.total_compressed_bytes"));
+  EXPECT_EQ(10000U, counter("decompressor.request.total_decompressed_bytes"));
+}
+
+// A body that is inflated in many pieces, both within a data frame and across data frames, comes
+// out unchanged.
+TEST_F(DecompressorFilterTest, DecompressMultiPieceRequest) {
+  Http::TestHeaderMapImpl headers{{":method", "post"}, {"content-encoding", "gzip"}};
+  filter_->decodeHeaders(headers, false);
+
+  Buffer::OwnedImpl data;
+  TestUtility::feedBufferWithRandomCharacters(data, 100000);
+  const std::string original = data.toString();
+  compress(data);
+  ASSERT_GT(data.length(), 3 * 4096);
+
+  // The first frame is inflated in several pieces, and the rest are smaller than a piece.
+  std::string decompressed;
+  Buffer::OwnedImpl frame;
+  frame.move(data, 3 * 4096 + 100);
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(frame, false));
+  decompressed.append(frame.toString());
+  while (data.length() > 0) {
+    frame.move(data, std::min<uint64_t>(data.length(), 1000));
+    EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(frame, data.length() == 0));
+    decompressed.append(frame.toString());
+    frame.drain(frame.length());
+  }
+  EXPECT_EQ(original, decompressed);
+  EXPECT_EQ(100000U, counter("decompressor.request.total_decompressed_bytes"));
+}
+
+TEST_F(DecompressorFilterTest, DecompressDeflateRequest) {
+  Http::TestHeaderMapImpl headers{{":method", "post"}, {"content-encoding", "Deflate"}};
+  filter_->decodeHeaders(headers, false);
+
+  Buffer::OwnedImpl data("hello world");
+  compress(data, 15);
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(data, true));
+  EXPECT_EQ("hello world", data.toString());
+}
+
+TEST_F(DecompressorFilterTest, UnsupportedEncoding) {
+  Http::TestHeaderMapImpl headers{
+      {":method", "post"}, {"content-encoding", "br"}, {"content-length", "5"}};
+  filter_->decodeHeaders(headers, false);
+  EXPECT_EQ("br", headers.get_("content-encoding"));
+  EXPECT_EQ("5", headers.get_("content-length"));
+
+  Buffer::OwnedImpl data("hello");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(data, true));
+  EXPECT_EQ("hello", data.toString());
+  EXPECT_EQ(1U, counter("decompressor.request.not_decompressed"));
+}
+
+TEST_F(DecompressorFilterTest, NoContentEncoding) {
+  Http::TestHeaderMapImpl headers{{":method", "post"}};
+  filter_->decodeHeaders(headers, false);
+  Buffer::OwnedImpl data("hello");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->decodeData(data, true));
+  EXPECT_EQ("hello", data.toString());
+}
+
+TEST_F(DecompressorFilterTest, RequestDirectionDisabled) {
+  setUpFilter(R"EOF(
+request_direction_config:
+  enabled: false
+)EOF");
+  Http::TestHeaderMapImpl headers{{":method", "post"}, {"content-encoding", "gzip"}};
+  filter_->decodeHeaders(headers, false);
+  EXPECT_EQ("gzip", headers.get_("content-encoding"));
+}
+
+// A body that expands past the limit is rejected.
+TEST_F(DecompressorFilterTest, RequestTooLarge) {
+  setUpFilter(R"EOF(
+request_direction_config:
+  max_decompressed_bytes: 1000
+)EOF");
+  Http::TestHeaderMapImpl headers{{":method", "post"}, {"content-encoding", "gzip"}};
+  filter_->decodeHeaders(headers, false);
+
+  Buffer::OwnedImpl data(std::string(1024 * 1024, 'a'));
+  compress(data);
+  expectLocalReply("413");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_->decodeData(data, false));
+  EXPECT_EQ(1U, counter("decompressor.request.too_large"));
+
+  // The rest of the body is discarded.
+  Buffer::OwnedImpl more("more");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_->decodeData(more, true));
+  EXPECT_EQ(0, more.length());
+}
+
+TEST_F(DecompressorFilterTest, MalformedRequest) {
+  Http::TestHeaderMapImpl headers{{":method", "post"}, {"content-encoding", "gzip"}};
+  filter_->decodeHeaders(headers, false);
+
+  Buffer::OwnedImpl data("this is not gzip");
+  expectLocalReply("400");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_->decodeData(data, true));
+  EXPECT_EQ(1U, counter("decompressor.request.decompression_error"));
+}
+
+TEST_F(DecompressorFilterTest, DecompressResponse) {
+  Http::TestHeaderMapImpl request_headers{{":method", "get"}, {"accept-encoding", "br"}};
+  filter_->decodeHeaders(request_headers, true);
+
+  Http::TestHeaderMapImpl headers{
+      {":status", "200"}, {"content-encoding", "gzip"}, {"content-length", "100"}};
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+  EXPECT_FALSE(headers.has("content-encoding"));
+  EXPECT_FALSE(headers.has("content-length"));
+
+  Buffer::OwnedImpl data("hello world");
+  compress(data);
+  EXPECT_EQ(Http::FilterDataStatus::Continue, filter_->encodeData(data, true));
+  EXPECT_EQ("hello world", data.toString());
+  EXPECT_EQ(1U, counter("decompressor.response.decompressed"));
+}
+
+// A client that accepts the content-coding gets the response untouched.
+TEST_F(DecompressorFilterTest, ResponseEncodingAccepted) {
+  for (const std::string accept_encoding : {"gzip", "deflate, GZIP;q=0.5", "*"}) {
+    setUpFilter("{}");
+    Http::TestHeaderMapImpl request_headers{{":method", "get"},
+                                            {"accept-encoding", accept_encoding}};
+    filter_->decodeHeaders(request_headers, true);
+    Http::TestHeaderMapImpl headers{{":status", "200"}, {"content-encoding", "gzip"}};
+    filter_->encodeHeaders(headers, false);
+    EXPECT_EQ("gzip", headers.get_("content-encoding")) << accept_encoding;
+  }
+
+  for (const std::string accept_encoding : {"gzip;q=0", "*, gzip;q=0", "*;q=0"}) {
+    setUpFilter("{}");
+    Http::TestHeaderMapImpl request_headers{{":method", "get"},
+                                            {"accept-encoding", accept_encoding}};
+    filter_->decodeHeaders(request_headers, true);
+    Http::TestHeaderMapImpl headers{{":status", "200"}, {"content-encoding", "gzip"}};
+    filter_->encodeHeaders(headers, false);
+    EXPECT_FALSE(headers.has("content-encoding")) << accept_encoding;
+  }
+}
+
+TEST_F(DecompressorFilterTest, MalformedResponse) {
+  Http::TestHeaderMapImpl request_headers{{":method", "get"}};
+  filter_->decodeHeaders(request_headers, true);
+  Http::TestHeaderMapImpl headers{{":status", "200"}, {"content-encoding", "gzip"}};
+  filter_->encodeHeaders(headers, false);
+
+  Buffer::OwnedImpl data("this is not gzip");
+  EXPECT_CALL(encoder_callbacks_, resetStream());
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_->encodeData(data, false));
+  EXPECT_EQ(0, data.length());
+  EXPECT_EQ(1U, counter("decompressor.response.decompression_error"));
+
+  Buffer::OwnedImpl more("more");
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, filter_->encodeData(more, true));
+}
+
+TEST_F(DecompressorFilterTest, HeadersOnlyResponse) {
+  Http::TestHeaderMapImpl request_headers{{":method", "head"}};
+  filter_->decodeHeaders(request_headers, true);
+  Http::TestHeaderMapImpl headers{
+      {":status", "200"}, {"content-encoding", "gzip"}, {"content-length", "100"}};
+  filter_->encodeHeaders(headers, true);
+  EXPECT_EQ("gzip", headers.get_("content-encoding"));
+  EXPECT_EQ("100", headers.get_("content-length"));
+}
+
+} // namespace
+} // namespace Decompressor
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,105 @@
+#include "common/common/lock_guard.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/gzip/compression_thread_pool.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Gzip {
+namespace {
+
+class CompressionThreadPoolTest : public testing::Test {
+public:
+  // Blocks the calling pool thread until release() is called.
+  void block() {
+    Thread::LockGuard lock(lock_);
+    blocked_++;
+    cond_var_.notifyAll();
+    while (!released_) {
+      cond_var_.wait(lock_);
+    }
+  }
+
+  void waitForBlocked(uint32_t count) {
+    Thread::LockGuard lock(lock_);
+    while (blocked_ < count) {
+      cond_var_.wait(lock_);
+    }
+  }
+
+  void release() {
+    Thread::LockGuard lock(lock_);
+    released_ = true;
+    cond_var_.notifyAll();
+  }
+
+  void waitForDone(uint32_t count) {
+    Thread::LockGuard lock(lock_);
+    while (done_ < count) {
+      cond_var_.wait(lock_);
+    }
+  }
+
+  void done() {
+    Thread::LockGuard lock(lock_);
+    done_++;
+    cond_var_.notifyAll();
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  Stats::Gauge& queue_depth_{store_.gauge("queue_depth")};
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar cond_var_;
+  uint32_t blocked_ GUARDED_BY(lock_){};
+  uint32_t done_ GUARDED_BY(lock_){};
+  bool released_ GUARDED_BY(lock_){};
+};
+
+TEST_F(CompressionThreadPoolTest, RunsJobs) {
+  CompressionThreadPool pool(Thread::threadFactoryForTest(), 2, 16, queue_depth_);
+  for (uint32_t i = 0; i < 10; i++) {
+    EXPECT_TRUE(pool.post([this]() -> void { done(); }));
+  }
+  waitForDone(10);
+  EXPECT_EQ(0U, queue_depth_.value());
+}
+
+TEST_F(CompressionThreadPoolTest, QueueFull) {
+  CompressionThreadPool pool(Thread::threadFactoryForTest(), 1, 2, queue_depth_);
+  EXPECT_TRUE(pool.post([this]() -> void { block(); }));
+  waitForBlocked(1);
+
+  EXPECT_TRUE(pool.post([this]() -> void { done(); }));
+  EXPECT_TRUE(pool.post([this]() -> void { done(); }));
+  EXPECT_FALSE(pool.post([this]() -> void { done(); }));
+  EXPECT_EQ(2U, queue_depth_.value());
+
+  release();
+  waitForDone(2);
+  EXPECT_EQ(0U, queue_depth_.value());
+  EXPECT_TRUE(pool.post([this]() -> void { done(); }));
+  waitForDone(3);
+}
+
+TEST_F(CompressionThreadPoolTest, ShutdownWithQueuedJobs) {
+  {
+    CompressionThreadPool pool(Thread::threadFactoryForTest(), 1, 2, queue_depth_);
+    EXPECT_TRUE(pool.post([this]() -> void { block(); }));
+    waitForBlocked(1);
+    EXPECT_TRUE(pool.post([this]() -> void { done(); }));
+    EXPECT_EQ(1U, queue_depth_.value());
+    release();
+  }
+  EXPECT_EQ(0U, queue_depth_.value());
+}
+
+} // namespace
+} // namespace Gzip
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -1,5 +1,6 @@
 #include <memory>
 
+#include "common/common/lock_guard.h"
 #include "common/compressor/zlib_compressor_impl.h"
 #include "common/decompressor/zlib_decompressor_impl.h"
 #include "common/protobuf/utility.h"
@@ -9,10 +10,13 @@
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/stats/mocks.h"
+#include "test/test_common/simulated_time_system.h"
 #include "test/test_common/utility.h"
 
 #include "gtest/gtest.h"
 
+using testing::_;
+using testing::Invoke;
 using testing::Return;
 
 namespace Envoy {
@@ -32,6 +36,12 @@ protected:
     decompressor_.init(31);
   }
 
+  void TearDown() override {
+    // The compression thread pool refers to the stats and the time system.
+    filter_.reset();
+    config_.reset();
+  }
+
   // GzipFilter private member functions
   void sanitizeEtagHeader(Http::HeaderMap& headers) { filter_->sanitizeEtagHeader(headers); }
 
@@ -64,10 +74,54 @@ protected:
     Json::ObjectSharedPtr config = Json::Factory::loadFromString(json);
     envoy::config::filter::http::gzip::v2::Gzip gzip;
     MessageUtil::loadFromJson(json, gzip);
-    config_.reset(new GzipFilterConfig(gzip, "test.", stats_, runtime_));
+    config_.reset(new GzipFilterConfig(gzip, "test.", stats_, runtime_, time_system_,
+                                       Thread::threadFactoryForTest()));
     filter_ = std::make_unique<GzipFilter>(config_);
   }
 
+  // Collects the output of offloaded compression and the completions posted to the worker.
+  void setUpOffload(std::string&& json) {
+    setUpFilter(std::move(json));
+    filter_->setEncoderFilterCallbacks(encoder_callbacks_);
+    ON_CALL(encoder_callbacks_, addEncodedData(_, true))
+        .WillByDefault(Invoke([this](Buffer::Instance& data, bool) { encoded_data_.move(data); }));
+    ON_CALL(encoder_callbacks_.dispatcher_, post(_))
+        .WillByDefault(Invoke([this](Event::PostCb callback) {
+          Thread::LockGuard lock(post_lock_);
+          posted_.push_back(callback);
+          post_cond_var_.notifyOne();
+        }));
+  }
+
+  // Waits for the next offloaded chunk to complete and resumes the stream as the worker would.
+  void runPosted() {
+    Event::PostCb callback;
+    {
+      Thread::LockGuard lock(post_lock_);
+      while (posted_.empty()) {
+        post_cond_var_.wait(post_lock_);
+      }
+      callback = posted_.front();
+      posted_.pop_front();
+    }
+    callback();
+  }
+
+  void startCompressedResponse() {
+    doRequest({{":method", "get"}, {"accept-encoding", "gzip"}}, true);
+    Http::TestHeaderMapImpl headers{{":method", "get"}, {"content-length", "4096"}};
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->encodeHeaders(headers, false));
+  }
+
+  Http::FilterDataStatus encodeChunk(uint64_t size, bool end_stream) {
+    Buffer::OwnedImpl chunk;
+    TestUtility::feedBufferWithRandomCharacters(chunk, size);
+    expected_str_ += chunk.toString();
+    const Http::FilterDataStatus status = filter_->encodeData(chunk, end_stream);
+    encoded_data_.move(chunk);
+    return status;
+  }
+
   void verifyCompressedData() {
     decompressor_.decompress(data_, decompressed_data_);
     const std::string uncompressed_str{decompressed_data_.toString()};
@@ -127,6 +181,12 @@ protected:
   std::string expected_str_;
   Stats::IsolatedStoreImpl stats_;
   NiceMock<Runtime::MockLoader> runtime_;
+  Event::SimulatedTimeSystem time_system_;
+  NiceMock<Http::MockStreamEncoderFilterCallbacks> encoder_callbacks_;
+  Buffer::OwnedImpl encoded_data_;
+  Thread::MutexBasicLockable post_lock_;
+  Thread::CondVar post_cond_var_;
+  std::list<Event::PostCb> posted_ GUARDED_BY(post_lock_);
 };
 
 // Test if Runtime Feature is Disabled
@@ -706,6 +766,100 @@ TEST_F(GzipFilterTest, RemoveAcceptEncodingHeader) {
   }
 }
 
+// Large chunks are compressed on the thread pool and the output stays in order with the chunks
+// that arrive in the meantime.
+TEST_F(GzipFilterTest, OffloadPreservesOrder) {
+  setUpOffload(R"EOF({"offload": {"min_chunk_size": 1024}})EOF");
+  startCompressedResponse();
+
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeChunk(2048, false));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeChunk(100, false));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeChunk(0, true));
+  EXPECT_EQ(0, encoded_data_.length());
+
+  EXPECT_CALL(encoder_callbacks_, continueEncoding());
+  runPosted();
+
+  data_.move(encoded_data_);
+  verifyCompressedData();
+  EXPECT_EQ(1U, stats_.counter("test.gzip.offloaded").value());
+  EXPECT_EQ(0U, stats_.counter("test.gzip.offload_rejected").value());
+  EXPECT_EQ(0U, stats_.gauge("test.gzip.offload_queue_depth").value());
+}
+
+// Data held back behind an offloaded chunk is offloaded in turn if it is large enough, and the
+// stream is only resumed once nothing is in flight.
+TEST_F(GzipFilterTest, OffloadPendingChunk) {
+  setUpOffload(R"EOF({"offload": {"min_chunk_size": 1024}})EOF");
+  startCompressedResponse();
+
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeChunk(1024, false));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeChunk(2048, true));
+
+  EXPECT_CALL(encoder_callbacks_, continueEncoding()).Times(0);
+  runPosted();
+  EXPECT_CALL(encoder_callbacks_, continueEncoding());
+  runPosted();
+
+  data_.move(encoded_data_);
+  verifyCompressedData();
+  EXPECT_EQ(2U, stats_.counter("test.gzip.offloaded").value());
+}
+
+// Small chunks are compressed inline.
+TEST_F(GzipFilterTest, OffloadSmallChunk) {
+  setUpOffload(R"EOF({"offload": {"min_chunk_size": 1024}})EOF");
+  startCompressedResponse();
+
+  EXPECT_EQ(Http::FilterDataStatus::Continue, encodeChunk(512, true));
+  data_.move(encoded_data_);
+  verifyCompressedData();
+  EXPECT_EQ(0U, stats_.counter("test.gzip.offloaded").value());
+}
+
+// Trailers wait for the offloaded body.
+TEST_F(GzipFilterTest, OffloadTrailers) {
+  setUpOffload(R"EOF({"offload": {"min_chunk_size": 1024}})EOF");
+  startCompressedResponse();
+
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeChunk(2048, false));
+  Http::TestHeaderMapImpl trailers;
+  EXPECT_EQ(Http::FilterTrailersStatus::StopIteration, filter_->encodeTrailers(trailers));
+
+  EXPECT_CALL(encoder_callbacks_, continueEncoding());
+  runPosted();
+  EXPECT_EQ(Http::FilterTrailersStatus::Continue, filter_->encodeTrailers(trailers));
+}
+
+// Data held back behind an offloaded chunk is subject to the encoder buffer limit.
+TEST_F(GzipFilterTest, OffloadWatermarks) {
+  setUpOffload(R"EOF({"offload": {"min_chunk_size": 1024}})EOF");
+  ON_CALL(encoder_callbacks_, encoderBufferLimit()).WillByDefault(Return(1000));
+  startCompressedResponse();
+
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeChunk(2048, false));
+  EXPECT_CALL(encoder_callbacks_, onEncoderFilterAboveWriteBufferHighWatermark());
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeChunk(800, false));
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeChunk(800, false));
+
+  EXPECT_CALL(encoder_callbacks_, onEncoderFilterBelowWriteBufferLowWatermark());
+  runPosted();
+  EXPECT_CALL(encoder_callbacks_, continueEncoding());
+  runPosted();
+}
+
+// Results that complete after the stream is destroyed are dropped.
+TEST_F(GzipFilterTest, OffloadAfterDestroy) {
+  setUpOffload(R"EOF({"offload": {"min_chunk_size": 1024}})EOF");
+  startCompressedResponse();
+
+  EXPECT_EQ(Http::FilterDataStatus::StopIterationNoBuffer, encodeChunk(2048, true));
+  filter_->onDestroy();
+  EXPECT_CALL(encoder_callbacks_, addEncodedData(_, _)).Times(0);
+  EXPECT_CALL(encoder_callbacks_, continueEncoding()).Times(0);
+  runPosted();
+}
+
 } // namespace Gzip
 } // namespace HttpFilters
 } // namespace Extensions
@@ -0,0 +1,146 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/request_coalescing/in_flight_request.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace RequestCoalescing {
+namespace {
+
+class MockWaiter : public InFlightRequest::Waiter {
+public:
+  MOCK_METHOD0(onResponseUpdated, void());
+};
+
+class InFlightRequestTest : public testing::Test {
+public:
+  InFlightRequestTest()
+      : stats_{ALL_REQUEST_COALESCING_STATS(POOL_COUNTER_PREFIX(store_, "test."),
+                                            POOL_GAUGE_PREFIX(store_, "test."))},
+        table_(2, 8, stats_) {}
+
+  Stats::IsolatedStoreImpl store_;
+  RequestCoalescingStats stats_;
+  InFlightRequestTable table_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+};
+
+TEST_F(InFlightRequestTest, Table) {
+  std::pair<InFlightRequestSharedPtr, bool> first = table_.findOrCreate("a");
+  EXPECT_TRUE(first.second);
+  std::pair<InFlightRequestSharedPtr, bool> second = table_.findOrCreate("a");
+  EXPECT_FALSE(second.second);
+  EXPECT_EQ(first.first, second.first);
+  EXPECT_TRUE(table_.findOrCreate("b").second);
+  EXPECT_EQ(2U, store_.gauge("test.in_flight").value());
+  EXPECT_EQ(2U, store_.counter("test.rq_upstream").value());
+
+  table_.remove("a", *first.first);
+  EXPECT_EQ(1U, store_.gauge("test.in_flight").value());
+  std::pair<InFlightRequestSharedPtr, bool> third = table_.findOrCreate("a");
+  EXPECT_TRUE(third.second);
+
+  // A stale request does not remove its successor.
+  table_.remove("a", *first.first);
+  EXPECT_EQ(third.first, table_.findOrCreate("a").first);
+}
+
+TEST_F(InFlightRequestTest, Waiters) {
+  InFlightRequestSharedPtr request = table_.findOrCreate("a").first;
+  auto waiter1 = std::make_shared<NiceMock<MockWaiter>>();
+  auto waiter2 = std::make_shared<NiceMock<MockWaiter>>();
+  auto waiter3 = std::make_shared<NiceMock<MockWaiter>>();
+  EXPECT_TRUE(request->addWaiter(dispatcher_, waiter1));
+  EXPECT_TRUE(request->addWaiter(dispatcher_, waiter2));
+  EXPECT_FALSE(request->addWaiter(dispatcher_, waiter3));
+  EXPECT_EQ(1U, store_.counter("test.rq_too_many_waiters").value());
+  EXPECT_EQ(2U, store_.gauge("test.rq_waiting").value());
+
+  request->removeWaiter(*waiter2);
+  request->removeWaiter(*waiter3);
+  EXPECT_EQ(1U, store_.gauge("test.rq_waiting").value());
+
+  // Destroyed waiters are not notified.
+  EXPECT_CALL(dispatcher_, post(_));
+  waiter1.reset();
+  request->publishHeaders(Http::TestHeaderMapImpl{{":status", "200"}}, false);
+
+  // Remaining waiters are accounted for when the request goes away.
+  table_.remove("a", *request);
+  request.reset();
+  EXPECT_EQ(0U, store_.gauge("test.rq_waiting").value());
+}
+
+TEST_F(InFlightRequestTest, Progress) {
+  InFlightRequestSharedPtr request = table_.findOrCreate("a").first;
+  auto waiter = std::make_shared<MockWaiter>();
+  ASSERT_TRUE(request->addWaiter(dispatcher_, waiter));
+
+  InFlightRequest::Progress progress = request->progress(false, 0);
+  EXPECT_EQ(nullptr, progress.headers_);
+  EXPECT_FALSE(progress.complete_);
+
+  EXPECT_CALL(*waiter, onResponseUpdated()).Times(3);
+  request->publishHeaders(Http::TestHeaderMapImpl{{":status", "200"}}, false);
+  Buffer::OwnedImpl data1("hello");
+  EXPECT_TRUE(request->publishData(data1, false));
+  Buffer::OwnedImpl data2("");
+  EXPECT_TRUE(request->publishData(data2, true));
+
+  progress = request->progress(false, 0);
+  ASSERT_NE(nullptr, progress.headers_);
+  EXPECT_STREQ("200", progress.headers_->Status()->value().c_str());
+  ASSERT_EQ(1U, progress.chunks_.size());
+  EXPECT_EQ("hello", *progress.chunks_[0]);
+  EXPECT_TRUE(progress.complete_);
+  EXPECT_FALSE(progress.failed_);
+
+  progress = request->progress(true, 1);
+  EXPECT_EQ(nullptr, progress.headers_);
+  EXPECT_TRUE(progress.chunks_.empty());
+  EXPECT_TRUE(progress.complete_);
+
+  // A complete request cannot fail.
+  request->fail();
+  EXPECT_FALSE(request->progress(true, 1).failed_);
+}
+
+TEST_F(InFlightRequestTest, TooLarge) {
+  InFlightRequestSharedPtr request = table_.findOrCreate("a").first;
+  request->publishHeaders(Http::TestHeaderMapImpl{{":status", "200"}}, false);
+  Buffer::OwnedImpl data1("hello");
+  EXPECT_TRUE(request->publishData(data1, false));
+  Buffer::OwnedImpl data2("world");
+  EXPECT_FALSE(request->publishData(data2, false));
+  EXPECT_TRUE(request->progress(true, 1).failed_);
+
+  auto waiter = std::make_shared<MockWaiter>();
+  EXPECT_FALSE(request->addWaiter(dispatcher_, waiter));
+}
+
+TEST_F(InFlightRequestTest, Trailers) {
+  InFlightRequestSharedPtr request = table_.findOrCreate("a").first;
+  request->publishHeaders(Http::TestHeaderMapImpl{{":status", "200"}}, false);
+  request->publishTrailers(Http::TestHeaderMapImpl{{"grpc-status", "0"}});
+  InFlightRequest::Progress progress = request->progress(true, 0);
+  ASSERT_NE(nullptr, progress.trailers_);
+  EXPECT_STREQ("0", progress.trailers_->GrpcStatus()->value().c_str());
+  EXPECT_TRUE(progress.complete_);
+}
+
+} // namespace
+} // namespace RequestCoalescing
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
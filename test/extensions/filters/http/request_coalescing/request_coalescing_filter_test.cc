@@ -0,0 +1,374 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/http/request_coalescing/config.h"
+#include "extensions/filters/http/request_coalescing/request_coalescing_filter.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace RequestCoalescing {
+namespace {
+
+class RequestCoalescingFilterTest : public testing::Test {
+public:
+  // A downstream stream. Posts to its dispatcher are queued, as they would be for a stream on
+  // another worker, and run by runPosted().
+  struct Stream {
+    Stream(RequestCoalescingFilterTest& parent) {
+      ON_CALL(callbacks_.dispatcher_, post(_)).WillByDefault(Invoke([&parent](Event::PostCb cb) {
+        parent.posted_.push_back(cb);
+      }));
+      filter_ = std::make_unique<RequestCoalescingFilter>(parent.config_);
+      filter_->setDecoderFilterCallbacks(callbacks_);
+    }
+
+    Http::FilterHeadersStatus decodeHeaders(Http::TestHeaderMapImpl&& headers) {
+      request_headers_ = std::move(headers);
+      return filter_->decodeHeaders(request_headers_, true);
+    }
+
+    NiceMock<Http::MockStreamDecoderFilterCallbacks> callbacks_;
+    std::unique_ptr<RequestCoalescingFilter> filter_;
+    Http::TestHeaderMapImpl request_headers_;
+  };
+  typedef std::unique_ptr<Stream> StreamPtr;
+
+  RequestCoalescingFilterTest() { setUpConfig("{}"); }
+
+  void setUpConfig(const std::string& yaml) {
+    envoy::config::filter::http::request_coalescing::v2alpha::RequestCoalescing proto_config;
+    MessageUtil::loadFromYaml(yaml, proto_config);
+    config_ = std::make_shared<RequestCoalescingFilterConfig>(proto_config, "test.", stats_);
+  }
+
+  StreamPtr makeStream() { return std::make_unique<Stream>(*this); }
+
+  // Start a request that is expected to be sent upstream.
+  StreamPtr startLeader() {
+    StreamPtr stream = makeStream();
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              stream->decodeHeaders(Http::TestHeaderMapImpl(request_headers_)));
+    return stream;
+  }
+
+  // Start a request that is expected to wait for an in-flight request.
+  StreamPtr startWaiter() {
+    StreamPtr stream = makeStream();
+    EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+              stream->decodeHeaders(Http::TestHeaderMapImpl(request_headers_)));
+    return stream;
+  }
+
+  void runPosted() {
+    while (!posted_.empty()) {
+      Event::PostCb cb = posted_.front();
+      posted_.pop_front();
+      cb();
+    }
+  }
+
+  void expectHeaders(Stream& stream, bool end_stream) {
+    EXPECT_CALL(stream.callbacks_, encodeHeaders_(_, end_stream))
+        .WillOnce(Invoke([](Http::HeaderMap& headers, bool) {
+          EXPECT_STREQ("200", headers.Status()->value().c_str());
+        }));
+  }
+
+  void expectData(Stream& stream, const std::string& body, bool end_stream) {
+    EXPECT_CALL(stream.callbacks_, encodeData(_, end_stream))
+        .WillOnce(
+            Invoke([body](Buffer::Instance& data, bool) { EXPECT_EQ(body, data.toString()); }));
+  }
+
+  Stats::IsolatedStoreImpl stats_;
+  RequestCoalescingFilterConfigSharedPtr config_;
+  std::list<Event::PostCb> posted_;
+  const Http::TestHeaderMapImpl request_headers_{
+      {":method", "GET"}, {":path", "/catalog"}, {":authority", "host"}};
+  Http::TestHeaderMapImpl response_headers_{{":status", "200"}, {"content-type", "text/plain"}};
+};
+
+TEST_F(RequestCoalescingFilterTest, FanOut) {
+  StreamPtr leader = startLeader();
+  StreamPtr waiter1 = startWaiter();
+  StreamPtr waiter2 = startWaiter();
+  EXPECT_EQ(1U, stats_.counter("test.request_coalescing.rq_upstream").value());
+  EXPECT_EQ(2U, stats_.counter("test.request_coalescing.rq_coalesced").value());
+  EXPECT_EQ(2U, stats_.gauge("test.request_coalescing.rq_waiting").value());
+  EXPECT_EQ(1U, stats_.gauge("test.request_coalescing.in_flight").value());
+  EXPECT_EQ(1U, waiter1->callbacks_.callbacks_.size());
+
+  // Nothing to replay until the response headers arrive.
+  EXPECT_CALL(waiter1->callbacks_, encodeHeaders_(_, _)).Times(0);
+  runPosted();
+  testing::Mock::VerifyAndClearExpectations(&waiter1->callbacks_);
+
+  expectHeaders(*waiter1, false);
+  expectHeaders(*waiter2, false);
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            leader->filter_->encodeHeaders(response_headers_, false));
+  runPosted();
+
+  expectData(*waiter1, "hello", false);
+  expectData(*waiter2, "hello", false);
+  Buffer::OwnedImpl data1("hello");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, leader->filter_->encodeData(data1, false));
+  runPosted();
+
+  expectData(*waiter1, "world", true);
+  expectData(*waiter2, "world", true);
+  Buffer::OwnedImpl data2("world");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, leader->filter_->encodeData(data2, true));
+  EXPECT_EQ(0U, stats_.gauge("test.request_coalescing.in_flight").value());
+  runPosted();
+
+  // The response is not replayed to the waiters twice as they see it pass through their own
+  // encoder path.
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            waiter1->filter_->encodeHeaders(response_headers_, false));
+
+  leader->filter_->onDestroy();
+  waiter1->filter_->onDestroy();
+  waiter2->filter_->onDestroy();
+  EXPECT_EQ(0U, stats_.gauge("test.request_coalescing.rq_waiting").value());
+  EXPECT_TRUE(waiter1->callbacks_.callbacks_.empty());
+
+  // The next request is sent upstream again.
+  startLeader();
+  EXPECT_EQ(2U, stats_.counter("test.request_coalescing.rq_upstream").value());
+}
+
+TEST_F(RequestCoalescingFilterTest, LateWaiterReplaysFromStart) {
+  StreamPtr leader = startLeader();
+  leader->filter_->encodeHeaders(response_headers_, false);
+  Buffer::OwnedImpl data1("hello");
+  leader->filter_->encodeData(data1, false);
+
+  StreamPtr waiter = startWaiter();
+  expectHeaders(*waiter, false);
+  expectData(*waiter, "hello", false);
+  runPosted();
+
+  Http::TestHeaderMapImpl trailers{{"grpc-status", "0"}};
+  EXPECT_CALL(waiter->callbacks_, encodeTrailers_(_))
+      .WillOnce(Invoke([](Http::HeaderMap& trailers) {
+        EXPECT_STREQ("0", trailers.GrpcStatus()->value().c_str());
+      }));
+  EXPECT_EQ(Http::FilterTrailersStatus::Continue, leader->filter_->encodeTrailers(trailers));
+  runPosted();
+}
+
+TEST_F(RequestCoalescingFilterTest, HeadersOnlyResponse) {
+  StreamPtr leader = startLeader();
+  StreamPtr waiter = startWaiter();
+  expectHeaders(*waiter, true);
+  EXPECT_CALL(waiter->callbacks_, encodeData(_, _)).Times(0);
+  leader->filter_->encodeHeaders(response_headers_, true);
+  runPosted();
+}
+
+TEST_F(RequestCoalescingFilterTest, NotCoalesced) {
+  StreamPtr leader = startLeader();
+
+  const auto expectNotCoalesced = [this](Http::TestHeaderMapImpl&& headers, bool end_stream) {
+    StreamPtr stream = makeStream();
+    EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+              stream->filter_->decodeHeaders(headers, end_stream));
+  };
+  expectNotCoalesced(Http::TestHeaderMapImpl(request_headers_), false);
+  expectNotCoalesced(
+      Http::TestHeaderMapImpl{{":method", "GET"}, {":path", "/other"}, {":authority", "host"}},
+      true);
+  expectNotCoalesced(
+      Http::TestHeaderMapImpl{{":method", "GET"}, {":path", "/catalog"}, {":authority", "other"}},
+      true);
+  expectNotCoalesced(
+      Http::TestHeaderMapImpl{{":method", "POST"}, {":path", "/catalog"}, {":authority", "host"}},
+      true);
+  expectNotCoalesced(Http::TestHeaderMapImpl{{":method", "GET"},
+                                             {":path", "/catalog"},
+                                             {":authority", "host"},
+                                             {"authorization", "token"}},
+                     true);
+  expectNotCoalesced(Http::TestHeaderMapImpl{{":method", "GET"},
+                                             {":path", "/catalog"},
+                                             {":authority", "host"},
+                                             {"cookie", "a=b"}},
+                     true);
+  EXPECT_EQ(0U, stats_.counter("test.request_coalescing.rq_coalesced").value());
+  // Requests for another path or host are eligible but lead requests of their own.
+  EXPECT_EQ(3U, stats_.counter("test.request_coalescing.rq_upstream").value());
+}
+
+TEST_F(RequestCoalescingFilterTest, KeyHeaders) {
+  setUpConfig("key_headers: [\"Accept-Encoding\", \"Cookie\"]");
+  StreamPtr leader = makeStream();
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            leader->decodeHeaders(Http::TestHeaderMapImpl{{":method", "GET"},
+                                                           {":path", "/catalog"},
+                                                           {":authority", "host"},
+                                                           {"accept-encoding", "gzip"},
+                                                           {"cookie", "a=b"}}));
+
+  StreamPtr other_encoding = makeStream();
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            other_encoding->decodeHeaders(Http::TestHeaderMapImpl{{":method", "GET"},
+                                                                   {":path", "/catalog"},
+                                                                   {":authority", "host"},
+                                                                   {"accept-encoding", ""},
+                                                                   {"cookie", "a=b"}}));
+
+  StreamPtr waiter = makeStream();
+  EXPECT_EQ(Http::FilterHeadersStatus::StopIteration,
+            waiter->decodeHeaders(Http::TestHeaderMapImpl{{":method", "GET"},
+                                                          {":path", "/catalog"},
+                                                          {":authority", "host"},
+                                                          {"accept-encoding", "gzip"},
+                                                          {"cookie", "a=b"}}));
+
+  // The response may vary on key headers.
+  Http::TestHeaderMapImpl response_headers{{":status", "200"}, {"vary", "Accept-Encoding"}};
+  expectHeaders(*waiter, true);
+  leader->filter_->encodeHeaders(response_headers, true);
+  runPosted();
+  EXPECT_EQ(0U, stats_.counter("test.request_coalescing.response_not_shareable").value());
+}
+
+TEST_F(RequestCoalescingFilterTest, NotShareable) {
+  const auto expectReleased = [this](Http::TestHeaderMapImpl&& response_headers) {
+    StreamPtr leader = startLeader();
+    StreamPtr waiter = startWaiter();
+    EXPECT_CALL(waiter->callbacks_, encodeHeaders_(_, _)).Times(0);
+    EXPECT_CALL(waiter->callbacks_, removeDownstreamWatermarkCallbacks(_));
+    EXPECT_CALL(waiter->callbacks_, continueDecoding());
+    leader->filter_->encodeHeaders(response_headers, true);
+    runPosted();
+    waiter->filter_->onDestroy();
+  };
+  expectReleased(Http::TestHeaderMapImpl{{":status", "200"}, {"set-cookie", "a=b"}});
+  expectReleased(Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "private"}});
+  expectReleased(
+      Http::TestHeaderMapImpl{{":status", "200"}, {"cache-control", "max-age=0, No-Store"}});
+  expectReleased(Http::TestHeaderMapImpl{{":status", "200"}, {"vary", "accept-encoding"}});
+  expectReleased(Http::TestHeaderMapImpl{{":status", "200"}, {"vary", "*"}});
+  EXPECT_EQ(5U, stats_.counter("test.request_coalescing.response_not_shareable").value());
+  EXPECT_EQ(5U, stats_.counter("test.request_coalescing.rq_released").value());
+  EXPECT_EQ(0U, stats_.gauge("test.request_coalescing.rq_waiting").value());
+  EXPECT_EQ(0U, stats_.gauge("test.request_coalescing.in_flight").value());
+}
+
+TEST_F(RequestCoalescingFilterTest, LeaderResetBeforeHeaders) {
+  StreamPtr leader = startLeader();
+  StreamPtr waiter = startWaiter();
+  EXPECT_CALL(waiter->callbacks_, continueDecoding());
+  leader->filter_->onDestroy();
+  runPosted();
+  EXPECT_EQ(1U, stats_.counter("test.request_coalescing.rq_released").value());
+
+  // The released request is now a plain pass-through.
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            waiter->filter_->encodeHeaders(response_headers_, true));
+  waiter->filter_->onDestroy();
+}
+
+TEST_F(RequestCoalescingFilterTest, LeaderResetAfterHeaders) {
+  StreamPtr leader = startLeader();
+  StreamPtr waiter = startWaiter();
+  expectHeaders(*waiter, false);
+  leader->filter_->encodeHeaders(response_headers_, false);
+  runPosted();
+
+  EXPECT_CALL(waiter->callbacks_, resetStream());
+  EXPECT_CALL(waiter->callbacks_, continueDecoding()).Times(0);
+  leader->filter_->onDestroy();
+  runPosted();
+  EXPECT_EQ(1U, stats_.counter("test.request_coalescing.rq_reset").value());
+  waiter->filter_->onDestroy();
+}
+
+TEST_F(RequestCoalescingFilterTest, ResponseTooLarge) {
+  setUpConfig("max_buffered_bytes: 8");
+  StreamPtr leader = startLeader();
+  StreamPtr waiter = startWaiter();
+  expectHeaders(*waiter, false);
+  expectData(*waiter, "hello", false);
+  leader->filter_->encodeHeaders(response_headers_, false);
+  Buffer::OwnedImpl data1("hello");
+  leader->filter_->encodeData(data1, false);
+  runPosted();
+
+  EXPECT_CALL(waiter->callbacks_, resetStream());
+  Buffer::OwnedImpl data2("world");
+  EXPECT_EQ(Http::FilterDataStatus::Continue, leader->filter_->encodeData(data2, true));
+  EXPECT_EQ(5U, data2.length());
+  runPosted();
+  EXPECT_EQ(1U, stats_.counter("test.request_coalescing.response_too_large").value());
+  EXPECT_EQ(0U, stats_.gauge("test.request_coalescing.in_flight").value());
+}
+
+TEST_F(RequestCoalescingFilterTest, TooManyWaiters) {
+  setUpConfig("max_waiters: 1");
+  StreamPtr leader = startLeader();
+  StreamPtr waiter = startWaiter();
+  StreamPtr stream = makeStream();
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue,
+            stream->decodeHeaders(Http::TestHeaderMapImpl(request_headers_)));
+  EXPECT_EQ(1U, stats_.counter("test.request_coalescing.rq_too_many_waiters").value());
+  EXPECT_EQ(1U, stats_.counter("test.request_coalescing.rq_coalesced").value());
+}
+
+TEST_F(RequestCoalescingFilterTest, Watermarks) {
+  StreamPtr leader = startLeader();
+  StreamPtr waiter = startWaiter();
+  ASSERT_EQ(1U, waiter->callbacks_.callbacks_.size());
+  Http::DownstreamWatermarkCallbacks& watermark_callbacks = *waiter->callbacks_.callbacks_.front();
+
+  expectHeaders(*waiter, false);
+  leader->filter_->encodeHeaders(response_headers_, false);
+  runPosted();
+
+  // The first chunk pushes the downstream over its high watermark.
+  EXPECT_CALL(waiter->callbacks_, encodeData(_, false))
+      .WillOnce(Invoke([&watermark_callbacks](Buffer::Instance& data, bool) {
+        EXPECT_EQ("hello", data.toString());
+        watermark_callbacks.onAboveWriteBufferHighWatermark();
+      }));
+  Buffer::OwnedImpl data1("hello");
+  leader->filter_->encodeData(data1, false);
+  Buffer::OwnedImpl data2("world");
+  leader->filter_->encodeData(data2, true);
+  runPosted();
+  testing::Mock::VerifyAndClearExpectations(&waiter->callbacks_);
+
+  expectData(*waiter, "world", true);
+  watermark_callbacks.onBelowWriteBufferLowWatermark();
+  runPosted();
+}
+
+TEST(RequestCoalescingFilterFactoryTest, CreateFilter) {
+  envoy::config::filter::http::request_coalescing::v2alpha::RequestCoalescing proto_config;
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  RequestCoalescingFilterFactory factory;
+  Http::FilterFactoryCb cb = factory.createFilterFactoryFromProto(proto_config, "stats", context);
+  Http::MockFilterChainFactoryCallbacks filter_callback;
+  EXPECT_CALL(filter_callback, addStreamFilter(_));
+  cb(filter_callback);
+}
+
+} // namespace
+} // namespace RequestCoalescing
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
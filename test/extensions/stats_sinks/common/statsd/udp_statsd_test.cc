@@ -1,4 +1,9 @@
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include <chrono>
+#include <string>
+#include <vector>
 
 #include "common/network/address_impl.h"
 #include "common/network/utility.h"
@@ -15,7 +20,10 @@
 #include "gtest/gtest.h"
 #include "spdlog/spdlog.h"
 
+using testing::_;
 using testing::NiceMock;
+using testing::SaveArg;
+using testing::SizeIs;
 
 namespace Envoy {
 namespace Extensions {
@@ -28,6 +36,72 @@ public:
   MOCK_METHOD1(write, void(const std::string& message));
 };
 
+class MockBatchWriter : public Writer {
+public:
+  explicit MockBatchWriter(uint64_t max_bytes_per_datagram) : Writer(max_bytes_per_datagram) {}
+
+  MOCK_METHOD1(writeBatch, void(const std::vector<std::string>& datagrams));
+};
+
+TEST(WriterTest, PacksMessagesIntoDatagrams) {
+  MockBatchWriter writer(25);
+  EXPECT_CALL(writer, writeBatch(_)).Times(0);
+  writer.buffer("envoy.a:1|c");
+  writer.buffer("envoy.b:2|c");
+  writer.buffer("envoy.c:3|c");
+  // Messages larger than a datagram are sent in a datagram of their own.
+  writer.buffer("envoy.long_counter_name:4|c");
+  writer.buffer("envoy.d:5|c");
+
+  EXPECT_CALL(writer, writeBatch(std::vector<std::string>{
+                          "envoy.a:1|c\nenvoy.b:2|c", "envoy.c:3|c",
+                          "envoy.long_counter_name:4|c", "envoy.d:5|c"}));
+  writer.flush();
+
+  // Nothing is left to write.
+  writer.flush();
+}
+
+TEST(WriterTest, WritesFullBatches) {
+  MockBatchWriter writer(1);
+  EXPECT_CALL(writer, writeBatch(_)).Times(0);
+  for (uint32_t i = 0; i < Writer::MaxBatchDatagrams; ++i) {
+    writer.buffer(fmt::format("envoy.c{}:1|c", i));
+  }
+
+  EXPECT_CALL(writer, writeBatch(SizeIs(Writer::MaxBatchDatagrams)));
+  writer.buffer("envoy.last:1|c");
+
+  EXPECT_CALL(writer, writeBatch(std::vector<std::string>{"envoy.last:1|c"}));
+  writer.flush();
+}
+
+class UdpWriterTest : public testing::TestWithParam<Network::Address::IpVersion> {};
+INSTANTIATE_TEST_CASE_P(IpVersions, UdpWriterTest,
+                        testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
+                        TestUtility::ipTestParamsToString);
+
+TEST_P(UdpWriterTest, SendsPackedDatagrams) {
+  auto server = Network::Test::bindFreeLoopbackPort(GetParam(),
+                                                    Network::Address::SocketType::Datagram);
+  {
+    Writer writer(server.first, 25);
+    writer.buffer("envoy.a:1|c");
+    writer.buffer("envoy.b:2|c");
+    writer.buffer("envoy.c:3|g");
+    writer.flush();
+  }
+
+  char buffer[64];
+  ssize_t received = ::recv(server.second, buffer, sizeof(buffer), 0);
+  ASSERT_GT(received, 0);
+  EXPECT_EQ("envoy.a:1|c\nenvoy.b:2|c", std::string(buffer, received));
+  received = ::recv(server.second, buffer, sizeof(buffer), 0);
+  ASSERT_GT(received, 0);
+  EXPECT_EQ("envoy.c:3|g", std::string(buffer, received));
+  ::close(server.second);
+}
+
 class UdpStatsdSinkTest : public testing::TestWithParam<Network::Address::IpVersion> {};
 INSTANTIATE_TEST_CASE_P(IpVersions, UdpStatsdSinkTest,
                         testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
@@ -150,6 +224,10 @@ TEST(UdpStatsdSinkTest, CheckActualStats) {
 
   NiceMock<Stats::MockHistogram> timer;
   timer.name_ = "test_timer";
+  // Without tagging, the tags, which are decoded under the symbol table lock, are not read for
+  // each sample.
+  EXPECT_CALL(timer, tags()).Times(0);
+  EXPECT_CALL(timer, tagExtractedName()).Times(0);
   EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
               write("envoy.test_timer:5|ms"));
   sink.onHistogramComplete(timer, 5);
@@ -177,6 +255,52 @@ TEST(UdpStatsdSinkTest, CheckActualStatsWithCustomPrefix) {
   tls_.shutdownThread();
 }
 
+TEST(UdpStatsdSinkTest, BatchHistogramSamples) {
+  NiceMock<Stats::MockSource> source;
+  auto writer_ptr = std::make_shared<NiceMock<MockBatchWriter>>(100);
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  UdpStatsdSink sink(tls_, writer_ptr, false, "", true);
+
+  // Samples are buffered until the next flush.
+  NiceMock<Stats::MockHistogram> timer;
+  timer.name_ = "test_timer";
+  EXPECT_CALL(*writer_ptr, writeBatch(_)).Times(0);
+  sink.onHistogramComplete(timer, 5);
+  sink.onHistogramComplete(timer, 6);
+
+  auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+  counter->name_ = "test_counter";
+  counter->used_ = true;
+  counter->latch_ = 1;
+  source.counters_.push_back(counter);
+
+  EXPECT_CALL(*writer_ptr,
+              writeBatch(std::vector<std::string>{
+                  "envoy.test_timer:5|ms\nenvoy.test_timer:6|ms\nenvoy.test_counter:1|c"}));
+  sink.flush(source);
+
+  tls_.shutdownThread();
+}
+
+// The flush of the samples buffered on workers does not refer to the sink, which may be destroyed
+// before it runs there.
+TEST(UdpStatsdSinkTest, BatchFlushOutlivesSink) {
+  NiceMock<Stats::MockSource> source;
+  auto writer_ptr = std::make_shared<NiceMock<MockBatchWriter>>(100);
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  auto sink = std::make_unique<UdpStatsdSink>(tls_, writer_ptr, false, "", true);
+
+  Event::PostCb worker_flush;
+  EXPECT_CALL(tls_, runOnAllThreads(_)).WillOnce(SaveArg<0>(&worker_flush));
+  sink->flush(source);
+  sink.reset();
+
+  EXPECT_CALL(*writer_ptr, writeBatch(_)).Times(0);
+  worker_flush();
+
+  tls_.shutdownThread();
+}
+
 TEST(UdpStatsdSinkWithTagsTest, CheckActualStats) {
   NiceMock<Stats::MockSource> source;
   auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
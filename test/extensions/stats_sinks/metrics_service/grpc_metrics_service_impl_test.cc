@@ -153,6 +153,42 @@ TEST(MetricsServiceSinkTest, CheckStatsCount) {
   EXPECT_EQ(1, (*streamer_).metric_count);
 }
 
+// Test that histograms are sent as a summary of the interval and a histogram of cumulative buckets.
+TEST(MetricsServiceSinkTest, HistogramSummaryAndBuckets) {
+  NiceMock<Stats::MockSource> source;
+  Event::SimulatedTimeSystem time_system;
+  std::shared_ptr<MockGrpcMetricsStreamer> streamer_{new MockGrpcMetricsStreamer()};
+
+  MetricsServiceSink sink(streamer_, time_system);
+
+  auto histogram = std::make_shared<NiceMock<Stats::MockParentHistogram>>();
+  histogram->name_ = "test_histogram";
+  histogram->used_ = true;
+  source.histograms_.push_back(histogram);
+
+  EXPECT_CALL(*streamer_, send(_))
+      .WillOnce(Invoke([](envoy::service::metrics::v2::StreamMetricsMessage& message) {
+        ASSERT_EQ(2, message.envoy_metrics_size());
+        const auto& summary_family = message.envoy_metrics(0);
+        EXPECT_EQ("test_histogram", summary_family.name());
+        EXPECT_EQ(io::prometheus::client::MetricType::SUMMARY, summary_family.type());
+        EXPECT_EQ(Stats::HistogramStatisticsImpl().supportedQuantiles().size(),
+                  static_cast<size_t>(summary_family.metric(0).summary().quantile_size()));
+
+        const auto& histogram_family = message.envoy_metrics(1);
+        EXPECT_EQ("test_histogram_bucket", histogram_family.name());
+        EXPECT_EQ(io::prometheus::client::MetricType::HISTOGRAM, histogram_family.type());
+        const auto& buckets = histogram_family.metric(0).histogram();
+        ASSERT_EQ(Stats::HistogramStatisticsImpl::defaultSupportedBuckets().size(),
+                  static_cast<size_t>(buckets.bucket_size()));
+        EXPECT_EQ(0.5, buckets.bucket(0).upper_bound());
+        EXPECT_EQ(0, buckets.bucket(0).cumulative_count());
+        EXPECT_EQ(0, buckets.sample_count());
+      }));
+
+  sink.flush(source);
+}
+
 } // namespace MetricsService
 } // namespace StatSinks
 } // namespace Extensions
@@ -115,6 +115,33 @@ TEST_P(StatsConfigParameterizedTest, UdpSinkCustomPrefix) {
   EXPECT_EQ(udp_sink->getPrefix(), customPrefix);
 }
 
+TEST_P(StatsConfigParameterizedTest, UdpSinkBatchHistogramSamplesRequiresMaxBytes) {
+  const std::string name = StatsSinkNames::get().Statsd;
+
+  envoy::config::metrics::v2::StatsdSink sink_config;
+  envoy::api::v2::core::SocketAddress& socket_address =
+      *sink_config.mutable_address()->mutable_socket_address();
+  socket_address.set_protocol(envoy::api::v2::core::SocketAddress::UDP);
+  socket_address.set_address(Network::Test::getLoopbackAddressString(GetParam()));
+  socket_address.set_port_value(8125);
+  sink_config.set_batch_histogram_samples(true);
+
+  Server::Configuration::StatsSinkFactory* factory =
+      Registry::FactoryRegistry<Server::Configuration::StatsSinkFactory>::getFactory(name);
+  ASSERT_NE(factory, nullptr);
+  ProtobufTypes::MessagePtr message = factory->createEmptyConfigProto();
+  MessageUtil::jsonConvert(sink_config, *message);
+
+  NiceMock<Server::MockInstance> server;
+  EXPECT_THROW_WITH_MESSAGE(factory->createStatsSink(*message, server), EnvoyException,
+                            "statsd: batch_histogram_samples requires max_bytes_per_datagram");
+
+  sink_config.mutable_max_bytes_per_datagram()->set_value(1400);
+  MessageUtil::jsonConvert(sink_config, *message);
+  Stats::SinkPtr sink = factory->createStatsSink(*message, server);
+  EXPECT_NE(dynamic_cast<Common::Statsd::UdpStatsdSink*>(sink.get()), nullptr);
+}
+
 TEST(StatsConfigTest, TcpSinkDefaultPrefix) {
   const std::string name = StatsSinkNames::get().Statsd;
 
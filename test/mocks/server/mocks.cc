@@ -165,6 +165,8 @@ MockFactoryContext::MockFactoryContext()
     : singleton_manager_(
           new Singleton::ManagerImpl(Thread::threadFactoryForTest().currentThreadId())) {
   ON_CALL(*this, accessLogManager()).WillByDefault(ReturnRef(access_log_manager_));
+  ON_CALL(*this, api()).WillByDefault(ReturnRef(api_));
+  ON_CALL(api_, threadFactory()).WillByDefault(ReturnRef(Thread::threadFactoryForTest()));
   ON_CALL(*this, clusterManager()).WillByDefault(ReturnRef(cluster_manager_));
   ON_CALL(*this, dispatcher()).WillByDefault(ReturnRef(dispatcher_));
   ON_CALL(*this, drainDecision()).WillByDefault(ReturnRef(drain_manager_));
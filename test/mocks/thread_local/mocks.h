@@ -61,6 +61,13 @@ public:
     void runOnAllThreads(Event::PostCb cb, Event::PostCb main_callback) override {
       parent_.runOnAllThreads(cb, main_callback);
     }
+    void runOnAllThreads(ObjectCb cb) override {
+      parent_.runOnAllThreads([&parent = parent_, index = index_, cb]() -> void {
+        if (parent.data_[index] != nullptr) {
+          cb(*parent.data_[index]);
+        }
+      });
+    }
     void set(InitializeCb cb) override { parent_.data_[index_] = cb(parent_.dispatcher_); }
 
     MockInstance& parent_;
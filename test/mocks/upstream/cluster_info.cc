@@ -1,5 +1,6 @@
 #include "test/mocks/upstream/cluster_info.h"
 
+#include "common/common/empty_string.h"
 #include "common/network/raw_buffer_socket.h"
 #include "common/upstream/upstream_impl.h"
 
@@ -58,6 +59,14 @@ MockClusterInfo::MockClusterInfo()
   ON_CALL(*this, lbOriginalDstConfig()).WillByDefault(ReturnRef(lb_original_dst_config_));
   ON_CALL(*this, lbConfig()).WillByDefault(ReturnRef(lb_config_));
   ON_CALL(*this, clusterSocketOptions()).WillByDefault(ReturnRef(cluster_socket_options_));
+  ON_CALL(*this, responseCounters(_))
+      .WillByDefault(Invoke([this](const Http::CodeStats& code_stats)
+                                -> const Http::CodeStats::ResponseCounters& {
+        if (response_counters_ == nullptr) {
+          response_counters_ = code_stats.createResponseCounters(stats_store_, EMPTY_STRING);
+        }
+        return *response_counters_;
+      }));
 }
 
 MockClusterInfo::~MockClusterInfo() {}
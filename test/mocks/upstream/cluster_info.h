@@ -82,6 +82,8 @@ public:
   MOCK_CONST_METHOD0(typedMetadata, const Envoy::Config::TypedMetadata&());
   MOCK_CONST_METHOD0(clusterSocketOptions, const Network::ConnectionSocket::OptionsSharedPtr&());
   MOCK_CONST_METHOD0(drainConnectionsOnHostRemoval, bool());
+  MOCK_CONST_METHOD1(responseCounters,
+                     const Http::CodeStats::ResponseCounters&(const Http::CodeStats& code_stats));
 
   std::string name_{"fake_cluster"};
   Http::Http2Settings http2_settings_{};
@@ -103,6 +105,7 @@ public:
   absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig> lb_original_dst_config_;
   Network::ConnectionSocket::OptionsSharedPtr cluster_socket_options_;
   envoy::api::v2::Cluster::CommonLbConfig lb_config_;
+  Http::CodeStats::ResponseCountersPtr response_counters_;
 };
 
 class MockIdleTimeEnabledClusterInfo : public MockClusterInfo {
@@ -72,6 +72,17 @@ TEST_F(ConfigurationImplTest, DefaultStatsFlushInterval) {
   config.initialize(bootstrap, server_, cluster_manager_factory_);
 
   EXPECT_EQ(std::chrono::milliseconds(5000), config.statsFlushInterval());
+  EXPECT_EQ(std::chrono::milliseconds(0), config.statsFullFlushInterval());
+}
+
+TEST_F(ConfigurationImplTest, CustomStatsFullFlushInterval) {
+  envoy::config::bootstrap::v2::Bootstrap bootstrap;
+  bootstrap.mutable_stats_full_flush_interval()->set_seconds(60);
+
+  MainImpl config;
+  config.initialize(bootstrap, server_, cluster_manager_factory_);
+
+  EXPECT_EQ(std::chrono::milliseconds(60000), config.statsFullFlushInterval());
 }
 
 TEST_F(ConfigurationImplTest, CustomStatsFlushInterval) {
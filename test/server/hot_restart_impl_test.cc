@@ -1,7 +1,10 @@
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include <memory>
 
 #include "common/api/os_sys_calls_impl.h"
-#include "common/common/hex.h"
 
 #include "server/hot_restart_impl.h"
 
@@ -9,16 +12,21 @@
 #include "test/mocks/server/mocks.h"
 #include "test/test_common/logging.h"
 #include "test/test_common/threadsafe_singleton_injector.h"
+#include "test/test_common/utility.h"
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "gtest/gtest.h"
 
 using testing::_;
+using testing::DoAll;
 using testing::Invoke;
 using testing::InvokeWithoutArgs;
+using testing::NiceMock;
 using testing::Return;
 using testing::ReturnRef;
+using testing::SaveArg;
 using testing::WithArg;
 
 namespace Envoy {
@@ -64,6 +72,7 @@ TEST_F(HotRestartImplTest, versionString) {
     setup();
     version = hot_restart_->version();
     EXPECT_TRUE(absl::StartsWith(version, fmt::format("{}.", SharedMemory::VERSION))) << version;
+    EXPECT_EQ(version, HotRestartImpl::hotRestartVersion());
     max_stats = options_.maxStats(); // Save this so we can double it below.
     max_obj_name_length = options_.statsOptions().maxObjNameLength();
     TearDown();
@@ -75,177 +84,156 @@ TEST_F(HotRestartImplTest, versionString) {
     TearDown();
   }
 
+  // Stats are no longer kept in shared memory, so their limits no longer matter to hot restart.
   {
     ON_CALL(options_, maxStats()).WillByDefault(Return(2 * max_stats));
     setup();
-    EXPECT_NE(version, hot_restart_->version()) << "Version changes when max-stats change";
+    EXPECT_EQ(version, hot_restart_->version()) << "Version ignores max-stats";
     TearDown();
   }
 
   {
     stats_options_.max_obj_name_length_ = 2 * max_obj_name_length;
     setup();
-    EXPECT_NE(version, hot_restart_->version())
-        << "Version changes when max-obj-name-length changes";
+    EXPECT_EQ(version, hot_restart_->version()) << "Version ignores max-obj-name-length";
     // TearDown is called automatically at end of test.
   }
 }
 
-// Check consistency of internal raw stat representation by comparing hash of
-// memory contents against a previously recorded value.
-TEST_F(HotRestartImplTest, Consistency) {
-  setup();
-
-  // Generate a stat, encode it to hex, and take the hash of that hex string. We
-  // expect the hash to vary only when the internal representation of a stat has
-  // been intentionally changed, in which case SharedMemory::VERSION should be
-  // incremented as well.
-  const uint64_t expected_hash = 1874506077228772558;
-  const uint64_t max_name_length = stats_options_.maxNameLength();
-
-  const std::string name_1(max_name_length, 'A');
-  Stats::RawStatData* stat_1 = hot_restart_->statsAllocator().alloc(name_1);
-  const uint64_t stat_size = sizeof(Stats::RawStatData) + max_name_length;
-  const std::string stat_hex_dump_1 = Hex::encode(reinterpret_cast<uint8_t*>(stat_1), stat_size);
-  EXPECT_EQ(HashUtil::xxHash64(stat_hex_dump_1), expected_hash);
-  EXPECT_EQ(name_1, stat_1->key());
-  hot_restart_->statsAllocator().free(*stat_1);
-}
-
-TEST_F(HotRestartImplTest, crossAlloc) {
-  setup();
-
-  Stats::RawStatData* stat1 = hot_restart_->statsAllocator().alloc("stat1");
-  Stats::RawStatData* stat2 = hot_restart_->statsAllocator().alloc("stat2");
-  Stats::RawStatData* stat3 = hot_restart_->statsAllocator().alloc("stat3");
-  Stats::RawStatData* stat4 = hot_restart_->statsAllocator().alloc("stat4");
-  Stats::RawStatData* stat5 = hot_restart_->statsAllocator().alloc("stat5");
-  hot_restart_->statsAllocator().free(*stat2);
-  hot_restart_->statsAllocator().free(*stat4);
-  stat2 = nullptr;
-  stat4 = nullptr;
-
-  EXPECT_CALL(options_, restartEpoch()).WillRepeatedly(Return(1));
-  EXPECT_CALL(os_sys_calls_, shmOpen(_, _, _));
-  EXPECT_CALL(os_sys_calls_, mmap(_, _, _, _, _, _))
-      .WillOnce(Return(Api::SysCallPtrResult{buffer_.data(), 0}));
-  EXPECT_CALL(os_sys_calls_, bind(_, _, _));
-  HotRestartImpl hot_restart2(options_);
-  Stats::RawStatData* stat1_prime = hot_restart2.statsAllocator().alloc("stat1");
-  Stats::RawStatData* stat3_prime = hot_restart2.statsAllocator().alloc("stat3");
-  Stats::RawStatData* stat5_prime = hot_restart2.statsAllocator().alloc("stat5");
-  EXPECT_EQ(stat1, stat1_prime);
-  EXPECT_EQ(stat3, stat3_prime);
-  EXPECT_EQ(stat5, stat5_prime);
-}
-
-TEST_F(HotRestartImplTest, allocFail) {
+// Stats are allocated from the heap, so neither their number nor the length of their names is
+// bounded by the options.
+TEST_F(HotRestartImplTest, HeapStats) {
   EXPECT_CALL(options_, maxStats()).WillRepeatedly(Return(2));
   setup();
 
-  Stats::RawStatData* s1 = hot_restart_->statsAllocator().alloc("1");
-  Stats::RawStatData* s2 = hot_restart_->statsAllocator().alloc("2");
-  Stats::RawStatData* s3 = hot_restart_->statsAllocator().alloc("3");
-  EXPECT_NE(s1, nullptr);
-  EXPECT_NE(s2, nullptr);
-  EXPECT_EQ(s3, nullptr);
+  EXPECT_FALSE(hot_restart_->statsAllocator().requiresBoundedStatNameSize());
+  const std::string long_name(4 * stats_options_.maxNameLength(), 'A');
+  std::vector<Stats::CounterSharedPtr> counters;
+  for (uint64_t i = 0; i < 3; i++) {
+    counters.push_back(
+        hot_restart_->statsAllocator().makeCounter(absl::StrCat(long_name, i), "", {}));
+    EXPECT_EQ(absl::StrCat(long_name, i), counters.back()->name());
+  }
 }
 
-// Because the shared memory is managed manually, make sure it meets
-// basic requirements:
-//   - Objects are correctly aligned so that std::atomic works properly
-//   - Objects don't overlap
-class HotRestartImplAlignmentTest : public HotRestartImplTest,
-                                    public testing::WithParamInterface<uint64_t> {
+// Stats values sent by a parent are merged into the stats of its child.
+class HotRestartImplStatsTest : public HotRestartImplTest {
 public:
-  HotRestartImplAlignmentTest() : name_len_(8 + GetParam()) {
-    stats_options_.max_obj_name_length_ = name_len_;
-    EXPECT_CALL(options_, statsOptions()).WillRepeatedly(ReturnRef(stats_options_));
-    EXPECT_CALL(options_, maxStats()).WillRepeatedly(Return(num_stats_));
-
+  void setupParentAndChild() {
+    // The parent and the child talk over real domain sockets, named after a base id of their own
+    // so that concurrent tests do not collide.
+    ON_CALL(os_sys_calls_, bind(_, _, _))
+        .WillByDefault(Invoke([](int fd, const sockaddr* address, socklen_t length) {
+          const int rc = ::bind(fd, address, length);
+          return Api::SysCallIntResult{rc, rc == -1 ? errno : 0};
+        }));
+    const uint64_t base_id = 10 * getpid();
+    ON_CALL(options_, baseId()).WillByDefault(Return(base_id));
     setup();
-    EXPECT_EQ(name_len_ + stats_options_.maxStatSuffixLength(), stats_options_.maxNameLength());
+    EXPECT_CALL(parent_dispatcher_, createFileEvent_(_, _, _, _))
+        .WillOnce(DoAll(SaveArg<0>(&parent_fd_), SaveArg<1>(&parent_socket_cb_),
+                        Return(new NiceMock<Event::MockFileEvent>())));
+    hot_restart_->initialize(parent_dispatcher_, parent_server_);
+
+    ON_CALL(child_options_, baseId()).WillByDefault(Return(base_id));
+    ON_CALL(child_options_, restartEpoch()).WillByDefault(Return(1));
+    EXPECT_CALL(child_options_, statsOptions()).WillRepeatedly(ReturnRef(stats_options_));
+    EXPECT_CALL(os_sys_calls_, shmOpen(_, _, _));
+    EXPECT_CALL(os_sys_calls_, mmap(_, _, _, _, _, _))
+        .WillOnce(Return(Api::SysCallPtrResult{buffer_.data(), 0}));
+    EXPECT_CALL(os_sys_calls_, bind(_, _, _));
+    child_ = std::make_unique<HotRestartImpl>(child_options_);
+    child_->initialize(child_dispatcher_, child_server_);
   }
 
-  Stats::StatsOptionsImpl stats_options_;
-  static const uint64_t num_stats_ = 8;
-  const uint64_t name_len_;
-};
-
-TEST_P(HotRestartImplAlignmentTest, objectAlignment) {
-
-  std::set<Stats::RawStatData*> used;
-  for (uint64_t i = 0; i < num_stats_; i++) {
-    Stats::RawStatData* stat = hot_restart_->statsAllocator().alloc(fmt::format("stat {}", i));
-    EXPECT_TRUE((reinterpret_cast<uintptr_t>(stat) % alignof(decltype(*stat))) == 0);
-    EXPECT_TRUE(used.find(stat) == used.end());
-    used.insert(stat);
+  // The child blocks until it has received all the stats values, so it fetches them on a thread
+  // of its own while the parent answers its request.
+  void fetchParentStats() {
+    HotRestart::GetParentStatsInfo info;
+    Thread::ThreadPtr child_thread = Thread::threadFactoryForTest().createThread(
+        [this, &info]() { child_->getParentStats(info); });
+    pollfd parent_socket{parent_fd_, POLLIN, 0};
+    ASSERT_EQ(1, poll(&parent_socket, 1, -1));
+    parent_socket_cb_(Event::FileReadyType::Read);
+    child_thread->join();
   }
-}
 
-TEST_P(HotRestartImplAlignmentTest, objectOverlap) {
-  // Iterate through all stats forwards and backwards, writing to all fields, then read them back to
-  // make sure that writing to an adjacent stat didn't overwrite
-  struct TestStat {
-    Stats::RawStatData* stat_;
-    std::string name_;
-    uint64_t index_;
-  };
-  std::vector<TestStat> stats;
-  for (uint64_t i = 0; i < num_stats_; i++) {
-    std::string name = fmt::format("{}zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz"
-                                   "zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz"
-                                   "zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz",
-                                   i)
-                           .substr(0, stats_options_.maxNameLength());
-    TestStat ts;
-    ts.stat_ = hot_restart_->statsAllocator().alloc(name);
-    ts.name_ = ts.stat_->name_;
-    ts.index_ = i;
-
-    // If this isn't true then the hard coded part of the name isn't long enough to make the test
-    // valid.
-    EXPECT_EQ(ts.name_.size(), stats_options_.maxNameLength());
-
-    stats.push_back(ts);
+  bool childHasCounter(const std::string& name) {
+    for (const Stats::CounterSharedPtr& counter : child_server_.stats_store_.counters()) {
+      if (counter->name() == name) {
+        return true;
+      }
+    }
+    return false;
   }
 
-  auto write = [](TestStat& ts) {
-    ts.stat_->value_ = ts.index_;
-    ts.stat_->pending_increment_ = ts.index_;
-    ts.stat_->flags_ = ts.index_;
-    ts.stat_->ref_count_ = ts.index_;
-    ts.stat_->unused_ = ts.index_;
-  };
-
-  auto verify = [](TestStat& ts) {
-    EXPECT_EQ(ts.stat_->key(), ts.name_);
-    EXPECT_EQ(ts.stat_->value_, ts.index_);
-    EXPECT_EQ(ts.stat_->pending_increment_, ts.index_);
-    EXPECT_EQ(ts.stat_->flags_, ts.index_);
-    EXPECT_EQ(ts.stat_->ref_count_, ts.index_);
-    EXPECT_EQ(ts.stat_->unused_, ts.index_);
-  };
-
-  for (TestStat& ts : stats) {
-    write(ts);
+  bool childHasGauge(const std::string& name) {
+    for (const Stats::GaugeSharedPtr& gauge : child_server_.stats_store_.gauges()) {
+      if (gauge->name() == name) {
+        return true;
+      }
+    }
+    return false;
   }
 
-  for (TestStat& ts : stats) {
-    verify(ts);
-  }
+  NiceMock<Event::MockDispatcher> parent_dispatcher_;
+  NiceMock<MockInstance> parent_server_;
+  int parent_fd_{-1};
+  Event::FileReadyCb parent_socket_cb_;
+  NiceMock<MockOptions> child_options_;
+  NiceMock<Event::MockDispatcher> child_dispatcher_;
+  NiceMock<MockInstance> child_server_;
+  std::unique_ptr<HotRestartImpl> child_;
+};
 
-  for (auto it = stats.rbegin(); it != stats.rend(); ++it) {
-    write(*it);
+// The parent sends the increments of its counters since it last sent them, and the used gauges
+// that it never set().
+TEST_F(HotRestartImplStatsTest, CounterDeltasAndUsedGauges) {
+  setupParentAndChild();
+  Stats::Store& parent_stats = parent_server_.stats_store_;
+  Stats::Store& child_stats = child_server_.stats_store_;
+  parent_stats.counter("requests").add(5);
+  parent_stats.counter("unused_counter");
+  parent_stats.gauge("connections").add(3);
+  parent_stats.gauge("unused_gauge");
+  parent_stats.gauge("uptime").set(100);
+
+  fetchParentStats();
+  EXPECT_EQ(5U, child_stats.counter("requests").value());
+  EXPECT_EQ(3U, child_stats.gauge("connections").value());
+  EXPECT_FALSE(childHasCounter("unused_counter"));
+  EXPECT_FALSE(childHasGauge("unused_gauge"));
+  EXPECT_FALSE(childHasGauge("uptime"));
+
+  // Only the increments made since the previous fetch are sent again.
+  parent_stats.counter("requests").add(2);
+  parent_stats.gauge("connections").inc();
+  fetchParentStats();
+  EXPECT_EQ(7U, child_stats.counter("requests").value());
+  EXPECT_EQ(4U, child_stats.gauge("connections").value());
+
+  // Nothing changed, so nothing is added.
+  fetchParentStats();
+  EXPECT_EQ(7U, child_stats.counter("requests").value());
+  EXPECT_EQ(4U, child_stats.gauge("connections").value());
+}
+
+// Stats values that do not fit in a single RPC message are split across several of them.
+TEST_F(HotRestartImplStatsTest, ValuesSplitAcrossMessages) {
+  setupParentAndChild();
+  // Together, the values take a few times the 64KiB of the largest RPC message.
+  const std::string long_name(1000, 'c');
+  for (uint64_t i = 0; i < 200; i++) {
+    parent_server_.stats_store_.counter(absl::StrCat(long_name, i)).add(i + 1);
+    parent_server_.stats_store_.gauge(absl::StrCat("g", long_name, i)).add(i);
   }
 
-  for (auto it = stats.rbegin(); it != stats.rend(); ++it) {
-    verify(*it);
+  fetchParentStats();
+  for (uint64_t i = 0; i < 200; i++) {
+    EXPECT_EQ(i + 1, child_server_.stats_store_.counter(absl::StrCat(long_name, i)).value());
+    EXPECT_EQ(i, child_server_.stats_store_.gauge(absl::StrCat("g", long_name, i)).value());
   }
 }
 
-INSTANTIATE_TEST_CASE_P(HotRestartImplAlignmentTest, HotRestartImplAlignmentTest,
-                        testing::Range(0UL, alignof(Stats::RawStatData) + 1));
-
 } // namespace Server
 } // namespace Envoy
@@ -19,6 +19,7 @@
 
 #include "server/http/admin.h"
 
+#include "test/mocks/buffer/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/mocks.h"
 #include "test/test_common/environment.h"
@@ -49,7 +50,7 @@ namespace Server {
 
 class AdminStatsTest : public testing::TestWithParam<Network::Address::IpVersion> {
 public:
-  AdminStatsTest() : alloc_(options_) {
+  AdminStatsTest() {
     store_ = std::make_unique<Stats::ThreadLocalStoreImpl>(options_, alloc_);
     store_->addSink(sink_);
   }
@@ -57,8 +58,12 @@ public:
   static std::string
   statsAsJsonHandler(std::map<std::string, uint64_t>& all_stats,
                      const std::vector<Stats::ParentHistogramSharedPtr>& all_histograms,
-                     const bool used_only, const absl::optional<std::regex> regex = absl::nullopt) {
-    return AdminImpl::statsAsJson(all_stats, all_histograms, used_only, regex,
+                     const bool used_only, const std::string& filter = "") {
+    const std::unique_ptr<Regex::CompiledGoogleReMatcher> matcher =
+        filter.empty() ? nullptr
+                       : std::make_unique<Regex::CompiledGoogleReMatcher>(
+                             filter, Regex::Utility::DefaultMaxProgramSize);
+    return AdminImpl::statsAsJson(all_stats, all_histograms, used_only, matcher.get(),
                                   true /*pretty_print*/);
   }
 
@@ -366,8 +371,8 @@ TEST_P(AdminStatsTest, StatsAsJsonFilterString) {
 
   std::map<std::string, uint64_t> all_stats;
 
-  std::string actual_json = statsAsJsonHandler(all_stats, store_->histograms(), false,
-                                               absl::optional<std::regex>{std::regex("[a-z]1")});
+  std::string actual_json =
+      statsAsJsonHandler(all_stats, store_->histograms(), false, "[a-z]1");
 
   // Because this is a filter case, we don't expect to see any stats except for those containing
   // "h1" in their name.
@@ -475,8 +480,8 @@ TEST_P(AdminStatsTest, UsedOnlyStatsAsJsonFilterString) {
 
   std::map<std::string, uint64_t> all_stats;
 
-  std::string actual_json = statsAsJsonHandler(all_stats, store_->histograms(), true,
-                                               absl::optional<std::regex>{std::regex("h[12]")});
+  std::string actual_json =
+      statsAsJsonHandler(all_stats, store_->histograms(), true, "h[12]");
 
   // Expected JSON should not have h2 values as it is not used, and should not have h3 values as
   // they are used but do not match.
@@ -1175,6 +1180,52 @@ TEST_P(AdminInstanceTest, GetRequestJson) {
               HasSubstr("application/json"));
 }
 
+TEST_P(AdminInstanceTest, GetRequestStatsText) {
+  server_.stats_store_.counter("b.counter").inc();
+  server_.stats_store_.counter("d.counter");
+  server_.stats_store_.gauge("a.gauge").set(3);
+  server_.stats_store_.gauge("c.gauge").set(4);
+
+  Http::HeaderMapImpl response_headers;
+  std::string body;
+  EXPECT_EQ(Http::Code::OK,
+            admin_.request("/stats?filter=^[a-c][.]", "GET", response_headers, body));
+  EXPECT_EQ("a.gauge: 3\nb.counter: 1\nc.gauge: 4\n", body);
+
+  body.clear();
+  EXPECT_EQ(Http::Code::OK,
+            admin_.request("/stats?usedonly&filter=counter", "GET", response_headers, body));
+  EXPECT_EQ("b.counter: 1\n", body);
+}
+
+TEST_P(AdminInstanceTest, GetRequestStatsInvalidFilter) {
+  Http::HeaderMapImpl response_headers;
+  std::string body;
+  EXPECT_EQ(Http::Code::BadRequest,
+            admin_.request("/stats?filter=(", "GET", response_headers, body));
+  EXPECT_THAT(body, HasSubstr("Invalid regex '('"));
+
+  body.clear();
+  EXPECT_EQ(Http::Code::BadRequest,
+            admin_.request("/stats/prometheus?filter=(", "GET", response_headers, body));
+  EXPECT_THAT(body, HasSubstr("Invalid regex '('"));
+}
+
+TEST_P(AdminInstanceTest, GetRequestStatsPrometheusFilter) {
+  server_.stats_store_.counter("cluster.foo.upstream_cx_total").inc();
+  server_.stats_store_.counter("cluster.bar.upstream_cx_total");
+  server_.stats_store_.gauge("cluster.foo.membership_total").set(2);
+
+  Http::HeaderMapImpl response_headers;
+  std::string body;
+  EXPECT_EQ(Http::Code::OK,
+            admin_.request("/stats?format=prometheus&usedonly&filter=foo[.]upstream", "GET",
+                           response_headers, body));
+  EXPECT_EQ("# TYPE envoy_cluster_foo_upstream_cx_total counter\n"
+            "envoy_cluster_foo_upstream_cx_total{} 1\n",
+            body);
+}
+
 TEST_P(AdminInstanceTest, PostRequest) {
   Http::HeaderMapImpl response_headers;
   std::string body;
@@ -1185,6 +1236,104 @@ TEST_P(AdminInstanceTest, PostRequest) {
               HasSubstr("text/plain"));
 }
 
+// Verifies that the stats are streamed a chunk at a time, and that streaming pauses while the
+// downstream connection is above its high watermark.
+TEST(StatsStreamerTest, StreamsChunks) {
+  Stats::IsolatedStoreImpl store;
+  store.counter("c1").inc();
+  store.counter("c3").inc();
+  store.gauge("g2").set(2);
+  store.gauge("g4").set(4);
+
+  NiceMock<Configuration::MockAdminStream> admin_stream;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> callbacks;
+  ON_CALL(admin_stream, canStream()).WillByDefault(Return(true));
+  ON_CALL(admin_stream, getDecoderFilterCallbacks()).WillByDefault(ReturnRef(callbacks));
+  std::function<void()> on_destroy;
+  EXPECT_CALL(admin_stream, addOnDestroyCallback(_))
+      .WillOnce(Invoke([&on_destroy](std::function<void()> cb) { on_destroy = cb; }));
+  std::list<std::function<void()>> posted;
+  ON_CALL(callbacks.dispatcher_, post(_))
+      .WillByDefault(Invoke([&posted](std::function<void()> cb) { posted.push_back(cb); }));
+  const auto run_posted = [&posted]() {
+    std::list<std::function<void()>> to_run;
+    to_run.swap(posted);
+    for (const auto& cb : to_run) {
+      cb();
+    }
+  };
+
+  EXPECT_CALL(admin_stream, setEndStreamOnComplete(false));
+  EXPECT_CALL(callbacks, addDownstreamWatermarkCallbacks(_));
+  Buffer::OwnedImpl response;
+  auto streamer = std::make_shared<StatsStreamer>(
+      store, StatsStreamer::Format::Text, true,
+      std::make_unique<Regex::CompiledGoogleReMatcher>("[1-3]", 1000), nullptr, 2);
+  streamer->start(response, admin_stream);
+  EXPECT_EQ("c1: 1\nc3: 1\n", response.toString());
+  EXPECT_EQ(1UL, posted.size());
+
+  // Nothing is rendered while the downstream connection is backed up.
+  streamer->onAboveWriteBufferHighWatermark();
+  EXPECT_CALL(callbacks, encodeData(_, _)).Times(0);
+  run_posted();
+  EXPECT_TRUE(posted.empty());
+
+  streamer->onBelowWriteBufferLowWatermark();
+  EXPECT_EQ(1UL, posted.size());
+  EXPECT_CALL(callbacks, encodeData(BufferStringEqual("g2: 2\n"), true));
+  run_posted();
+  EXPECT_TRUE(posted.empty());
+
+  EXPECT_CALL(callbacks, removeDownstreamWatermarkCallbacks(_));
+  on_destroy();
+}
+
+TEST(StatsStreamerTest, StopsStreamingOnDestroy) {
+  Stats::IsolatedStoreImpl store;
+  store.counter("c1");
+  store.counter("c2");
+
+  NiceMock<Configuration::MockAdminStream> admin_stream;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> callbacks;
+  ON_CALL(admin_stream, canStream()).WillByDefault(Return(true));
+  ON_CALL(admin_stream, getDecoderFilterCallbacks()).WillByDefault(ReturnRef(callbacks));
+  std::function<void()> on_destroy;
+  ON_CALL(admin_stream, addOnDestroyCallback(_))
+      .WillByDefault(Invoke([&on_destroy](std::function<void()> cb) { on_destroy = cb; }));
+  std::function<void()> posted;
+  ON_CALL(callbacks.dispatcher_, post(_))
+      .WillByDefault(Invoke([&posted](std::function<void()> cb) { posted = cb; }));
+
+  Buffer::OwnedImpl response;
+  std::make_shared<StatsStreamer>(store, StatsStreamer::Format::Text, false, nullptr, nullptr, 1)
+      ->start(response, admin_stream);
+  EXPECT_EQ("c1: 0\n", response.toString());
+
+  on_destroy();
+  EXPECT_CALL(callbacks, encodeData(_, _)).Times(0);
+  posted();
+}
+
+TEST(StatsStreamerTest, RendersEverythingWithoutStreaming) {
+  Stats::IsolatedStoreImpl store;
+  store.counter("cluster.foo.c").inc();
+  store.gauge("cluster.foo.g").set(1);
+
+  NiceMock<Configuration::MockAdminStream> admin_stream;
+  EXPECT_CALL(admin_stream, canStream()).WillOnce(Return(false));
+  EXPECT_CALL(admin_stream, setEndStreamOnComplete(_)).Times(0);
+  Buffer::OwnedImpl response;
+  std::make_shared<StatsStreamer>(store, StatsStreamer::Format::Prometheus, false, nullptr,
+                                  std::make_shared<PrometheusNameCache>(), 1)
+      ->start(response, admin_stream);
+  EXPECT_EQ("# TYPE envoy_cluster_foo_c counter\n"
+            "envoy_cluster_foo_c{} 1\n"
+            "# TYPE envoy_cluster_foo_g gauge\n"
+            "envoy_cluster_foo_g{} 1\n",
+            response.toString());
+}
+
 class PrometheusStatsFormatterTest : public testing::Test {
 protected:
   PrometheusStatsFormatterTest() /*: alloc_(stats_options_)*/ {}
@@ -1202,6 +1351,7 @@ protected:
   Stats::HeapStatDataAllocator alloc_;
   std::vector<Stats::CounterSharedPtr> counters_;
   std::vector<Stats::GaugeSharedPtr> gauges_;
+  std::vector<Stats::ParentHistogramSharedPtr> histograms_;
 };
 
 TEST_F(PrometheusStatsFormatterTest, MetricName) {
@@ -1251,7 +1401,8 @@ TEST_F(PrometheusStatsFormatterTest, MetricNameCollison) {
            {{"another_tag_name_4", "another_tag_4-value"}});
 
   Buffer::OwnedImpl response;
-  EXPECT_EQ(2UL, PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, response));
+  EXPECT_EQ(2UL,
+            PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, histograms_, response));
 }
 
 TEST_F(PrometheusStatsFormatterTest, UniqueMetricName) {
@@ -1269,7 +1420,79 @@ TEST_F(PrometheusStatsFormatterTest, UniqueMetricName) {
            {{"another_tag_name_4", "another_tag_4-value"}});
 
   Buffer::OwnedImpl response;
-  EXPECT_EQ(4UL, PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, response));
+  EXPECT_EQ(4UL,
+            PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, histograms_, response));
+}
+
+TEST_F(PrometheusStatsFormatterTest, HistogramWithBuckets) {
+  const std::vector<double> buckets{10, 100, 1000};
+  histogram_t* hist = hist_alloc();
+  for (uint64_t value : {5, 50, 50, 500, 5000}) {
+    hist_insert_intscale(hist, value, 0, 1);
+  }
+  Stats::HistogramStatisticsImpl statistics(hist, buckets);
+  hist_free(hist);
+
+  auto histogram = std::make_shared<NiceMock<Stats::MockParentHistogram>>();
+  histogram->name_ = "cluster.test_cluster_1.upstream_rq_time";
+  histogram->used_ = true;
+  ON_CALL(*histogram, tagExtractedName()).WillByDefault(Return("cluster.upstream_rq_time"));
+  ON_CALL(*histogram, tags())
+      .WillByDefault(Return(std::vector<Stats::Tag>{{"envoy.cluster_name", "test_cluster_1"}}));
+  ON_CALL(*histogram, cumulativeStatistics()).WillByDefault(ReturnRef(statistics));
+  histograms_.push_back(histogram);
+
+  // Histograms that were never merged are not output.
+  auto unused_histogram = std::make_shared<NiceMock<Stats::MockParentHistogram>>();
+  unused_histogram->used_ = false;
+  histograms_.push_back(unused_histogram);
+
+  Buffer::OwnedImpl response;
+  EXPECT_EQ(1UL,
+            PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, histograms_, response));
+  const std::string output = response.toString();
+  EXPECT_THAT(output, HasSubstr("# TYPE envoy_cluster_upstream_rq_time histogram\n"));
+  EXPECT_THAT(output, HasSubstr("envoy_cluster_upstream_rq_time_bucket{envoy_cluster_name=\""
+                                "test_cluster_1\",le=\"10\"} 1\n"));
+  EXPECT_THAT(output, HasSubstr("envoy_cluster_upstream_rq_time_bucket{envoy_cluster_name=\""
+                                "test_cluster_1\",le=\"100\"} 3\n"));
+  EXPECT_THAT(output, HasSubstr("envoy_cluster_upstream_rq_time_bucket{envoy_cluster_name=\""
+                                "test_cluster_1\",le=\"1000\"} 4\n"));
+  EXPECT_THAT(output, HasSubstr("envoy_cluster_upstream_rq_time_bucket{envoy_cluster_name=\""
+                                "test_cluster_1\",le=\"+Inf\"} 5\n"));
+  EXPECT_THAT(output, HasSubstr("envoy_cluster_upstream_rq_time_sum{envoy_cluster_name=\""
+                                "test_cluster_1\"} "));
+  EXPECT_THAT(output, HasSubstr("envoy_cluster_upstream_rq_time_count{envoy_cluster_name=\""
+                                "test_cluster_1\"} 5\n"));
+}
+
+TEST_F(PrometheusStatsFormatterTest, NameCache) {
+  addCounter("cluster.test_cluster_1.upstream_cx_total", {{"a.tag-name", "a.tag-value"}});
+  addGauge("cluster.test_cluster_2.upstream_cx_active", {});
+
+  PrometheusNameCache name_cache;
+  const PrometheusNameCache::Entry& counter_names = name_cache.get(counters_[0]);
+  EXPECT_EQ("envoy_cluster_test_cluster_1_upstream_cx_total", counter_names.metric_name_);
+  EXPECT_EQ("a_tag_name=\"a.tag-value\"", counter_names.tags_);
+  EXPECT_EQ("envoy_cluster_test_cluster_1_upstream_cx_total{a_tag_name=\"a.tag-value\"}",
+            counter_names.series_);
+  EXPECT_EQ("envoy_cluster_test_cluster_2_upstream_cx_active{}",
+            name_cache.get(gauges_[0]).series_);
+  EXPECT_EQ(2UL, name_cache.size());
+
+  // Scrapes reuse the cached names, and produce the same output as without a cache.
+  Buffer::OwnedImpl cached_response;
+  PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, histograms_, name_cache,
+                                              cached_response);
+  EXPECT_EQ(2UL, name_cache.size());
+  Buffer::OwnedImpl response;
+  PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, histograms_, response);
+  EXPECT_EQ(response.toString(), cached_response.toString());
+
+  // The entries of freed stats are dropped.
+  gauges_.clear();
+  name_cache.removeExpired();
+  EXPECT_EQ(1UL, name_cache.size());
 }
 
 } // namespace Server
@@ -348,13 +348,12 @@ bool TestHeaderMapImpl::has(const LowerCaseString& key) { return get(key) != nul
 
 namespace Stats {
 
-MockedTestAllocator::MockedTestAllocator(const StatsOptions& stats_options)
-    : TestAllocator(stats_options) {
-  ON_CALL(*this, alloc(_)).WillByDefault(Invoke([this](absl::string_view name) -> RawStatData* {
+MockedTestAllocator::MockedTestAllocator() {
+  ON_CALL(*this, alloc(_)).WillByDefault(Invoke([this](absl::string_view name) -> HeapStatData* {
     return TestAllocator::alloc(name);
   }));
 
-  ON_CALL(*this, free(_)).WillByDefault(Invoke([this](RawStatData& data) -> void {
+  ON_CALL(*this, free(_)).WillByDefault(Invoke([this](HeapStatData& data) -> void {
     return TestAllocator::free(data);
   }));
 
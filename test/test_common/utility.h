@@ -16,12 +16,11 @@
 #include "envoy/thread/thread.h"
 
 #include "common/buffer/buffer_impl.h"
-#include "common/common/block_memory_hash_set.h"
 #include "common/common/c_smart_ptr.h"
 #include "common/common/thread.h"
 #include "common/http/header_map_impl.h"
 #include "common/protobuf/utility.h"
-#include "common/stats/raw_stat_data.h"
+#include "common/stats/heap_stat_data.h"
 
 #include "test/test_common/printers.h"
 
@@ -432,40 +431,22 @@ makeHeaderMap(const std::initializer_list<std::pair<std::string, std::string>>&
 namespace Stats {
 
 /**
- * Implements a RawStatDataAllocator using a contiguous block of heap-allocated
- * memory, but is otherwise identical to the shared memory allocator in terms of
- * reference counting, data structures, etc.
+ * Implements a HeapStatDataAllocator that requires bounded stat names, so that the truncation of
+ * long stat names by the stores can be tested.
  */
-class TestAllocator : public RawStatDataAllocator {
+class TestAllocator : public HeapStatDataAllocator {
 public:
-  struct TestBlockMemoryHashSetOptions : public BlockMemoryHashSetOptions {
-    TestBlockMemoryHashSetOptions() {
-      capacity = 200;
-      num_slots = 131;
-    }
-  };
-
-  explicit TestAllocator(const StatsOptions& stats_options)
-      : RawStatDataAllocator(mutex_, hash_set_, stats_options),
-        block_memory_(std::make_unique<uint8_t[]>(
-            RawStatDataSet::numBytes(block_hash_options_, stats_options))),
-        hash_set_(block_hash_options_, true /* init */, block_memory_.get(), stats_options) {}
-  ~TestAllocator() { EXPECT_EQ(0, hash_set_.size()); }
-
-private:
-  Thread::MutexBasicLockable mutex_;
-  TestBlockMemoryHashSetOptions block_hash_options_;
-  std::unique_ptr<uint8_t[]> block_memory_;
-  RawStatDataSet hash_set_;
+  // StatDataAllocator
+  bool requiresBoundedStatNameSize() const override { return true; }
 };
 
 class MockedTestAllocator : public TestAllocator {
 public:
-  MockedTestAllocator(const StatsOptions& stats_options);
+  MockedTestAllocator();
   virtual ~MockedTestAllocator();
 
-  MOCK_METHOD1(alloc, RawStatData*(absl::string_view name));
-  MOCK_METHOD1(free, void(RawStatData& data));
+  MOCK_METHOD1(alloc, HeapStatData*(absl::string_view name));
+  MOCK_METHOD1(free, void(HeapStatData& data));
 };
 
 } // namespace Stats
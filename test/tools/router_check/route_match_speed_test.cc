@@ -0,0 +1,108 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+
+#include "envoy/api/v2/rds.pb.h"
+
+#include "test/test_common/utility.h"
+#include "test/tools/router_check/router.h"
+
+#include "fmt/format.h"
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace {
+
+enum class MatchType { Prefix, Path };
+
+// Generates a single virtual host with one route per service, as produced by a route table
+// generator.
+envoy::api::v2::RouteConfiguration routeConfig(int64_t num_routes, MatchType match_type) {
+  envoy::api::v2::RouteConfiguration route_config;
+  auto* virtual_host = route_config.add_virtual_hosts();
+  virtual_host->set_name("default");
+  virtual_host->add_domains("*");
+  for (int64_t i = 0; i < num_routes; i++) {
+    auto* route = virtual_host->add_routes();
+    if (match_type == MatchType::Prefix) {
+      route->mutable_match()->set_prefix(fmt::format("/service_{}/", i));
+    } else {
+      route->mutable_match()->set_path(fmt::format("/service_{}/endpoint", i));
+    }
+    route->mutable_route()->set_cluster(fmt::format("cluster_{}", i));
+  }
+  return route_config;
+}
+
+void matchRoute(benchmark::State& state, MatchType match_type, const std::string& path) {
+  RouterCheckTool tool = RouterCheckTool::create(routeConfig(state.range(0), match_type));
+  Http::TestHeaderMapImpl headers{
+      {":authority", "www.lyft.com"}, {":path", path}, {":method", "GET"}};
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tool.config().route(headers, 0));
+  }
+}
+
+// Generates one virtual host per tenant, each matching its own wildcard subdomain.
+envoy::api::v2::RouteConfiguration wildcardDomainConfig(int64_t num_tenants) {
+  envoy::api::v2::RouteConfiguration route_config;
+  for (int64_t i = 0; i < num_tenants; i++) {
+    auto* virtual_host = route_config.add_virtual_hosts();
+    virtual_host->set_name(fmt::format("tenant_{}", i));
+    virtual_host->add_domains(fmt::format("*.tenant_{}.example.com", i));
+    auto* route = virtual_host->add_routes();
+    route->mutable_match()->set_prefix("/");
+    route->mutable_route()->set_cluster(fmt::format("cluster_{}", i));
+  }
+  return route_config;
+}
+
+void matchVirtualHost(benchmark::State& state, const std::string& host) {
+  RouterCheckTool tool = RouterCheckTool::create(wildcardDomainConfig(state.range(0)));
+  Http::TestHeaderMapImpl headers{{":authority", host}, {":path", "/"}, {":method", "GET"}};
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(tool.config().route(headers, 0));
+  }
+}
+
+} // namespace
+} // namespace Envoy
+
+// Matches the last of N prefix routes.
+static void BM_PrefixRouteMatchLast(benchmark::State& state) {
+  Envoy::matchRoute(state, Envoy::MatchType::Prefix,
+                    fmt::format("/service_{}/endpoint?id=1", state.range(0) - 1));
+}
+BENCHMARK(BM_PrefixRouteMatchLast)->RangeMultiplier(8)->Range(1, 4096);
+
+// Matches none of N prefix routes.
+static void BM_PrefixRouteMiss(benchmark::State& state) {
+  Envoy::matchRoute(state, Envoy::MatchType::Prefix, "/unknown/endpoint");
+}
+BENCHMARK(BM_PrefixRouteMiss)->RangeMultiplier(8)->Range(1, 4096);
+
+// Matches the last of N exact path routes.
+static void BM_PathRouteMatchLast(benchmark::State& state) {
+  Envoy::matchRoute(state, Envoy::MatchType::Path,
+                    fmt::format("/service_{}/endpoint", state.range(0) - 1));
+}
+BENCHMARK(BM_PathRouteMatchLast)->RangeMultiplier(8)->Range(1, 4096);
+
+// Matches the wildcard domain of the last of N tenants.
+static void BM_WildcardDomainMatchLast(benchmark::State& state) {
+  Envoy::matchVirtualHost(state, fmt::format("API.tenant_{}.example.com", state.range(0) - 1));
+}
+BENCHMARK(BM_WildcardDomainMatchLast)->RangeMultiplier(8)->Range(1, 4096);
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
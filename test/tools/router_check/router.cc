@@ -1,10 +1,13 @@
 #include "test/tools/router_check/router.h"
 
+#include <algorithm>
 #include <functional>
+#include <iomanip>
 #include <memory>
 #include <string>
 #include <unordered_map>
 
+#include "common/memory/stats.h"
 #include "common/network/utility.h"
 #include "common/protobuf/utility.h"
 #include "common/stream_info/stream_info_impl.h"
@@ -45,17 +48,23 @@ RouterCheckTool RouterCheckTool::create(const std::string& router_config_file) {
   // TODO(hennna): Allow users to load a full config and extract the route configuration from it.
   envoy::api::v2::RouteConfiguration route_config;
   MessageUtil::loadFromFile(router_config_file, route_config);
+  return create(route_config);
+}
 
+// static
+RouterCheckTool RouterCheckTool::create(const envoy::api::v2::RouteConfiguration& route_config) {
   auto factory_context = std::make_unique<NiceMock<Server::Configuration::MockFactoryContext>>();
   auto config = std::make_unique<Router::ConfigImpl>(route_config, *factory_context, false);
 
-  return RouterCheckTool(std::move(factory_context), std::move(config));
+  return RouterCheckTool(std::move(factory_context), std::move(config), route_config);
 }
 
 RouterCheckTool::RouterCheckTool(
     std::unique_ptr<NiceMock<Server::Configuration::MockFactoryContext>> factory_context,
-    std::unique_ptr<Router::ConfigImpl> config)
-    : factory_context_(std::move(factory_context)), config_(std::move(config)) {}
+    std::unique_ptr<Router::ConfigImpl> config,
+    const envoy::api::v2::RouteConfiguration& route_config)
+    : factory_context_(std::move(factory_context)), config_(std::move(config)),
+      route_config_(route_config) {}
 
 bool RouterCheckTool::compareEntriesInJson(const std::string& expected_route_json) {
   Json::ObjectSharedPtr loader = Json::Factory::loadFromFile(expected_route_json);
@@ -125,6 +134,133 @@ bool RouterCheckTool::compareEntriesInJson(const std::string& expected_route_jso
   return no_failures;
 }
 
+std::vector<BenchmarkRequest> RouterCheckTool::loadCorpus(const std::string& corpus_json) const {
+  Json::ObjectSharedPtr loader = Json::Factory::loadFromFile(corpus_json);
+  loader->validateSchema(Json::ToolSchema::routerCheckSchema());
+
+  std::vector<BenchmarkRequest> corpus;
+  for (const Json::ObjectSharedPtr& check_config : loader->asObjectArray()) {
+    corpus.push_back({check_config->getString("test_name", ""), ToolConfig::create(check_config)});
+  }
+  return corpus;
+}
+
+std::vector<BenchmarkRequest> RouterCheckTool::synthesizeCorpus() const {
+  std::vector<BenchmarkRequest> corpus;
+  for (const auto& virtual_host : route_config_.virtual_hosts()) {
+    std::string host = virtual_host.domains().empty() ? "" : virtual_host.domains(0);
+    std::replace(host.begin(), host.end(), '*', 'x');
+
+    for (const auto& route : virtual_host.routes()) {
+      std::string path;
+      switch (route.match().path_specifier_case()) {
+      case envoy::api::v2::route::RouteMatch::kPrefix:
+        path = route.match().prefix();
+        break;
+      case envoy::api::v2::route::RouteMatch::kPath:
+        path = route.match().path();
+        break;
+      default:
+        continue;
+      }
+
+      std::unique_ptr<Http::TestHeaderMapImpl> headers(new Http::TestHeaderMapImpl());
+      headers->addCopy(":authority", host);
+      headers->addCopy(":path", path.empty() ? "/" : path);
+      headers->addCopy("x-forwarded-proto", "http");
+      bool has_method = false;
+      for (const auto& header : route.match().headers()) {
+        if (header.invert_match()) {
+          continue;
+        }
+        std::string value;
+        switch (header.header_match_specifier_case()) {
+        case envoy::api::v2::route::HeaderMatcher::kExactMatch:
+          value = header.exact_match();
+          break;
+        case envoy::api::v2::route::HeaderMatcher::kPrefixMatch:
+          value = header.prefix_match();
+          break;
+        case envoy::api::v2::route::HeaderMatcher::kSuffixMatch:
+          value = header.suffix_match();
+          break;
+        case envoy::api::v2::route::HeaderMatcher::kRangeMatch:
+          value = std::to_string(header.range_match().start());
+          break;
+        case envoy::api::v2::route::HeaderMatcher::kRegexMatch:
+          // No value is known to match, so the route is benchmarked as a miss.
+          continue;
+        default:
+          value = "true";
+          break;
+        }
+        has_method |= Http::LowerCaseString(header.name()) == Http::Headers::get().Method;
+        headers->addCopy(header.name(), value);
+      }
+      if (!has_method) {
+        headers->addCopy(":method", "GET");
+      }
+
+      corpus.push_back({fmt::format("{} {}{}", virtual_host.name(), host, path),
+                        ToolConfig(std::move(headers), 0)});
+    }
+  }
+  return corpus;
+}
+
+void RouterCheckTool::benchmark(std::vector<BenchmarkRequest>& corpus, uint64_t iterations) {
+  if (corpus.empty() || iterations == 0) {
+    std::cout << "no requests to replay" << std::endl;
+    return;
+  }
+
+  std::vector<uint64_t> latencies;
+  latencies.reserve(corpus.size() * iterations);
+  std::vector<std::pair<uint64_t, size_t>> totals(corpus.size());
+  const uint64_t allocated_before = Memory::Stats::totalCurrentlyAllocated();
+  for (uint64_t i = 0; i < iterations; i++) {
+    for (size_t request = 0; request < corpus.size(); request++) {
+      ToolConfig& tool_config = corpus[request].tool_config_;
+      const MonotonicTime start = time_system_.monotonicTime();
+      tool_config.route_ = config_->route(*tool_config.headers_, tool_config.random_value_);
+      const uint64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   time_system_.monotonicTime() - start)
+                                   .count();
+      latencies.push_back(latency);
+      totals[request].first += latency;
+      totals[request].second = request;
+    }
+  }
+  const uint64_t allocated_after = Memory::Stats::totalCurrentlyAllocated();
+
+  std::sort(latencies.begin(), latencies.end());
+  const auto percentile = [&latencies](double p) -> uint64_t {
+    return latencies[std::min<size_t>(latencies.size() - 1, latencies.size() * p)];
+  };
+  std::cout << "requests: " << corpus.size() << ", iterations: " << iterations << std::endl;
+  std::cout << "route() latency (ns): p50 " << percentile(0.5) << ", p90 " << percentile(0.9)
+            << ", p99 " << percentile(0.99) << ", p999 " << percentile(0.999) << ", max "
+            << latencies.back() << std::endl;
+  // Allocations freed before route() returns do not show up here.
+  std::cout << "memory retained (bytes): "
+            << (allocated_after > allocated_before ? allocated_after - allocated_before : 0)
+            << std::endl;
+
+  std::sort(totals.begin(), totals.end(), std::greater<std::pair<uint64_t, size_t>>());
+  std::cout << "slowest requests (mean ns, request, cluster):" << std::endl;
+  for (size_t i = 0; i < std::min<size_t>(totals.size(), 10); i++) {
+    const BenchmarkRequest& request = corpus[totals[i].second];
+    const Router::RouteConstSharedPtr& route = request.tool_config_.route_;
+    std::string cluster = "<no route>";
+    if (route != nullptr) {
+      cluster = route->routeEntry() != nullptr ? route->routeEntry()->clusterName()
+                                               : "<direct response>";
+    }
+    std::cout << std::setw(10) << totals[i].first / iterations << "  " << request.name_ << "  "
+              << cluster << std::endl;
+  }
+}
+
 bool RouterCheckTool::compareCluster(ToolConfig& tool_config, const std::string& expected) {
   std::string actual = "";
 
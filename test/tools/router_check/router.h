@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "common/common/logger.h"
 #include "common/common/utility.h"
@@ -12,6 +13,7 @@
 
 #include "test/mocks/server/mocks.h"
 #include "test/test_common/printers.h"
+#include "test/test_common/test_time.h"
 #include "test/test_common/utility.h"
 #include "test/tools/router_check/json/tool_config_schemas.h"
 
@@ -35,9 +37,19 @@ struct ToolConfig {
   int random_value_;
 
 private:
+  friend class RouterCheckTool;
+
   ToolConfig(std::unique_ptr<Http::TestHeaderMapImpl> headers, int random_value);
 };
 
+/**
+ * A request replayed by the benchmark mode of the router check tool.
+ */
+struct BenchmarkRequest {
+  std::string name_;
+  ToolConfig tool_config_;
+};
+
 /**
  * A route table check tool that check whether route parameters returned by a router match
  * what is expected.
@@ -51,6 +63,12 @@ public:
    * */
   static RouterCheckTool create(const std::string& router_config_file);
 
+  /**
+   * @param route_config v2 router config.
+   * @return RouterCheckTool a RouterCheckTool instance for the route configuration.
+   */
+  static RouterCheckTool create(const envoy::api::v2::RouteConfiguration& route_config);
+
   /**
    * TODO(tonya11en): Use a YAML format for the expected routes. This will require a proto.
    *
@@ -59,15 +77,43 @@ public:
    */
   bool compareEntriesInJson(const std::string& expected_route_json);
 
+  /**
+   * @param corpus_json tool config json file. Only the inputs of its test cases are used.
+   * @return std::vector<BenchmarkRequest> a request for each test case, named after it.
+   */
+  std::vector<BenchmarkRequest> loadCorpus(const std::string& corpus_json) const;
+
+  /**
+   * Synthesizes a request for each route with a prefix or path match, sent to the first domain of
+   * its virtual host and carrying the headers the route matches on. Wildcards in domains are
+   * replaced with "x". Regex routes are skipped.
+   * @return std::vector<BenchmarkRequest> the synthesized requests.
+   */
+  std::vector<BenchmarkRequest> synthesizeCorpus() const;
+
+  /**
+   * Replays each request of a corpus against the route table and prints the latency percentiles
+   * of route(), the memory retained by the route table while replaying, and the slowest requests.
+   * @param corpus supplies the requests to replay.
+   * @param iterations supplies how many times each request is replayed.
+   */
+  void benchmark(std::vector<BenchmarkRequest>& corpus, uint64_t iterations);
+
   /**
    * Set whether to print out match case details.
    */
   void setShowDetails() { details_ = true; }
 
+  /**
+   * @return the route configuration under test.
+   */
+  const Router::Config& config() const { return *config_; }
+
 private:
   RouterCheckTool(
       std::unique_ptr<NiceMock<Server::Configuration::MockFactoryContext>> factory_context,
-      std::unique_ptr<Router::ConfigImpl> config);
+      std::unique_ptr<Router::ConfigImpl> config,
+      const envoy::api::v2::RouteConfiguration& route_config);
   bool compareCluster(ToolConfig& tool_config, const std::string& expected);
   bool compareVirtualCluster(ToolConfig& tool_config, const std::string& expected);
   bool compareVirtualHost(ToolConfig& tool_config, const std::string& expected);
@@ -93,5 +139,8 @@ private:
   // TODO(hennna): Switch away from mocks following work done by @rlazarus in github issue #499.
   std::unique_ptr<NiceMock<Server::Configuration::MockFactoryContext>> factory_context_;
   std::unique_ptr<Router::ConfigImpl> config_;
+  envoy::api::v2::RouteConfiguration route_config_;
+  // Benchmark latencies are measured in real time.
+  Event::TestRealTimeSystem time_system_;
 };
 } // namespace Envoy
@@ -1,17 +1,34 @@
 // NOLINT(namespace-envoy)
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "test/tools/router_check/router.h"
 
 int main(int argc, char* argv[]) {
-  if (argc < 3 || argc > 4) {
+  if (argc < 3 || argc > 5) {
     return EXIT_FAILURE;
   }
 
   try {
     Envoy::RouterCheckTool checktool = Envoy::RouterCheckTool::create(argv[1]);
 
+    if (argc >= 4 && std::string(argv[3]) == "--benchmark") {
+      uint64_t iterations = 1000;
+      if (argc == 5 && !Envoy::StringUtil::atoul(argv[4], iterations)) {
+        return EXIT_FAILURE;
+      }
+      std::vector<Envoy::BenchmarkRequest> corpus = std::string(argv[2]) == "--synthesize"
+                                                        ? checktool.synthesizeCorpus()
+                                                        : checktool.loadCorpus(argv[2]);
+      checktool.benchmark(corpus, iterations);
+      return EXIT_SUCCESS;
+    }
+
+    if (argc == 5) {
+      return EXIT_FAILURE;
+    }
+
     if (argc == 4 && std::string(argv[3]) == "--details") {
       checktool.setShowDetails();
     }
@@ -31,3 +31,14 @@ FAILURE_OUTPUT=$("${PATH_BIN}" "${PATH_CONFIG}/TestRoutes.yaml" "${PATH_CONFIG}/
 if [[ "${FAILURE_OUTPUT}" != *"expected: [cluster1], actual: [instant-server], test type: cluster_name"* ]]; then
   exit 1
 fi
+
+# Benchmark mode
+echo testing benchmark mode
+BENCHMARK_OUTPUT=$("${PATH_BIN}" "${PATH_CONFIG}/TestRoutes.yaml" "${PATH_CONFIG}/TestRoutes.golden.json" "--benchmark" 10)
+if [[ "${BENCHMARK_OUTPUT}" != *"route() latency (ns): p50"* ]]; then
+  exit 1
+fi
+SYNTHESIZED_OUTPUT=$("${PATH_BIN}" "${PATH_CONFIG}/TestRoutes.yaml" "--synthesize" "--benchmark" 10)
+if [[ "${SYNTHESIZED_OUTPUT}" != *"slowest requests"* ]]; then
+  exit 1
+fi